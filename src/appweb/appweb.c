@@ -29,6 +29,7 @@
  *          --ejs name:path         # Create an ejs application at the path
  *          --log logFile:level     # Log to file file at verbosity level
  *          --name uniqueName       # Name for this instance
+ *          --reactors count        # Set the number of I/O event loops
  *          --threads maxThreads    # Set maximum pool threads
  *          --version               # Output version information
  *          -v                      # Same as --log stdout:2
@@ -76,7 +77,7 @@ int main(int argc, char **argv)
     MaHttp      *http;
     cchar       *ipAddrPort, *documentRoot, *homeDir, *argp, *logSpec, *ejsAlias;
     char        *configFile, *ipAddr;
-    int         err, poolThreads, outputVersion, argind, port;
+    int         err, poolThreads, reactors, outputVersion, argind, port;
     
     mpr = mprCreate(argc, argv, memoryFailure);
     mprSetAppName(mpr, argv[0], BLD_NAME, BLD_VERSION);
@@ -109,6 +110,7 @@ int main(int argc, char **argv)
     homeDir = 0;
     outputVersion = 0;
     poolThreads = -1;
+    reactors = -1;
 
     for (argind = 1; !err && argind < argc; argind++) {
         argp = argv[argind];
@@ -184,6 +186,14 @@ int main(int argc, char **argv)
                 mprSetAppName(mpr, argv[++argind], 0, 0);
             }
 
+        } else if (strcmp(argp, "--reactors") == 0) {
+            if (argind >= argc) {
+                err++;
+
+            } else {
+                reactors = atoi(argv[++argind]);
+            }
+
         } else if (strcmp(argp, "--threads") == 0) {
             if (argind >= argc) {
                 err++;
@@ -277,6 +287,9 @@ int main(int argc, char **argv)
     }
 #endif
 
+    if (reactors >= 0) {
+        http->limits.reactors = reactors;
+    }
 #if BLD_FEATURE_MULTITHREAD
     if (poolThreads >= 0) {
         mprSetMaxPoolThreads(http, poolThreads);
@@ -404,6 +417,7 @@ static void printUsage(Mpr *mpr)
     "    --home directory       # Change to directory to run\n"
     "    --name uniqueName      # Unique name for this instance\n"
     "    --log logFile:level    # Log to file file at verbosity level\n"
+    "    --reactors count       # Set the number of I/O event loops\n"
     "    --threads maxThreads   # Set maximum pool threads\n"
     "    --version              # Output version information\n\n"
     "  Without IPaddress, %s will read the appweb.conf configuration file.\n\n",
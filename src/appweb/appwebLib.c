@@ -1041,6 +1041,16 @@ int maConfigureServer(MprCtx ctx, MaHttp *http, MaServer *server, cchar *configF
             maAddHandler(http, location, "fileHandler", "");
         }
 
+        /*
+         *  Output filters in the same order as the default configuration file. Streamed responses need the chunk filter.
+         */
+        if (maLookupStage(http, "rangeFilter")) {
+            maAddFilter(http, location, "rangeFilter", "", MA_FILTER_OUTGOING);
+        }
+        if (maLookupStage(http, "chunkFilter")) {
+            maAddFilter(http, location, "chunkFilter", "", MA_FILTER_OUTGOING);
+        }
+
         /*
          *  Add cgi-bin with a location block for the /cgi-bin URL prefix.
          */
@@ -1863,6 +1873,22 @@ static int processSetting(MaServer *server, char *key, char *value, MaConfigStat
             limits->maxHeader = num;
             return 1;
 
+        } else if (mprStrcmpAnyCase(key, "LimitFileCache") == 0) {
+            num = atoi(value);
+            if (num < MA_BOT_FILE_CACHE || num > MA_TOP_FILE_CACHE) {
+                return MPR_ERR_BAD_SYNTAX;
+            }
+            limits->maxFileCache = num;
+            return 1;
+
+        } else if (mprStrcmpAnyCase(key, "LimitFileCacheItem") == 0) {
+            num = atoi(value);
+            if (num < MA_BOT_FILE_CACHE_ITEM || num > MA_TOP_FILE_CACHE_ITEM) {
+                return MPR_ERR_BAD_SYNTAX;
+            }
+            limits->maxFileCacheItem = num;
+            return 1;
+
         } else if (mprStrcmpAnyCase(key, "LimitResponseBody") == 0) {
             num = atoi(value);
             if (num < MA_BOT_RESPONSE_BODY || num > MA_TOP_RESPONSE_BODY) {
@@ -1871,6 +1897,14 @@ static int processSetting(MaServer *server, char *key, char *value, MaConfigStat
             limits->maxResponseBody = num;
             return 1;
 
+        } else if (mprStrcmpAnyCase(key, "LimitSendBatch") == 0) {
+            num = atoi(value);
+            if (num < MA_BOT_SEND_BATCH || num > MA_TOP_SEND_BATCH) {
+                return MPR_ERR_BAD_SYNTAX;
+            }
+            limits->maxSendBatch = num;
+            return 1;
+
         } else if (mprStrcmpAnyCase(key, "LimitStageBuffer") == 0) {
             num = atoi(value);
             if (num < MA_BOT_STAGE_BUFFER || num > MA_TOP_STAGE_BUFFER) {
@@ -2141,6 +2175,16 @@ static int processSetting(MaServer *server, char *key, char *value, MaConfigStat
             maInsertAlias(host, alias);
             return 1;
 
+        } else if (mprStrcmpAnyCase(key, "Reactors") == 0) {
+#if BLD_FEATURE_MULTITHREAD
+            num = atoi(value);
+            if (num < 0 || num > MA_TOP_REACTORS) {
+                return MPR_ERR_BAD_SYNTAX;
+            }
+            limits->reactors = num;
+#endif
+            return 1;
+
         } else if (mprStrcmpAnyCase(key, "ResetPipeline") == 0) {
             maResetPipeline(location);
             return 1;
@@ -2713,12 +2757,24 @@ int MaServer::saveConfig(char *configFile)
     if (limits->minThreads != 0) {
         mprFprintf(fd, "\nStartThreads %d\n", limits->minThreads);
     }
+    if (limits->reactors > 1) {
+        mprFprintf(fd, "Reactors %d\n", limits->reactors);
+    }
     if (limits->maxBody != MA_MAX_BODY) {
         mprFprintf(fd, "LimitRequestBody %d\n", limits->maxBody);
     }
     if (limits->maxResponseBody != MA_MAX_RESPONSE_BODY) {
         mprFprintf(fd, "LimitResponseBody %d\n", limits->maxResponseBody);
     }
+    if (limits->maxFileCache != MA_FILE_CACHE_SIZE) {
+        mprFprintf(fd, "LimitFileCache %d\n", limits->maxFileCache);
+    }
+    if (limits->maxFileCacheItem != MA_FILE_CACHE_ITEM) {
+        mprFprintf(fd, "LimitFileCacheItem %d\n", limits->maxFileCacheItem);
+    }
+    if (limits->maxSendBatch != MA_MAX_SEND_BATCH) {
+        mprFprintf(fd, "LimitSendBatch %d\n", limits->maxSendBatch);
+    }
     if (limits->maxNumHeaders != MA_MAX_NUM_HEADERS) {
         mprFprintf(fd, "LimitRequestFields %d\n", limits->maxNumHeaders);
     }
@@ -3187,7 +3243,12 @@ static MaConn *createConn(MprCtx ctx, MaHost *host, MprSocket *sock, cchar *ipAd
     conn->host = host;
     conn->originalHost = host;
     conn->input = 0;
-    conn->expire = 1;
+
+    /*
+     *  The host timer closes expired connections. Give the first request the full timeout as it may run the event 
+     *  loop (and the timer) before the first I/O event has been processed.
+     */
+    conn->expire = mprGetTime(conn) + host->timeout;
 
     maInitSchedulerQueue(&conn->serviceq);
 
@@ -3200,6 +3261,10 @@ static MaConn *createConn(MprCtx ctx, MaHost *host, MprSocket *sock, cchar *ipAd
  */
 static int connectionDestructor(MaConn *conn)
 {
+    /*
+     *  Shared packet data is freed with the connection. Tell the packet destructors not to release it.
+     */
+    conn->flags |= MA_CONN_DESTROYED;
     maRemoveConn(conn->host, conn);
     mprAssert(conn->sock);
 
@@ -3330,6 +3395,12 @@ static void setupHandler(MaConn *conn)
         mprSetSocketCallback(conn->sock, (MprSocketProc) ioEvent, conn, NULL, conn->socketEventMask, MPR_NORMAL_PRIORITY);
     } else {
         mprSetSocketEventMask(conn->sock, conn->socketEventMask);
+#if BLD_FEATURE_MULTITHREAD
+        /*
+         *  The wait service disables a handler's events while it is being serviced
+         */
+        mprEnableWaitEvents(conn->sock->handler, 1);
+#endif
     }
 }
 
@@ -3341,6 +3412,13 @@ static void setupConnIO(MaConn *conn)
 {
     conn->socketEventMask = 0;
     
+    if (conn->request && MPR_HTTP_STATE_COMPLETE == conn->state) {
+        /*
+         *  A write event may have completed the request. Finish it now so the connection is either closed or 
+         *  listens for the next request below.
+         */
+        maProcessReadEvent(conn, 0);
+    }
     if (conn->request) {
         if (conn->response->queue[MA_QUEUE_SEND].prevQ->count > 0) {
             /*
@@ -3350,9 +3428,6 @@ static void setupConnIO(MaConn *conn)
         }
         if (conn->state <= MPR_HTTP_STATE_CHUNK) {
             conn->socketEventMask |= MPR_READABLE;
-            
-        } else if (MPR_HTTP_STATE_COMPLETE == conn->state) {
-            maProcessReadEvent(conn, 0);
         }
 
     } else {
@@ -3369,13 +3444,14 @@ static void setupConnIO(MaConn *conn)
         }
     }
 
+    //  TODO Locking??
+    conn->expire = conn->time + conn->host->timeout;
+
     /*
-     *  Not end of file so enable an I/O handler to listen for either more data or another request on this connection
+     *  Not end of file so enable an I/O handler to listen for either more data or another request on this connection.
+     *  When multithreaded, another pool thread may service the next event and free the connection once this returns.
      */
     setupHandler(conn);
-
-    //  TODO Locking??
-    conn->expire = conn->time + conn->host->timeout;
 }
 
 
@@ -3532,6 +3608,24 @@ void *maGetHandlerQueueData(MaConn *conn)
 static void addPacketForNet(MaQueue *q, MaPacket *packet);
 static void adjustNetVec(MaQueue *q, int written);
 static int  buildNetVec(MaQueue *q);
+static bool deferNetWrite(MaQueue *q);
+
+
+/*
+ *  Invoked to initialize the net connector for a request
+ */
+static void netOpen(MaQueue *q)
+{
+    MaLimits    *limits;
+
+    /*
+     *  Let upstream stages queue a full send batch before the connector applies back pressure
+     */
+    limits = &q->conn->http->limits;
+    if (q->direction == MA_QUEUE_SEND) {
+        q->max = max(q->max, limits->maxSendBatch);
+    }
+}
 
 
 static void netOutgoingService(MaQueue *q)
@@ -3545,14 +3639,25 @@ static void netOutgoingService(MaQueue *q)
     
     while (q->first || q->ioIndex) {
 
-        if (q->ioIndex == 0 && buildNetVec(q) <= 0) {
-            break;
+        if (q->ioIndex == 0) {
+            if (deferNetWrite(q)) {
+                break;
+            }
+            if (buildNetVec(q) <= 0) {
+                if (q->flags & MA_QUEUE_EOF) {
+                    /* Only the end packet remains. All the data has already been written. */
+                    maCompleteRequest(conn);
+                }
+                break;
+            }
         }
 
         /*
-         *  Issue a single I/O request to write all the blocks in the I/O vector
+         *  Issue a single I/O request to write all the blocks in the I/O vector. If the headers are going out ahead 
+         *  of body data that is still to come, cork the socket so they share a frame with the body.
          */
         mprAssert(q->ioIndex > 0);
+        mprSetSocketCork(conn->sock, (q->first->flags & MA_PACKET_HEADER) && !(q->flags & MA_QUEUE_EOF));
         written = mprWriteSocketVector(conn->sock, q->iovec, q->ioIndex);
         mprLog(q, 5, "Net connector write %d", written);
 
@@ -3602,6 +3707,26 @@ static void netOutgoingService(MaQueue *q)
 }
 
 
+/*
+ *  Decide if writing should wait to coalesce more output. If the response is incomplete, less than a send batch is 
+ *  queued and other queues are scheduled to run (which may add more), reschedule this queue to run after them.
+ */
+static bool deferNetWrite(MaQueue *q)
+{
+    MaConn      *conn;
+
+    conn = q->conn;
+    if (q->last == 0 || (q->last->flags & MA_PACKET_END) || q->count >= conn->http->limits.maxSendBatch) {
+        return 0;
+    }
+    if (conn->serviceq.scheduleNext == &conn->serviceq) {
+        return 0;
+    }
+    maScheduleQueue(q);
+    return 1;
+}
+
+
 /*
  *  Build the IO vector. Return the count of bytes to be written. Return -1 for EOF.
  */
@@ -3610,13 +3735,15 @@ static int buildNetVec(MaQueue *q)
     MaConn      *conn;
     MaResponse  *resp;
     MaPacket    *packet;
+    int         batch;
 
     conn = q->conn;
     resp = conn->response;
+    batch = conn->http->limits.maxSendBatch;
 
     /*
-     *  Examine each packet and accumulate as many packets into the I/O vector as possible. Leave the packets on the queue 
-     *  for now, they are removed after the IO is complete for the entire packet.
+     *  Examine each packet and accumulate as many packets into the I/O vector as possible, up to the send batch limit. 
+     *  Leave the packets on the queue for now, they are removed after the IO is complete for the entire packet.
      */
     for (packet = q->first; packet; packet = packet->next) {
         
@@ -3626,6 +3753,9 @@ static int buildNetVec(MaQueue *q)
         if (q->ioIndex >= (MA_MAX_IOVEC - 2)) {
             break;
         }
+        if (packet->count > 0 && q->ioCount >= batch) {
+            break;
+        }
         if (packet->flags & MA_PACKET_HEADER) {
             if (resp->chunkSize <= 0 && q->count > 0 && resp->length < 0) {
                 /* Incase no chunking filter and we've not seen all the data yet */
@@ -3793,7 +3923,7 @@ static void adjustNetVec(MaQueue *q, int written)
         /*
          *  Compact
          */
-        for (j = 0; i < q->ioIndex; j++) {
+        for (j = 0; i < q->ioIndex; ) {
             iovec[j++] = iovec[i++];
         }
         q->ioIndex = j;
@@ -3812,6 +3942,7 @@ int maOpenNetConnector(MaHttp *http)
     if (stage == 0) {
         return MPR_ERR_CANT_CREATE;
     }
+    stage->open = netOpen;
     stage->outgoingService = netOutgoingService;
     http->netConnector = stage;
     return 0;
@@ -3930,6 +4061,10 @@ static void sendOutgoingService(MaQueue *q)
              *  Rebuild the iovector only when the past vector has been completely written. Simplifies the logic quite a bit.
              */
             if (buildSendVec(q) <= 0) {
+                if (q->flags & MA_QUEUE_EOF) {
+                    /* Only the end packet remains. All the data has already been written. */
+                    maCompleteRequest(conn);
+                }
                 break;
             }
         }
@@ -3939,6 +4074,7 @@ static void sendOutgoingService(MaQueue *q)
          */
         ioCount = q->ioIndex - q->ioFileEntry;
         mprAssert(ioCount >= 0);
+        mprSetSocketCork(conn->sock, (q->first->flags & MA_PACKET_HEADER) && !(q->flags & MA_QUEUE_EOF));
         written = mprSendFileToSocket(resp->file, conn->sock, resp->pos, q->ioCount, q->iovec, ioCount, NULL, 0);
         if (written < 0) {
             errCode = mprGetOsError(q);
@@ -3979,9 +4115,11 @@ static int buildSendVec(MaQueue *q)
     MaConn      *conn;
     MaResponse  *resp;
     MaPacket    *packet;
+    int         batch;
 
     conn = q->conn;
     resp = conn->response;
+    batch = conn->http->limits.maxSendBatch;
 
     mprAssert(q->ioIndex == 0);
     q->ioCount = 0;
@@ -3999,6 +4137,9 @@ static int buildSendVec(MaQueue *q)
         if (q->ioIndex >= (MA_MAX_IOVEC - 2)) {
             break;
         }
+        if (packet->count > 0 && q->ioCount >= batch) {
+            break;
+        }
         
         if (packet->flags & MA_PACKET_HEADER) {
             maFillHeaders(conn, packet);
@@ -4207,7 +4348,7 @@ static void adjustSendVec(MaQueue *q, int written)
         /*
          *  Compact
          */
-        for (j = 0; i < q->ioIndex; j++) {
+        for (j = 0; i < q->ioIndex; ) {
             iovec[j++] = iovec[i++];
         }
         q->ioIndex = j;
@@ -5367,6 +5508,10 @@ void maRangeService(MaQueue *q, MaRangeFillProc fill)
            resp->entityLength = q->count;
         }
         if (resp->code != MPR_HTTP_CODE_OK || !maFixRangeLength(conn)) {
+            /*
+             *  Ignore the ranges and send the full response. Ranges from the end need the entity length.
+             */
+            req->ranges = 0;
             maSendPackets(q);
             maRemoveQueue(q);
             return;
@@ -5440,24 +5585,27 @@ void maRangeService(MaQueue *q, MaRangeFillProc fill)
                         return;
                     }
                 }
-                bytes -= count;
-                resp->pos += count;
-                if (resp->rangeBoundary) {
+                if (resp->rangeBoundary && resp->pos == range->start) {
+                    /* A range may span packets. Only the first is preceded by the range boundary */
                     maPutNext(q, createRangePacket(conn, range));
                 }
+                bytes -= count;
+                resp->pos += count;
 #if UNUSED
                 //  TODO - is this being used anywhere?
                 packet->pos = resp->pos;
 #endif
                 maPutNext(q, packet);
                 if (resp->pos >= range->end) {
-                    range = range->next;
+                    /*
+                     *  Save the current range now as this routine returns early when the downstream queue is full
+                     */
+                    range = resp->currentRange = range->next;
                 }
                 break;
             }
         }
     }
-    resp->currentRange = range;
 }
 
 
@@ -5548,7 +5696,8 @@ bool maFixRangeLength(MaConn *conn)
          *      Range: -50              Last 50 bytes
          *      Range: 1-               Skip first byte then emit the rest
          */
-        if (length) {
+        if (length > 0) {
+            /* The entity length is -1 until a dynamic response is complete */
             if (range->end > length) {
                 range->end = length;
             }
@@ -7898,10 +8047,29 @@ void mprEgiHandlerDummy() {}
 
 #if BLD_FEATURE_FILE
 
+/*
+ *  Static file cache. Cached files are reference counted by the cache and by the responses serving them, so an
+ *  evicted file remains valid until the last response using it is freed.
+ */
+typedef struct MaFileCache {
+    MprHashTable    *index;                 /* Cached files by filename */
+    MaCachedFile    lru;                    /* LRU list head */
+    int             size;                   /* Memory used by cached files */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;
+#endif
+} MaFileCache;
+
 
+static bool acceptsGzip(cchar *accept);
+static bool gzipChanged(MaCachedFile *file);
 static void handleDeleteRequest(MaQueue *q);
 static int  readFileData(MaQueue *q, MaPacket *packet);
 static void handlePutRequest(MaQueue *q);
+static MaCachedFile *loadCachedFile(MaConn *conn, MaFileCache *cache);
+static void lockFileCache(MaFileCache *cache);
+static void unlockFileCache(MaFileCache *cache);
+static void removeCachedFile(MaFileCache *cache, MaCachedFile *file);
 
 /*
  *  Initialize a handler instance for the file handler.
@@ -7911,7 +8079,9 @@ static void openFile(MaQueue *q)
     MaRequest       *req;
     MaResponse      *resp;
     MaConn          *conn;
+    MaCachedFile    *cached;
     char            *date;
+    int             length;
 
     conn = q->conn;
     resp = conn->response;
@@ -7920,22 +8090,41 @@ static void openFile(MaQueue *q)
     switch (req->method) {
     case MA_REQ_GET:
     case MA_REQ_HEAD:
-        //  TODO - OPT could cache this
-        date = maGetDateString(conn->arena, &resp->fileInfo);
-        maSetHeader(conn, 0, "Last-Modified", date);
-        mprFree(date);
+        if ((cached = resp->cachedFile) != 0) {
+            /*
+             *  Serve from memory. Use the precompressed variant if the client accepts it and wants the whole file.
+             */
+            resp->cachedData = cached->data;
+            length = cached->length;
+            if (cached->gzipData) {
+                maSetHeader(conn, 0, "Vary", "Accept-Encoding");
+                if (req->ranges == 0 && acceptsGzip(req->acceptEncoding)) {
+                    maSetHeader(conn, 0, "Content-Encoding", "gzip");
+                    resp->cachedData = cached->gzipData;
+                    resp->etag = cached->gzipEtag;
+                    length = cached->gzipLength;
+                }
+            }
+            maSetHeader(conn, 0, "Last-Modified", "%s", cached->lastModified);
+
+        } else {
+            date = maGetDateString(conn->arena, &resp->fileInfo);
+            maSetHeader(conn, 0, "Last-Modified", date);
+            mprFree(date);
+            length = (int) resp->fileInfo.size;
+        }
 
         if (maContentNotModified(conn)) {
             maSetResponseCode(conn, MPR_HTTP_CODE_NOT_MODIFIED);
             maOmitResponseBody(conn);
         } else {
-            maSetEntityLength(conn, (int) resp->fileInfo.size);
+            maSetEntityLength(conn, length);
         }
         
         if (!resp->fileInfo.isReg) {
             maFailRequest(conn, MPR_HTTP_CODE_NOT_FOUND, "Can't locate document: %s", req->url);
             
-        } else if (!(resp->connector == conn->http->sendConnector)) {
+        } else if (cached == 0 && !(resp->connector == conn->http->sendConnector)) {
             /*
              *  Open the file if a body must be sent with the response. The file will be automatically closed when 
              *  the response is freed. Cool eh?
@@ -7949,11 +8138,13 @@ static void openFile(MaQueue *q)
                 
     case MA_REQ_PUT:
         maOmitResponseBody(conn);
+        maRemoveCachedFile(conn->http, resp->filename);
         handlePutRequest(q);
         break;
         
     case MA_REQ_DELETE:
         maOmitResponseBody(conn);
+        maRemoveCachedFile(conn->http, resp->filename);
         handleDeleteRequest(q);
         break;
             
@@ -8071,6 +8262,7 @@ static void incomingFileData(MaQueue *q, MaPacket *packet)
          */
         mprFree(file);
         q->queueData = 0;
+        maRemoveCachedFile(conn->http, resp->filename);
         return;
     }
 
@@ -8113,6 +8305,22 @@ static int readFileData(MaQueue *q, MaPacket *packet)
     len = packet->count;
     mprAssert(len > 0);
 
+    if (resp->cachedData) {
+        /*
+         *  Reference the cached content rather than copying it. The response holds a reference on the cached file.
+         *  For ranged requests, maRangeService will have set resp->pos to the next read position already.
+         */
+        mprAssert(packet->content == 0);
+        if ((packet->content = mprAllocObjZeroed(packet, MprBuf)) == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        packet->content->data = packet->content->start = (uchar*) &resp->cachedData[resp->pos];
+        packet->content->end = packet->content->endbuf = packet->content->data + len;
+        packet->content->buflen = packet->content->maxsize = len;
+        packet->flags |= MA_PACKET_BORROWED;
+        return len;
+    }
+
     if (packet->content == 0) {
         packet->content = mprCreateBuf(packet, len, len);
         if (packet->content == 0) {
@@ -8225,6 +8433,267 @@ static void handleDeleteRequest(MaQueue *q)
 }
 
 
+/*
+ *  Get a cached copy of the response file. See appweb.h for details.
+ */
+MaCachedFile *maGetCachedFile(MaConn *conn, bool fresh)
+{
+    MaFileCache     *cache;
+    MaResponse      *resp;
+    MaCachedFile    *file;
+    MprFileInfo     *info;
+    MprTime         now;
+
+    resp = conn->response;
+    cache = conn->http->fileCache;
+    if (cache == 0 || conn->http->limits.maxFileCache <= 0 || resp->filename == 0) {
+        return 0;
+    }
+    if ((file = resp->cachedFile) != 0) {
+        if (strcmp(file->filename, resp->filename) == 0) {
+            return file;
+        }
+        /* The filename was remapped (directory index or extra path info) since the file was looked up */
+        resp->cachedFile = 0;
+        maReleaseCachedFile(conn->http, file);
+    }
+    info = &resp->fileInfo;
+    now = mprGetTime(conn);
+
+    lockFileCache(cache);
+    if ((file = (MaCachedFile*) mprLookupHash(cache->index, resp->filename)) != 0) {
+        if ((now - file->checked) >= MA_FILE_CACHE_VALID) {
+            if (fresh) {
+                file = 0;
+            } else if (info->valid && file->info.inode == info->inode && file->info.size == info->size && 
+                    file->info.mtime == info->mtime && !gzipChanged(file)) {
+                file->checked = now;
+            } else {
+                removeCachedFile(cache, file);
+                file = 0;
+            }
+        }
+    }
+    if (file == 0 && !fresh && info->valid && info->isReg && info->size <= conn->http->limits.maxFileCacheItem) {
+        file = loadCachedFile(conn, cache);
+    }
+    if (file) {
+        file->prev->next = file->next;
+        file->next->prev = file->prev;
+        file->next = cache->lru.next;
+        file->prev = &cache->lru;
+        cache->lru.next->prev = file;
+        cache->lru.next = file;
+        file->refs++;
+        resp->cachedFile = file;
+        if (fresh) {
+            *info = file->info;
+        }
+    }
+    unlockFileCache(cache);
+    return file;
+}
+
+
+void maReleaseCachedFile(MaHttp *http, MaCachedFile *file)
+{
+    MaFileCache     *cache;
+
+    cache = http->fileCache;
+    lockFileCache(cache);
+    if (--file->refs <= 0) {
+        mprFree(file);
+    }
+    unlockFileCache(cache);
+}
+
+
+void maRemoveCachedFile(MaHttp *http, cchar *filename)
+{
+    MaFileCache     *cache;
+    MaCachedFile    *file;
+
+    if ((cache = http->fileCache) == 0 || filename == 0) {
+        return;
+    }
+    lockFileCache(cache);
+    if ((file = (MaCachedFile*) mprLookupHash(cache->index, filename)) != 0) {
+        removeCachedFile(cache, file);
+    }
+    unlockFileCache(cache);
+}
+
+
+/*
+ *  Read a file and its precompressed variant into the cache. Evicts the least recently used files to make room. 
+ *  Must be called locked.
+ */
+static MaCachedFile *loadCachedFile(MaConn *conn, MaFileCache *cache)
+{
+    MaResponse      *resp;
+    MaCachedFile    *file;
+    MprFile         *fp;
+    int             length, size;
+
+    resp = conn->response;
+    length = (int) resp->fileInfo.size;
+    size = (int) (sizeof(MaCachedFile) + 2 * strlen(resp->filename) + length);
+    if (size > conn->http->limits.maxFileCache) {
+        return 0;
+    }
+    if ((file = mprAllocObjZeroed(cache, MaCachedFile)) == 0) {
+        return 0;
+    }
+    file->filename = mprStrdup(file, resp->filename);
+    mprAllocStrcat(file, &file->gzipName, -1, NULL, resp->filename, ".gz", NULL);
+    file->info = resp->fileInfo;
+    file->data = mprAlloc(file, length + 1);
+    if (file->filename == 0 || file->gzipName == 0 || file->data == 0) {
+        mprFree(file);
+        return 0;
+    }
+    if ((fp = mprOpen(file, resp->filename, O_RDONLY | O_BINARY, 0)) == 0 || mprRead(fp, file->data, length) != length) {
+        mprFree(file);
+        return 0;
+    }
+    mprFree(fp);
+    file->length = length;
+
+    /*
+     *  Use a precompressed variant if one exists and is not older than the file. Its information is kept even if it 
+     *  is not used so the entry is reloaded when the variant is created, modified or removed.
+     */
+    mprGetFileInfo(file, file->gzipName, &file->gzipInfo);
+    if (file->gzipInfo.valid && file->gzipInfo.isReg && file->gzipInfo.mtime >= file->info.mtime &&
+            file->gzipInfo.size < length && (fp = mprOpen(file, file->gzipName, O_RDONLY | O_BINARY, 0)) != 0) {
+        file->gzipLength = (int) file->gzipInfo.size;
+        file->gzipData = mprAlloc(file, file->gzipLength + 1);
+        if (file->gzipData == 0 || mprRead(fp, file->gzipData, file->gzipLength) != file->gzipLength) {
+            mprFree(file->gzipData);
+            file->gzipData = 0;
+            file->gzipLength = 0;
+        }
+        mprFree(fp);
+    }
+
+    mprAllocSprintf(file, &file->etag, -1, "%x-%Lx-%Lx", file->info.inode, file->info.size, file->info.mtime);
+    if (file->gzipData) {
+        mprAllocSprintf(file, &file->gzipEtag, -1, "%s-gz", file->etag);
+    }
+    file->lastModified = maGetDateString(file, &file->info);
+    file->checked = mprGetTime(conn);
+    file->size = size + file->gzipLength;
+    file->refs = 1;
+
+    while (cache->size + file->size > conn->http->limits.maxFileCache && cache->lru.prev != &cache->lru) {
+        removeCachedFile(cache, cache->lru.prev);
+    }
+    file->next = cache->lru.next;
+    file->prev = &cache->lru;
+    cache->lru.next->prev = file;
+    cache->lru.next = file;
+    mprAddHash(cache->index, file->filename, file);
+    cache->size += file->size;
+    return file;
+}
+
+
+/*
+ *  Unlink a file from the cache and drop the cache reference. Must be called locked.
+ */
+static void removeCachedFile(MaFileCache *cache, MaCachedFile *file)
+{
+    file->prev->next = file->next;
+    file->next->prev = file->prev;
+    file->next = file->prev = file;
+    mprRemoveHash(cache->index, file->filename);
+    cache->size -= file->size;
+    if (--file->refs <= 0) {
+        mprFree(file);
+    }
+}
+
+
+/*
+ *  Test if the precompressed variant was created, modified or removed since the file was cached
+ */
+static bool gzipChanged(MaCachedFile *file)
+{
+    MprFileInfo     info;
+
+    mprGetFileInfo(file, file->gzipName, &info);
+    if (!info.valid || !file->gzipInfo.valid) {
+        return info.valid != file->gzipInfo.valid;
+    }
+    return info.inode != file->gzipInfo.inode || info.size != file->gzipInfo.size || info.mtime != file->gzipInfo.mtime;
+}
+
+
+/*
+ *  Test if an Accept-Encoding header value accepts gzip. Parameters other than a zero quality are ignored.
+ */
+static bool acceptsGzip(cchar *accept)
+{
+    cchar       *cp, *end;
+
+    if (accept == 0) {
+        return 0;
+    }
+    for (cp = accept; (cp = strstr(cp, "gzip")) != 0; cp += 4) {
+        if (cp > accept && !isspace((int) cp[-1]) && cp[-1] != ',') {
+            continue;
+        }
+        for (end = &cp[4]; isspace((int) *end); end++) ;
+        if (*end == '\0' || *end == ',') {
+            return 1;
+        }
+        if (*end == ';') {
+            for (end++; isspace((int) *end); end++) ;
+            return !(end[0] == 'q' && end[1] == '=' && atof(&end[2]) <= 0);
+        }
+    }
+    return 0;
+}
+
+
+static void lockFileCache(MaFileCache *cache)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(cache->mutex);
+#endif
+}
+
+
+static void unlockFileCache(MaFileCache *cache)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(cache->mutex);
+#endif
+}
+
+
+static MaFileCache *createFileCache(MaHttp *http)
+{
+    MaFileCache     *cache;
+
+    if ((cache = mprAllocObjZeroed(http, MaFileCache)) == 0) {
+        return 0;
+    }
+    cache->lru.next = cache->lru.prev = &cache->lru;
+    if ((cache->index = mprCreateHash(cache, MA_FILE_CACHE_HASH_SIZE)) == 0) {
+        mprFree(cache);
+        return 0;
+    }
+#if BLD_FEATURE_MULTITHREAD
+    if ((cache->mutex = mprCreateLock(cache)) == 0) {
+        mprFree(cache);
+        return 0;
+    }
+#endif
+    return cache;
+}
+
+
 /*
  *  Dynamic module initialization
  */
@@ -8249,6 +8718,7 @@ MprModule *maFileHandlerInit(MaHttp *http, cchar *path)
     handler->outgoingService = outgoingFileService;
     handler->incomingData = incomingFileData;
     http->fileHandler = handler;
+    http->fileCache = createFileCache(http);
 
     return module;
 }
@@ -10529,23 +10999,68 @@ MaListen *maCreateListen(MaServer *server, cchar *ipAddr, int port, int flags)
 }
 
 
+/*
+ *  Open a listening socket owned by the given reactor. Connections accepted on it stay on that reactor.
+ */
+static MprSocket *openListenSocket(MaListen *listen, int reactor, int flags)
+{
+    MprSocket   *sock;
+
+#if BLD_FEATURE_SSL
+    sock = mprCreateSocket(listen, listen->ssl);
+#else
+    sock = mprCreateSocket(listen, NULL);
+#endif
+    if (sock == 0) {
+        return 0;
+    }
+    mprSetSocketWaitService(sock, mprGetReactor(listen, reactor));
+
+    if (mprOpenServerSocket(sock, listen->ipAddr, listen->port, (MprSocketAcceptProc) maAcceptConn, listen->server,
+            flags) < 0) {
+        mprFree(sock);
+        return 0;
+    }
+    return sock;
+}
+
+
 int maStartListening(MaListen *listen)
 {
+    MprSocket   *sock;
     cchar       *proto;
     char        *ipAddr;
+    int         flags, reactor, reactors;
 
-#if BLD_FEATURE_SSL
-    listen->sock = mprCreateSocket(listen, listen->ssl);
+    flags = MPR_SOCKET_NODELAY | MPR_SOCKET_THREAD;
+    reactors = mprGetReactorCount(listen);
+#if defined(SO_REUSEPORT)
+    if (reactors > 1) {
+        flags |= MPR_SOCKET_REUSEPORT;
+    }
 #else
-    listen->sock = mprCreateSocket(listen, NULL);
+    reactors = 1;
 #endif
 
-    if (mprOpenServerSocket(listen->sock, listen->ipAddr, listen->port, (MprSocketAcceptProc) maAcceptConn, listen->server,
-            MPR_SOCKET_NODELAY | MPR_SOCKET_THREAD) < 0) {
+    if ((listen->sock = openListenSocket(listen, 0, flags)) == 0) {
         mprError(listen, "Can't open a socket on %s, port %d", listen->ipAddr, listen->port);
         return MPR_ERR_CANT_OPEN;
     }
 
+    /*
+     *  Shard the endpoint across reactors. Each reactor gets its own listening socket on the same port.
+     */
+    if (reactors > 1) {
+        listen->shards = mprCreateList(listen);
+        for (reactor = 1; reactor < reactors; reactor++) {
+            if ((sock = openListenSocket(listen, reactor, flags)) == 0) {
+                mprError(listen, "Can't open reactor %d socket on %s, port %d", reactor, listen->ipAddr, listen->port);
+                break;
+            }
+            mprAddItem(listen->shards, sock);
+        }
+    }
+
     proto = "HTTP";
 #if BLD_FEATURE_SSL
     if (mprSocketIsSecure(listen->sock)) {
@@ -10564,6 +11079,16 @@ int maStartListening(MaListen *listen)
 
 int maStopListening(MaListen *listen)
 {
+    MprSocket   *sock;
+    int         next;
+
+    if (listen->shards) {
+        for (next = 0; (sock = mprGetNextItem(listen->shards, &next)) != 0; ) {
+            mprFree(sock);
+        }
+        mprFree(listen->shards);
+        listen->shards = 0;
+    }
     if (listen->sock) {
         mprFree(listen->sock);
         listen->sock = 0;
@@ -11435,7 +11960,7 @@ int maOpenMimeTypes(MaHost *host, cchar *path)
     host->mimeFile = mprStrdup(host, path);
 
     if (host->mimeTypes == 0) {
-        host->mimeTypes = mprCreateHash(host, MA_MIME_HASH_SIZE);
+        host->mimeTypes = mprCreateCaselessHash(host, MA_MIME_HASH_SIZE);
     }
     file = mprOpen(host, path, O_RDONLY | O_TEXT, 0);
     if (file == 0) {
@@ -11480,7 +12005,7 @@ MaMimeType *maAddMimeType(MaHost *host, cchar *ext, cchar *mimeType)
     mime->type = mprStrdup(host, mimeType);
 
     if (host->mimeTypes == 0) {
-        host->mimeTypes = mprCreateHash(host, MA_MIME_HASH_SIZE);
+        host->mimeTypes = mprCreateCaselessHash(host, MA_MIME_HASH_SIZE);
     }
     if (*ext == '.') {
         ext++;
@@ -12057,9 +12582,14 @@ void maCreatePipeline(MaConn *conn)
         }
     }
     
+#if BLD_FEATURE_FILE
+    if (resp->handler == http->fileHandler && (req->method & (MA_REQ_GET | MA_REQ_HEAD)) && !conn->requestFailed) {
+        maGetCachedFile(conn, 0);
+    }
+#endif
     connector = location->connector;
 #if BLD_FEATURE_SEND
-    if (resp->handler == http->fileHandler && connector == http->netConnector && 
+    if (resp->handler == http->fileHandler && connector == http->netConnector && resp->cachedFile == 0 &&
         http->sendConnector && !req->ranges && !host->secure) {
         /*
          *  Switch (transparently) to the send connector if serving whole static file content via the net connector
@@ -12401,6 +12931,14 @@ static bool mapToFile(MaConn *conn, bool *rescan)
 
     req->auth = req->dir->auth;
 
+#if BLD_FEATURE_FILE
+    if (!resp->fileInfo.valid && (req->method & (MA_REQ_GET | MA_REQ_HEAD))) {
+        /*
+         *  Recently validated cached files don't need to be stat'd again
+         */
+        maGetCachedFile(conn, 1);
+    }
+#endif
     if (!resp->fileInfo.valid && mprGetFileInfo(conn, resp->filename, &resp->fileInfo) < 0) {
 #if UNUSED
         if (req->method & (MA_REQ_GET | MA_REQ_POST)) {
@@ -12654,7 +13192,9 @@ static void setEnv(MaConn *conn)
         if (!info->valid) {
             mprGetFileInfo(conn, resp->filename, info);
         }
-        if (info->valid) {
+        if (resp->cachedFile && strcmp(resp->cachedFile->filename, resp->filename) == 0) {
+            resp->etag = resp->cachedFile->etag;
+        } else if (info->valid) {
             mprAllocSprintf(resp, &resp->etag, -1, "%x-%Lx-%Lx", info->inode, info->size, info->mtime);
         }
     }
@@ -12895,6 +13435,30 @@ int maGetPacketLength(MaPacket *packet)
 }
 
 
+/*
+ *  Release a reference to shared packet content. The data is freed when the last packet referencing it is freed.
+ */
+static void releasePacketData(MaPacket *packet)
+{
+    MaPacketData    *shared;
+
+    shared = packet->shared;
+    if (shared && !(packet->conn->flags & MA_CONN_DESTROYED)) {
+        if (--shared->refs <= 0) {
+            mprFree(shared);
+        }
+    }
+    packet->shared = 0;
+}
+
+
+static int packetDestructor(MaPacket *packet)
+{
+    releasePacketData(packet);
+    return 0;
+}
+
+
 /*
  *  Create a new packet. If size is -1, then also create a default growable buffer -- used for incoming body content. If 
  *  size > 0, then create a non-growable buffer of the requested size.
@@ -12910,7 +13474,7 @@ MaPacket *maCreatePacket(MaConn *conn, int size)
     ctx = conn;
 #endif
     
-    packet = mprAllocObjZeroed(ctx, MaPacket);
+    packet = mprAllocObjWithDestructorZeroed(ctx, MaPacket, packetDestructor);
     if (packet == 0) {
         return 0;
     }
@@ -13351,15 +13915,37 @@ int maWrite(MaQueue *q, cchar *fmt, ...)
 
 
 /*
- *  Join two packets by pulling the content from the second into the first.
+ *  Join two packets by pulling the content from the second into the first. Split and borrowed content is a fixed
+ *  window over data the packet does not own, so it is first copied into a private buffer that can grow. The count 
+ *  only includes the data actually appended.
  */
 int maJoinPacket(MaPacket *packet, MaPacket *p)
 {
-    packet->count += maGetPacketLength(p);
-    if (mprPutBlockToBuf(packet->content, mprGetBufStart(p->content), maGetPacketLength(p)) < 0) {
-        return MPR_ERR_NO_MEMORY;
+    MprBuf      *content;
+    int         len, size, written;
+
+    len = maGetPacketLength(p);
+    if (len <= 0) {
+        return 0;
     }
-    return 0;
+    content = packet->content;
+    size = maGetPacketLength(packet) + len;
+    if (content == 0 || packet->shared || (packet->flags & MA_PACKET_BORROWED) || 
+            (content->maxsize > 0 && size > content->maxsize)) {
+        if ((packet->content = mprCreateBuf(packet, size, -1)) == 0) {
+            packet->content = content;
+            return MPR_ERR_NO_MEMORY;
+        }
+        if (content) {
+            mprPutBlockToBuf(packet->content, mprGetBufStart(content), mprGetBufLength(content));
+            mprFree(content);
+        }
+        releasePacketData(packet);
+        packet->flags &= ~MA_PACKET_BORROWED;
+    }
+    written = mprPutBlockToBuf(packet->content, mprGetBufStart(p->content), len);
+    packet->count += written;
+    return (written < len) ? MPR_ERR_NO_MEMORY : 0;
 }
 
 
@@ -13370,40 +13956,73 @@ int maJoinPacket(MaPacket *packet, MaPacket *p)
 MaPacket *maSplitPacket(MaConn *conn, MaPacket *orig, int offset)
 {
     MaPacket    *packet;
+    MprBuf      *content, *tail;
+    int         count;
 
     if (offset >= orig->count) {
         mprAssert(0);
         return 0;
     }
+    content = orig->content;
+    count = orig->count - offset;
+
+    if (content && mprGetBufLength(content) > 0) {
+        if (count >= mprGetBufLength(content)) {
+            /* The original packet must retain some data */
+            mprAssert(count < mprGetBufLength(content));
+            return 0;
+        }
+        if (orig->shared == 0 && !(orig->flags & MA_PACKET_BORROWED)) {
+            if ((orig->shared = mprAllocObjZeroed(conn, MaPacketData)) == 0) {
+                return 0;
+            }
+            orig->shared->refs = 1;
+            mprStealBlock(orig->shared, content->data);
+        }
+    }
 
     packet = maCreatePacket(conn, 0);
     if (packet == 0) {
         return 0;
     }
-    
     packet->flags = orig->flags;
-    packet->count = orig->count - offset;
+    packet->count = count;
     orig->count = offset;
 
     /*
      *  Suffix migrates to the new packet
      */
-    if (packet->suffix) {
+    if (orig->suffix) {
         packet->suffix = orig->suffix;
         mprStealBlock(packet, packet->suffix);
         orig->suffix = 0;
     }
 
-    if (orig->content && maGetPacketLength(orig) > 0) {
-        packet->content = mprCreateBuf(packet, packet->count, -1);
-        if (packet->content == 0) {
+    if (orig->shared || (content && mprGetBufLength(content) > 0 && (orig->flags & MA_PACKET_BORROWED))) {
+        /*
+         *  The new packet's content is a fixed window over the tail of the original data. Both buffers are capped at 
+         *  their current size so neither can grow (and reallocate) the shared data. Borrowed data is not counted.
+         */
+        if ((tail = mprAllocObjZeroed(packet, MprBuf)) == 0) {
+            orig->count += count;
             mprFree(packet);
             return 0;
         }
-        mprAdjustBufEnd(orig->content, -packet->count);
-        mprPutBlockToBuf(packet->content, mprGetBufEnd(orig->content), packet->count);
+        mprAdjustBufEnd(content, -count);
+        tail->data = tail->start = content->end;
+        tail->end = tail->endbuf = content->end + count;
+        tail->buflen = tail->maxsize = count;
+        tail->growBy = content->growBy;
+        packet->content = tail;
+
+        content->endbuf = content->end;
+        content->buflen = content->maxsize = (int) (content->endbuf - content->data);
+
+        if (orig->shared) {
+            packet->shared = orig->shared;
+            packet->shared->refs++;
+        }
     }
-    
     return packet;
 }
 
@@ -13559,11 +14178,14 @@ MaRequest *maCreateRequest(MaConn *conn)
 
     /*
      *  Create a request memory arena. From this arena, are all allocations made for this entire request.
-     *  Arenas are scalable, thread-safe virtual memory blocks that are freed in one chunk.
+     *  Arenas are scalable, thread-safe virtual memory blocks that are released in one chunk. The arena is retained 
+     *  by the connection and reset after each request so keep-alive requests reuse it.
      */
-    arena  = mprAllocArena(conn->arena, "request", MA_REQ_MEM, 0, NULL);
-    if (arena == 0) {
-        return 0;
+    if ((arena = conn->requestArena) == 0) {
+        arena = conn->requestArena = mprAllocArena(conn->arena, "request", MA_REQ_MEM, 0, NULL);
+        if (arena == 0) {
+            return 0;
+        }
     }
 
     req = mprAllocObjWithDestructorZeroed(arena, MaRequest, destroyRequest);
@@ -13628,6 +14250,12 @@ void maProcessReadEvent(MaConn *conn, MaPacket *packet)
 
         switch (conn->state) {
         case MPR_HTTP_STATE_BEGIN:
+            /*
+             *  A completed request may have left the next pipelined request in conn->input
+             */
+            if ((packet = conn->input) == 0) {
+                return;
+            }
             conn->canProceed = parseRequest(conn, packet);
             break;
 
@@ -13671,12 +14299,19 @@ static bool parseRequest(MaConn *conn, MaPacket *packet)
     if ((len = mprGetBufLength(packet->content)) == 0) {
         return 0;
     }
-    if (len >= conn->host->limits->maxHeader) {
-        maFailRequest(conn, MPR_HTTP_CODE_REQUEST_TOO_LARGE, "Header too big");
+    start = mprGetBufStart(packet->content);
+    end = mprStrnstr(start, "\r\n\r\n", len);
+
+    /*
+     *  Only the headers count against the limit as the packet may also hold body content read with them. There is no
+     *  request yet to fail, so just close the connection.
+     */
+    if ((end ? (int) (end - start) : len) >= conn->host->limits->maxHeader) {
+        mprLog(conn, 2, "Request headers too big, closing connection");
+        conn->keepAliveCount = -1;
         return 0;
     }
-    start = mprGetBufStart(packet->content);
-    if ((end = mprStrnstr(start, "\r\n\r\n", len)) == 0) {
+    if (end == 0) {
         return 0;
     }
 
@@ -14139,7 +14774,7 @@ static void processContent(MaConn *conn, MaPacket *packet)
     MaResponse      *resp;
     MaQueue         *q;
     MprBuf          *content;
-    int             nbytes;
+    int             nbytes, extra;
 
 
     req = conn->request;
@@ -14184,10 +14819,15 @@ static void processContent(MaConn *conn, MaPacket *packet)
 
             if (req->remainingContent == 0 && mprGetBufLength(packet->content) > nbytes) {
                 /*
-                 *  Looks like this packet contains the header of the next request. Split the packet and put back
-                 *  the next request header onto the connection input queue.
+                 *  Looks like this packet contains the header of the next request. Move the next request header into
+                 *  a new input packet. This is copied rather than split as further input is appended to conn->input.
                  */
-                conn->input = maSplitPacket(conn, packet, mprGetBufLength(content) - nbytes);
+                extra = mprGetBufLength(content) - nbytes;
+                if ((conn->input = maCreatePacket(conn, MA_BUFSIZE)) != 0) {
+                    mprPutBlockToBuf(conn->input->content, mprGetBufStart(content) + nbytes, extra);
+                    conn->input->count = extra;
+                }
+                mprAdjustBufEnd(content, -extra);
             }
             if ((q->count + packet->count) > q->max) {
                 conn->keepAliveCount = 0;
@@ -14240,8 +14880,8 @@ static bool processCompletion(MaConn *conn)
 #if BLD_DEBUG
     mprAssert((conn->arena->allocBytes / 1024) < 20000);
     mprLog(req, 7, "Request complete used %,d K, conn usage %,d K, mpr usage %,d K, page usage %,d K", 
-        req->arena->allocBytes / 1024, conn->arena->allocBytes / 1024, mprGetMpr(conn)->heap.allocBytes / 1024, 
-        mprGetMpr(conn)->pageHeap.allocBytes / 1024);
+        (int) (req->arena->allocBytes / 1024), (int) (conn->arena->allocBytes / 1024), 
+        (int) (mprGetMpr(conn)->heap.allocBytes / 1024), (int) (mprGetMpr(conn)->pageHeap.allocBytes / 1024));
 //  mprPrintAllocReport(mprGetMpr(conn), "Before completing request");
 #endif
 
@@ -14250,10 +14890,11 @@ static bool processCompletion(MaConn *conn)
     mprAssert(!more || mprGetParent(packet) == conn);
 
     /*
-     *  This will free the request and response and cause maResetConn to run which will reset the state and cleanse the conn
-     *  The connection will not be closed unless keepAliveCount is zero when returning to ioEvent in conn.c 
+     *  This will release the request and response and cause maResetConn to run which will reset the state and cleanse 
+     *  the conn. The arena is rewound for the next request on this connection. The connection will not be closed 
+     *  unless keepAliveCount is zero when returning to ioEvent in conn.c 
      */
-    mprFree(req->arena);
+    mprResetArena(req->arena);
 
     return more;
 }
@@ -14897,7 +15538,7 @@ MaResponse *maCreateResponse(MaConn *conn)
     resp->entityLength = -1;
     resp->chunkSize = -1;
 
-    resp->headers = mprCreateHash(resp, MA_HEADER_HASH_SIZE);
+    resp->headers = mprCreateCaselessHash(resp, MA_HEADER_HASH_SIZE);
 
     maInitQueue(http, &resp->queue[MA_QUEUE_SEND], "responseSendHead");
     maInitQueue(http, &resp->queue[MA_QUEUE_RECEIVE], "responseReceiveHead");
@@ -14913,6 +15554,11 @@ static int destroyResponse(MaResponse *resp)
     conn = resp->conn;
     mprLog(conn, 5, "destroyResponse");
     maCloseStage(conn);
+#if BLD_FEATURE_FILE
+    if (resp->cachedFile) {
+        maReleaseCachedFile(conn->http, resp->cachedFile);
+    }
+#endif
 
     return 0;
 }
@@ -14981,9 +15627,10 @@ void maFillHeaders(MaConn *conn, MaPacket *packet)
         if (req->ranges->next == 0) {
             range = req->ranges;
             if (resp->entityLength > 0) {
-                putFormattedHeader(packet, "Content-Range", "bytes %d-%d/%d", range->start, range->end, resp->entityLength);
+                putFormattedHeader(packet, "Content-Range", "bytes %d-%d/%d", range->start, range->end - 1, 
+                    resp->entityLength);
             } else {
-                putFormattedHeader(packet, "Content-Range", "bytes %d-%d/*", range->start, range->end);
+                putFormattedHeader(packet, "Content-Range", "bytes %d-%d/*", range->start, range->end - 1);
             }
         } else {
             putFormattedHeader(packet, "Content-Type", "multipart/byteranges; boundary=%s", resp->rangeBoundary);
@@ -15210,7 +15857,6 @@ void maSetHeader(MaConn *conn, bool allowMultiple, cchar *key, cchar *fmt, ...)
     if (allowMultiple) {
         mprAddDuplicateHash(resp->headers, key, value);
     } else {
-        //  TODO - this should be doing case mapping on the key
         mprAddHash(resp->headers, key, value);
     }
 }
@@ -15745,6 +16391,9 @@ static void initLimits(MaHttp *http)
     limits->maxBody = MA_MAX_BODY;
     limits->maxChunkSize = MA_MAX_CHUNK_SIZE;
     limits->maxResponseBody = MA_MAX_RESPONSE_BODY;
+    limits->maxSendBatch = MA_MAX_SEND_BATCH;
+    limits->maxFileCache = MA_FILE_CACHE_SIZE;
+    limits->maxFileCacheItem = MA_FILE_CACHE_ITEM;
     limits->maxStageBuffer = MA_MAX_STAGE_BUFFER;
     limits->maxNumHeaders = MA_MAX_NUM_HEADERS;
     limits->maxHeader = MA_MAX_HEADERS;
@@ -15818,6 +16467,17 @@ int maStartServer(MaServer *server)
         }
     }
 
+#if BLD_FEATURE_MULTITHREAD
+    /*
+     *  Start the additional I/O event loops before listening so each can own a shard of every listening endpoint
+     */
+    if (server->http->limits.reactors > 1 && mprGetReactorCount(server) == 1) {
+        if (mprStartReactors(server, server->http->limits.reactors) < 0) {
+            mprError(server, "Can't start %d reactors", server->http->limits.reactors);
+        }
+    }
+#endif
+
     /*
      *  Listen to all required ipAddr:ports
      */
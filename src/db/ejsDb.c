@@ -25,8 +25,6 @@ typedef struct EjsDb
 {
     EjsObject       obj;
     sqlite3         *sdb;               /* Sqlite handle */
-    MprHeap         *arena;             /* Memory context arena */
-    MprThreadLocal  *tls;               /* Thread local data for setting Sqlite memory context */
 } EjsDb;
 
 
@@ -49,29 +47,14 @@ static EjsVar *dbConstructor(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
     path = ejsGetString(argv[0]);    
     
     /*
-     *  Create a memory context for use by sqlite. This is a virtual paged memory region.
-     *  TODO - this is not ideal for long running applications.
-     */
-    db->arena = mprAllocArena(ejs, "sqlite", EJS_MAX_DB_MEM, 0, 0);
-    if (db->arena == 0) {
-        return 0;
-    }
-    
-    /*
-     *  Create a destructor object so we can cleanup and close the database. Must create after the arena so it will be
-     *  invoked before the arena is freed. 
+     *  Create a destructor object so we can cleanup and close the database when the interpreter is freed. Sqlite 
+     *  allocates its memory from the Mpr (see sqliteMem.c) as its per-file state is shared by all connections.
      */
     if ((dbp = mprAllocObject(ejs, 1, (MprDestructor) dbDestructor)) == 0) {
         ejsThrowMemoryError(ejs);
         return 0;
     }
     *dbp = db;
-    
-    db->tls = mprCreateThreadLocal(db->arena);
-    if (db->tls == 0) {
-        return 0;
-    }
-    ejsSetDbMemoryContext(db->tls, db->arena);
 
     sdb = 0;
     if (sqlite3_open(path, &sdb /* TODO remove , SQLITE_OPEN_READWRITE, 0 */) != SQLITE_OK) {
@@ -104,7 +87,6 @@ static int dbDestructor(EjsDb **dbp)
     db = *dbp;
 
     if (db->sdb) {
-        ejsSetDbMemoryContext(db->tls, db->arena);
         sqlite3_close(db->sdb);
         db->sdb = 0;
     }
@@ -121,7 +103,6 @@ static int closeDb(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
     mprAssert(db);
 
     if (db->sdb) {
-        ejsSetDbMemoryContext(db->tls, db->arena);
         sqlite3_close(db->sdb);
         db->sdb = 0;
     }
@@ -169,8 +150,6 @@ static EjsVar *sql(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
 
     cmd = ejsGetString(argv[0]);
     
-    ejsSetDbMemoryContext(db->tls, db->arena);
-
     rc = SQLITE_OK;
     retries = 0;
     sdb = db->sdb;
@@ -275,8 +254,6 @@ static EjsVar *save(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
     char        **data, *error;
     int         rc, rowCount, i;
 
-    ejsSetDbMemoryContext(db->tls, db->arena);
-
     ap = ejsCreateArray(ejs, 0);
 
     rc = sqlite3_exec(db->sdb,
@@ -314,8 +291,6 @@ static EjsVar *tables(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
     char        **data, *error;
     int         rc, rowCount, i;
 
-    ejsSetDbMemoryContext(db->tls, db->arena);
-
     ap = ejsCreateArray(ejs, 0);
 
     rc = sqlite3_get_table(db->sdb,
@@ -349,7 +324,6 @@ static EjsVar *tables(Ejs *ejs, EjsDb *db, int argc, EjsVar **argv)
 static EjsVar *finalizeDb(Ejs *ejs, EjsDb *db)
 {
     if (db->sdb) {
-        ejsSetDbMemoryContext(db->tls, db->arena);
         closeDb(ejs, db, 0, 0);
         db->sdb = 0;
     }
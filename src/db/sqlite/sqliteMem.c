@@ -11,34 +11,23 @@
 #if BLD_FEATURE_SQLITE
 /*********************************** Locals ***********************************/
 
-#if BLD_FEATURE_MULTITHREAD
-static MprThreadLocal   *sqliteLocal;
-#endif
-
 static MprCtx           sqliteCtx;
 
 /************************************ Code ************************************/
-
-void ejsSetDbMemoryContext(MprThreadLocal *tls, MprCtx ctx)
-{
-#if BLD_FEATURE_MULTITHREAD
-    sqliteLocal = tls;
-    mprSetThreadData(tls, (void*) ctx);
-#else
-    sqliteCtx = ctx;
-#endif
-}
-
 /*
- *  Get a memory context to work with. This allows sqlite to execute without anyone explicitly calling ejsSetDbMemoryContext
+ *  Get a memory context to work with. Sqlite shares the open file and lock state of a database between all its
+ *  connections and frees it when the last one closes. So all memory comes from the Mpr, which outlives any one 
+ *  database, interpreter or request, and which is thread-safe.
  */
-static inline MprCtx getCtx(MprCtx ctx)
+static inline MprCtx getCtx()
 {
-    if (ctx == 0) {
-        ctx = mprGetMpr(0);
-        if (ctx == 0) {
-            ctx = sqliteCtx = mprCreate(0, NULL, NULL);
+    MprCtx      ctx;
+
+    if ((ctx = mprGetMpr(0)) == 0) {
+        if (sqliteCtx == 0) {
+            sqliteCtx = mprCreate(0, NULL, NULL);
         }
+        ctx = sqliteCtx;
     }
     return ctx;
 }
@@ -58,16 +47,7 @@ int64 sqlite3_memory_highwater(int resetFlag)
 
 void *sqlite3_malloc(int size) 
 {
-    MprCtx      ctx;
-
-#if BLD_FEATURE_MULTITHREAD
-    if (sqliteLocal) {
-        ctx = mprGetThreadData(sqliteLocal);
-    } else 
-#endif
-        ctx = sqliteCtx;
-
-    return mprAlloc(getCtx(ctx), size);
+    return mprAlloc(getCtx(), size);
 }
 
 
@@ -79,16 +59,7 @@ void sqlite3_free(void *ptr)
 
 void *sqlite3_realloc(void *ptr, int size) 
 {
-    MprCtx      ctx;
-
-#if BLD_FEATURE_MULTITHREAD
-    if (sqliteLocal) {
-        ctx = mprGetThreadData(sqliteLocal);
-    } else
-#endif
-        ctx = sqliteCtx;
-
-    return mprRealloc(getCtx(ctx), ptr, size);
+    return mprRealloc(getCtx(), ptr, size);
 }
 
 
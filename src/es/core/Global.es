@@ -228,13 +228,14 @@ module ejs {
 
 	/**
 	 *	Convert a string into an object. This will parse a string that has been encoded via serialize. It may contain
-	 *	nested objects and arrays. This is a static method.
-	 *	@param name The string containing the object encoding.
+	 *	nested objects and arrays. This is a static method. ByteArrays created by serialize with the binary option 
+	 *	are decoded from their read position to their write position.
+	 *	@param obj The string or ByteArray containing the object encoding.
 	 *	@return The fully constructed object or undefined if it could not be reconstructed.
-	 *	@throws IOError If the object could not be reconstructed from the string.
+	 *	@throws IOError If the object could not be reconstructed from the binary encoding.
 	 *	@spec ejs-11
 	 */
-	native function deserialize(obj: String): Object
+	native function deserialize(obj: Object): Object
 
 
 	# ECMA || FUTURE
@@ -362,14 +363,17 @@ module ejs {
 	 *	Encode an object as a string. This function returns a literal string for the object and all its properties. 
 	 *	If @maxDepth is sufficiently large (or zero for infinite depth), each property will be processed recursively 
 	 *	until all properties are rendered. 
-	 *	@param maxDepth The depth to recurse when converting properties to literals. If set to zero, the depth is infinite.
+	 *	@param options The depth to recurse when converting properties to literals. If set to zero, the depth is 
+	 *		infinite. Alternatively, an options object with "depth", "all", "base" and "binary" properties. If binary 
+	 *		is true, the object is encoded into a compact binary ByteArray that preserves shared and cyclic references.
 	 *	@param all Encode non-enumerable and class fixture properties and functions.
 	 *	@param base Encode base class properties.
-	 *	@return This function returns an object literal that can be used to reinstantiate an object.
+	 *	@return This function returns an object literal that can be used to reinstantiate an object, or a ByteArray
+	 *		for binary encodings.
 	 *	@throws TypeError If the object could not be converted to a string.
 	 *	@spec ejs-11
 	 */ 
-	native function serialize(obj: Object, maxDepth: Number = 0, all: Boolean = false, base: Boolean = false): String
+	native function serialize(obj: Object, options: Object = null, all: Boolean = false, base: Boolean = false): Object
 
 	/*
      *  TODO - remove
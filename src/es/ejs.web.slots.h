@@ -34,42 +34,53 @@
  */
 #define ES_ejs_web_Controller__origin                                  5
 #define ES_ejs_web_Controller_ejs_web_initialize                       5
-#define ES_ejs_web_Controller_ejs_web_cache                            6
-#define ES_ejs_web_Controller_ejs_web_createSession                    7
-#define ES_ejs_web_Controller_ejs_web_destroySession                   8
-#define ES_ejs_web_Controller_ejs_web_discardOutput                    9
-#define ES_ejs_web_Controller_ejs_web_beforeFilter                     10
-#define ES_ejs_web_Controller_ejs_web_afterFilter                      11
-#define ES_ejs_web_Controller_ejs_web_wrapFilter                       12
-#define ES_ejs_web_Controller_runFilters                               13
-#define ES_ejs_web_Controller_ejs_web_doAction                         14
-#define ES_ejs_web_Controller_ejs_web_sendError                        15
-#define ES_ejs_web_Controller_ejs_web_escapeHtml                       16
-#define ES_ejs_web_Controller_ejs_web_html                             17
-#define ES_ejs_web_Controller_ejs_web_inform                           18
-#define ES_ejs_web_Controller_ejs_web_error                            19
-#define ES_ejs_web_Controller_ejs_web_keepAlive                        20
-#define ES_ejs_web_Controller_ejs_web_loadView                         21
-#define ES_ejs_web_Controller_ejs_web_makeUrl                          22
-#define ES_ejs_web_Controller_ejs_web_redirectUrl                      23
-#define ES_ejs_web_Controller_ejs_web_redirect                         24
-#define ES_ejs_web_Controller_ejs_web_render                           25
-#define ES_ejs_web_Controller_ejs_web_renderFile                       26
-#define ES_ejs_web_Controller_ejs_web_renderRaw                        27
-#define ES_ejs_web_Controller_ejs_web_renderView                       28
-#define ES_ejs_web_Controller_reportError                              29
-#define ES_ejs_web_Controller_ejs_web_setCookie                        30
-#define ES_ejs_web_Controller_ejs_web_setHeader                        31
-#define ES_ejs_web_Controller_ejs_web_setHttpCode                      32
-#define ES_ejs_web_Controller_ejs_web_statusMessage                    33
-#define ES_ejs_web_Controller_ejs_web_setMimeType                      34
-#define ES_ejs_web_Controller_ejs_web_unescapeHtml                     35
-#define ES_ejs_web_Controller_ejs_web_warn                             36
-#define ES_ejs_web_Controller_ejs_web_write                            37
-#define ES_ejs_web_Controller_ejs_web_writeHtml                        38
-#define ES_ejs_web_Controller_ejs_web_writeRaw                         39
-#define ES_ejs_web_Controller_action_missing                           40
-#define ES_ejs_web_Controller_NUM_CLASS_PROP                           41
+#define ES_ejs_web_Controller_params                                   6
+#define ES_ejs_web_Controller_set_params                               7
+#define ES_ejs_web_Controller_loadParams                               8
+#define ES_ejs_web_Controller_ejs_web_cache                            9
+#define ES_ejs_web_Controller_ejs_web_cacheAction                      10
+#define ES_ejs_web_Controller_joinNames                                11
+#define ES_ejs_web_Controller_ejs_web_expireCache                      12
+#define ES_ejs_web_Controller_ejs_web_createSession                    13
+#define ES_ejs_web_Controller_ejs_web_destroySession                   14
+#define ES_ejs_web_Controller_ejs_web_discardOutput                    15
+#define ES_ejs_web_Controller_ejs_web_flush                            16
+#define ES_ejs_web_Controller_ejs_web_beforeFilter                     17
+#define ES_ejs_web_Controller_ejs_web_afterFilter                      18
+#define ES_ejs_web_Controller_ejs_web_wrapFilter                       19
+#define ES_ejs_web_Controller_runFilters                               20
+#define ES_ejs_web_Controller_ejs_web_doAction                         21
+#define ES_ejs_web_Controller_beginCache                               22
+#define ES_ejs_web_Controller_saveCache                                23
+#define ES_ejs_web_Controller_ejs_web_sendError                        24
+#define ES_ejs_web_Controller_ejs_web_escapeHtml                       25
+#define ES_ejs_web_Controller_ejs_web_html                             26
+#define ES_ejs_web_Controller_ejs_web_inform                           27
+#define ES_ejs_web_Controller_ejs_web_error                            28
+#define ES_ejs_web_Controller_ejs_web_keepAlive                        29
+#define ES_ejs_web_Controller_ejs_web_stream                           30
+#define ES_ejs_web_Controller_ejs_web_loadView                         31
+#define ES_ejs_web_Controller_ejs_web_makeUrl                          32
+#define ES_ejs_web_Controller_ejs_web_redirectUrl                      33
+#define ES_ejs_web_Controller_ejs_web_redirect                         34
+#define ES_ejs_web_Controller_ejs_web_render                           35
+#define ES_ejs_web_Controller_ejs_web_renderFile                       36
+#define ES_ejs_web_Controller_ejs_web_renderRaw                        37
+#define ES_ejs_web_Controller_ejs_web_renderView                       38
+#define ES_ejs_web_Controller_reportError                              39
+#define ES_ejs_web_Controller_ejs_web_setCookie                        40
+#define ES_ejs_web_Controller_ejs_web_setHeader                        41
+#define ES_ejs_web_Controller_ejs_web_setHttpCode                      42
+#define ES_ejs_web_Controller_ejs_web_statusMessage                    43
+#define ES_ejs_web_Controller_ejs_web_setMimeType                      44
+#define ES_ejs_web_Controller_ejs_web_unescapeHtml                     45
+#define ES_ejs_web_Controller_ejs_web_warn                             46
+#define ES_ejs_web_Controller_ejs_web_write                            47
+#define ES_ejs_web_Controller_ejs_web_writeHtml                        48
+#define ES_ejs_web_Controller_ejs_web_writeJSON                        49
+#define ES_ejs_web_Controller_ejs_web_writeRaw                         50
+#define ES_ejs_web_Controller_action_missing                           51
+#define ES_ejs_web_Controller_NUM_CLASS_PROP                           52
 
 /**
  * Instance slots for "Controller" type 
@@ -83,18 +94,20 @@
 #define ES_ejs_web_Controller_flash                                    6
 #define ES_ejs_web_Controller_home                                     7
 #define ES_ejs_web_Controller_host                                     8
-#define ES_ejs_web_Controller_params                                   9
-#define ES_ejs_web_Controller_request                                  10
-#define ES_ejs_web_Controller_response                                 11
-#define ES_ejs_web_Controller_session                                  12
+#define ES_ejs_web_Controller_request                                  9
+#define ES_ejs_web_Controller_response                                 10
+#define ES_ejs_web_Controller_session                                  11
+#define ES_ejs_web_Controller_streamViews                              12
 #define ES_ejs_web_Controller_isApp                                    13
 #define ES_ejs_web_Controller_rendered                                 14
 #define ES_ejs_web_Controller_redirected                               15
 #define ES_ejs_web_Controller_events                                   16
 #define ES_ejs_web_Controller__afterFilters                            17
-#define ES_ejs_web_Controller__beforeFilters                           18
-#define ES_ejs_web_Controller__wrapFilters                             19
-#define ES_ejs_web_Controller_NUM_INSTANCE_PROP                        20
+#define ES_ejs_web_Controller__cacheActions                            18
+#define ES_ejs_web_Controller__params                                  19
+#define ES_ejs_web_Controller__beforeFilters                           20
+#define ES_ejs_web_Controller__wrapFilters                             21
+#define ES_ejs_web_Controller_NUM_INSTANCE_PROP                        22
 
 /**
  * 
@@ -110,7 +123,15 @@
 #define ES_ejs_web_Controller_ejs_web_initialize_name                  7
 #define ES_ejs_web_Controller_ejs_web_initialize__hoisted_8_adapter    8
 #define ES_ejs_web_Controller_ejs_web_initialize__hoisted_9_dbname     9
+#define ES_ejs_web_Controller_set_params_value                         0
+#define ES_ejs_web_Controller_loadParams_params                        0
 #define ES_ejs_web_Controller_ejs_web_cache_enable                     0
+#define ES_ejs_web_Controller_ejs_web_cacheAction_actions              0
+#define ES_ejs_web_Controller_ejs_web_cacheAction_options              1
+#define ES_ejs_web_Controller_ejs_web_cacheAction_spec                 2
+#define ES_ejs_web_Controller_ejs_web_cacheAction__hoisted_3_name      3
+#define ES_ejs_web_Controller_joinNames_names                          0
+#define ES_ejs_web_Controller_ejs_web_expireCache_tag                  0
 #define ES_ejs_web_Controller_ejs_web_createSession_timeout            0
 #define ES_ejs_web_Controller_ejs_web_beforeFilter_fn                  0
 #define ES_ejs_web_Controller_ejs_web_beforeFilter_options             1
@@ -123,9 +144,14 @@
 #define ES_ejs_web_Controller_runFilters__hoisted_2_fn                 2
 #define ES_ejs_web_Controller_runFilters__hoisted_3_options            3
 #define ES_ejs_web_Controller_ejs_web_doAction_act                     0
-#define ES_ejs_web_Controller_ejs_web_doAction__hoisted_1_e            1
-#define ES_ejs_web_Controller_ejs_web_doAction__hoisted_3_item         3
-#define ES_ejs_web_Controller_ejs_web_doAction__hoisted_4_old          4
+#define ES_ejs_web_Controller_ejs_web_doAction_cacheSpec               1
+#define ES_ejs_web_Controller_ejs_web_doAction__hoisted_2_e            2
+#define ES_ejs_web_Controller_ejs_web_doAction__hoisted_4_item         4
+#define ES_ejs_web_Controller_ejs_web_doAction__hoisted_5_old          5
+#define ES_ejs_web_Controller_saveCache_lifespan                       0
+#define ES_ejs_web_Controller_saveCache_vary                           1
+#define ES_ejs_web_Controller_saveCache_tags                           2
+#define ES_ejs_web_Controller_saveCache_session                        3
 #define ES_ejs_web_Controller_ejs_web_sendError_code                   0
 #define ES_ejs_web_Controller_ejs_web_sendError_msg                    1
 #define ES_ejs_web_Controller_ejs_web_escapeHtml_s                     0
@@ -134,6 +160,7 @@
 #define ES_ejs_web_Controller_ejs_web_inform_msg                       0
 #define ES_ejs_web_Controller_ejs_web_error_msg                        0
 #define ES_ejs_web_Controller_ejs_web_keepAlive_on                     0
+#define ES_ejs_web_Controller_ejs_web_stream_on                        0
 #define ES_ejs_web_Controller_ejs_web_loadView_path                    0
 #define ES_ejs_web_Controller_ejs_web_makeUrl_action                   0
 #define ES_ejs_web_Controller_ejs_web_makeUrl_id                       1
@@ -176,19 +203,20 @@
 #define ES_ejs_web_Controller_ejs_web_warn_msg                         0
 #define ES_ejs_web_Controller_ejs_web_write_args                       0
 #define ES_ejs_web_Controller_ejs_web_writeHtml_args                   0
+#define ES_ejs_web_Controller_ejs_web_writeJSON_obj                    0
 #define ES_ejs_web_Controller_ejs_web_writeRaw_args                    0
 
 
 /**
  *   Class property slots for the "_SoloController" class 
  */
-#define ES_ejs_web__SoloController__origin                             41
-#define ES_ejs_web__SoloController_NUM_CLASS_PROP                      41
+#define ES_ejs_web__SoloController__origin                             52
+#define ES_ejs_web__SoloController_NUM_CLASS_PROP                      52
 
 /**
  * Instance slots for "_SoloController" type 
  */
-#define ES_ejs_web__SoloController_NUM_INSTANCE_PROP                   20
+#define ES_ejs_web__SoloController_NUM_INSTANCE_PROP                   22
 
 
 /**
@@ -355,21 +383,22 @@
 #define ES_ejs_web_View_ejs_web_setHttpCode                            43
 #define ES_ejs_web_View_ejs_web_setMimeType                            44
 #define ES_ejs_web_View_ejs_web_write                                  45
-#define ES_ejs_web_View_ejs_web_writeHtml                              46
-#define ES_ejs_web_View_ejs_web_writeRaw                               47
-#define ES_ejs_web_View_ejs_web_d                                      48
-#define ES_ejs_web_View_addHelper                                      49
-#define ES_ejs_web_View_getConnector                                   50
-#define ES_ejs_web_View_setOptions                                     51
-#define ES_ejs_web_View_ejs_web_getValue                               52
-#define ES_ejs_web_View_ejs_web_date                                   53
-#define ES_ejs_web_View_ejs_web_currency                               54
-#define ES_ejs_web_View_ejs_web_number                                 55
-#define ES_ejs_web_View_htmlOptions                                    56
-#define ES_ejs_web_View_ejs_web_getOptions                             57
-#define ES_ejs_web_View_sort                                           58
-#define ES_ejs_web_View_filter                                         59
-#define ES_ejs_web_View_NUM_CLASS_PROP                                 60
+#define ES_ejs_web_View_ejs_web_writeSegment                           46
+#define ES_ejs_web_View_ejs_web_writeHtml                              47
+#define ES_ejs_web_View_ejs_web_writeRaw                               48
+#define ES_ejs_web_View_ejs_web_d                                      49
+#define ES_ejs_web_View_addHelper                                      50
+#define ES_ejs_web_View_getConnector                                   51
+#define ES_ejs_web_View_setOptions                                     52
+#define ES_ejs_web_View_ejs_web_getValue                               53
+#define ES_ejs_web_View_ejs_web_date                                   54
+#define ES_ejs_web_View_ejs_web_currency                               55
+#define ES_ejs_web_View_ejs_web_number                                 56
+#define ES_ejs_web_View_htmlOptions                                    57
+#define ES_ejs_web_View_ejs_web_getOptions                             58
+#define ES_ejs_web_View_sort                                           59
+#define ES_ejs_web_View_filter                                         60
+#define ES_ejs_web_View_NUM_CLASS_PROP                                 61
 
 /**
  * Instance slots for "View" type 
@@ -506,6 +535,7 @@
 #define ES_ejs_web_View_ejs_web_setHttpCode_code                       0
 #define ES_ejs_web_View_ejs_web_setMimeType_format                     0
 #define ES_ejs_web_View_ejs_web_write_args                             0
+#define ES_ejs_web_View_ejs_web_writeSegment_text                      0
 #define ES_ejs_web_View_ejs_web_writeHtml_args                         0
 #define ES_ejs_web_View_ejs_web_writeRaw_args                          0
 #define ES_ejs_web_View_ejs_web_d_args                                 0
@@ -527,11 +557,11 @@
 #define ES_ejs_web_View_ejs_web_getValue_typeName                      4
 #define ES_ejs_web_View_ejs_web_getValue_fmt                           5
 #define ES_ejs_web_View_ejs_web_date_fmt                               0
-#define ES_ejs_web_View_ejs_web_date___fun_4958__                      1
+#define ES_ejs_web_View_ejs_web_date___fun_5291__                      1
 #define ES_ejs_web_View_ejs_web_currency_fmt                           0
-#define ES_ejs_web_View_ejs_web_currency___fun_4992__                  1
+#define ES_ejs_web_View_ejs_web_currency___fun_5325__                  1
 #define ES_ejs_web_View_ejs_web_number_fmt                             0
-#define ES_ejs_web_View_ejs_web_number___fun_5022__                    1
+#define ES_ejs_web_View_ejs_web_number___fun_5355__                    1
 #define ES_ejs_web_View_ejs_web_getOptions_options                     0
 #define ES_ejs_web_View_ejs_web_getOptions_result                      1
 #define ES_ejs_web_View_ejs_web_getOptions__hoisted_2_option           2
@@ -951,6 +981,6 @@
 #define ES_ejs_web_GoogleConnector_getOptions__hoisted_3_word          3
 #define ES_ejs_web_GoogleConnector_write_str                           0
 
-#define _ES_CHECKSUM_ejs_web 3386405
+#define _ES_CHECKSUM_ejs_web 3526665
 
 #endif
@@ -480,7 +480,11 @@ module ejs.io {
         /**
          *  Put the file stream into async mode and define a completion callback. When in async mode, I/O will be 
          *  non-blocking and the callback function will be invoked when the there is read data available or when 
-         *  the write side can accept more data.
+         *  the write side can accept more data. I/O is performed in the background via the application event loop,
+         *  so the application must service events (see App.serviceEvents). Reads return only data that has already been
+         *  read ahead and readBytes returns null once the end of file has been reached. Writes are buffered and the 
+         *  callback is invoked once all written data has been transferred to the file. Closing the file waits for 
+         *  pending writes to complete.
          *  @param callback Callback function to invoke when the pending I/O is complete. The callback is invoked 
          *  with the signature: function callback(e: Event): void.  Where e.data == stream.
          */
@@ -77,11 +77,6 @@ module ejs.web {
          */
         public var host:        Host
 
-        /**
-         *  Form parameters. 
-         */
-        public var params:      Object
-
         /**
          *  The request object stores details of the incoming client's request
          */
@@ -100,12 +95,20 @@ module ejs.web {
          */
         public /* synchronized */ var session: Object
 
+        /**
+         *  Stream view output to the client while the view is rendering. Defaults to false. Only set to true if views
+         *  do not modify HTTP headers after writing output.
+         */
+        public var streamViews: Boolean
+
         private var isApp:      Boolean
         private var rendered:   Boolean
         private var redirected: Boolean
         private var events:     Dispatcher
 
         private var _afterFilters: Array
+        private var _cacheActions: Object
+        private var _params:    Object
         private var _beforeFilters: Array
         private var _wrapFilters: Array
 
@@ -156,19 +159,86 @@ module ejs.web {
             // events = new Dispatcher
             rendered = false
             redirected = false
-            //  TODO - better to do these lazily
-            params = new Object
+            streamViews = false
             let name: String = Reflect(this).name
             controllerName = name.trim("Controller")
         }
 
 
+        /**
+         *  Form parameters. Parameters are defined from the request on first access.
+         */
+        public function get params(): Object {
+            if (_params == null) {
+                _params = new Object
+                loadParams(_params)
+            }
+            return _params
+        }
+
+        public function set params(value: Object): Void {
+            _params = value
+        }
+
+        private native function loadParams(params: Object): Void
+
+
         /** 
          *  Add a cache-control header to direct the browser to not cache the response.
          */
         native function cache(enable: Boolean = true): Void
 
 
+        /**
+         *  Cache the responses of actions. Cached responses are replayed by the web server without running the
+         *  controller, so filters and the action are skipped on a cache hit. Only GET requests that succeed without
+         *  setting cookies or redirecting are cached.
+         *  @param actions Action name or array of action names
+         *  @param options Cache options. Lifespan is the number of seconds to keep responses (default 60). A lifespan
+         *      of zero disables caching. Vary is a request header name or array of names whose values select distinct
+         *      responses. Tags is a tag or array of tags for use with expireCache. If session is true, responses are
+         *      cached separately for each session. Otherwise they are shared by all clients.
+         */
+        function cacheAction(actions: Object, options: Object = null): Void {
+            if (_cacheActions == null) {
+                _cacheActions = {}
+            }
+            if (options == null) {
+                options = {}
+            }
+            let spec = {
+                lifespan: (options.lifespan != undefined) ? options.lifespan : 60,
+                vary: joinNames(options.vary),
+                tags: joinNames(options.tags),
+                session: options.session ? true : false
+            }
+            if (actions is Array) {
+                for each (name in actions) {
+                    _cacheActions[name] = spec
+                }
+            } else {
+                _cacheActions[actions] = spec
+            }
+        }
+
+
+        private function joinNames(names: Object): String {
+            if (names is Array) {
+                return names.join(" ")
+            } else if (names) {
+                return names.toString()
+            }
+            return ""
+        }
+
+
+        /**
+         *  Expire cached action responses.
+         *  @param tag Expire responses cached with this tag. If omitted, all cached responses are expired.
+         */
+        native function expireCache(tag: String = null): Void
+
+
         /**
          *  Enable session control. This enables session state management for this request and other requests 
          *  from the browser. If a session has not already been created, this call creates a session and sets 
@@ -196,6 +266,12 @@ module ejs.web {
         native function discardOutput(): Void
 
 
+        /**
+         *  Flush buffered output to the client. Once output has been flushed, HTTP headers can no longer be modified.
+         */
+        native function flush(): Void
+
+
         function beforeFilter(fn, options: Object = null): Void {
             if (_beforeFilters == null) {
                 _beforeFilters = []
@@ -272,6 +348,14 @@ module ejs.web {
                 lastFlash = flash.clone()
             }
 
+            /*
+             *  Responses that consume flash messages depend on session state and are not cached
+             */
+            let cacheSpec = (_cacheActions && !lastFlash) ? _cacheActions[actionName] : null
+            if (cacheSpec) {
+                beginCache()
+            }
+
             runFilters(_beforeFilters)
 
             if (!redirected) {
@@ -291,6 +375,10 @@ module ejs.web {
 
                 runFilters(_afterFilters)
 
+                if (cacheSpec) {
+                    saveCache(cacheSpec.lifespan, cacheSpec.vary, cacheSpec.tags, cacheSpec.session)
+                }
+
                 //  TODO - temp
                 if (Record.db) {
                     Record.db.close()
@@ -313,6 +401,10 @@ module ejs.web {
         }
 
 
+        private native function beginCache(): Void
+        private native function saveCache(lifespan: Number, vary: String, tags: String, session: Boolean): Void
+
+
         /**
          *  Send an error response back to the client. This calls discard.
          *  @param msg Message to display
@@ -366,6 +458,15 @@ module ejs.web {
         native function keepAlive(on: Boolean): Void
 
 
+        /**
+         *  Control whether output is streamed to the client as it is written. When enabled, output is sent in fixed
+         *  size packets while the request runs rather than after it completes. HTTP headers must be set before the 
+         *  first packet is sent.
+         *  @param on Set to true to enable streaming.
+         */
+        native function stream(on: Boolean): Void
+
+
         /**
          *  Load a view. If path is not supplied, use the default view for the current action.
          *  @param viewName Name of the view to load. It may be a fully qualified path name or a filename relative to the 
@@ -526,6 +627,9 @@ module ejs.web {
                     for (let n: String in this) {
                         view[n] = this[n]
                     }
+                    if (streamViews) {
+                        stream(true)
+                    }
                     view.render()
                 } catch (e: Error) {
                     reportError(Http.ServerError, 'Error rendering: "' + viewName + '.ejs".', e)
@@ -642,6 +746,15 @@ module ejs.web {
         }
 
 
+        /**
+         *  Serialize an object as JSON and write it to the client in one block. Keys are quoted, functions and 
+         *  undefined properties are omitted and the response mime type is set to "application/json". Cyclic objects
+         *  throw a TypeError. The serialized text is not converted to an intermediate string.
+         *  @param obj Object to serialize and write
+         */
+        native function writeJSON(obj: Object): Void
+
+
         //ZZZ - comment
         //  TODO - omit the new line
         native function writeRaw(...args): Void
@@ -4,11 +4,6 @@
 
 module ejs.web {
 
-    /**
-     *  Array of all sessions
-     */
-    var sessions = []
-
     /**
      *  Session state storage class
      */
@@ -778,6 +778,14 @@ module ejs.web {
         }
 
 
+        /**
+         *  Write a template segment to the client. Compiled views use this to write literal HTML and expression
+         *  results. The text is written directly to the response without the argument processing of write().
+         *  @param text Text to write
+         */
+        native function writeSegment(text: String): Void
+
+
         /**
          *  Write HTML escaped text to the client. This call writes the arguments back to the client's browser after mapping
          *  all HTML control sequences into safe alternatives. The arguments are converted to strings before writing back to 
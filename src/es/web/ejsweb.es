@@ -18,6 +18,7 @@ class EjsWeb {
     private const NextMigration: String = ".ejs/nextMigration"
 
     private var applyMigration: Boolean = false
+    private var collapseSpace: Boolean = false
     private var appName: String
     private var command: String 
     private var config: Object
@@ -41,7 +42,7 @@ class EjsWeb {
             config = {}
         }
         ejsweb = App.args[0]
-        if (ejsweb == "ejsweb") {
+        if (!basename(ejsweb).startsWith("ajsweb")) {
             compiler = "ejsc"
         } else {
             compiler = "ajsc"
@@ -76,6 +77,10 @@ class EjsWeb {
                 applyMigration = true
                 break
 
+            case "--collapse-space":
+                collapseSpace = true
+                break
+
             case "--debug":
                 debug = true
                 break
@@ -182,6 +187,7 @@ class EjsWeb {
         print("\nUsage: " + App.args[0] + " [options] [commands] ...\n" +
             "  Options:\n" + 
             "    --apply                      # Apply migrations\n" + 
+            "    --collapse-space             # Collapse white space in views\n" + 
             "    --database [sqlite | mysql]  # Sqlite only currently supported adapter\n" + 
             "    --keep\n" + 
             "    --layout layoutPage\n" + 
@@ -496,7 +502,7 @@ class EjsWeb {
          *  Parse the ejs file and create an ".es" equivalent
          */
         trace("[PARSE]", file)
-        let ep: EjsParser = new EjsParser
+        let ep: EjsParser = new EjsParser(collapseSpace)
         results = Templates.ViewHeader + ep.parse(file, App.workingDir, layoutPage) + Templates.ViewFooter
         results = results.replace(/\${CONTROLLER}/g, controllerPrefix)
         results = results.replace(/\${VIEW}/g, viewName)
@@ -1778,24 +1784,43 @@ class Token {
 
 class EjsParser {
 
-    private const ContentMarker: String         = "__ejs:CONTENT:ejs__"
-    private const ContentPattern: RegExp        = new RegExp(ContentMarker)
     private const LayoutsDir: String            = "views/layouts"
+    private const PreserveTags: Array           = [ "pre", "textarea", "script", "style" ]
+    private const SpacePattern: RegExp          = /[ \t]*\r?\n[ \t\r\n]*/g
 
     private var appBaseDir: String
     private var script: String
     private var pos: Number                     = 0
     private var lineNumber: Number              = 0
     private var layoutPage: String
+    private var collapse: Boolean
+
+
+    /*
+     *  If collapse is true, white space in literal HTML that spans lines is collapsed to a single newline
+     */
+    public function EjsParser(collapse: Boolean = false) {
+        this.collapse = collapse
+    }
 
 
     /*
      *  Main parser. Parse the script and return the compiled (Ejscript) result
      */
     public function parse(file: String, appDir: String, layout: string): String {
+        return generate(parseSegments(file, appDir, layout))
+    }
+
+
+    /*
+     *  Parse the script into a list of segments. Each segment has a "literal" property for HTML text, a "code" property
+     *  for Ejscript or a "content" property marking where a layout includes the page. Includes and layouts are inlined 
+     *  here so that adjacent literal text can be merged at compile time.
+     */
+    function parseSegments(file: String, appDir: String, layout: string): Array {
 
         var token: ByteArray = new ByteArray
-        var out: ByteArray = new ByteArray
+        var segments: Array = new Array
         var tid: Number
 
         appBaseDir = appDir;
@@ -1808,7 +1833,7 @@ class EjsParser {
 
             switch (tid) {
             case Token.Literal:
-                out.write("\nwrite(\"" + token + "\");\n")
+                segments.append({ literal: token.toString() })
                 break
 
             case Token.Var:
@@ -1816,19 +1841,18 @@ class EjsParser {
                  *	Trick to get undefined variables to evaluate to "".
                  *	Catenate with "" to cause toString to run.
                  */
-                out.write("\nwrite(\"\" + ", token, ");\n")
+                segments.append({ code: "\nwriteSegment(\"\" + " + token + ");\n" })
                 break
 
             case Token.Equals:
-                out.write("\nwrite(\"\" + (", token, "));\n")
+                segments.append({ code: "\nwriteSegment(\"\" + (" + token + "));\n" })
                 break
 
             case Token.EjsTag:
                 /*
                  *  Just copy the Ejscript code straight through
                  */
-                //  TODO BUG ByteArray.write(ByteArray) is not working. Requires toString()
-                out.write(token.toString())
+                segments.append({ code: token.toString() })
                 break
 
             case Token.Control:
@@ -1842,8 +1866,10 @@ class EjsParser {
                     /*
                      *	Recurse and process the include script
                      */
-                    let inc: EjsParser = new EjsParser
-                    out.write(inc.parse(incPath, appBaseDir, undefined))
+                    let inc: EjsParser = new EjsParser(collapse)
+                    for each (segment in inc.parseSegments(incPath, appBaseDir, undefined)) {
+                        segments.append(segment)
+                    }
                     break
 
                 case "layout":
@@ -1860,7 +1886,7 @@ class EjsParser {
                     break
 
                 case "content":
-                    out.write(ContentMarker)
+                    segments.append({ content: true })
                     break
 
                 default:
@@ -1877,13 +1903,119 @@ class EjsParser {
         }
 
         if (layoutPage != undefined && layoutPage != file) {
-            let layoutText: String = new EjsParser().parse(layoutPage, appBaseDir, layoutPage)
-            return layoutText.replace(ContentPattern, out.toString())
+            let layoutSegments: Array = new EjsParser(collapse).parseSegments(layoutPage, appBaseDir, layoutPage)
+            let result: Array = new Array
+            let inserted: Boolean = false
+            for each (segment in layoutSegments) {
+                if (segment.content && !inserted) {
+                    for each (s in segments) {
+                        result.append(s)
+                    }
+                    inserted = true
+                } else {
+                    result.append(segment)
+                }
+            }
+            return result
+        }
+        return segments
+    }
+
+
+    /*
+     *  Generate the Ejscript for a list of segments. Adjacent literal segments are merged and written with a single 
+     *  writeSegment call so the literal HTML is stored once as a module constant and written directly to the response.
+     */
+    function generate(segments: Array): String {
+        var out: ByteArray = new ByteArray
+        var text: String
+        var state: Object = { tag: null }
+
+        for each (segment in segments) {
+            if (segment.literal != undefined) {
+                text = (text == null) ? segment.literal : (text + segment.literal)
+                continue
+            }
+            if (text != null) {
+                writeLiteral(out, text, state)
+                text = null
+            }
+            if (segment.code != undefined) {
+                out.write(segment.code)
+            }
+        }
+        if (text != null) {
+            writeLiteral(out, text, state)
         }
         return out.toString()
     }
 
 
+    function writeLiteral(out: ByteArray, text: String, state: Object): Void {
+        if (collapse) {
+            text = collapseSpace(text, state)
+        }
+        if (text != "") {
+            out.write("\nwriteSegment(\"" + text + "\");\n")
+        }
+    }
+
+
+    /*
+     *  Collapse runs of white space that span lines to a single newline. Text inside pre, textarea, script and style 
+     *  elements is preserved. state.tag holds the open element so an element that spans Ejscript code is preserved up
+     *  to its end tag. The state is created for each call to generate.
+     */
+    function collapseSpace(text: String, state: Object): String {
+        var result: String = ""
+
+        while (text.length > 0) {
+            let lower: String = text.toLower()
+            if (state.tag) {
+                let end: Number = findTag(lower, "</" + state.tag)
+                if (end < 0) {
+                    return result + text
+                }
+                result += text.substring(0, end)
+                text = text.substring(end)
+                state.tag = null
+                continue
+            }
+            let start: Number = -1
+            for each (tag in PreserveTags) {
+                let i: Number = findTag(lower, "<" + tag)
+                if (i >= 0 && (start < 0 || i < start)) {
+                    start = i
+                    state.tag = tag
+                }
+            }
+            if (start < 0) {
+                return result + text.replace(SpacePattern, "\n")
+            }
+            start += state.tag.length + 1
+            result += text.substring(0, start).replace(SpacePattern, "\n")
+            text = text.substring(start)
+        }
+        return result
+    }
+
+
+    /*
+     *  Find a tag. The tag name must be followed by white space or ">" so that "<pre" does not match "<preview".
+     */
+    function findTag(text: String, prefix: String): Number {
+        let i: Number = text.indexOf(prefix)
+        while (i >= 0) {
+            let next: Number = i + prefix.length
+            if (next < text.length && (text[next] == ">" || text[next].isSpace)) {
+                return i
+            }
+            i = text.indexOf(prefix, i + 1)
+        }
+        return -1
+    }
+
+
     /*
      *  Get the next input token. Read from script[pos]. Return the next token ID and update the token byte array
      */
@@ -0,0 +1,93 @@
+/*
+ *	XMLReader.es - Streaming XML reader
+ *
+ *	Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+module ejs {
+
+	use default namespace intrinsic
+
+	/**
+	 *	Event based (SAX style) XML reader. The reader parses XML read incrementally from a stream and invokes handler 
+	 *	methods as each element, text run and comment is parsed. Unlike the XML class, no XML nodes are created, so 
+	 *	documents much larger than the XML load limits can be processed using a small, fixed amount of memory.
+	 *
+	 *	@Example
+	 *		file = new File("feed.xml")
+	 *		file.open(File.Read)
+	 *		reader = new XMLReader(file)
+	 *		reader.parse({
+	 *			start: function (name, attributes) { print("<" + name + ">") },
+	 *			end: function (name) { print("</" + name + ">") },
+	 *			text: function (text) { print(text) }
+	 *		})
+	 *	@spec ejs-11
+	 */
+	native final class XMLReader {
+
+		use default namespace public
+
+		/**
+		 *	Create a streaming XML reader.
+		 *	@param input Stream from which to read the XML document. This may be a File, Socket, Http or any other Stream
+		 *		object opened for reading.
+		 *	@param maxToken Maximum size in bytes of any single element name, attribute value, comment or text run. 
+		 *		The document itself is not limited in size. If negative, the default XML buffer limit is used.
+		 */
+		native function XMLReader(input: Stream, maxToken: Number = -1)
+
+
+		/**
+		 *	Read and parse the input stream until end of file. The handler object may define any of the following 
+		 *	methods which are invoked as the document is parsed. Missing methods are silently skipped.
+		 *	<ul>
+		 *		<li>start(name: String, attributes: Object) - Invoked for each opening element. The attributes object 
+		 *			has a property for each element attribute. Solo elements invoke start and then end.</li>
+		 *		<li>end(name: String) - Invoked for each closing element.</li>
+		 *		<li>text(text: String) - Invoked for element data and CDATA sections.</li>
+		 *		<li>comment(text: String) - Invoked for each comment.</li>
+		 *	</ul>
+		 *	@param handler Object defining the handler methods.
+		 *	@throws SyntaxError if the XML is not well formed. Exceptions thrown by handler methods terminate the parse
+		 *		and are propagated to the caller.
+		 */
+		native function parse(handler: Object): Void
+
+
+		/**
+		 *	Current line number in the input. During a parse, this is the line number of the last item parsed.
+		 */
+		native function get lineNumber(): Number
+	}
+}
+
+
+/*
+ *	@copy	default
+ *	
+ *	Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *	
+ *	This software is distributed under commercial and open source licenses.
+ *	You may use the GPL open source license described below or you may acquire 
+ *	a commercial license from Embedthis Software. You agree to be fully bound 
+ *	by the terms of either license. Consult the LICENSE.TXT distributed with 
+ *	this software for full details.
+ *	
+ *	This software is open source; you can redistribute it and/or modify it 
+ *	under the terms of the GNU General Public License as published by the 
+ *	Free Software Foundation; either version 2 of the License, or (at your 
+ *	option) any later version. See the GNU General Public License for more 
+ *	details at: http://www.embedthis.com/downloads/gplLicense.html
+ *	
+ *	This program is distributed WITHOUT ANY WARRANTY; without even the 
+ *	implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+ *	
+ *	This GPL license does NOT permit incorporating this software into 
+ *	proprietary programs. If you are unable to comply with the GPL, you must
+ *	acquire a commercial license to use this software. Commercial licenses 
+ *	for this software and support services are available from Embedthis 
+ *	Software at http://www.embedthis.com 
+ *	
+ *	@end
+ */
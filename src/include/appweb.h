@@ -163,6 +163,9 @@
     #define MA_MAX_PASS             64                  /**< Size of password */
     #define MA_MAX_SECRET           32                  /**< Number of random bytes to use */
     #define MA_MAX_IOVEC            16                  /**< Number of fragments in a single socket write */
+    #define MA_MAX_SEND_BATCH       (16 * 1024)         /**< Bytes gathered from packets into a single socket write */
+    #define MA_FILE_CACHE_SIZE      (256 * 1024)        /**< Memory for cached static files. Zero to disable */
+    #define MA_FILE_CACHE_ITEM      (16 * 1024)         /**< Largest static file to cache */
 
 #elif BLD_TUNE == MPR_TUNE_BALANCED
     /*
@@ -184,6 +187,9 @@
     #define MA_MAX_PASS             128
     #define MA_MAX_SECRET           32
     #define MA_MAX_IOVEC            24
+    #define MA_MAX_SEND_BATCH       (64 * 1024)
+    #define MA_FILE_CACHE_SIZE      (4 * 1024 * 1024)
+    #define MA_FILE_CACHE_ITEM      (64 * 1024)
 #else
     /*
      *  Tune for speed
@@ -205,6 +211,9 @@
     #define MA_MAX_PASS             128
     #define MA_MAX_SECRET           32
     #define MA_MAX_IOVEC            32
+    #define MA_MAX_SEND_BATCH       (256 * 1024)
+    #define MA_FILE_CACHE_SIZE      (16 * 1024 * 1024)
+    #define MA_FILE_CACHE_ITEM      (256 * 1024)
 #endif
 
 
@@ -219,6 +228,7 @@
 #define MA_MAX_CONFIG_DEPTH     (16)            /* Max nest of directives in config file */
 #define MA_RANGE_BUFSIZE        (128)           /* Size of a range boundary */
 #define MA_MAX_REWRITE          (10)            /* Maximum recursive URI rewrites */
+#define MA_FILE_CACHE_VALID     (1000)          /* Ticks a cached file is trusted before it is checked again */
 
 /*
  *  Hash sizes (primes work best)
@@ -231,11 +241,13 @@
 #define MA_VAR_HASH_SIZE        31              /* Size of query var hash */
 #define MA_HANDLER_HASH_SIZE    17              /* Size of handler hash */
 #define MA_ACTION_HASH_SIZE     13              /* Size of action program hash */
+#define MA_FILE_CACHE_HASH_SIZE 61              /* Size of static file cache hash */
 
 /*
  *  These constants are to sanity check user input in the http.conf
  */
 #define MA_TOP_THREADS          100
+#define MA_TOP_REACTORS         64
 
 #define MA_BOT_BODY             512
 #define MA_TOP_BODY             (0x7fffffff)        /* 2 GB */
@@ -261,6 +273,15 @@
 #define MA_BOT_STAGE_BUFFER     (2 * 1024)
 #define MA_TOP_STAGE_BUFFER     (1 * 1024 * 1024)   /* 1 MB */
 
+#define MA_BOT_SEND_BATCH       (4 * 1024)
+#define MA_TOP_SEND_BATCH       (16 * 1024 * 1024)  /* 16 MB */
+
+#define MA_BOT_FILE_CACHE       0
+#define MA_TOP_FILE_CACHE       (1024 * 1024 * 1024) /* 1 GB */
+
+#define MA_BOT_FILE_CACHE_ITEM  1
+#define MA_TOP_FILE_CACHE_ITEM  (16 * 1024 * 1024)  /* 16 MB */
+
 #define MA_BOT_UPLOAD_SIZE      1
 #define MA_TOP_UPLOAD_SIZE      0x7fffffff          /* 2 GB */
 
@@ -375,9 +396,13 @@ typedef struct MaLimits {
     int             maxHeader;              /**< Max size of the total header */
     int             maxNumHeaders;          /**< Max number of lines of header */
     int             maxResponseBody;        /**< Max size of generated response content */
+    int             maxSendBatch;           /**< Max bytes gathered from packets into one socket write */
+    int             maxFileCache;           /**< Max memory for cached static files. Zero disables the cache */
+    int             maxFileCacheItem;       /**< Max size of a static file to cache */
     int             maxStageBuffer;         /**< Max buffering by any pipeline stage */
     int             maxThreads;             /**< Max number of pool threads */
     int             minThreads;             /**< Min number of pool threads */
+    int             reactors;               /**< Number of I/O event loops (0 or 1 for a single loop) */
     int             maxUploadSize;          /**< Max size of an uploaded file */
     int             maxUrl;                 /**< Max size of a URL */
     int             threadStackSize;        /**< Stack size for each pool thread */
@@ -411,6 +436,7 @@ typedef struct MaHttp {
     struct MaStage  *ejsHandler;            /**< Ejscript Web Framework handler */
     struct MaStage  *fileHandler;           /**< Static file handler */
     struct MaStage  *passHandler;           /**< Pass through handler */
+    struct MaFileCache *fileCache;          /**< Static file content cache */
 
     char            *username;              /**< Http server user name */
     char            *groupname;             /**< Http server group name */
@@ -515,6 +541,7 @@ typedef struct  MaListen {
     bool            secure;
 #endif
     MprSocket       *sock;                  /**< Underlying socket */
+    MprList         *shards;                /**< Additional SO_REUSEPORT sockets, one per extra reactor */
 #if BLD_FEATURE_SSL
     struct MprSsl   *ssl;                   /**< SSL configuration */
 #endif
@@ -1144,6 +1171,7 @@ extern bool maFixRangeLength(struct MaConn *conn);
 #define MA_PACKET_RANGE     0x2             /**< Packet is a range boundary packet */
 #define MA_PACKET_DATA      0x4             /**< Packet contains actual content data */
 #define MA_PACKET_END       0x8             /**< End of stream packet */
+#define MA_PACKET_BORROWED  0x10            /**< Content references data owned elsewhere. Never freed or reparented */
 
 /**
  *  Data packet. 
@@ -1153,7 +1181,9 @@ extern bool maFixRangeLength(struct MaConn *conn);
  *      an END packet.
  *      \n\n
  *      Packets contain data and optional prefix or suffix headers. Packets can be split, joined, filled or emptied. 
- *      The pipeline stages will fill or transform packet data as required.
+ *      The pipeline stages will fill or transform packet data as required. Splitting a packet does not copy the data.
+ *      Both halves reference the original content which is freed when the last of them is freed. Borrowed content
+ *      (MA_PACKET_BORROWED) is owned elsewhere, such as by the file cache, and split packets simply window it.
  *  @stability Evolving
  *  @defgroup MaPacket MaPacket
  *  @see MaPacket MaQueue maCreateDataPackage maCreatePacket maCreateEndPacket maJoinPacket maSplitPacket 
@@ -1170,8 +1200,17 @@ typedef struct MaPacket {
 #endif
     struct MaPacket *next;                  /**< Next packet in chain */
     struct MaConn   *conn;                  /**< Owning connection */
+    struct MaPacketData *shared;            /**< Content data shared with split packets */
 } MaPacket;
 
+/*
+ *  Reference counted owner of packet content data that has been split over several packets. The content data block
+ *  is reparented under this object and is freed when the last referencing packet is freed.
+ */
+typedef struct MaPacketData {
+    int             refs;                   /**< Count of packets referencing the data */
+} MaPacketData;
+
 /**
  *  Create a data packet
  *  @description Create a packet of the required size.
@@ -1229,7 +1268,8 @@ extern int maJoinPacket(MaPacket *packet, MaPacket *other);
  *  @description Split a data packet at the specified offset. Packets may need to be split so that downstream
  *      stages can digest their contents. If a packet is too large for the queue maximum size, it should be split.
  *      When the packet is split, a new packet is created containing the data after the offset. Any suffix headers
- *      are moved to the new packet.
+ *      are moved to the new packet. The data is not copied. The new packet references the content of the original
+ *      packet and neither packet's content buffer can be grown afterwards.
  *  @param conn MaConn connection object
  *  @param packet Packet to split
  *  @param offset Location in the original packet at which to split
@@ -1790,6 +1830,65 @@ extern struct MaStage *maLookupStage(MaHttp *http, cchar *name);
 extern int maOpenPassHandler(MaHttp *http);
 extern int maOpenNetConnector(MaHttp *http);
 extern int maOpenSendConnector(MaHttp *http);
+
+/**
+ *  Cached static file
+ *  @description The file handler keeps small static files in memory so hits are served without opening or reading the
+ *      file. Entries are keyed by filename and validated against the file inode, size and modification time. If a 
+ *      precompressed "filename.gz" variant exists, it is cached too and served to clients that accept gzip encoding.
+ *  @stability Evolving
+ *  @defgroup MaCachedFile MaCachedFile
+ *  @see MaCachedFile maGetCachedFile maReleaseCachedFile maRemoveCachedFile
+ */
+typedef struct MaCachedFile {
+    struct MaCachedFile *prev;              /**< LRU list links. Most recently used first */
+    struct MaCachedFile *next;
+    char            *filename;              /**< Cache key */
+    MprFileInfo     info;                   /**< File information when the file was loaded */
+    MprTime         checked;                /**< When the entry was last validated against the file system */
+    char            *data;                  /**< File content */
+    int             length;                 /**< Length of data */
+    char            *gzipName;              /**< Name of the precompressed variant "filename.gz" */
+    MprFileInfo     gzipInfo;               /**< Precompressed variant information. Not valid if it did not exist */
+    char            *gzipData;              /**< Precompressed content from "filename.gz" */
+    int             gzipLength;             /**< Length of gzipData */
+    char            *etag;                  /**< Entity tag for the file content */
+    char            *gzipEtag;              /**< Entity tag for the precompressed content */
+    char            *lastModified;          /**< Last-Modified header value */
+    int             size;                   /**< Memory charged to the cache */
+    int             refs;                   /**< References by the cache and by responses */
+} MaCachedFile;
+
+/**
+ *  Get the cached copy of the response file
+ *  @description Look up the response filename in the static file cache and take a reference in resp->cachedFile that
+ *      is released when the response is freed. If fresh is true, this is a quick check that never touches the file 
+ *      system. An entry is only returned if it was validated within the last MA_FILE_CACHE_VALID ticks and 
+ *      resp->fileInfo is set from it. Otherwise the entry is validated against resp->fileInfo and the precompressed
+ *      variant against the file system, and a missing or stale file is (re)loaded if it is small enough to cache.
+ *  @param conn MaConn connection object
+ *  @param fresh Set to true to only return entries that do not need validation
+ *  @return The cached file or null if the file is not cached.
+ *  @ingroup MaCachedFile
+ */
+extern MaCachedFile *maGetCachedFile(struct MaConn *conn, bool fresh);
+
+/**
+ *  Release a reference to a cached file
+ *  @param http Http service object
+ *  @param file Cached file returned from maGetCachedFile
+ *  @ingroup MaCachedFile
+ */
+extern void maReleaseCachedFile(MaHttp *http, MaCachedFile *file);
+
+/**
+ *  Remove a file from the static file cache
+ *  @description Used when a file is modified or deleted via the server.
+ *  @param http Http service object
+ *  @param filename Name of the file
+ *  @ingroup MaCachedFile
+ */
+extern void maRemoveCachedFile(MaHttp *http, cchar *filename);
 extern void maRegisterStage(MaHttp *http, MaStage *stage);
 extern int maSetConnector(MaHttp *http, MaLocation *location, cchar *name);
 extern int maSetHandler(MaHttp *http, MaHost *host, MaLocation *location, cchar *name);
@@ -1821,6 +1920,7 @@ extern bool maMatchFilterByExtension(MaFilter *filter, cchar *ext);
 #define MA_CONN_CLOSE               0x1     /**< Connection needs to be closed */
 #define MA_CONN_CLEAN_MASK          0x1     /**< Mask to clear flags after a request completes */
 #define MA_CONN_CASE_INSENSITIVE    0x2     /**< System case-insensitive for file matches */
+#define MA_CONN_DESTROYED           0x4     /**< Connection is being freed */
 
 /**
  *  Http Connections
@@ -1834,6 +1934,7 @@ extern bool maMatchFilterByExtension(MaFilter *filter, cchar *ext);
 typedef struct MaConn {
 
     MprHeap          *arena;                /**< Connection memory arena */
+    MprHeap          *requestArena;         /**< Request memory arena. Reset and reused for keep-alive requests */
 
     struct MaRequest *request;              /**< Request object */
     struct MaResponse *response;            /**< Response object */
@@ -2144,6 +2245,8 @@ typedef struct MaResponse {
      */
     MprFile         *file;                  /**< File to be served */
     MprFileInfo     fileInfo;               /**< File information if there is a real file to serve */
+    struct MaCachedFile *cachedFile;        /**< Cached file content. Referenced until the response is freed */
+    cchar           *cachedData;            /**< Cached content to serve. Either the file or its gzip variant */
     char            *filename;              /**< Name of a real file being served */
     cchar           *extension;             /**< Filename extension */
     int             entityLength;           /**< Original content length before range subsetting */
@@ -99,37 +99,38 @@
 #define ES_ejs_events_TimerEvent                                       78
 #define ES_XML                                                         79
 #define ES_XMLList                                                     80
-#define ES_ejs_io_BinaryStream                                         81
-#define ES_ejs_io_File                                                 82
-#define ES_ejs_io_Http                                                 83
-#define ES_ejs_io_HttpDataEvent                                        84
-#define ES_ejs_io_HttpErrorEvent                                       85
-#define ES_ejs_io_TextStream                                           86
-#define ES_ejs_io_XMLHttp                                              87
-#define ES_ejs_sys_App                                                 88
-#define ES_Config                                                      89
-#define ES_ejs_sys_GC                                                  90
-#define ES_ejs_sys_Memory                                              91
-#define ES_ejs_sys_System                                              92
-#define ES_basename                                                    93
-#define ES_close                                                       94
-#define ES_cp                                                          95
-#define ES_dirname                                                     96
-#define ES_exists                                                      97
-#define ES_extension                                                   98
-#define ES_freeSpace                                                   99
-#define ES_isDir                                                       100
-#define ES_ls                                                          101
-#define ES_mkdir                                                       102
-#define ES_mv                                                          103
-#define ES_open                                                        104
-#define ES_pwd                                                         105
-#define ES_read                                                        106
-#define ES_rm                                                          107
-#define ES_rmdir                                                       108
-#define ES_tempname                                                    109
-#define ES_write                                                       110
-#define ES_global_NUM_CLASS_PROP                                       111
+#define ES_XMLReader                                                   81
+#define ES_ejs_io_BinaryStream                                         82
+#define ES_ejs_io_File                                                 83
+#define ES_ejs_io_Http                                                 84
+#define ES_ejs_io_HttpDataEvent                                        85
+#define ES_ejs_io_HttpErrorEvent                                       86
+#define ES_ejs_io_TextStream                                           87
+#define ES_ejs_io_XMLHttp                                              88
+#define ES_ejs_sys_App                                                 89
+#define ES_Config                                                      90
+#define ES_ejs_sys_GC                                                  91
+#define ES_ejs_sys_Memory                                              92
+#define ES_ejs_sys_System                                              93
+#define ES_basename                                                    94
+#define ES_close                                                       95
+#define ES_cp                                                          96
+#define ES_dirname                                                     97
+#define ES_exists                                                      98
+#define ES_extension                                                   99
+#define ES_freeSpace                                                   100
+#define ES_isDir                                                       101
+#define ES_ls                                                          102
+#define ES_mkdir                                                       103
+#define ES_mv                                                          104
+#define ES_open                                                        105
+#define ES_pwd                                                         106
+#define ES_read                                                        107
+#define ES_rm                                                          108
+#define ES_rmdir                                                       109
+#define ES_tempname                                                    110
+#define ES_write                                                       111
+#define ES_global_NUM_CLASS_PROP                                       112
 
 /**
  * Instance slots for "global" type 
@@ -154,7 +155,7 @@
 #define ES_parse_input                                                 0
 #define ES_parse_preferredType                                         1
 #define ES_serialize_obj                                               0
-#define ES_serialize_maxDepth                                          1
+#define ES_serialize_options                                           1
 #define ES_serialize_all                                               2
 #define ES_serialize_base                                              3
 #define ES_printHash_name                                              0
@@ -1278,6 +1279,29 @@
 #define ES_XMLList_setSettings_settings                                0
 #define ES_XMLList_text_name                                           0
 
-#define _ES_CHECKSUM_ejs 2035482
+
+/**
+ *   Class property slots for the "XMLReader" class 
+ */
+#define ES_XMLReader__origin                                           5
+#define ES_XMLReader_XMLReader                                         5
+#define ES_XMLReader_parse                                             6
+#define ES_XMLReader_lineNumber                                        7
+#define ES_XMLReader_NUM_CLASS_PROP                                    8
+
+/**
+ * Instance slots for "XMLReader" type 
+ */
+#define ES_XMLReader_NUM_INSTANCE_PROP                                 0
+
+/**
+ * 
+ *    Local slots for methods in type XMLReader 
+ */
+#define ES_XMLReader_XMLReader_input                                   0
+#define ES_XMLReader_XMLReader_maxToken                                1
+#define ES_XMLReader_parse_handler                                     0
+
+#define _ES_CHECKSUM_ejs 2064385
 
 #endif
@@ -338,7 +338,7 @@ typedef int (*EjsSortFn)(Ejs *ejs, struct EjsVar *p1, struct EjsVar *p2, cchar *
  *  @see EjsVar ejsGetVarType ejsAllocVar ejsFreeVar ejsCastVar ejsCloneVar ejsCreateInstance ejsCreateVar
  *      ejsDestroyVar ejsDefineProperty ejsDeleteProperty ejsDeletePropertyByName ejsFinalizeVar
  *      ejsGetProperty ejsLookupProperty ejsMarkVar ejsSetProperty ejsSetPropertyByName ejsSetPropertyName
- *      ejsSetPropertyTrait ejsSerialize ejsDeserialize ejsParseVar
+ *      ejsSetPropertyTrait ejsSerialize ejsSerializeBinary ejsDeserialize ejsDeserializeBinary ejsParseVar
  */
 typedef struct EjsVar {
 #if BLD_DEBUG
@@ -690,6 +690,52 @@ extern int ejsSetPropertyTrait(Ejs *ejs, EjsVar *vp, int slotNum, struct EjsType
  *  @ingroup EjsVar
  */
 extern EjsVar  *ejsSerialize(Ejs *ejs, EjsVar *value, int maxDepth, bool showAll, bool showBase);
+
+/**
+ *  Serialize a variable into a buffer
+ *  @description Serialize a variable by appending its string representation to a buffer. This avoids creating 
+ *      intermediate strings when the output is to be written to a stream.
+ *  @return Zero if successful. Otherwise a negative MPR error code and an exception is thrown.
+ *  @ingroup EjsVar
+ */
+extern int ejsSerializeToBuf(Ejs *ejs, MprBuf *buf, EjsVar *value, int maxDepth, bool showAll, bool showBase);
+
+/**
+ *  Serialize a variable into a buffer as strict JSON
+ *  @description Serialize a variable by appending JSON text to a buffer. Keys are quoted, functions and undefined 
+ *      object properties are omitted and non-finite numbers are written as null.
+ *  @return Zero if successful. Otherwise a negative MPR error code and an exception is thrown. Cyclic references 
+ *      throw a TypeError.
+ *  @ingroup EjsVar
+ */
+extern int ejsSerializeJSON(Ejs *ejs, MprBuf *buf, EjsVar *value);
+
+/**
+ *  Serialize a variable into a binary byte array
+ *  @description Serialize a variable using a compact binary encoding. Numbers are written as tagged varints, 
+ *      repeated strings are written once and referenced via a string table, and shared or cyclic objects are written 
+ *      as back-references so the object graph is reconstructed by ejsDeserializeBinary.
+ *  @return A ByteArray containing the encoding. The write position is set to the length of the encoding.
+ *  @ingroup EjsVar
+ */
+extern EjsVar  *ejsSerializeBinary(Ejs *ejs, EjsVar *value, int maxDepth, bool showAll, bool showBase);
+
+/**
+ *  Serialize a variable into a buffer using the binary encoding
+ *  @return Zero if successful. Otherwise a negative MPR error code and an exception is thrown.
+ *  @ingroup EjsVar
+ */
+extern int ejsSerializeBinaryToBuf(Ejs *ejs, MprBuf *buf, EjsVar *value, int maxDepth, bool showAll, bool showBase);
+
+/**
+ *  Deserialize a binary encoding
+ *  @description Reconstruct an object graph from data created by ejsSerializeBinary.
+ *  @param data Binary encoding
+ *  @param len Length of the data in bytes
+ *  @return The reconstructed value or null if the data is corrupt, in which case an IOError is thrown.
+ *  @ingroup EjsVar
+ */
+extern EjsVar  *ejsDeserializeBinary(Ejs *ejs, cchar *data, int len);
 extern EjsVar  *ejsDeserialize(Ejs *ejs, EjsVar *value);
 extern EjsVar *ejsParseVar(Ejs *ejs, cchar *str,  int prefType);
 extern void ejsZeroSlots(Ejs *ejs, EjsVar **slots, int count);
@@ -1841,6 +1887,24 @@ typedef struct EjsFile {
     MprFileInfo     info;               /**< Cached file info */
     char            *path;              /**< Filename path */
     int             mode;               /**< Current open mode */
+    Ejs             *ejs;               /**< Interpreter reference for async callbacks */
+    EjsFunction     *callback;          /**< Async I/O callback. Defining puts the file into async mode */
+    MprBuf          *asyncBuf;          /**< Async read-ahead data or write data pending output */
+    char            *ioBuf;             /**< Staging buffer for the current async I/O pass */
+    int             ioLength;           /**< Bytes requested for the current async I/O pass */
+    int             ioCount;            /**< Bytes transferred by the last async I/O pass. Set to -1 on errors */
+    MprEvent        *ioEvent;           /**< Queued async I/O pass or completion event */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;             /**< Serializes allocations made by pool threads for async I/O */
+    MprCond         *ioCond;            /**< Signalled when a pool thread completes an async I/O pass */
+    int             ioDone;             /**< Set by the pool thread when the async I/O pass is complete */
+#endif
+    uint            ioBusy: 1;          /**< An async I/O pass is outstanding */
+    uint            ioEof: 1;           /**< Async read-ahead has reached the end of file */
+    uint            ioError: 1;         /**< Async I/O failed. Reported on the next read or write */
+    uint            ioPinned: 1;        /**< File was made permanent for the duration of the async I/O pass */
+    uint            ioThread: 1;        /**< The async I/O pass is running on a pool thread */
+    uint            ioWrite: 1;         /**< The async I/O pass is a write */
 #if FUTURE
     cchar           *cygdrive;          /**< Cygwin drive directory (c:/cygdrive) */
     cchar           *newline;           /**< Newline delimiters */
@@ -2128,17 +2192,35 @@ extern EjsVar *ejsGetTypeName(Ejs *ejs, EjsVar *vp);
 extern EjsVar *ejsGetTypeOf(Ejs *ejs, EjsVar *vp);
 
 
+/**
+ *  Compiled regular expression program. Programs may be shared by many RegExp objects via the service regex cache.
+ *  Shared programs are reference counted by the cache and by each RegExp using them.
+ *  @ingroup EjsRegExp
+ */
+typedef struct EjsRegExpCode {
+    struct EjsRegExpCode *prev;                     /**< Regex cache LRU list linkage */
+    struct EjsRegExpCode *next;
+    char            *key;                           /**< Regex cache key */
+    void            *compiled;                      /**< Compiled pcre program */
+    void            *extra;                         /**< Study data from pcre_study. Null if not (yet) studied */
+    int             runs;                           /**< Count of executions before the program was studied */
+    int             refs;                           /**< References to a shared program */
+    bool            studied;                        /**< Program has been studied (extra may still be null) */
+    bool            shared;                         /**< Program is owned by the service regex cache */
+} EjsRegExpCode;
+
+
 /**
  *  RegExp Class
  *  @description The regular expression class provides string pattern matching and substitution.
  *  @stability Evolving
  *  @defgroup EjsRegExp EjsRegExp
- *  @see EjsRegExp ejsCreateRegExp ejsIsRegExp
+ *  @see EjsRegExp ejsCreateRegExp ejsIsRegExp ejsRunRegExp
  */
 typedef struct EjsRegExp {
     EjsVar          var;                            /**< Logically extends Object */
     char            *pattern;                       /**< Pattern to match with */
-    void            *compiled;                      /**< Compiled pattern */
+    EjsRegExpCode   *code;                          /**< Compiled pattern */
     bool            global;                         /**< Search for pattern globally (multiple times) */
     bool            ignoreCase;                     /**< Do case insensitive matching */
     bool            multiline;                      /**< Match patterns over multiple lines */
@@ -2158,6 +2240,23 @@ typedef struct EjsRegExp {
  */
 extern EjsRegExp *ejsCreateRegExp(Ejs *ejs, cchar *pattern);
 
+/**
+ *  Run a regular expression over a string
+ *  @description Match the compiled regular expression against the string. Programs that are run frequently are 
+ *      studied to speed up subsequent matching.
+ *  @param ejs Ejs reference returned from #ejsCreate
+ *  @param rp Regular expression object
+ *  @param str String to match
+ *  @param len Length of str in bytes
+ *  @param start Offset in str at which to start matching
+ *  @param options Pcre execution options. Typically zero or PCRE_NOTEMPTY.
+ *  @param matches Array to receive the offsets of the match and submatches. May be null.
+ *  @param size Number of elements in the matches array
+ *  @return The number of matches found (including the whole match), or a negative pcre error if there is no match.
+ *  @ingroup EjsRegExp
+ */
+extern int ejsRunRegExp(Ejs *ejs, EjsRegExp *rp, cchar *str, int len, int start, int options, int *matches, int size);
+
 #if DOXYGEN
     /**
      *  Determine if the variable is a regular expression
@@ -2359,6 +2458,33 @@ extern EjsXML *ejsSetXML(Ejs *ejs, EjsXML *xml, int index, EjsXML *node);
 extern int ejsAppendAttributeToXML(Ejs *ejs, EjsXML *parent, EjsXML *node);
 extern EjsXML *ejsCreateXMLList(Ejs *ejs, EjsXML *targetObject, EjsName *targetProperty);
 
+
+/**
+ *  XMLReader class
+ *  @description Event based streaming XML reader. The reader drives the MPR XML parser with data read incrementally 
+ *      from a stream and invokes script handler methods for elements, text and comments without creating XML nodes.
+ *  @stability Prototype
+ *  @defgroup EjsXMLReader EjsXMLReader
+ *  @see EjsXMLReader
+ */
+typedef struct EjsXMLReader {
+    EjsObject       obj;                    /**< Extends Object */
+    Ejs             *ejs;                   /**< Interpreter reference for parser callbacks */
+    EjsVar          *input;                 /**< Input stream */
+    EjsFunction     *readFn;                /**< Input stream read method */
+    EjsByteArray    *buffer;                /**< Buffer for reading from the input stream */
+    EjsVar          *handler;               /**< Handler object for the current parse */
+    EjsFunction     *startFn;               /**< Handler method for opening elements */
+    EjsFunction     *endFn;                 /**< Handler method for closing elements */
+    EjsFunction     *textFn;                /**< Handler method for element text */
+    EjsFunction     *commentFn;             /**< Handler method for comments */
+    EjsVar          *attributes;            /**< Attributes of the element being opened */
+    MprXml          *xp;                    /**< Parser for the current parse */
+    int             maxToken;               /**< Maximum size of a single parsed token */
+    int             depth;                  /**< Current element nesting depth */
+    int             lineNumber;             /**< Line number of the last item parsed */
+} EjsXMLReader;
+
 #else
 #define ejsIsXML(vp) 0
 #endif /* BLD_FEATURE_EJS_E4X */
@@ -2456,6 +2582,7 @@ extern void     ejsCreateTimerType(Ejs *ejs);
 extern void     ejsCreateTypes(Ejs *ejs);
 extern int      ejsCreateXMLType(Ejs *ejs);
 extern int      ejsCreateXMLListType(Ejs *ejs);
+extern int      ejsCreateXMLReaderType(Ejs *ejs);
 
 /*
  *  Core type configuration
@@ -2493,6 +2620,7 @@ extern void     ejsConfigureTypes(Ejs *ejs);
 extern void     ejsConfigureVoidType(Ejs *ejs);
 extern int      ejsConfigureXMLType(Ejs *ejs);
 extern int      ejsConfigureXMLListType(Ejs *ejs);
+extern int      ejsConfigureXMLReaderType(Ejs *ejs);
 
 extern int      ejsAddNativeModule(Ejs *ejs, char *name, EjsNativeCallback callback);
 extern void     ejsCreateCoreNamespaces(Ejs *ejs);
@@ -2502,7 +2630,6 @@ extern int      ejsDefineErrorTypes(Ejs *ejs);
 extern int      ejsGetAvailableData(EjsByteArray *ap);
 extern void     ejsInheritBaseClassNamespaces(Ejs *ejs, struct EjsType *type, struct EjsType *baseType);
 extern void     ejsInitializeDefaultHelpers(struct EjsTypeHelpers *helpers);
-extern void     ejsSetDbMemoryContext(MprThreadLocal *tls, MprCtx ctx);
 
 #ifdef __cplusplus
 }
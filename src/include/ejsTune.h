@@ -31,11 +31,13 @@ extern "C" {
     #define EJS_E4X_BUF_MAX         (256 * 1024)    /* Max XML document size */
     #define EJS_MAX_RECURSION       10000           /* Maximum recursion */
     #define EJS_MAX_REGEX_MATCHES   32              /* Maximum regular sub-expressions */
+    #define EJS_REGEX_CACHE_MAX     64              /* Maximum compiled regular expressions to cache */
     #define EJS_MAX_DB_MEM          (2*1024*1024)   /* Maximum regular sub-expressions */
 
     #define E4X_BUF_SIZE            512             /* Initial buffer size for tokens */
     #define E4X_BUF_MAX             (32 * 1024)     /* Max size for tokens */
     #define E4X_MAX_NODE_DEPTH      24              /* Max nesting of tags */
+    #define EJS_MAX_LITERAL_DEPTH   64              /* Max nesting of deserialized object literals */
 
     #define EJS_WEB_TOK_INCR        1024
     #define EJS_WEB_MAX_HEADER      1024
@@ -45,7 +47,17 @@ extern "C" {
 
     #define EJS_CGI_MIN_BUF         (32 * 1024)     /* CGI output buffering */
     #define EJS_CGI_MAX_BUF         (128 * 1024)
+    #define EJS_CGI_MAX_POST        (1024 * 1024)   /* Max request body accepted by the CGI gateway */
     #define EJS_CGI_HDR_HASH        (31)
+    #define EJS_FCGI_MAX_CONNS      (16)            /* Max concurrent FastCGI connections */
+    #define EJS_FCGI_MAX_REQUESTS   (1000)          /* FastCGI requests served before recycling the process */
+    #define EJS_SESSION_SHARDS      (4)             /* Session store shards, each with its own lock */
+    #define EJS_SESSION_HASH        (31)            /* Session hash buckets per shard */
+    #define EJS_SESSION_SHM_SLOTS   (256)           /* Shared session store slots */
+    #define EJS_SESSION_SHM_SIZE    (1024)          /* Max shared session record size */
+    #define EJS_WEB_STREAM_SIZE     (4 * 1024)      /* Streamed response packet size */
+    #define EJS_WEB_CACHE_SIZE      (256 * 1024)    /* Max total size of cached responses */
+    #define EJS_WEB_CACHE_HASH      (31)            /* Response cache hash buckets */
 
 #elif BLD_TUNE == MPR_TUNE_BALANCED
 
@@ -59,11 +71,13 @@ extern "C" {
     #define EJS_E4X_BUF_MAX         (1024 * 1024)
     #define EJS_MAX_RECURSION       (1000000)
     #define EJS_MAX_REGEX_MATCHES   64
+    #define EJS_REGEX_CACHE_MAX     256
     #define EJS_MAX_DB_MEM          (20*1024*1024)
 
     #define E4X_BUF_SIZE            4096
     #define E4X_BUF_MAX             (128 * 1024)
     #define E4X_MAX_NODE_DEPTH      128
+    #define EJS_MAX_LITERAL_DEPTH   256
 
     #define EJS_WEB_TOK_INCR        4096
     #define EJS_WEB_MAX_HEADER      4096
@@ -73,7 +87,17 @@ extern "C" {
 
     #define EJS_CGI_MIN_BUF         (64 * 1024)     /* CGI output buffering */
     #define EJS_CGI_MAX_BUF         (256 * 1024)
+    #define EJS_CGI_MAX_POST        (4096 * 1024)   /* Max request body accepted by the CGI gateway */
     #define EJS_CGI_HDR_HASH        (51)
+    #define EJS_FCGI_MAX_CONNS      (64)            /* Max concurrent FastCGI connections */
+    #define EJS_FCGI_MAX_REQUESTS   (5000)          /* FastCGI requests served before recycling the process */
+    #define EJS_SESSION_SHARDS      (8)             /* Session store shards, each with its own lock */
+    #define EJS_SESSION_HASH        (61)            /* Session hash buckets per shard */
+    #define EJS_SESSION_SHM_SLOTS   (1024)          /* Shared session store slots */
+    #define EJS_SESSION_SHM_SIZE    (2048)          /* Max shared session record size */
+    #define EJS_WEB_STREAM_SIZE     (8 * 1024)      /* Streamed response packet size */
+    #define EJS_WEB_CACHE_SIZE      (1024 * 1024)   /* Max total size of cached responses */
+    #define EJS_WEB_CACHE_HASH      (61)            /* Response cache hash buckets */
 
 #else
     /*
@@ -86,11 +110,13 @@ extern "C" {
     #define EJS_E4X_BUF_MAX         (1024 * 1024)
     #define EJS_MAX_RECURSION       (1000000)
     #define EJS_MAX_REGEX_MATCHES   128
+    #define EJS_REGEX_CACHE_MAX     1024
     #define EJS_MAX_DB_MEM          (20*1024*1024)
 
     #define E4X_BUF_SIZE            4096
     #define E4X_BUF_MAX             (128 * 1024)
     #define E4X_MAX_NODE_DEPTH      128
+    #define EJS_MAX_LITERAL_DEPTH   256
 
     #define EJS_WEB_TOK_INCR        4096
     #define EJS_WEB_MAX_HEADER      4096
@@ -100,12 +126,33 @@ extern "C" {
 
     #define EJS_CGI_MIN_BUF         (128 * 1024)     /* CGI output buffering */
     #define EJS_CGI_MAX_BUF         (512 * 1024)
+    #define EJS_CGI_MAX_POST        (16384 * 1024)  /* Max request body accepted by the CGI gateway */
     #define EJS_CGI_HDR_HASH        (101)
+    #define EJS_FCGI_MAX_CONNS      (256)           /* Max concurrent FastCGI connections */
+    #define EJS_FCGI_MAX_REQUESTS   (10000)         /* FastCGI requests served before recycling the process */
+    #define EJS_SESSION_SHARDS      (16)            /* Session store shards, each with its own lock */
+    #define EJS_SESSION_HASH        (127)           /* Session hash buckets per shard */
+    #define EJS_SESSION_SHM_SLOTS   (4096)          /* Shared session store slots */
+    #define EJS_SESSION_SHM_SIZE    (4096)          /* Max shared session record size */
+    #define EJS_WEB_STREAM_SIZE     (16 * 1024)     /* Streamed response packet size */
+    #define EJS_WEB_CACHE_SIZE      (8192 * 1024)   /* Max total size of cached responses */
+    #define EJS_WEB_CACHE_HASH      (127)           /* Response cache hash buckets */
 #endif
 
 #define EJS_SESSION_TIMEOUT         1800
 #define EJS_TIMER_PERIOD            1000            /* Timer checks ever 1 second */
 
+/*
+ *  Async file I/O
+ */
+#define EJS_FILE_ASYNC_CHUNK        (8 * 1024)      /* Bytes transferred per async file I/O pass */
+#define EJS_FILE_ASYNC_MAX          (64 * 1024)     /* Max async read-ahead buffering per file */
+
+/*
+ *  Regular expressions
+ */
+#define EJS_REGEX_STUDY_THRESHOLD   8               /* Executions of a pattern before it is studied */
+
 /*
  *  Object Property hash constants
  */
@@ -254,7 +254,12 @@ typedef struct Ejs {
  *  @ingroup Ejs
  */
 typedef struct EjsService {
-    char        *ejsPath;           /* Module load search path */
+    char            *ejsPath;       /* Module load search path */
+    MprHashTable    *regexCache;    /* Compiled regular expressions shared by all interpreters */
+    struct EjsRegExpCode *regexLru; /* Regex cache LRU list head. Most recently used first */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;         /* Multithread sync */
+#endif
 } EjsService;
 
 
@@ -38,6 +38,34 @@
 #define EJS_WEB_RESPONSE_VAR    2           /* Fields of the Response object */
 
 /*********************************** Types ************************************/
+/*
+ *  Session backend. A backend holds session records outside the process so that multiple worker processes can share
+ *  sessions. Records are opaque binary blobs encoded by the session code.
+ *  get - Return the record version or zero if the session does not exist. The record is copied into buf only if its 
+ *      version differs from known. A get counts as session activity.
+ *  put - Store a record and return its new version.
+ *  remove - Remove a record.
+ */
+typedef struct EjsWebSessionBackend {
+    int         (*get)(struct EjsWebSessionBackend *backend, cchar *id, int known, MprBuf *buf);
+    int         (*put)(struct EjsWebSessionBackend *backend, cchar *id, cchar *data, int len, int timeout);
+    int         (*remove)(struct EjsWebSessionBackend *backend, cchar *id);
+} EjsWebSessionBackend;
+
+
+/*
+ *  Cached response. Responses of cacheable actions are captured as they are generated and replayed by the web server
+ *  connector on later requests without running the interpreter.
+ */
+typedef struct EjsWebCached {
+    int             code;                   /* HTTP status code */
+    cchar           *mimeType;              /* Response mime type */
+    MprHashTable    *headers;               /* Custom response headers */
+    MprBuf          *body;                  /* Response content */
+    int             uncacheable;            /* Response set cookies or redirected and must not be cached */
+} EjsWebCached;
+
+
 /*
  *  Service control block. This defines the function callbacks for a web server module to implement.
  *  Aall these functions as required to interact with the web server.
@@ -46,14 +74,19 @@ typedef struct EjsWebControl {
     EjsService  *service;                   /* EJS service */
     Ejs         *master;                    /* Master interpreter */
     EjsVar      *applications;              /* Application cache */
-    EjsObject   *sessions;                  /* Session cache */
+    struct EjsWebSessionStore *sessions;    /* Session store */
+    EjsWebSessionBackend *sessionBackend;   /* Optional shared session backend */
+    struct EjsWebCache *cache;              /* Response cache */
+    MprHashTable *routes;                   /* Compiled route tables by application directory */
     cchar       *modulePath;                /* Path to the ejs web server module and handler */
     int         sessionTimeout;             /* Default session timeout */
+    int         sessionSpeed;               /* Session clock speed up. Used by tests of long session timeouts */
     int         nextSession;                /* Session ID counter */
 
     void        (*defineParams)(void *handle);
     void        (*discardOutput)(void *handle);
     void        (*error)(void *handle, int code, cchar *fmt, ...);
+    int         (*flush)(void *handle);
     cchar       *(*getHeader)(void *handle, cchar *key);
     EjsVar      *(*getVar)(void *handle, int collection, int field);
     void        (*redirect)(void *handle, int code, cchar *url);
@@ -68,6 +101,7 @@ typedef struct EjsWebControl {
     void        (*lock)(void *lockData);
     void        (*unlock)(void *lockData);
     void        *lockData;
+    MprMutex    *buildLock;                 /* Serializes component builds and route table loading */
 #endif
 
 } EjsWebControl;
@@ -81,6 +115,7 @@ typedef struct EjsWebControl {
 #define EJS_WEB_FLAG_SESSION             0x2    /* Auto create sessions for each request */
 #define EJS_WEB_FLAG_APP                 0x4    /* Request for content inside an Ejscript Application*/
 #define EJS_WEB_FLAG_SOLO                0x8    /* Solo ejs file */
+#define EJS_WEB_FLAG_STREAM              0x10   /* Stream output to the client as it is written */
 
 /*
  *  Per request control block
@@ -98,6 +133,7 @@ typedef struct EjsWeb {
     EjsName         controllerName; /* Qualified Controller name (with "Controller" suffix) */
     EjsName         doActionName;   /* Qualified do action function name */
     char            *viewName;      /* Name of the view function */
+    cchar           **routeParams;  /* Route parameter name and value pairs. Null terminated */
 
     EjsVar          *params;        /* Form variables */
     EjsVar          *cookies;       /* Parsed cookies cache */
@@ -112,6 +148,10 @@ typedef struct EjsWeb {
     EjsVar          *controller;    /* Controller instance to run */
     EjsVar          *doAction;      /* doAction() function to run. May be renderView() for Stand-Alone views. */
 
+    cchar           *cacheUri;      /* Response cache key URI. Set by connectors that serve cached responses */
+    EjsWebCached    *capture;       /* Response being captured for the cache */
+    EjsWebCached    *cached;        /* Cached response to replay instead of running the request */
+
 } EjsWeb;
 
 
@@ -135,6 +175,7 @@ typedef struct EjsWebHost
 {
     EjsVar      var;
     void        *handle;
+    EjsVar      *values[ES_ejs_web_Host_NUM_INSTANCE_PROP];     /* Property values materialized on first access */
 } EjsWebHost;
 
 
@@ -145,6 +186,7 @@ typedef struct EjsWebRequest
 {
     EjsVar      var;
     void        *handle;
+    EjsVar      *values[ES_ejs_web_Request_NUM_INSTANCE_PROP];  /* Property values materialized on first access */
 } EjsWebRequest;
 
 
@@ -165,6 +207,10 @@ typedef struct EjsWebSession
     MprTime     expire;                     /* When the session should expire */
     cchar       *id;                        /* Session ID */
     int         timeout;                    /* Session inactivity lifespan */
+    struct EjsWebSession *nextExpire;       /* Next session in the same expiry wheel slot */
+    int         version;                    /* Session backend record version */
+    int         dirty;                      /* Modified since last saved to the session backend */
+    int         users;                      /* Requests using the session. Guarded by ejsLockWeb */
 } EjsWebSession;
 
 
@@ -181,6 +227,7 @@ extern void         ejsConfigureWebResponseType(Ejs *ejs);
 extern void         ejsConfigureWebHostType(Ejs *ejs);
 extern void         ejsConfigureWebControllerType(Ejs *ejs);
 extern void         ejsConfigureWebSessionType(Ejs *ejs);
+extern void         ejsConfigureWebViewType(Ejs *ejs);
 
 //DDD
 extern EjsWeb       *ejsCreateWebRequest(MprCtx ctx, EjsWebControl *control, void *req, cchar *scriptName, cchar *uri,
@@ -196,11 +243,20 @@ extern EjsWebResponse *ejsCreateWebResponseObject(Ejs *ejs, void *handle);
 extern EjsWebSession *ejsCreateWebSessionObject(Ejs *ejs, void *handle);
 
 extern void         ejsDefineWebParam(Ejs *ejs, cchar *key, cchar *value);
+extern void         ejsDefineWebRouteParams(EjsWeb *web);
+extern bool         ejsMatchWebRoute(EjsWeb *web);
 
 //DDD
 extern int          ejsLoadView(Ejs *ejs);
 //DDD
 extern void         ejsParseWebSessionCookie(EjsWeb *web);
+//DDD
+extern void         ejsSaveWebSession(EjsWeb *web);
+extern void         ejsDetachWebSession(EjsWeb *web);
+//DDD
+extern struct EjsWebSessionStore *ejsCreateWebSessionStore(EjsWebControl *control);
+extern char         *ejsGetWebSessionId(MprCtx ctx, cchar *cookie);
+extern struct EjsWebCache *ejsCreateWebCache(MprCtx ctx, int maxSize);
 
 /******************************** Published API *******************************/
 #ifdef  __cplusplus
@@ -209,20 +265,31 @@ extern "C" {
 
 //DDD -- All these
 extern EjsWebSession *ejsCreateSession(Ejs *ejs, int timeout, bool secure);
+extern void         ejsBeginWebCache(Ejs *ejs);
+extern void         ejsExpireWebCache(EjsWebControl *control, cchar *tag);
+extern EjsWebCached *ejsLookupWebCache(MprCtx ctx, EjsWebControl *control, void *handle, cchar *uri);
+extern int          ejsSaveWebCache(Ejs *ejs, int lifespan, cchar *vary, cchar *tags, bool session);
+extern EjsWebSessionBackend *ejsCreateSharedSessionBackend(MprCtx ctx, cchar *path, int slots, int slotSize);
 extern bool         ejsDestroySession(Ejs *ejs);
 extern void         ejsDefineParams(Ejs *ejs);
 extern void         ejsDiscardOutput(Ejs *ejs);
+extern int          ejsFlushWeb(Ejs *ejs);
 extern EjsVar       *ejsCreateCookies(Ejs *ejs);
 extern cchar        *ejsGetHeader(Ejs *ejs, cchar *key);
 extern EjsVar       *ejsGetWebVar(Ejs *ejs, int collection, int field);
+extern void         ejsLockBuild(EjsWebControl *control);
+extern void         ejsLockWeb(EjsWebControl *control);
 extern int          ejsMapToStorage(Ejs *ejs, char *path, int pathsize, cchar *uri);
 extern int          ejsReadFile(Ejs *ejs, char **buf, int *len, cchar *path);
 extern void         ejsRedirect(Ejs *ejs, int code, cchar *url);
 extern void         ejsSetCookie(Ejs *ejs, cchar *name, cchar *value, int lifetime, cchar *path, bool secure);
 extern void         ejsSetWebHeader(Ejs *ejs, bool allowMultiple, cchar *key, cchar *fmt, ...);
 extern void         ejsSetHttpCode(Ejs *ejs, int code);
-extern void         ejsSetMimeType(Ejs *ejs, int code);
+extern void         ejsSetMimeType(Ejs *ejs, cchar *mimeType);
+extern void         ejsSetWebStreaming(Ejs *ejs, bool on);
 extern int          ejsSetWebVar(Ejs *ejs, int collection, int field, EjsVar *value);
+extern void         ejsUnlockBuild(EjsWebControl *control);
+extern void         ejsUnlockWeb(EjsWebControl *control);
 extern void         ejsWebError(Ejs *ejs, int code, cchar *fmt, ...);
 extern int          ejsWriteBlock(Ejs *ejs, cchar *buf, int size);
 extern int          ejsWriteString(Ejs *ejs, cchar *buf);
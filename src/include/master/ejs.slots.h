@@ -154,7 +154,7 @@
 #define ES_parse_input                                                 0
 #define ES_parse_preferredType                                         1
 #define ES_serialize_obj                                               0
-#define ES_serialize_maxDepth                                          1
+#define ES_serialize_options                                           1
 #define ES_serialize_all                                               2
 #define ES_serialize_base                                              3
 #define ES_printHash_name                                              0
@@ -107,6 +107,16 @@
 #if LINUX && !__UCLIBC__
     #include    <sys/sendfile.h>
 #endif
+#if LINUX
+    #include    <sys/syscall.h>
+#endif
+
+#if LINUX && !defined(BLD_FEATURE_EPOLL)
+    #define BLD_FEATURE_EPOLL 1
+#endif
+#if BLD_FEATURE_EPOLL
+    #include    <sys/epoll.h>
+#endif
 
 #if CYGWIN || LINUX
     #include    <stdint.h>
@@ -1009,6 +1019,11 @@ extern "C" {
     #define MPR_SSL_BUFSIZE         2048        /**< SSL has 16K max*/
     #define MPR_FILES_HASH_SIZE     29          /** Hash size for rom file system */
     #define MPR_TIME_HASH_SIZE      67          /** Hash size for time token lookup */
+    #define MPR_EPOLL_EVENTS        16          /**< Events collected per epoll wait */
+    #define MPR_POOL_DEQUE_SIZE     16          /**< Initial pool thread task deque size (power of 2) */
+    #define MPR_ALLOC_CACHE_LIMIT   128         /**< Largest block (with header) kept in thread caches */
+    #define MPR_ALLOC_CACHE_BATCH   8           /**< Blocks moved between a thread cache and the depot */
+    #define MPR_ALLOC_CACHE_FLUSH   16384       /**< Unflushed per-thread change in allocated bytes */
     #define MPR_HTTP_MAX_PASS       64          /**< Size of password */
     #define MPR_HTTP_MAX_USER       64          /**< Size of user name */
     #define MPR_HTTP_MAX_SECRET     32          /**< Random bytes to use */
@@ -1035,6 +1050,11 @@ extern "C" {
     #define MPR_SSL_BUFSIZE         4096
     #define MPR_FILES_HASH_SIZE     61
     #define MPR_TIME_HASH_SIZE      89
+    #define MPR_EPOLL_EVENTS        64
+    #define MPR_POOL_DEQUE_SIZE     32
+    #define MPR_ALLOC_CACHE_LIMIT   256
+    #define MPR_ALLOC_CACHE_BATCH   16
+    #define MPR_ALLOC_CACHE_FLUSH   65536
     
     #define MPR_HTTP_MAX_PASS       128
     #define MPR_HTTP_MAX_USER       64
@@ -1061,6 +1081,11 @@ extern "C" {
     #define MPR_SSL_BUFSIZE         4096
     #define MPR_FILES_HASH_SIZE     61
     #define MPR_TIME_HASH_SIZE      97
+    #define MPR_EPOLL_EVENTS        256
+    #define MPR_POOL_DEQUE_SIZE     64
+    #define MPR_ALLOC_CACHE_LIMIT   512
+    #define MPR_ALLOC_CACHE_BATCH   32
+    #define MPR_ALLOC_CACHE_FLUSH   65536
     
     #define MPR_HTTP_MAX_PASS       128
     #define MPR_HTTP_MAX_USER       64
@@ -1120,6 +1145,7 @@ extern "C" {
 #define MPR_TIMEOUT_STOP_THREAD 10000       /**< Time to stop running threads */
 #define MPR_TIMEOUT_STOP        5000        /**< Wait when stopping resources */
 #define MPR_TIMEOUT_LINGER      2000        /**< Close socket linger timeout */
+#define MPR_TIMEOUT_REACTOR     1000        /**< Max reactor wait before checking for exit */
 
 
 /*
@@ -2673,27 +2699,36 @@ extern void mprUserError(MprCtx ctx, cchar *fmt, ...);
 
 /**
  *  Hash table entry structure.
- *  @description Each hash entry has a descriptor entry. This is used to manage the hash table link chains.
- *  @see MprHash, mprAddHash, mprAddDuplicateHash, mprCopyHash, mprCreateHash, mprGetFirstHash, mprGetNextHash,
- *      mprGethashCount, mprLookupHash, mprLookupHashEntry, mprRemoveHash, mprFree, mprCreateKeyPair
+ *  @description Hash entries are stored inline in an open addressed table. Entries may move when the table is 
+ *      modified, so an entry pointer is only valid until the next add or remove.
+ *  @see MprHash, mprAddHash, mprAddDuplicateHash, mprCopyHash, mprCreateHash, mprCreateCaselessHash, mprGetFirstHash, 
+ *      mprGetNextHash, mprGethashCount, mprLookupHash, mprLookupHashEntry, mprRemoveHash, mprFree, mprCreateKeyPair
  *  @stability Evolving.
  *  @defgroup MprHash MprHash
  */
 typedef struct MprHash {
-    struct MprHash *next;               /**< Next symbol in hash chain */
     char            *key;               /**< Hash key */
     cvoid           *data;              /**< Pointer to symbol data */
-    int             bucket;             /**< Hash bucket index */
+    uint            hash;               /**< Hash of the key. Zero if the slot has never been used */
 } MprHash;
 
 
+/*
+ *  Hash table flags
+ */
+#define MPR_HASH_CASELESS   0x1         /**< Keys are compared without regard to case */
+
 /**
  *  Hash table control structure
  */
 typedef struct MprHashTable {
-    MprHash         **buckets;          /**< Hash collision bucket table */
-    int             hashSize;           /**< Size of the buckets array */
+    MprHash         *entries;           /**< Open addressed entry table */
+    MprHash         *old;               /**< Prior entry table being migrated after the table grew */
+    int             size;               /**< Number of slots in entries. Always a power of two */
+    int             oldSize;            /**< Number of slots in old */
+    int             migrate;            /**< Next slot in old to migrate */
     int             count;              /**< Number of symbols in the table */
+    int             flags;              /**< Table flags */
 } MprHashTable;
 
 
@@ -2735,13 +2770,26 @@ extern MprHashTable *mprCopyHash(MprCtx ctx, MprHashTable *table);
  *  Create a hash table
  *  @description Creates a hash table that can store arbitrary objects associated with string key values.
  *  @param ctx Any memory context allocated by the MPR.
- *  @param hashSize Size of the hash table for the symbol table. Should be a prime number.
+ *  @param hashSize Initial size of the hash table. This is rounded up to a power of two and the table grows 
+ *      as required. Set to -1 for the default size.
  *  @return Returns a pointer to the allocated symbol table. Caller should use mprFree to dispose of the table 
  *      when complete.
  *  @ingroup MprHash
  */
 extern MprHashTable *mprCreateHash(MprCtx ctx, int hashSize);
 
+/**
+ *  Create a caseless hash table
+ *  @description Creates a hash table whose keys are hashed and compared without regard to case. Keys are stored 
+ *      as supplied. This is useful for Http header tables.
+ *  @param ctx Any memory context allocated by the MPR.
+ *  @param hashSize Initial size of the hash table. Set to -1 for the default size.
+ *  @return Returns a pointer to the allocated symbol table. Caller should use mprFree to dispose of the table 
+ *      when complete.
+ *  @ingroup MprHash
+ */
+extern MprHashTable *mprCreateCaselessHash(MprCtx ctx, int hashSize);
+
 /**
  *  Return the first symbol in a symbol entry
  *  @description Prepares for walking the contents of a symbol table by returning the first entry in the symbol table.
@@ -3523,6 +3571,7 @@ extern void mprUnloadModule(MprModule *mp);
 #define MPR_EVENT_CONTINUOUS    0x1     /**< Auto reschedule the event */
 #define MPR_EVENT_THREAD        0x2     /**< Run proc using pool thread */
 #define MPR_EVENT_RUNNING       0x4     /**< Event currently executing */
+#define MPR_EVENT_TIMER         0x8000  /**< Internal: event is queued on the timer wheel */
 
 /**
  *  Event callback function
@@ -3554,14 +3603,24 @@ typedef struct MprEvent {
 } MprEvent;
 
 
+/*
+ *  Timer wheel geometry. Future events are hashed by due time (msec ticks) into a hierarchy of wheels. Level zero
+ *  has one slot per tick, each higher level has slots covering a whole lower wheel. Events cascade down as time
+ *  advances. Five levels of 64 slots span 2^30 msec (12 days); longer timers are parked in the last level.
+ */
+#define MPR_TIMER_WHEEL_BITS    6
+#define MPR_TIMER_WHEEL_SIZE    (1 << MPR_TIMER_WHEEL_BITS)
+#define MPR_TIMER_WHEEL_MASK    (MPR_TIMER_WHEEL_SIZE - 1)
+#define MPR_TIMER_WHEEL_LEVELS  5
+
 /*
  *  Event service
  */
 typedef struct MprEventService {
     MprEvent        eventQ;             /* Event queue */
-    MprEvent        timerQ;             /* Queue of future events */
-    MprEvent        taskQ;              /* Task queue */
-    MprTime         lastEventDue;       /* When the last event is due */
+    MprEvent        timerWheel[MPR_TIMER_WHEEL_LEVELS][MPR_TIMER_WHEEL_SIZE];  /* Future events by due time */
+    MprTime         timerTick;          /* Next timer wheel tick to process */
+    int             timerCount;         /* Number of events on the timer wheel */
     MprTime         lastRan;            /* When last checked queues */
     MprTime         now;                /* Current notion of time */
     int             eventCounter;       /* Incremented for each event (wraps) */
@@ -4228,6 +4287,13 @@ typedef int (*MprDestructor)(MprCtx ctx);
 #define BLD_FEATURE_MEMORY_STATS    1
 #endif
 
+/*
+ *  Per-thread caches of small malloc blocks. Needs thread specific data with an exit destructor.
+ */
+#if BLD_FEATURE_MULTITHREAD && BLD_UNIX_LIKE && !defined(BLD_FEATURE_ALLOC_CACHE)
+#define BLD_FEATURE_ALLOC_CACHE     1
+#endif
+
 /*
  *  MprBlk flags
  */
@@ -4311,8 +4377,8 @@ typedef struct MprHeap {
     /*
      *  Heap stats
      */
-    int            allocBytes;             /* Number of bytes allocated for this heap */
-    int            peakAllocBytes;         /* Peak allocated (max allocBytes) */
+    int64          allocBytes;             /* Number of bytes allocated for this heap */
+    int64          peakAllocBytes;         /* Peak allocated (max allocBytes) */
     int            allocBlocks;            /* Number of alloced blocks for this heap */
     int            peakAllocBlocks;        /* Peak allocated blocks */
     int            totalAllocCalls;        /* Total count of allocation calls */
@@ -4329,6 +4395,24 @@ typedef struct MprHeap {
 } MprHeap;
 
 
+#if BLD_FEATURE_ALLOC_CACHE
+/*
+ *  Small blocks are cached in size classes of 16 bytes
+ */
+#define MPR_ALLOC_CACHE_CLASSES     (MPR_ALLOC_CACHE_LIMIT / 16)
+#define MPR_ALLOC_CACHE_ROUND(size) (((size) + 15) & ~15)
+#define MPR_ALLOC_CACHE_CLASS(size) (((size) >> 4) - 1)
+
+/*
+ *  Per-thread cache of free blocks. Only the owning thread touches it.
+ */
+typedef struct MprAllocCache {
+    MprBlk          *freeList[MPR_ALLOC_CACHE_CLASSES];     /* Free blocks per size class */
+    int             freeCount[MPR_ALLOC_CACHE_CLASSES];     /* Count of blocks on each free list */
+    int64           bytes;                                  /* Change in allocated bytes not yet flushed */
+} MprAllocCache;
+#endif
+
 /*
  *  Memory allocation control
  */
@@ -4336,14 +4420,20 @@ typedef struct MprAlloc {
     MprHeap         pageHeap;               /* Page based heap for Arena allocations */
     uint            pageSize;               /* System page size */
     int             inAllocException;       /* Recursive protect */
-    uint            bytesAllocated;         /* Bytes currently allocated */
-    uint            peakAllocated;          /* Peak bytes allocated */
+    int64           bytesAllocated;         /* Bytes currently allocated. Signed as thread caches may hold unflushed frees */
+    int64           peakAllocated;          /* Peak bytes allocated */
     uint            errors;                 /* Allocation errors */
     uint            peakStack;              /* Peak stack usage */
     uint            numCpu;                 /* Number of CPUs */
     uint            redLine;                /* Warn if allocation exceeds this level */
     uint            maxMemory;              /* Max memory to allocate */
     void            *stackStart;            /* Start of app stack */
+#if BLD_FEATURE_ALLOC_CACHE
+    pthread_key_t   cacheKey;               /* Thread specific key for the thread cache */
+    MprSpin         depotSpin;              /* Guards the depot */
+    MprBlk          *depot[MPR_ALLOC_CACHE_CLASSES];        /* Shared free blocks per size class */
+    int             depotCount[MPR_ALLOC_CACHE_CLASSES];    /* Count of blocks in each depot list */
+#endif
 } MprAlloc;
 
 
@@ -4360,6 +4450,7 @@ typedef struct MprAlloc {
 extern struct Mpr *mprCreateAllocService(MprAllocNotifier cback, MprDestructor destructor);
 extern MprHeap  *mprAllocArena(MprCtx ctx, cchar *name, uint arenaSize, bool threadSafe, MprDestructor destructor);
 extern MprHeap  *mprAllocSlab(MprCtx ctx, cchar *name, uint objSize, uint count, bool threadSafe, MprDestructor destructor);
+extern void     mprResetArena(MprHeap *heap);
 extern void     mprSetAllocNotifier(MprCtx ctx, MprAllocNotifier cback);
 extern void     mprInitBlock(MprCtx ctx, void *ptr, uint size);
 
@@ -4600,7 +4691,7 @@ extern bool     mprStackCheck(MprCtx ctx);
 extern void mprSetAllocLimits(MprCtx ctx, uint redline, uint maxMemory);
 
 extern MprAlloc *mprGetAllocStats(MprCtx ctx);
-extern int      mprGetUsedMemory(MprCtx ctx);
+extern int64    mprGetUsedMemory(MprCtx ctx);
 
 /**
  *  Duplicate a block of memory.
@@ -4672,6 +4763,12 @@ typedef struct MprWaitService {
     int             fdsSize;                /* Size of fds array */
     int             breakPipe[2];           /* Pipe to wakeup select when multithreaded */
 #endif
+#if BLD_FEATURE_EPOLL
+    int             epfd;                   /* Epoll descriptor. Set to -1 if using poll */
+    struct epoll_event *events;             /* Ready events returned by epoll_wait */
+    struct MprWaitHandler **fdHandlers;     /* Handlers by descriptor. Handlers sharing a descriptor are chained */
+    int             fdHandlersSize;         /* Size of fdHandlers */
+#endif
 #if BLD_WIN_LIKE
 #if USE_EVENTS
     WSAEVENT        *events;                /* Array of events to select on */
@@ -4695,6 +4792,15 @@ typedef struct MprWaitService {
 
 extern MprWaitService *mprCreateWaitService(struct Mpr *mpr);
 extern int  mprInitSelectWait(MprWaitService *ws);
+#if BLD_UNIX_LIKE
+extern int  mprWaitForSelectIO(MprWaitService *ws, int timeout);
+#endif
+#if BLD_FEATURE_EPOLL
+extern int  mprInitEpollWait(MprWaitService *ws);
+extern int  mprAddEpollHandler(MprWaitService *ws, struct MprWaitHandler *wp);
+extern void mprRemoveEpollHandler(MprWaitService *ws, struct MprWaitHandler *wp);
+extern void mprSetWaitEvents(MprWaitService *ws, struct MprWaitHandler *wp, int mask);
+#endif
 extern int  mprStartWaitService(MprWaitService *ws);
 extern int  mprStopWaitService(MprWaitService *ws);
 
@@ -4711,6 +4817,35 @@ extern void mprServiceWinIO(MprWaitService *ws, int sockFd, int winMask);
     #define mprAwakenWaitService(ws)
 #endif
 
+/**
+ *  Start reactor event loops
+ *  @description Create additional wait services, each serviced by a dedicated thread pinned to a CPU. Sockets assigned
+ *      to a reactor via #mprSetSocketWaitService have all their I/O events detected by that reactor for their lifetime.
+ *      The primary wait service serviced by #mprServiceEvents is always reactor zero.
+ *  @param ctx Any memory allocation context created by MprAlloc
+ *  @param count Total number of reactors including the primary wait service.
+ *  @return Zero if successful, otherwise a negative MPR error code.
+ *  @ingroup MprWaitHandler
+ */
+extern int mprStartReactors(MprCtx ctx, int count);
+
+/**
+ *  Get a reactor
+ *  @param ctx Any memory allocation context created by MprAlloc
+ *  @param index Reactor index. This is taken modulo the reactor count so callers may pass a rolling counter.
+ *  @return The reactor's wait service. Returns the primary wait service if no reactors have been started.
+ *  @ingroup MprWaitHandler
+ */
+extern MprWaitService *mprGetReactor(MprCtx ctx, int index);
+
+/**
+ *  Get the number of reactors
+ *  @param ctx Any memory allocation context created by MprAlloc
+ *  @return The number of reactors including the primary wait service.
+ *  @ingroup MprWaitHandler
+ */
+extern int mprGetReactorCount(MprCtx ctx);
+
 extern int mprWaitForIO(MprWaitService *ws, int timeout);
 
 
@@ -4741,6 +4876,10 @@ typedef struct MprWaitHandler {
     WSAEVENT        *event;             /**< Wait event handle */
 #endif
 #endif
+#if BLD_FEATURE_EPOLL
+    int             epollMask;          /**< Events this handler has registered with epoll */
+    struct MprWaitHandler *nextFd;      /**< Next handler using the same descriptor */
+#endif
 
 #if BLD_FEATURE_MULTITHREAD
     int             priority;           /**< Thread priority */
@@ -4775,6 +4914,24 @@ typedef struct MprWaitHandler {
 extern MprWaitHandler *mprCreateWaitHandler(MprCtx ctx, int fd, int mask, MprWaitProc proc, void *data,
         int priority, int flags);
 
+/**
+ *  Create a wait handler on a given wait service
+ *  @description Same as #mprCreateWaitHandler but registers the handler with a specific wait service (reactor)
+ *      instead of the primary wait service.
+ *  @param ws Wait service returned from #mprGetReactor
+ *  @param ctx Any memory allocation context created by MprAlloc
+ *  @param fd File descriptor
+ *  @param mask Mask of events of interest. This is made by oring MPR_READABLE and MPR_WRITEABLE
+ *  @param proc Callback function to invoke when an I/O event of interest has occurred.
+ *  @param data Data item to pass to the callback
+ *  @param priority MPR priority to associate with the callback.
+ *  @param flags Flags may be set to MPR_WAIT_THREAD.
+ *  @returns A new wait handler registered with the wait service
+ *  @ingroup MprWaitHandler
+ */
+extern MprWaitHandler *mprCreateServiceWaitHandler(MprWaitService *ws, MprCtx ctx, int fd, int mask, MprWaitProc proc,
+        void *data, int priority, int flags);
+
 /**
  *  Disable wait events
  *  @description Disable wait events for a given file descriptor.
@@ -4924,6 +5081,8 @@ extern bool mprHasSecureSockets(MprCtx ctx);
 #define MPR_SOCKET_NODELAY      0x100       /**< Disable Nagle algorithm */
 #define MPR_SOCKET_THREAD       0x400       /**< Process callbacks on a pool thread */
 #define MPR_SOCKET_CLIENT       0x800       /**< Socket is a client */
+#define MPR_SOCKET_REUSEPORT    0x1000      /**< Set SO_REUSEPORT so listeners may share a port */
+#define MPR_SOCKET_CORK         0x2000      /**< Hold partial frames until more data is written */
 
 
 /**
@@ -4940,7 +5099,7 @@ extern bool mprHasSecureSockets(MprCtx ctx);
  *      mprWriteSocket, mprWriteSocketString, mprReadSocket, mprSetSocketCallback, mprSetSocketEventMask, 
  *      mprGetSocketBlockingMode, mprGetSocketEof, mprGetSocketFd, mprGetSocketPort, mprGetSocketBlockingMode, 
  *      mprSetSocketNoDelay, mprGetSocketError, mprParseIp, mprSendFileToSocket, mprSetSocketEof, mprSocketIsSecure
- *      mprWriteSocketVector
+ *      mprWriteSocketVector mprSetSocketCork
  *  @defgroup MprSocket MprSocket
  */
 typedef struct MprSocket {
@@ -4974,6 +5133,7 @@ typedef struct MprSocket {
 
     struct MprSslSocket *sslSocket;     /**< Extended ssl socket state. If set, then using ssl */
     struct MprSsl   *ssl;               /**< SSL configuration */
+    struct MprWaitService *waitService; /**< Wait service (reactor) detecting I/O for this socket */
 } MprSocket;
 
 
@@ -5122,6 +5282,16 @@ extern void mprSetSocketCallback(MprSocket *sp, MprSocketProc fn, void *data, vo
  */
 extern void mprSetSocketEventMask(MprSocket *sp, int mask);
 
+/**
+ *  Assign a socket to a reactor
+ *  @description Define the wait service used to detect I/O for a socket. This must be called before the socket is
+ *      opened or its callback is defined. Sockets accepted on a listening socket inherit its wait service.
+ *  @param sp Socket object returned from #mprCreateSocket
+ *  @param ws Wait service returned from #mprGetReactor
+ *  @ingroup MprSocket
+ */
+extern void mprSetSocketWaitService(MprSocket *sp, struct MprWaitService *ws);
+
 /**
  *  Get the socket blocking mode.
  *  @description Return the current blocking mode setting.
@@ -5181,6 +5351,19 @@ extern int mprSetSocketBlockingMode(MprSocket *sp, bool on);
  */
 extern int mprSetSocketNoDelay(MprSocket *sp, bool on);
 
+/**
+ *  Set the socket cork mode.
+ *  @description Cork a socket to hold back partially filled frames while more output is expected. Consecutive
+ *      writes are then coalesced into full TCP segments even if the delay mode is set to no delay. Uncork the socket
+ *      before the last write of a burst so the data is pushed. On Linux, this uses MSG_MORE and costs no additional
+ *      system calls.
+ *  @param sp Socket object returned from #mprCreateSocket
+ *  @param on Set to non-zero to cork the socket. Set to zero to uncork.
+ *  @return The old cork mode.
+ *  @ingroup MprSocket
+ */
+extern int mprSetSocketCork(MprSocket *sp, bool on);
+
 /**
  *  Get a socket error code
  *  @description This will map a Windows socket error code into a posix error code.
@@ -5262,9 +5445,12 @@ typedef struct MprPoolStats {
 //  TODO - rename MprThreadPoolService
 /**
  *  Thread Pool Service
- *  @description The MPR provides a thread pool for rapid starting and assignment of threads to tasks.
+ *  @description The MPR provides a thread pool for rapid starting and assignment of threads to tasks. Each pool 
+ *      thread owns a deque of tasks. Threads run their own tasks newest first and steal the oldest tasks from 
+ *      other threads when their own deque runs dry.
  *  @stability Evolving
- *  @see MprPoolService, mprAvailablePoolThreads, mprSetMaxPoolThreads, mprSetMinPoolThreads
+ *  @see MprPoolService, mprAvailablePoolThreads, mprSetMaxPoolThreads, mprSetMinPoolThreads, mprStartPoolTasks,
+ *      mprParallelFor
  *  @defgroup MprPoolService MprPoolService
  */
 typedef struct MprPoolService {
@@ -5273,8 +5459,15 @@ typedef struct MprPoolService {
     int             stackSize;          /* Stack size for worker threads */
     MprList         *tasks;             /* Prioritized list of pending tasks */
 
-    MprList         *busyThreads;       /* List of threads to service tasks */
-    MprList         *idleThreads;       /* List of threads to service tasks */
+    MprSpin         *spin;              /* Guards the worker table, idle stack and thread counts */
+    struct MprPoolThread **workers;     /* Every thread ever created. Never shrinks so thieves can scan it */
+    struct MprPoolThread **idle;        /* Stack of sleeping threads */
+    int             workerCount;        /* Count of entries in workers */
+    int             workerMax;          /* Size of the workers and idle tables */
+    int             idleCount;          /* Count of entries in idle */
+    int             nextWorker;         /* Round robin index for tasks submitted when no thread is idle */
+    MprThreadLocal  *current;           /* Pool thread running on the current O/S thread */
+
     int             maxThreads;         /* Max # threads in pool */
     int             maxUseThreads;      /* Max threads ever used */
     int             minThreads;         /* Max # threads in pool */
@@ -5341,14 +5534,35 @@ extern void mprGetPoolServiceStats(MprPoolService *ps, MprPoolStats *stats);
 #define MPR_POOL_THREAD_IDLE        0x2
 #define MPR_POOL_THREAD_BUSY        0x4
 #define MPR_POOL_THREAD_PRUNED      0x8
+#define MPR_POOL_THREAD_EXITED      0x10
 
 typedef void        (*MprPoolProc)(void *data, struct MprPoolThread *tp);
 
+/**
+ *  Parallel for loop procedure
+ *  @param data Data argument supplied to mprParallelFor
+ *  @param start First index of the range to process
+ *  @param end One past the last index of the range to process
+ *  @ingroup MprPoolService
+ */
+typedef void        (*MprPoolForProc)(void *data, int start, int end);
+
+/**
+ *  Pool task description
+ *  @description Describes one task for mprStartPoolTasks.
+ *  @ingroup MprPoolService
+ */
+typedef struct MprPoolTask {
+    MprPoolProc     proc;               /**< Procedure to run */
+    void            *data;              /**< Argument for proc */
+    int             priority;           /**< Thread priority while running the task */
+} MprPoolTask;
+
 /*
  *  Threads in the thread pool
  */
 typedef struct MprPoolThread {
-    MprPoolProc     proc;               /* Procedure to run */
+    MprPoolProc     proc;               /* Procedure being run */
     void            *data;
     int             priority;
     int             state;
@@ -5356,11 +5570,57 @@ typedef struct MprPoolThread {
 
     struct MprThread *thread;           /* Associated thread */
     MprCond         *idleCond;          /* Used to wait for work */
+
+    MprSpin         *spin;              /* Guards the deque and state */
+    MprPoolTask     *tasks;             /* Ring of queued tasks. Owner uses the tail, thieves the head */
+    int             taskMax;            /* Size of tasks (power of 2) */
+    int             head;               /* Index of the oldest task */
+    int             tail;               /* Index past the newest task */
+    int             inIdle;             /* On the pool idle stack */
 } MprPoolThread;
 
 
+/**
+ *  Start a task on a pool thread
+ *  @description Queue a procedure to run on a pool thread. If called from a pool thread, the task is pushed on 
+ *      that thread's own deque and idle threads are woken to steal it. Otherwise it is handed to an idle thread, 
+ *      a new thread or the deque of a busy thread.
+ *  @param ctx Any memory allocation context created by MprAlloc
+ *  @param proc Procedure to run
+ *  @param data Argument for proc
+ *  @param priority Thread priority while running the task
+ *  @return Zero if the task was queued. Otherwise MPR_ERR_BUSY if the pool has no threads.
+ *  @ingroup MprPoolService
+ */
 extern int mprStartPoolThread(MprCtx ctx, MprPoolProc proc, void *data, int priority);
 
+/**
+ *  Start a batch of pool tasks
+ *  @description Queue a set of tasks in one call. See mprStartPoolThread for how tasks are placed.
+ *  @param ctx Any memory allocation context created by MprAlloc
+ *  @param tasks Array of task descriptions
+ *  @param count Count of elements in tasks
+ *  @return The count of tasks queued. Tasks after the first that could not be queued are not started.
+ *  @ingroup MprPoolService
+ */
+extern int mprStartPoolTasks(MprCtx ctx, MprPoolTask *tasks, int count);
+
+/**
+ *  Run a loop in parallel over the thread pool
+ *  @description Split the range [start, end) into chunks of at most grain indices and invoke proc on each 
+ *      chunk. Chunks are handed to idle pool threads and the caller runs any chunk not yet claimed. The call returns
+ *      when every chunk has completed. If no pool threads are free, the whole range runs on the calling thread.
+ *  @param ctx Any memory allocation context created by MprAlloc
+ *  @param start First index
+ *  @param end One past the last index
+ *  @param grain Maximum chunk size. If <= 0, the range is split evenly over the pool threads.
+ *  @param proc Procedure to invoke for each chunk
+ *  @param data Argument for proc
+ *  @return Zero if successful. Otherwise MPR_ERR_NO_MEMORY.
+ *  @ingroup MprPoolService
+ */
+extern int mprParallelFor(MprCtx ctx, int start, int end, int grain, MprPoolForProc proc, void *data);
+
 #endif /* BLD_FEATURE_MULTITHREAD */
 
 
@@ -6284,6 +6544,10 @@ typedef struct Mpr {
     char            *args;              /**< Command line args */
 #endif
 
+#if BLD_FEATURE_MULTITHREAD
+    struct MprWaitService   **reactors;     /**< Additional event loops. Reactor zero is waitService */
+    int             reactorCount;       /**< Count of reactors including waitService */
+#endif
 } Mpr;
 
 
@@ -219,6 +219,12 @@ void mprStop(Mpr *mpr)
     mprStopSocketService(mpr->socketService);
     mprStopWaitService(mpr->waitService);
 #if BLD_FEATURE_MULTITHREAD
+{
+    int     i;
+    for (i = 1; i < mpr->reactorCount; i++) {
+        mprAwakenWaitService(mpr->reactors[i]);
+    }
+}
     mprStopPoolService(mpr->poolService, MPR_TIMEOUT_STOP_TASK);
 #endif
     mprStopEventService(mpr->eventService);
@@ -697,9 +703,18 @@ static inline void freeMemory(MprBlk *bp);
 static inline MprHeap *getHeap(MprBlk *bp);
 static inline void initHeap(MprHeap *heap, cchar *name, bool threadSafe);
 static inline void linkBlock(MprHeap *heap, MprBlk *parent, MprBlk *bp);
+static void releaseArenaChildren(MprBlk *bp);
 static void sysinit(Mpr *mpr);
+static inline void trackAllocation(int64 size);
 static void inline unlinkBlock(MprHeap *heap, MprBlk *bp);
 
+#if BLD_FEATURE_ALLOC_CACHE
+static inline MprBlk *allocCached(uint size);
+static inline void freeCached(MprBlk *bp, uint size);
+static inline MprAllocCache *getCache();
+static void releaseCache(MprAllocCache *cache);
+#endif
+
 #if USE_REGIONS
 static MprRegion *createRegion(MprHeap *heap, uint size);
 #endif
@@ -763,6 +778,16 @@ Mpr *mprCreateAllocService(MprAllocNotifier cback, MprDestructor destructor)
     mpr->pageHeap.flags = MPR_ALLOC_PAGE_HEAP;
     initHeap(&mpr->heap, "mpr", 1);
 
+#if BLD_FEATURE_ALLOC_CACHE
+    mprCreateStaticSpinLock(mpr, &alloc.depotSpin);
+    if (pthread_key_create(&alloc.cacheKey, (void (*)(void*)) releaseCache) != 0) {
+        if (cback) {
+            (*cback)(0, sizeof(MprAllocCache), 0, 0);
+        }
+        return 0;
+    }
+#endif
+
 #if BLD_FEATURE_MEMORY_DEBUG
     stopAlloc = 0;
 #endif
@@ -898,6 +923,83 @@ MprHeap *mprAllocSlab(MprCtx ctx, cchar *name, uint objSize, uint count, bool th
 }
 
 
+/*
+ *  Release everything allocated from an arena and rewind it for reuse. Destructors run and nested heaps are freed, 
+ *  but arena blocks are not individually unlinked or accounted. Regions added as the arena grew are returned and 
+ *  the initial region is rewound. This is much cheaper than freeing and recreating the arena.
+ */
+void mprResetArena(MprHeap *heap)
+{
+    MprRegion   *initial, *region, *next;
+    int         pass;
+
+    mprAssert(heap);
+    mprAssert(heap->flags & MPR_ALLOC_ARENA_HEAP);
+
+    releaseArenaChildren(GET_BLK(heap));
+
+    lock(heap);
+    trackAllocation(-heap->allocBytes);
+    heap->allocBytes = 0;
+    heap->allocBlocks = 0;
+
+#if USE_REGIONS
+    initial = (MprRegion*) ((char*) heap + sizeof(MprHeap));
+    for (pass = 0; pass < 2; pass++) {
+        for (region = (pass == 0) ? heap->region : heap->depleted; region; region = next) {
+            next = (pass == 0) ? 0 : region->next;
+            if (region != initial) {
+                mprMapFree(region, region->vmSize);
+            }
+        }
+    }
+    initial->next = 0;
+    initial->nextMem = initial->memory;
+    initial->remaining = initial->size;
+    heap->region = initial;
+    heap->depleted = 0;
+#endif
+    unlock(heap);
+}
+
+
+/*
+ *  Release the children of an arena block. Only destructors and blocks from other heaps need individual attention.
+ */
+static void releaseArenaChildren(MprBlk *bp)
+{
+    MprBlk      *child, *sibling;
+
+    while ((child = bp->children) != 0) {
+        mprAssert(VALID_BLK(child));
+        if (IS_HEAP(child) || GET_FLAG(child, MPR_ALLOC_FROM_MALLOC)) {
+            mprFree(GET_PTR(child));
+            continue;
+        }
+        if (unlikely(HAS_DESTRUCTOR(child))) {
+            (GET_DESTRUCTOR(child))(GET_PTR(child));
+        }
+        releaseArenaChildren(child);
+
+        /*
+         *  A destructor may have allocated new siblings, so the child may no longer be first
+         */
+        if (likely(bp->children == child)) {
+            bp->children = child->next;
+        } else {
+            for (sibling = bp->children; sibling && sibling->next != child; sibling = sibling->next) {
+                ;
+            }
+            if (sibling) {
+                sibling->next = child->next;
+            }
+        }
+        child->parent = 0;
+        child->next = 0;
+    }
+}
+
+
 /*
  *  Allocate a block. Not used to allocate heaps.
  */
@@ -920,6 +1022,14 @@ void *mprAlloc(MprCtx ctx, uint usize)
     lock(heap);
 
     size = MPR_ALLOC_ALIGN(MPR_ALLOC_HDR_SIZE + usize);
+#if BLD_FEATURE_ALLOC_CACHE
+    /*
+     *  Round small malloc blocks up to their cache size class
+     */
+    if (size <= MPR_ALLOC_CACHE_LIMIT && !(heap->flags & (MPR_ALLOC_ARENA_HEAP | MPR_ALLOC_SLAB_HEAP))) {
+        size = MPR_ALLOC_CACHE_ROUND(size);
+    }
+#endif
     usize = size - MPR_ALLOC_HDR_SIZE;
 
     if (unlikely(approveAllocation(heap, parent, size) < 0)) {
@@ -1340,22 +1450,26 @@ void *mprMemdup(MprCtx ctx, const void *ptr, uint usize)
  */
 static int approveAllocation(MprHeap *heap, MprBlk *parent, uint size)
 {
+    int64   used;
     int     diff;
 
     /*
-     *  Don't worry about races on bytesAllocated here. Not critical
+     *  Don't worry about races on bytesAllocated here. Not critical. With thread caches, the total may briefly read
+     *  low (even below zero) as other threads hold unflushed counts. Compare in 64 bits so limits above INT_MAX and 
+     *  large requests don't wrap.
      */
-    if ((size + alloc.bytesAllocated) > alloc.maxMemory) {
+    used = alloc.bytesAllocated;
+    if ((used + size) > (int64) alloc.maxMemory) {
         /*
          *  Prevent allocation if over the maximum
          */
         if (allocException(parent, size, 0) < 0) {
             mprAssert(0);
-            mprSetAllocError(parent);
+            mprSetAllocError(GET_PTR(parent));
             return -1;
         }
 
-    } else if ((size + alloc.bytesAllocated) > alloc.redLine) {
+    } else if ((used + size) > (int64) alloc.redLine) {
         /*
          *  Warn if allocation puts us over the red line
          */
@@ -1365,15 +1479,7 @@ static int approveAllocation(MprHeap *heap, MprBlk *parent, uint size)
         }
     }
 
-    /*
-     *  Update the global memory usage stats. Very short duration lock.
-     */
-    mprSpinLock(&_globalMpr->heap.spin);
-    alloc.bytesAllocated += size;
-    if (alloc.bytesAllocated > alloc.peakAllocated) {
-        alloc.peakAllocated = alloc.bytesAllocated;
-    }
-    mprSpinUnlock(&_globalMpr->heap.spin);
+    trackAllocation(size);
 
     /*
      *  Monitor stack usage. Don't worry about races here. Not critically important.
@@ -1466,7 +1572,13 @@ static inline MprBlk *allocBlock(MprHeap *heap, uint usize)
 
     } else {
 #endif
-        if ((bp = (MprBlk*) allocMemory(size)) == 0) {
+#if BLD_FEATURE_ALLOC_CACHE
+        if (size <= MPR_ALLOC_CACHE_LIMIT) {
+            bp = allocCached(size);
+        } else
+#endif
+        bp = (MprBlk*) allocMemory(size);
+        if (bp == 0) {
             return 0;
         }
         //  TODO - can now set size inline here
@@ -1536,10 +1648,7 @@ static inline void freeBlock(MprHeap *heap, MprBlk *parent, MprBlk *bp)
     }
 
     size = GET_SIZE(bp);
-    mprSpinLock(&_globalMpr->heap.spin);
-    alloc.bytesAllocated -= size;
-    mprAssert(alloc.bytesAllocated >= 0);
-    mprSpinUnlock(&_globalMpr->heap.spin);
+    trackAllocation(-size);
 
 #if USE_REGIONS
     if (!(bp->flags & MPR_ALLOC_FROM_MALLOC)) {
@@ -1566,10 +1675,182 @@ static inline void freeBlock(MprHeap *heap, MprBlk *parent, MprBlk *bp)
     }
 #endif
 
+#if BLD_FEATURE_ALLOC_CACHE
+    if (size <= MPR_ALLOC_CACHE_LIMIT && bp != GET_BLK(_globalMpr)) {
+        freeCached(bp, size);
+        return;
+    }
+#endif
     freeMemory(bp);
 }
 
 
+/*
+ *  Update the global memory usage stats. Very short duration lock. With thread caches, each thread accumulates its 
+ *  change and only takes the lock once it exceeds MPR_ALLOC_CACHE_FLUSH bytes either way.
+ */
+static inline void trackAllocation(int64 size)
+{
+#if BLD_FEATURE_ALLOC_CACHE
+    MprAllocCache   *cache;
+
+    if (likely((cache = getCache()) != 0)) {
+        cache->bytes += size;
+        if (-MPR_ALLOC_CACHE_FLUSH < cache->bytes && cache->bytes < MPR_ALLOC_CACHE_FLUSH) {
+            return;
+        }
+        size = cache->bytes;
+        cache->bytes = 0;
+    }
+#endif
+    mprSpinLock(&_globalMpr->heap.spin);
+    alloc.bytesAllocated += size;
+    if (alloc.bytesAllocated > alloc.peakAllocated) {
+        alloc.peakAllocated = alloc.bytesAllocated;
+    }
+    mprSpinUnlock(&_globalMpr->heap.spin);
+}
+
+
+#if BLD_FEATURE_ALLOC_CACHE
+/*
+ *  Thread caches hold free malloc blocks in size classes of 16 bytes. A thread allocates from and frees to its own 
+ *  cache without locking. Blocks move between the cache and the shared depot in batches of MPR_ALLOC_CACHE_BATCH, 
+ *  so the depot lock is taken at most once per batch. A block freed by another thread simply joins that thread's 
+ *  cache. Blocks in class N are at least (N + 1) * 16 bytes.
+ */
+static inline MprAllocCache *getCache()
+{
+    MprAllocCache   *cache;
+
+    if (unlikely((cache = (MprAllocCache*) pthread_getspecific(alloc.cacheKey)) == 0)) {
+        if ((cache = (MprAllocCache*) calloc(1, sizeof(MprAllocCache))) == 0) {
+            return 0;
+        }
+        pthread_setspecific(alloc.cacheKey, cache);
+    }
+    return cache;
+}
+
+
+static inline MprBlk *allocCached(uint size)
+{
+    MprAllocCache   *cache;
+    MprBlk          *bp, *last;
+    int             cls, count;
+
+    size = MPR_ALLOC_CACHE_ROUND(size);
+    cls = MPR_ALLOC_CACHE_CLASS(size);
+
+    if (unlikely((cache = getCache()) == 0)) {
+        return (MprBlk*) allocMemory(size);
+    }
+    if (unlikely(cache->freeList[cls] == 0)) {
+        /*
+         *  Refill a batch from the depot
+         */
+        mprSpinLock(&alloc.depotSpin);
+        if ((bp = alloc.depot[cls]) != 0) {
+            for (count = 1, last = bp; count < MPR_ALLOC_CACHE_BATCH && last->next; count++) {
+                last = last->next;
+            }
+            alloc.depot[cls] = last->next;
+            alloc.depotCount[cls] -= count;
+            last->next = 0;
+            cache->freeList[cls] = bp;
+            cache->freeCount[cls] = count;
+        }
+        mprSpinUnlock(&alloc.depotSpin);
+        if (bp == 0) {
+            return (MprBlk*) allocMemory(size);
+        }
+    }
+    bp = cache->freeList[cls];
+    cache->freeList[cls] = bp->next;
+    cache->freeCount[cls]--;
+    return bp;
+}
+
+
+static inline void freeCached(MprBlk *bp, uint size)
+{
+    MprAllocCache   *cache;
+    MprBlk          *first, *last, *next;
+    int             cls, count;
+
+    if (unlikely((cache = getCache()) == 0)) {
+        freeMemory(bp);
+        return;
+    }
+#if BLD_FEATURE_MEMORY_DEBUG
+    memset(bp, 0xF1, size);
+#endif
+    cls = MPR_ALLOC_CACHE_CLASS(size);
+    bp->next = cache->freeList[cls];
+    cache->freeList[cls] = bp;
+
+    if (unlikely(++cache->freeCount[cls] > (2 * MPR_ALLOC_CACHE_BATCH))) {
+        /*
+         *  Return a batch to the depot. If the depot is full, give the blocks back to malloc.
+         */
+        first = cache->freeList[cls];
+        for (count = 1, last = first; count < MPR_ALLOC_CACHE_BATCH; count++) {
+            last = last->next;
+        }
+        cache->freeList[cls] = last->next;
+        cache->freeCount[cls] -= count;
+
+        mprSpinLock(&alloc.depotSpin);
+        if (alloc.depotCount[cls] < (MPR_ALLOC_CACHE_BATCH * 64)) {
+            last->next = alloc.depot[cls];
+            alloc.depot[cls] = first;
+            alloc.depotCount[cls] += count;
+            first = 0;
+        }
+        mprSpinUnlock(&alloc.depotSpin);
+
+        if (first) {
+            last->next = 0;
+            for (; first; first = next) {
+                next = first->next;
+                free(first);
+            }
+        }
+    }
+}
+
+
+/*
+ *  Thread exit. Give the cached blocks to the depot and flush the byte count.
+ */
+static void releaseCache(MprAllocCache *cache)
+{
+    MprBlk      *last;
+    int         cls;
+
+    mprSpinLock(&alloc.depotSpin);
+    for (cls = 0; cls < MPR_ALLOC_CACHE_CLASSES; cls++) {
+        if ((last = cache->freeList[cls]) != 0) {
+            while (last->next) {
+                last = last->next;
+            }
+            last->next = alloc.depot[cls];
+            alloc.depot[cls] = cache->freeList[cls];
+            alloc.depotCount[cls] += cache->freeCount[cls];
+        }
+    }
+    mprSpinUnlock(&alloc.depotSpin);
+
+    if (cache->bytes && _globalMpr) {
+        mprSpinLock(&_globalMpr->heap.spin);
+        alloc.bytesAllocated += cache->bytes;
+        mprSpinUnlock(&_globalMpr->heap.spin);
+    }
+    free(cache);
+}
+#endif /* BLD_FEATURE_ALLOC_CACHE */
+
+
 #if USE_REGIONS
 /*
  *  Create a new region to satify the request if no memory exists in any depleted regions. 
@@ -1817,9 +2098,9 @@ MprAlloc *mprGetAllocStats(MprCtx ctx)
 
 
 
-int mprGetUsedMemory(MprCtx ctx)
+int64 mprGetUsedMemory(MprCtx ctx)
 {
-    return alloc.bytesAllocated;
+    return max(alloc.bytesAllocated, 0);
 }
 
 
@@ -1907,7 +2188,7 @@ static int allocException(MprBlk *parent, uint size, bool granted)
         for (heap = getHeap(parent); heap; heap = getHeap(parent)) {
             if (heap->notifier) {
                 //  TODO - notifier returns int - what is this?
-                (heap->notifier)(parent, size, alloc.bytesAllocated, granted);
+                (heap->notifier)(GET_PTR(parent), size, (uint) max(alloc.bytesAllocated, 0), granted);
             }
             parent = parent->parent;
             if (parent == 0) {
@@ -2224,8 +2505,8 @@ static void printMprHeaps(MprCtx ctx)
             total += heap->region->size;
         }
 
-        mprLog(ctx, 0, "    Allocated memory         %,10d K",          heap->allocBytes / 1024);
-        mprLog(ctx, 0, "    Peak heap memory         %,10d K",          heap->peakAllocBytes / 1024);
+        mprLog(ctx, 0, "    Allocated memory         %,10d K",          (int) (heap->allocBytes / 1024));
+        mprLog(ctx, 0, "    Peak heap memory         %,10d K",          (int) (heap->peakAllocBytes / 1024));
         mprLog(ctx, 0, "    Allocated blocks         %,10d",            heap->allocBlocks);
         mprLog(ctx, 0, "    Peak heap blocks         %,10d",            heap->peakAllocBlocks);
         mprLog(ctx, 0, "    Alloc calls              %,10d",            heap->totalAllocCalls);
@@ -2269,8 +2550,8 @@ void mprPrintAllocReport(MprCtx ctx, cchar *msg)
      */
     mprLog(ctx, 0, "\n\n\nMPR Memory Report %s", msg);
     mprLog(ctx, 0, "------------------------------------------------------------------------------------------\n");
-    mprLog(ctx, 0, "  Current heap memory  %,14d K",              ap->bytesAllocated / 1024);
-    mprLog(ctx, 0, "  Peak heap memory     %,14d K",              ap->peakAllocated / 1024);
+    mprLog(ctx, 0, "  Current heap memory  %,14d K",              (int) (ap->bytesAllocated / 1024));
+    mprLog(ctx, 0, "  Peak heap memory     %,14d K",              (int) (ap->peakAllocated / 1024));
     mprLog(ctx, 0, "  Peak stack size      %,14d K",              ap->peakStack / 1024);
     mprLog(ctx, 0, "  Allocation errors    %,14d",                ap->errors);
     
@@ -2278,9 +2559,9 @@ void mprPrintAllocReport(MprCtx ctx, cchar *msg)
      *  Limits
      */
     mprLog(ctx, 0, "  Memory limit         %,14d MB (%d %%)",    ap->maxMemory / (1024 * 1024), 
-           percent(ap->bytesAllocated, ap->maxMemory));
+           (int) percent(ap->bytesAllocated, ap->maxMemory));
     mprLog(ctx, 0, "  Memory redline       %,14d MB (%d %%)",    ap->redLine / (1024 * 1024), 
-           percent(ap->bytesAllocated, ap->redLine));
+           (int) percent(ap->bytesAllocated, ap->redLine));
 
     /*
      *  Heaps
@@ -3766,6 +4047,7 @@ static void runCmdCallback(MprCmd *cmd, int fd, int channel, void *data)
 
     } else {
         mprAdjustBufEnd(buf, len);
+        mprEnableCmdEvents(cmd, channel);
     }
 }
 
@@ -6032,8 +6314,11 @@ MprDiskFileService *mprCreateDiskFileService(MprCtx ctx)
 
 
 
+static void addTimer(MprEventService *es, MprEvent *event);
+static void advanceTimers(MprEventService *es, MprTime now);
 static void appendEvent(MprEvent *eventQ, MprEvent *event);
 static int  eventDestructor(MprEvent *event);
+static MprTime getNextTimerTick(MprEventService *es);
 static void queueEvent(MprEventService *es, MprEvent *event);
 static void removeEvent(MprEvent *event);
 
@@ -6043,6 +6328,8 @@ static void removeEvent(MprEvent *event);
 MprEventService *mprCreateEventService(MprCtx ctx)
 {
     MprEventService     *es;
+    MprEvent            *q;
+    int                 level, slot;
 
     es = mprAllocObjWithDestructorZeroed(ctx, MprEventService, eventDestructor);
     if (es == 0) {
@@ -6060,10 +6347,15 @@ MprEventService *mprCreateEventService(MprCtx ctx)
     es->eventQ.next = &es->eventQ;
     es->eventQ.prev = &es->eventQ;
 
-    es->timerQ.next = &es->timerQ;
-    es->timerQ.prev = &es->timerQ;
+    for (level = 0; level < MPR_TIMER_WHEEL_LEVELS; level++) {
+        for (slot = 0; slot < MPR_TIMER_WHEEL_SIZE; slot++) {
+            q = &es->timerWheel[level][slot];
+            q->next = q->prev = q;
+        }
+    }
 
     es->now = mprGetTime(ctx);
+    es->timerTick = es->now;
 
     return es;
 }
@@ -6105,7 +6397,7 @@ MprEvent *mprCreateEvent(MprCtx ctx, MprEventProc proc, int period, int priority
     event->period = period;
     event->priority = priority;
     event->data = data;
-    event->flags = flags;
+    event->flags = flags & ~MPR_EVENT_TIMER;
     event->timestamp = es->now;
     event->due = event->timestamp + period;
     event->service = es;
@@ -6146,12 +6438,8 @@ void mprRemoveEvent(MprEvent *event)
     es = mpr->eventService;
 
     mprSpinLock(es->spin);
-    removeEvent(event);
-
-    if (es->timerQ.next != &es->timerQ) {
-        es->lastEventDue = es->timerQ.prev->due;
-    } else {
-        es->lastEventDue = es->now;
+    if (event->next) {
+        removeEvent(event);
     }
     mprSpinUnlock(es->spin);
 }
@@ -6177,28 +6465,14 @@ static void queueEvent(MprEventService *es, MprEvent *event)
 {
     MprEvent    *np, *q;
 
-    /*  TODO OPT Spinlock */
     mprSpinLock(es->spin);
 
     if (event->due > es->now) {
         /*
-         *  Due in the future some time
+         *  Due in the future some time. O(1) insert on the timer wheel.
          */
-        q = &es->timerQ;
-
-        if (event->due > es->lastEventDue) {
-            np = q->prev;
+        addTimer(es, event);
 
-        } else {
-            for (np = q->prev; np != q; np = np->prev) {
-                if (event->due <= np->due) {
-                    break;
-                }
-                if (event->priority >= np->priority) {
-                    break;
-                }
-            }
-        }
     } else {
         q = &es->eventQ;
         for (np = q->prev; np != q; np = np->prev) {
@@ -6206,15 +6480,13 @@ static void queueEvent(MprEventService *es, MprEvent *event)
                 break;
             }
         }
+        /*
+         *  Will assert if already in the queue
+         */
+        mprAssert(np != event);
+        appendEvent(np, event);
         es->eventCounter++;
     }
-
-    /*
-     *  Will assert if already in the queue
-     */
-    mprAssert(np != event);
-
-    appendEvent(np, event);
     mprSpinUnlock(es->spin);
 
     mprAwakenWaitService(mprGetMpr(es)->waitService);
@@ -6227,36 +6499,22 @@ static void queueEvent(MprEventService *es, MprEvent *event)
  */
 MprEvent *mprGetNextEvent(MprEventService *es)
 {
-    MprEvent    *event, *next;
+    MprEvent    *event;
 
     mprSpinLock(es->spin);
 
+    if (es->eventQ.next == &es->eventQ) {
+        /*
+         *  Move due timer events to the event queue. Allows priorities to work.
+         */
+        advanceTimers(es, es->now);
+    }
     event = es->eventQ.next;
     if (event != &es->eventQ) {
         removeEvent(event);
 
     } else {
-        /*
-         *  Move due timer events to the event queue. Allows priorities to work.
-         */
-        for (event = es->timerQ.next; event != &es->timerQ; event = next) {
-            if (event->due > es->now) {
-                break;
-            }
-            /*  TODO OPT -- OPTIMIZE event loop here */
-            next = event->next;
-            removeEvent(event);
-            appendEvent(&es->eventQ, event);
-            es->eventCounter++;
-        }
-            
-        event = es->eventQ.next;
-        if (event != &es->eventQ) {
-            removeEvent(event);
-
-        } else {
-            event = 0;
-        }
+        event = 0;
     }
     mprSpinUnlock(es->spin);
 
@@ -6299,17 +6557,17 @@ int mprServiceEvents(MprCtx ctx, int maxDelay, int flags)
         } else {
             delay = mprGetIdleTime(es);
             if (maxDelay >= 0) {
-                delay = min(maxDelay, delay);
+                delay = (int) min(maxDelay - (es->now - start), delay);
             }
             mprWaitForIO(ws, delay);
             es->now = mprGetTime(es);
         }
 
-        if (maxDelay >= 0) {
-            maxDelay -= (int) (es->now - start);
-            if (maxDelay <= 0) {
-                break;
-            }
+        /*
+         *  Measure from the start each time. Deducting the elapsed time on every pass would end early.
+         */
+        if (maxDelay >= 0 && (es->now - start) >= maxDelay) {
+            break;
         }
         
     } while (!mprIsExiting(mpr) && !(flags & MPR_SERVICE_ONE_THING));
@@ -6354,7 +6612,8 @@ void mprDoEvent(MprEvent *event, void *poolThread)
  */
 int mprGetIdleTime(MprEventService *es)
 {
-    int     delay;
+    MprTime     next;
+    int         delay;
     
     es->now = mprGetTime(es);
 
@@ -6363,10 +6622,17 @@ int mprGetIdleTime(MprEventService *es)
     if (es->eventQ.next != &es->eventQ) {
         delay = 0;
 
-    } else if (es->timerQ.next != &es->timerQ) {
-        delay = (int) (es->timerQ.next->due - es->now);
-        if (delay < 0) {
+    } else if (es->timerCount > 0) {
+        /*
+         *  This may be a cascade point rather than the exact due time of a distant timer
+         */
+        next = getNextTimerTick(es);
+        if (next <= es->now) {
             delay = 0;
+        } else if ((next - es->now) >= INT_MAX) {
+            delay = INT_MAX;
+        } else {
+            delay = (int) (next - es->now);
         }
         
     } else {
@@ -6430,6 +6696,10 @@ static void appendEvent(MprEvent *eventQ, MprEvent *event)
  */
 static void removeEvent(MprEvent *event)
 {
+    if (event->flags & MPR_EVENT_TIMER) {
+        event->flags &= ~MPR_EVENT_TIMER;
+        event->service->timerCount--;
+    }
     event->next->prev = event->prev;
     event->prev->next = event->next;
     event->next = 0;
@@ -6438,67 +6708,223 @@ static void removeEvent(MprEvent *event)
 
 
 /*
- *  @copy   default
- *  
- *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
- *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
- *  
- *  This software is distributed under commercial and open source licenses.
- *  You may use the GPL open source license described below or you may acquire 
- *  a commercial license from Embedthis Software. You agree to be fully bound 
- *  by the terms of either license. Consult the LICENSE.TXT distributed with 
- *  this software for full details.
- *  
- *  This software is open source; you can redistribute it and/or modify it 
- *  under the terms of the GNU General Public License as published by the 
- *  Free Software Foundation; either version 2 of the License, or (at your 
- *  option) any later version. See the GNU General Public License for more 
- *  details at: http://www.embedthis.com/downloads/gplLicense.html
- *  
- *  This program is distributed WITHOUT ANY WARRANTY; without even the 
- *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
- *  
- *  This GPL license does NOT permit incorporating this software into 
- *  proprietary programs. If you are unable to comply with the GPL, you must
- *  acquire a commercial license to use this software. Commercial licenses 
- *  for this software and support services are available from Embedthis 
- *  Software at http://www.embedthis.com 
- *  
- *  @end
- */
-/************************************************************************/
-/*
- *  End of file "../mprEvent.c"
+ *  Hash a future event onto the timer wheel by its due tick. Must be locked when called.
  */
-/************************************************************************/
+static void addTimer(MprEventService *es, MprEvent *event)
+{
+    MprTime     due, ticks;
+    int         level, shift;
 
+    due = event->due;
+    ticks = due - es->timerTick;
+
+    if (ticks < 0) {
+        /*
+         *  Already due but the wheel has moved on. Fire on the next tick processed.
+         */
+        due = es->timerTick;
+        ticks = 0;
+
+    } else if (ticks >= ((MprTime) 1 << (MPR_TIMER_WHEEL_BITS * MPR_TIMER_WHEEL_LEVELS))) {
+        /*
+         *  Beyond the wheel horizon. Park in the last level and re-hash when cascaded.
+         */
+        ticks = ((MprTime) 1 << (MPR_TIMER_WHEEL_BITS * MPR_TIMER_WHEEL_LEVELS)) - 1;
+        due = es->timerTick + ticks;
+    }
+    for (level = 0; level < MPR_TIMER_WHEEL_LEVELS - 1; level++) {
+        if (ticks < ((MprTime) 1 << (MPR_TIMER_WHEEL_BITS * (level + 1)))) {
+            break;
+        }
+    }
+    shift = MPR_TIMER_WHEEL_BITS * level;
+    appendEvent(&es->timerWheel[level][(int) (due >> shift) & MPR_TIMER_WHEEL_MASK], event);
+    event->flags |= MPR_EVENT_TIMER;
+    es->timerCount++;
+}
 
 
-/************************************************************************/
 /*
- *  Start of file "../mprFile.c"
+ *  Re-hash all events in a higher level slot onto lower levels. Returns the slot index.
  */
-/************************************************************************/
+static int cascadeTimers(MprEventService *es, int level)
+{
+    MprEvent    *q, *event, *next;
+    int         index;
 
-/**
- *  mprFile.c - File services.
- *
- *  This modules provides a simple cross platform file I/O abstraction. It uses a file system switch and 
- *  underneath a file system provider that implements actual I/O.
- *
- *  Copyright (c) All Rights Reserved. See details at the end of the file.
- */
+    index = (int) (es->timerTick >> (MPR_TIMER_WHEEL_BITS * level)) & MPR_TIMER_WHEEL_MASK;
+    q = &es->timerWheel[level][index];
 
+    for (event = q->next; event != q; event = next) {
+        next = event->next;
+        removeEvent(event);
+        addTimer(es, event);
+    }
+    return index;
+}
 
 
+/*
+ *  Return the next tick at which the wheel has work: either a level zero slot holding due events or a higher level
+ *  slot that must be cascaded. A cascade point may come before the next level zero slot and must not be skipped.
+ *  Must be locked when called.
+ */
+static MprTime getNextTimerTick(MprEventService *es)
+{
+    MprEvent    *q;
+    MprTime     base, tick, best;
+    int         level, shift, i;
 
-static int  fillBuf(MprFile *file);
+    best = es->timerTick + ((MprTime) 1 << (MPR_TIMER_WHEEL_BITS * MPR_TIMER_WHEEL_LEVELS));
 
-#if BLD_WIN_LIKE
-#define isDelim(mpr, c)               ((c) == '/' || (c) == '\\')
-#define isAbsPath(mpr, path)          ((isalpha(*path) && path[1] == ':' && isDelim(mpr, path[2])) || isDelim(mpr, path[0]))
-#define isAbsPathWithDrive(mpr, path) ((isalpha(*path) && path[1] == ':' && isDelim(mpr, path[2])))
-#else
+    for (i = 0; i < MPR_TIMER_WHEEL_SIZE; i++) {
+        tick = es->timerTick + i;
+        q = &es->timerWheel[0][(int) tick & MPR_TIMER_WHEEL_MASK];
+        if (q->next != q) {
+            best = tick;
+            break;
+        }
+    }
+    for (level = 1; level < MPR_TIMER_WHEEL_LEVELS; level++) {
+        shift = MPR_TIMER_WHEEL_BITS * level;
+        base = es->timerTick >> shift;
+        for (i = 0; i <= MPR_TIMER_WHEEL_SIZE; i++) {
+            tick = (base + i) << shift;
+            if (tick >= best) {
+                break;
+            }
+            if (tick < es->timerTick) {
+                continue;
+            }
+            q = &es->timerWheel[level][(int) (base + i) & MPR_TIMER_WHEEL_MASK];
+            if (q->next != q) {
+                best = tick;
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+
+/*
+ *  Advance the timer wheel up to and including "now". Due events are moved to the event queue a slot at a time.
+ *  Empty stretches of the wheel are skipped. Must be locked when called.
+ */
+static void advanceTimers(MprEventService *es, MprTime now)
+{
+    MprEvent    *q, *event;
+    MprTime     next, last;
+    int         level, shift;
+
+    while (es->timerTick <= now) {
+        if (es->timerCount == 0) {
+            es->timerTick = now + 1;
+            break;
+        }
+        next = getNextTimerTick(es);
+        if (next > now) {
+            es->timerTick = now + 1;
+            break;
+        }
+        last = es->timerTick - 1;
+        es->timerTick = next;
+
+        /*
+         *  Cascade each level with a slot boundary in (last, next]. A level boundary is also a boundary of all
+         *  lower levels, so stop at the first level not crossed.
+         */
+        for (level = 1; level < MPR_TIMER_WHEEL_LEVELS; level++) {
+            shift = MPR_TIMER_WHEEL_BITS * level;
+            if ((next >> shift) == (last >> shift)) {
+                break;
+            }
+            cascadeTimers(es, level);
+        }
+
+        /*
+         *  Fire the whole slot as a batch
+         */
+        q = &es->timerWheel[0][(int) es->timerTick & MPR_TIMER_WHEEL_MASK];
+        if (q->next != q) {
+            for (event = q->next; event != q; event = event->next) {
+                event->flags &= ~MPR_EVENT_TIMER;
+                es->timerCount--;
+                es->eventCounter++;
+            }
+            q->next->prev = es->eventQ.prev;
+            es->eventQ.prev->next = q->next;
+            q->prev->next = &es->eventQ;
+            es->eventQ.prev = q->prev;
+            q->next = q->prev = q;
+        }
+        es->timerTick++;
+    }
+}
+
+
+/*
+ *  @copy   default
+ *  
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *  
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire 
+ *  a commercial license from Embedthis Software. You agree to be fully bound 
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with 
+ *  this software for full details.
+ *  
+ *  This software is open source; you can redistribute it and/or modify it 
+ *  under the terms of the GNU General Public License as published by the 
+ *  Free Software Foundation; either version 2 of the License, or (at your 
+ *  option) any later version. See the GNU General Public License for more 
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *  
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the 
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+ *  
+ *  This GPL license does NOT permit incorporating this software into 
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses 
+ *  for this software and support services are available from Embedthis 
+ *  Software at http://www.embedthis.com 
+ *  
+ *  @end
+ */
+/************************************************************************/
+/*
+ *  End of file "../mprEvent.c"
+ */
+/************************************************************************/
+
+
+
+/************************************************************************/
+/*
+ *  Start of file "../mprFile.c"
+ */
+/************************************************************************/
+
+/**
+ *  mprFile.c - File services.
+ *
+ *  This modules provides a simple cross platform file I/O abstraction. It uses a file system switch and 
+ *  underneath a file system provider that implements actual I/O.
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+
+
+
+static int  fillBuf(MprFile *file);
+
+#if BLD_WIN_LIKE
+#define isDelim(mpr, c)               ((c) == '/' || (c) == '\\')
+#define isAbsPath(mpr, path)          ((isalpha(*path) && path[1] == ':' && isDelim(mpr, path[2])) || isDelim(mpr, path[0]))
+#define isAbsPathWithDrive(mpr, path) ((isalpha(*path) && path[1] == ':' && isDelim(mpr, path[2])))
+#else
 #define isDelim(mpr, c)               ((c) == mpr->pathDelimiter)
 #define isAbsPath(mpr, path)          (path[0] == mpr->pathDelimiter)
 #endif
@@ -7930,9 +8356,10 @@ char *mprSearchForFile(MprCtx ctx, cchar *file, int flags, cchar *search, ...)
  *  mprHash.cpp - Fast hashing table lookup module
  *
  *  This hash table uses a fast key lookup mechanism. Keys are strings and the value entries are arbitrary pointers.
- *  The keys are hashed into a series of buckets which then have a chain of hash entries using the standard doubly
- *  linked list classes (List/Link). The chain in in collating sequence so search time through the chain is on
- *  average (N/hashSize)/2.
+ *  Entries are stored inline in an open addressed table using Robin Hood probing. The full hash of each key is stored
+ *  with the entry so most mismatches are rejected without a string compare and the table can grow without rehashing
+ *  keys. When the table grows, entries are migrated a few at a time by subsequent insertions rather than all at once. 
+ *  Tables may be created caseless in which case keys are hashed and compared without regard to case.
  *
  *  This module is not thread-safe. It is the callers responsibility to perform all thread synchronization.
  *
@@ -7942,38 +8369,62 @@ char *mprSearchForFile(MprCtx ctx, cchar *file, int flags, cchar *search, ...)
 
 
 
-static int hashIndex(cchar *key, int size);
-static MprHash  *lookupInner(int *bucketIndex, MprHash **prevSp, MprHashTable *table, cchar *key);
-
 /*
- *  Create a new hash table of a given size. Caller should provide a size that is a prime number for the greatest
- *  efficiency. Caller should use mprFree to free the hash table.
+ *  Maximum load before growing (75%) and the number of old slots migrated per insertion after growing
  */
+#define HASH_MAX_LOAD(size)     ((size) - ((size) >> 2))
+#define HASH_MIGRATE            4
 
+static MprHash *addEntry(MprHashTable *table, uint hash, cchar *key, cvoid *ptr);
+static MprHashTable *createHash(MprCtx ctx, int hashSize, int flags);
+static MprHash *findEntry(MprHashTable *table, MprHash *entries, int size, cchar *key, uint hash);
+static int growHash(MprHashTable *table);
+static uint hashKey(MprHashTable *table, cchar *key);
+static MprHash *insertEntry(MprHash *entries, int size, uint hash, char *key, cvoid *data);
+static MprHash *lookupInner(MprHashTable *table, cchar *key, uint hash);
+static void migrateEntries(MprHashTable *table, int count);
+static MprHash *nextEntry(MprHashTable *table, MprHash *last);
+static void removeEntry(MprHash *entries, int size, MprHash *hp);
+
+/*
+ *  Create a new hash table of a given size. The size is rounded up to a power of two and the table will grow as 
+ *  required. Caller should use mprFree to free the hash table.
+ */
 MprHashTable *mprCreateHash(MprCtx ctx, int hashSize)
+{
+    return createHash(ctx, hashSize, 0);
+}
+
+
+MprHashTable *mprCreateCaselessHash(MprCtx ctx, int hashSize)
+{
+    return createHash(ctx, hashSize, MPR_HASH_CASELESS);
+}
+
+
+static MprHashTable *createHash(MprCtx ctx, int hashSize, int flags)
 {
     MprHashTable    *table;
+    int             size;
 
     table = mprAllocObjZeroed(ctx, MprHashTable);
     if (table == 0) {
         return 0;
     }
-
-    /*  TODO -- should support rehashing */
-    if (hashSize < MPR_DEFAULT_HASH_SIZE) {
+    if (hashSize <= 0) {
         hashSize = MPR_DEFAULT_HASH_SIZE;
     }
-    table->hashSize = hashSize;
-
-    table->count = 0;
-    table->hashSize = hashSize;
-    table->buckets = (MprHash**) mprAllocZeroed(table, sizeof(MprHash*) * hashSize);
+    for (size = 8; size < hashSize; size <<= 1) {
+        ;
+    }
+    table->size = size;
+    table->flags = flags;
+    table->entries = (MprHash*) mprAllocZeroed(table, sizeof(MprHash) * size);
 
-    if (table->buckets == 0) {
+    if (table->entries == 0) {
         mprFree(table);
         return 0;
     }
-
     return table;
 }
 
@@ -7983,7 +8434,7 @@ MprHashTable *mprCopyHash(MprCtx ctx, MprHashTable *master)
     MprHash         *hp;
     MprHashTable    *table;
 
-    table = mprCreateHash(ctx, master->hashSize);
+    table = createHash(ctx, master->size, master->flags);
     if (table == 0) {
         return 0;
     }
@@ -8002,36 +8453,20 @@ MprHashTable *mprCopyHash(MprCtx ctx, MprHashTable *master)
  */
 MprHash *mprAddHash(MprHashTable *table, cchar *key, cvoid *ptr)
 {
-    MprHash     *sp, *prevSp;
-    int         index;
+    MprHash     *sp;
+    uint        hash;
 
-    sp = lookupInner(&index, &prevSp, table, key);
+    mprAssert(key);
 
-    if (sp != 0) {
+    hash = hashKey(table, key);
+    if ((sp = lookupInner(table, key, hash)) != 0) {
         /*
          *  Already exists. Just update the data.
          */
         sp->data = ptr;
         return sp;
     }
-
-    /*
-     *  New entry
-     */
-    sp = mprAllocObjZeroed(table, MprHash);
-    if (sp == 0) {
-        return 0;
-    }
-
-    sp->data = ptr;
-    sp->key = mprStrdup(sp, key);
-    sp->bucket = index;
-
-    sp->next = table->buckets[index];
-    table->buckets[index] = sp;
-
-    table->count++;
-    return sp;
+    return addEntry(table, hash, key, ptr);
 }
 
 
@@ -8042,25 +8477,9 @@ MprHash *mprAddHash(MprHashTable *table, cchar *key, cvoid *ptr)
  */
 MprHash *mprAddDuplicateHash(MprHashTable *table, cchar *key, cvoid *ptr)
 {
-    MprHash     *sp;
-    int         index;
-
-    sp = mprAllocObjZeroed(table, MprHash);
-    if (sp == 0) {
-        return 0;
-    }
-
-    index = hashIndex(key, table->hashSize);
-
-    sp->data = ptr;
-    sp->key = mprStrdup(sp, key);
-    sp->bucket = index;
-
-    sp->next = table->buckets[index];
-    table->buckets[index] = sp;
+    mprAssert(key);
 
-    table->count++;
-    return sp;
+    return addEntry(table, hashKey(table, key), key, ptr);
 }
 
 
@@ -8069,21 +8488,28 @@ MprHash *mprAddDuplicateHash(MprHashTable *table, cchar *key, cvoid *ptr)
  */
 int mprRemoveHash(MprHashTable *table, cchar *key)
 {
-    MprHash     *sp, *prevSp;
-    int         index;
+    MprHash     *sp;
+    uint        hash;
 
-    if ((sp = lookupInner(&index, &prevSp, table, key)) == 0) {
-        return MPR_ERR_NOT_FOUND;
-    }
+    mprAssert(key);
+
+    hash = hashKey(table, key);
+    if ((sp = findEntry(table, table->entries, table->size, key, hash)) != 0) {
+        mprFree(sp->key);
+        removeEntry(table->entries, table->size, sp);
+
+    } else if (table->old && (sp = findEntry(table, table->old, table->oldSize, key, hash)) != 0) {
+        /*
+         *  The old table is never inserted into, so leave a tombstone with the hash intact for later probes
+         */
+        mprFree(sp->key);
+        sp->key = 0;
+        sp->data = 0;
 
-    if (prevSp) {
-        prevSp->next = sp->next;
     } else {
-        table->buckets[index] = sp->next;
+        return MPR_ERR_NOT_FOUND;
     }
     table->count--;
-
-    mprFree(sp);
     return 0;
 }
 
@@ -8095,7 +8521,7 @@ MprHash *mprLookupHashEntry(MprHashTable *table, cchar *key)
 {
     mprAssert(key);
 
-    return lookupInner(0, 0, table, key);
+    return lookupInner(table, key, hashKey(table, key));
 }
 
 
@@ -8108,7 +8534,7 @@ cvoid *mprLookupHash(MprHashTable *table, cchar *key)
 
     mprAssert(key);
 
-    sp = lookupInner(0, 0, table, key);
+    sp = lookupInner(table, key, hashKey(table, key));
     if (sp == 0) {
         return 0;
     }
@@ -8116,83 +8542,219 @@ cvoid *mprLookupHash(MprHashTable *table, cchar *key)
 }
 
 
-static MprHash *lookupInner(int *bucketIndex, MprHash **prevSp, MprHashTable *table, cchar *key)
+int mprGetHashCount(MprHashTable *table)
 {
-    MprHash     *sp, *prev;
-    int         index, rc;
+    return table->count;
+}
 
-    mprAssert(key);
 
-    index = hashIndex(key, table->hashSize);
-    if (bucketIndex) {
-        *bucketIndex = index;
-    }
+/*
+ *  Return the first entry in the table.
+ */
+MprHash *mprGetFirstHash(MprHashTable *table)
+{
+    mprAssert(table);
 
-    sp = table->buckets[index];
-    prev = 0;
+    return nextEntry(table, 0);
+}
 
-    while (sp) {
-        rc = strcmp(sp->key, key);
-        if (rc == 0) {
-            if (prevSp) {
-                *prevSp = prev;
-            }
-            return sp;
+
+/*
+ *  Return the next entry in the table
+ */
+MprHash *mprGetNextHash(MprHashTable *table, MprHash *last)
+{
+    mprAssert(table);
+
+    return nextEntry(table, last);
+}
+
+
+static MprHash *addEntry(MprHashTable *table, uint hash, cchar *key, cvoid *ptr)
+{
+    char        *dup;
+
+    if ((dup = mprStrdup(table, key)) == 0) {
+        return 0;
+    }
+    /*
+     *  Migrate before inserting as migration may move the new entry
+     */
+    if ((table->count + 1) > HASH_MAX_LOAD(table->size)) {
+        if (growHash(table) < 0) {
+            mprFree(dup);
+            return 0;
         }
-        prev = sp;
-        mprAssert(sp != sp->next);
-        sp = sp->next;
     }
+    if (table->old) {
+        migrateEntries(table, HASH_MIGRATE);
+    }
+    table->count++;
+    return insertEntry(table->entries, table->size, hash, dup, ptr);
+}
+
+
+/*
+ *  Double the table size. Existing entries stay in the old table until migrated by later insertions.
+ */
+static int growHash(MprHashTable *table)
+{
+    MprHash     *entries;
+
+    if (table->old) {
+        migrateEntries(table, table->oldSize);
+    }
+    if ((entries = (MprHash*) mprAllocZeroed(table, sizeof(MprHash) * table->size * 2)) == 0) {
+        return MPR_ERR_NO_MEMORY;
+    }
+    table->old = table->entries;
+    table->oldSize = table->size;
+    table->migrate = 0;
+    table->entries = entries;
+    table->size *= 2;
     return 0;
 }
 
 
-int mprGetHashCount(MprHashTable *table)
+static void migrateEntries(MprHashTable *table, int count)
 {
-    return table->count;
+    MprHash     *hp;
+
+    while (count-- > 0 && table->migrate < table->oldSize) {
+        hp = &table->old[table->migrate++];
+        if (hp->key) {
+            insertEntry(table->entries, table->size, hp->hash, hp->key, hp->data);
+            hp->key = 0;
+        }
+    }
+    if (table->migrate >= table->oldSize) {
+        mprFree(table->old);
+        table->old = 0;
+        table->oldSize = 0;
+        table->migrate = 0;
+    }
 }
 
 
 /*
- *  Return the first entry in the table.
+ *  Robin Hood insertion. An entry displaces any entry that is closer to its home slot. Returns the slot of the new entry.
  */
-MprHash *mprGetFirstHash(MprHashTable *table)
+static MprHash *insertEntry(MprHash *entries, int size, uint hash, char *key, cvoid *data)
 {
-    MprHash     *sp;
-    int         i;
+    MprHash     entry, tmp, *hp, *result;
+    int         mask, index, dist, hdist;
 
-    mprAssert(table);
+    mask = size - 1;
+    entry.key = key;
+    entry.data = data;
+    entry.hash = hash;
+    result = 0;
 
-    for (i = 0; i < table->hashSize; i++) {
-        if ((sp = (MprHash*) table->buckets[i]) != 0) {
-            return sp;
+    for (index = hash & mask, dist = 0; ; index = (index + 1) & mask, dist++) {
+        hp = &entries[index];
+        if (hp->hash == 0) {
+            *hp = entry;
+            return result ? result : hp;
+        }
+        hdist = (index - hp->hash) & mask;
+        if (hdist < dist) {
+            tmp = *hp;
+            *hp = entry;
+            entry = tmp;
+            dist = hdist;
+            if (result == 0) {
+                result = hp;
+            }
         }
     }
-    return 0;
 }
 
 
 /*
- *  Return the next entry in the table
+ *  Backward shift deletion. Following entries that are not in their home slot are moved back one slot.
  */
-MprHash *mprGetNextHash(MprHashTable *table, MprHash *last)
+static void removeEntry(MprHash *entries, int size, MprHash *hp)
 {
-    MprHash     *sp;
-    int         i;
+    MprHash     *np;
+    int         mask, index, next;
 
-    mprAssert(table);
+    mask = size - 1;
+    index = (int) (hp - entries);
+
+    while (1) {
+        next = (index + 1) & mask;
+        np = &entries[next];
+        if (np->hash == 0 || ((next - np->hash) & mask) == 0) {
+            break;
+        }
+        entries[index] = *np;
+        index = next;
+    }
+    entries[index].key = 0;
+    entries[index].data = 0;
+    entries[index].hash = 0;
+}
+
+
+static MprHash *lookupInner(MprHashTable *table, cchar *key, uint hash)
+{
+    MprHash     *sp;
 
-    if (last == 0) {
-        return mprGetFirstHash(table);
+    if ((sp = findEntry(table, table->entries, table->size, key, hash)) == 0 && table->old) {
+        sp = findEntry(table, table->old, table->oldSize, key, hash);
     }
+    return sp;
+}
+
+
+/*
+ *  Probe for a key. The search stops at an empty slot or at an entry closer to its home slot than the key would be.
+ */
+static MprHash *findEntry(MprHashTable *table, MprHash *entries, int size, cchar *key, uint hash)
+{
+    MprHash     *hp;
+    int         mask, index, dist;
 
-    if (last->next) {
-        return last->next;
+    mask = size - 1;
+
+    for (index = hash & mask, dist = 0; ; index = (index + 1) & mask, dist++) {
+        hp = &entries[index];
+        if (hp->hash == 0 || (int) ((index - hp->hash) & mask) < dist) {
+            return 0;
+        }
+        if (hp->hash == hash && hp->key) {
+            if (table->flags & MPR_HASH_CASELESS) {
+                if (mprStrcmpAnyCase(hp->key, key) == 0) {
+                    return hp;
+                }
+            } else if (strcmp(hp->key, key) == 0) {
+                return hp;
+            }
+        }
     }
+}
+
 
-    for (i = last->bucket + 1; i < table->hashSize; i++) {
-        if ((sp = (MprHash*) table->buckets[i]) != 0) {
-            return sp;
+/*
+ *  Return the entry following last. Unmigrated entries in the old table are returned before the current table.
+ */
+static MprHash *nextEntry(MprHashTable *table, MprHash *last)
+{
+    MprHash     *hp, *end;
+
+    if (table->old && (last == 0 || (table->old <= last && last < &table->old[table->oldSize]))) {
+        end = &table->old[table->oldSize];
+        for (hp = last ? last + 1 : &table->old[table->migrate]; hp < end; hp++) {
+            if (hp->key) {
+                return hp;
+            }
+        }
+        last = 0;
+    }
+    end = &table->entries[table->size];
+    for (hp = last ? last + 1 : table->entries; hp < end; hp++) {
+        if (hp->key) {
+            return hp;
         }
     }
     return 0;
@@ -8200,18 +8762,25 @@ MprHash *mprGetNextHash(MprHashTable *table, MprHash *last)
 
 
 /*
- *  Hash the key to produce a hash index.
+ *  Hash the key (FNV-1a). Zero is reserved to mark unused slots.
  */
-static int hashIndex(cchar *key, int size)
+static uint hashKey(MprHashTable *table, cchar *key)
 {
-    uint        sum;
+    uint        hash;
 
-    sum = 0;
-    while (*key) {
-        sum += (sum * 33) + *key++;
+    hash = 2166136261U;
+    if (table->flags & MPR_HASH_CASELESS) {
+        while (*key) {
+            hash ^= (uchar) tolower((int) (uchar) *key++);
+            hash *= 16777619;
+        }
+    } else {
+        while (*key) {
+            hash ^= (uchar) *key++;
+            hash *= 16777619;
+        }
     }
-
-    return sum % size;
+    return hash ? hash : 1;
 }
 
 
@@ -8640,7 +9209,7 @@ static MprHttpResponse *createResponse(MprHttp *http)
         return 0;
     }
 
-    resp->headers = mprCreateHash(resp, -1);
+    resp->headers = mprCreateCaselessHash(resp, -1);
     resp->content = mprCreateBuf(resp, MPR_HTTP_BUFSIZE, http->bufmax);
     resp->http = http;
     resp->code = -1;
@@ -8942,12 +9511,22 @@ static bool issueRequest(MprHttp *http, cchar *method, cchar *requestUrl, int fl
         completeRequest(http);
 
     } else {
+        /*
+         *  Set the state before enabling events. When multithreaded, the response may be read on a pool thread 
+         *  before this thread continues, and readEvent ignores data while the state is still BEGIN.
+         */
+        http->state = MPR_HTTP_STATE_WAIT;
         if (http->sock->handler == 0) {
             mprSetSocketCallback(http->sock, (MprSocketProc) readEvent, (void*) http, 0, MPR_READABLE, MPR_NORMAL_PRIORITY);
         } else {
             mprSetSocketEventMask(http->sock, MPR_READABLE);
-        }
-        http->state = MPR_HTTP_STATE_WAIT;
+#if BLD_FEATURE_MULTITHREAD
+            /*
+             *  A kept-alive connection. Events were left disabled when the last response completed.
+             */
+            mprEnableWaitEvents(http->sock->handler, 1);
+#endif
+        }
 
         if (!(http->userFlags & MPR_HTTP_DONT_BLOCK)) {
             waitForResponse(http);
@@ -13081,7 +13660,9 @@ void free(void *ptr)
  *  mprPool.c - Thread pool service
  *
  *  The MPR provides a high peformance thread pool service where pre-allocated threads can be dispatched to 
- *  service tasks.
+ *  service tasks. Each thread owns a deque of tasks guarded by its own spin lock. Threads run their own tasks 
+ *  newest first and steal the oldest tasks from other threads when idle, so submitters do not contend on a 
+ *  single pool lock.
  *
  *  Copyright (c) All Rights Reserved. See details at the end of the file.
  */
@@ -13089,12 +13670,41 @@ void free(void *ptr)
 
 #if BLD_FEATURE_MULTITHREAD
 
-static int  changeState(MprPoolThread *pt, int state);
+/*
+ *  Parallel for loop state. Chunks are claimed under the spin lock so each runs exactly once, either on a pool
+ *  thread or on the caller.
+ */
+typedef struct PoolFor {
+    MprPoolForProc      proc;
+    void                *data;
+    MprSpin             *spin;
+    MprCond             *done;              /* Signalled when queued drops to zero */
+    int                 queued;             /* Chunk tasks handed to the pool and not yet retired */
+} PoolFor;
+
+typedef struct PoolForChunk {
+    PoolFor             *job;
+    int                 start;
+    int                 end;
+    int                 claimed;
+} PoolForChunk;
+
 static MprPoolThread *createPoolThread(MprPoolService *ps, int stackSize);
 static int  getNextThreadNum(MprPoolService *ps);
+static int  growWorkers(MprPoolService *ps);
+static MprPoolThread *popIdle(MprPoolService *ps);
+static int  popTask(MprPoolThread *pt, MprPoolTask *task);
 static int  poolThreadDestructor(MprPoolThread *pt);
-static void pruneThreads(MprPoolService *ps, MprEvent *timer);
 static void poolMain(MprPoolThread *pt, MprThread *tp);
+static void pruneThreads(MprPoolService *ps, MprEvent *timer);
+static void pushIdle(MprPoolService *ps, MprPoolThread *pt);
+static int  pushTask(MprPoolThread *pt, MprPoolTask *task);
+static int  queueTask(MprPoolService *ps, MprPoolTask *task, int busyOk);
+static void runChunk(PoolForChunk *cp, MprPoolThread *pt);
+static void runTask(MprPoolThread *pt, MprPoolTask *task);
+static int  startPoolThread(MprPoolService *ps, MprPoolTask *task);
+static int  stealTask(MprPoolService *ps, MprPoolThread *thief, MprPoolTask *task);
+static int  wakeIdle(MprPoolService *ps);
 
 /*
  *  Constructor for a thread pool
@@ -13110,19 +13720,16 @@ MprPoolService *mprCreatePoolService(MprCtx ctx)
     }
 
     ps->mutex = mprCreateLock(ps);
+    ps->spin = mprCreateSpinLock(ps);
+    ps->current = mprCreateThreadLocal();
+    if (ps->mutex == 0 || ps->spin == 0 || ps->current == 0) {
+        mprFree(ps);
+        return 0;
+    }
     
     ps->minThreads = MPR_DEFAULT_MIN_THREADS;
     ps->maxThreads = MPR_DEFAULT_MIN_THREADS;
 
-    /*
-     *  Presize the lists so they cannot get memory allocation failures later on.
-     */
-    ps->idleThreads = mprCreateList(ps);
-    mprSetListLimits(ps->idleThreads, ps->maxThreads, -1);
-
-    ps->busyThreads = mprCreateList(ps);
-    mprSetListLimits(ps->busyThreads, ps->maxThreads, -1);
-
     return ps;
 }
 
@@ -13157,7 +13764,7 @@ int mprStartPoolService(MprPoolService *ps)
 void mprStopPoolService(MprPoolService *ps, int timeout)
 {
     MprPoolThread       *pt;
-    int                 next;
+    int                 i, count, wake;
 
     mprLock(ps->mutex);
 
@@ -13167,12 +13774,27 @@ void mprStopPoolService(MprPoolService *ps, int timeout)
     }
 
     /*
-     *  Wake up all idle threads. Busy threads take care of themselves. An idle thread will wakeup, exit and be 
-     *  removed from the busy list and then delete the thread. We progressively remove the last thread in the idle
-     *  list. ChangeState will move the threads to the busy queue.
+     *  Mark every thread as pruned. Busy threads will exit once they run out of work and sleeping threads are 
+     *  woken so they can exit.
      */
-    for (next = -1; (pt = (MprPoolThread*) mprGetPrevItem(ps->idleThreads, &next)) != 0; next = -1) {
-        changeState(pt, MPR_POOL_THREAD_BUSY);
+    mprSpinLock(ps->spin);
+    count = ps->workerCount;
+    mprSpinUnlock(ps->spin);
+
+    for (i = 0; i < count; i++) {
+        mprSpinLock(ps->spin);
+        pt = ps->workers[i];
+        mprSpinUnlock(ps->spin);
+
+        mprSpinLock(pt->spin);
+        wake = (pt->state == MPR_POOL_THREAD_SLEEPING);
+        if (!(pt->state & MPR_POOL_THREAD_EXITED)) {
+            pt->state = MPR_POOL_THREAD_PRUNED;
+        }
+        mprSpinUnlock(pt->spin);
+        if (wake) {
+            mprSignalCond(pt->idleCond);
+        }
     }
 
     /*
@@ -13184,10 +13806,6 @@ void mprStopPoolService(MprPoolService *ps, int timeout)
         timeout -= 10;
         mprLock(ps->mutex);
     }
-
-    mprAssert(ps->idleThreads->length == 0);
-    mprAssert(ps->busyThreads->length == 0);
-
     mprUnlock(ps->mutex);
 }
 
@@ -13198,7 +13816,6 @@ void mprStopPoolService(MprPoolService *ps, int timeout)
  */
 void mprSetMinPoolThreads(MprCtx ctx, int n)
 { 
-    MprPoolThread   *pt;
     MprPoolService  *ps;
 
     ps = mprGetMpr(ctx)->poolService;
@@ -13206,17 +13823,11 @@ void mprSetMinPoolThreads(MprCtx ctx, int n)
     mprLock(ps->mutex);
 
     ps->minThreads = n; 
-    
     while (ps->numThreads < ps->minThreads) {
-        pt = createPoolThread(ps, ps->stackSize);
-
-        ps->numThreads++;
-        ps->maxUseThreads = max(ps->numThreads, ps->maxUseThreads);
-        ps->pruneHighWater = max(ps->numThreads, ps->pruneHighWater);
-
-        mprStartThread(pt->thread);
+        if (startPoolThread(ps, 0) < 0) {
+            break;
+        }
     }
-    
     mprUnlock(ps->mutex);
 }
 
@@ -13254,59 +13865,415 @@ int mprGetMaxPoolThreads(MprCtx ctx)
 
 
 int mprStartPoolThread(MprCtx ctx, MprPoolProc proc, void *data, int priority)
+{
+    MprPoolTask     task;
+
+    task.proc = proc;
+    task.data = data;
+    task.priority = priority;
+
+    return queueTask(mprGetMpr(ctx)->poolService, &task, 1);
+}
+
+
+
+int mprStartPoolTasks(MprCtx ctx, MprPoolTask *tasks, int count)
+{
+    MprPoolService  *ps;
+    int             i;
+
+    ps = mprGetMpr(ctx)->poolService;
+
+    for (i = 0; i < count; i++) {
+        if (queueTask(ps, &tasks[i], 1) < 0) {
+            break;
+        }
+    }
+    return i;
+}
+
+
+
+int mprParallelFor(MprCtx ctx, int start, int end, int grain, MprPoolForProc proc, void *data)
 {
     MprPoolService  *ps;
     MprPoolThread   *pt;
-    int             next;
+    MprPoolTask     task;
+    PoolFor         *job;
+    PoolForChunk    *chunks, *cp;
+    int             i, count, run, queued;
 
     ps = mprGetMpr(ctx)->poolService;
 
-    mprLock(ps->mutex);
+    if (end <= start) {
+        return 0;
+    }
+    if (grain <= 0) {
+        count = ps->maxThreads + 1;
+        grain = (end - start + count - 1) / count;
+    }
+    count = (end - start + grain - 1) / grain;
+    if (count <= 1 || ps->maxThreads == 0) {
+        (proc)(data, start, end);
+        return 0;
+    }
+
+    job = mprAllocObjZeroed(ctx, PoolFor);
+    if (job == 0) {
+        return MPR_ERR_NO_MEMORY;
+    }
+    job->proc = proc;
+    job->data = data;
+    job->spin = mprCreateSpinLock(job);
+    job->done = mprCreateCond(job);
+    chunks = (PoolForChunk*) mprAllocZeroed(job, count * sizeof(PoolForChunk));
+    if (job->spin == 0 || job->done == 0 || chunks == 0) {
+        mprFree(job);
+        return MPR_ERR_NO_MEMORY;
+    }
+    for (i = 0; i < count; i++) {
+        cp = &chunks[i];
+        cp->job = job;
+        cp->start = start + i * grain;
+        cp->end = min(cp->start + grain, end);
+    }
 
     /*
-     *  Try to find an idle thread and wake it up. It will wakeup in poolMain(). If not any available, then add 
-     *  another thread to the pool. Must account for threads we've already created but have not yet gone to work 
-     *  and inserted themselves in the idle/busy queues.
+     *  Hand all but the first chunk to free threads. Don't queue behind busy threads as the caller would only wait 
+     *  on them. Whatever could not be handed out is picked up by the caller below.
      */
-    next = 0;
-    pt = (MprPoolThread*) mprGetNextItem(ps->idleThreads, &next);
-    if (pt) {
+    task.proc = (MprPoolProc) runChunk;
+    task.priority = MPR_NORMAL_PRIORITY;
+    for (i = 1; i < count; i++) {
+        task.data = &chunks[i];
+        mprSpinLock(job->spin);
+        job->queued++;
+        mprSpinUnlock(job->spin);
+        if (queueTask(ps, &task, 0) < 0) {
+            mprSpinLock(job->spin);
+            job->queued--;
+            mprSpinUnlock(job->spin);
+            break;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        cp = &chunks[i];
+        mprSpinLock(job->spin);
+        run = !cp->claimed;
+        cp->claimed = 1;
+        mprSpinUnlock(job->spin);
+        if (run) {
+            (proc)(data, cp->start, cp->end);
+        }
+    }
+
+    /*
+     *  Wait for the queued chunk tasks to retire. A pool thread caller runs its own deque meanwhile as that is 
+     *  where its chunks were pushed.
+     */
+    pt = (MprPoolThread*) mprGetThreadData(ps->current);
+    for (;;) {
+        mprSpinLock(job->spin);
+        queued = job->queued;
+        mprSpinUnlock(job->spin);
+        if (queued == 0) {
+            break;
+        }
+        if (pt && popTask(pt, &task)) {
+            runTask(pt, &task);
+        } else {
+            mprWaitForCond(job->done, -1);
+        }
+    }
+    mprFree(job);
+    return 0;
+}
 
-        pt->proc = proc;
-        pt->data = data;
-        pt->priority = priority;
-        changeState(pt, MPR_POOL_THREAD_BUSY);
 
-    } else if (ps->numThreads < ps->maxThreads) {
 
-        /*
-         *  Can't find an idle thread. Try to create more threads in the pool. Otherwise, we will have to wait. 
-         *  No need to wakeup the thread -- it will immediately go to work.
-         */
-        pt = createPoolThread(ps, ps->stackSize);
+/*
+ *  Run one chunk of a parallel for loop unless the caller already claimed it
+ */
+static void runChunk(PoolForChunk *cp, MprPoolThread *pt)
+{
+    PoolFor     *job;
+    int         run;
+
+    job = cp->job;
 
-        ps->numThreads++;
-        ps->maxUseThreads = max(ps->numThreads, ps->maxUseThreads);
-        ps->pruneHighWater = max(ps->numThreads, ps->pruneHighWater);
+    mprSpinLock(job->spin);
+    run = !cp->claimed;
+    cp->claimed = 1;
+    mprSpinUnlock(job->spin);
 
-        pt->proc = proc;
-        pt->data = data;
-        pt->priority = priority;
+    if (run) {
+        (job->proc)(job->data, cp->start, cp->end);
+    }
+
+    /*
+     *  Signal while holding the spin lock. The caller frees the job as soon as it sees queued reach zero.
+     */
+    mprSpinLock(job->spin);
+    if (--job->queued == 0) {
+        mprSignalCond(job->done);
+    }
+    mprSpinUnlock(job->spin);
+}
 
-        changeState(pt, MPR_POOL_THREAD_BUSY);
 
-        mprStartThread(pt->thread);
 
-    } else {
+/*
+ *  Place a task. Pool threads push onto their own deque and wake an idle thread to steal it. Other callers hand 
+ *  the task to an idle thread, a new thread or, if busyOk, the deque of a busy thread.
+ */
+static int queueTask(MprPoolService *ps, MprPoolTask *task, int busyOk)
+{
+    MprPoolThread   *pt;
+    int             i, count, next;
+
+    pt = (MprPoolThread*) mprGetThreadData(ps->current);
+    if (pt && pushTask(pt, task) == 0) {
+        if (!wakeIdle(ps) && ps->numThreads < ps->maxThreads) {
+            mprLock(ps->mutex);
+            startPoolThread(ps, 0);
+            mprUnlock(ps->mutex);
+        }
+        return 0;
+    }
+
+    while ((pt = popIdle(ps)) != 0) {
+        if (pushTask(pt, task) == 0) {
+            return 0;
+        }
+    }
+
+    mprLock(ps->mutex);
+    if (startPoolThread(ps, task) == 0) {
+        mprUnlock(ps->mutex);
+        return 0;
+    }
+    mprUnlock(ps->mutex);
+
+    if (busyOk) {
+        mprSpinLock(ps->spin);
+        count = ps->workerCount;
+        next = ps->nextWorker++;
+        mprSpinUnlock(ps->spin);
+
+        for (i = 0; i < count; i++) {
+            mprSpinLock(ps->spin);
+            pt = ps->workers[(next + i) % count];
+            mprSpinUnlock(ps->spin);
+            if (pushTask(pt, task) == 0) {
+                return 0;
+            }
+        }
+    }
+    return MPR_ERR_BUSY;
+}
+
+
+
+/*
+ *  Create a thread if below the limit. Must be called with ps->mutex locked.
+ */
+static int startPoolThread(MprPoolService *ps, MprPoolTask *task)
+{
+    MprPoolThread   *pt;
+
+    if (ps->numThreads >= ps->maxThreads) {
+        return MPR_ERR_BUSY;
+    }
+    if ((pt = createPoolThread(ps, ps->stackSize)) == 0) {
+        return MPR_ERR_NO_MEMORY;
+    }
+    if (task) {
+        pushTask(pt, task);
+    }
+
+    mprSpinLock(ps->spin);
+    ps->numThreads++;
+    ps->maxUseThreads = max(ps->numThreads, ps->maxUseThreads);
+    ps->pruneHighWater = max(ps->numThreads, ps->pruneHighWater);
+    mprSpinUnlock(ps->spin);
+
+    mprStartThread(pt->thread);
+    return 0;
+}
+
+
+
+/*
+ *  Push a task on the tail of a thread's deque. Wake the thread if it is sleeping. Fails if the thread is exiting.
+ */
+static int pushTask(MprPoolThread *pt, MprPoolTask *task)
+{
+    MprPoolTask     *tasks, *old;
+    int             i, count, size, wake;
+
+    old = 0;
+    mprSpinLock(pt->spin);
+    while ((pt->tail - pt->head) == pt->taskMax) {
         /*
-         *  No free threads and can't create anymore. We will have to wait. Busy threads will call dispatch when 
-         *  they become idle
+         *  Full. Allocate outside the lock and rebase the ring at zero.
          */
-        mprUnlock(ps->mutex);
+        size = pt->taskMax * 2;
+        mprSpinUnlock(pt->spin);
+        tasks = (MprPoolTask*) mprAlloc(pt, size * sizeof(MprPoolTask));
+        if (tasks == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        mprSpinLock(pt->spin);
+        count = pt->tail - pt->head;
+        if (count == pt->taskMax && size > pt->taskMax) {
+            for (i = 0; i < count; i++) {
+                tasks[i] = pt->tasks[(pt->head + i) & (pt->taskMax - 1)];
+            }
+            old = pt->tasks;
+            pt->tasks = tasks;
+            pt->taskMax = size;
+            pt->head = 0;
+            pt->tail = count;
+            break;
+        }
+        mprSpinUnlock(pt->spin);
+        mprFree(tasks);
+        mprSpinLock(pt->spin);
+    }
+    if (pt->state & (MPR_POOL_THREAD_PRUNED | MPR_POOL_THREAD_EXITED)) {
+        mprSpinUnlock(pt->spin);
+        mprFree(old);
         return MPR_ERR_BUSY;
     }
+    pt->tasks[pt->tail++ & (pt->taskMax - 1)] = *task;
 
-    mprUnlock(ps->mutex);
+    wake = (pt->state == MPR_POOL_THREAD_SLEEPING);
+    if (wake) {
+        pt->state = MPR_POOL_THREAD_BUSY;
+    }
+    mprSpinUnlock(pt->spin);
+
+    if (wake) {
+        mprSignalCond(pt->idleCond);
+    }
+    mprFree(old);
+    return 0;
+}
+
+
+
+/*
+ *  Owner pops the newest task from the tail of its own deque
+ */
+static int popTask(MprPoolThread *pt, MprPoolTask *task)
+{
+    int     found;
+
+    mprSpinLock(pt->spin);
+    found = (pt->tail != pt->head);
+    if (found) {
+        *task = pt->tasks[--pt->tail & (pt->taskMax - 1)];
+        if (pt->tail == pt->head) {
+            pt->head = pt->tail = 0;
+        }
+    }
+    mprSpinUnlock(pt->spin);
+    return found;
+}
+
+
+
+/*
+ *  Steal the oldest task from the head of another thread's deque. Pool threads are never freed, so a thread 
+ *  pointer read from the worker table stays valid after the table lock is released.
+ */
+static int stealTask(MprPoolService *ps, MprPoolThread *thief, MprPoolTask *task)
+{
+    MprPoolThread   *pt;
+    int             i, count, next, found;
+
+    mprSpinLock(ps->spin);
+    count = ps->workerCount;
+    next = ps->nextWorker++;
+    mprSpinUnlock(ps->spin);
+
+    for (i = 0; i < count; i++) {
+        mprSpinLock(ps->spin);
+        pt = ps->workers[(next + i) % count];
+        mprSpinUnlock(ps->spin);
+        if (pt == thief) {
+            continue;
+        }
+        mprSpinLock(pt->spin);
+        found = (pt->tail != pt->head);
+        if (found) {
+            *task = pt->tasks[pt->head++ & (pt->taskMax - 1)];
+            if (pt->tail == pt->head) {
+                pt->head = pt->tail = 0;
+            }
+        }
+        mprSpinUnlock(pt->spin);
+        if (found) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+
+static void pushIdle(MprPoolService *ps, MprPoolThread *pt)
+{
+    mprSpinLock(ps->spin);
+    if (!pt->inIdle) {
+        ps->idle[ps->idleCount++] = pt;
+        pt->inIdle = 1;
+    }
+    mprSpinUnlock(ps->spin);
+}
+
+
+
+/*
+ *  Take the most recently idled thread. It may have been woken or exited since, so callers must cope with that.
+ */
+static MprPoolThread *popIdle(MprPoolService *ps)
+{
+    MprPoolThread   *pt;
+
+    pt = 0;
+    mprSpinLock(ps->spin);
+    if (ps->idleCount > 0) {
+        pt = ps->idle[--ps->idleCount];
+        pt->inIdle = 0;
+    }
+    mprSpinUnlock(ps->spin);
+    return pt;
+}
+
+
+
+/*
+ *  Wake one sleeping thread so it can steal work. Returns true if a thread was woken.
+ */
+static int wakeIdle(MprPoolService *ps)
+{
+    MprPoolThread   *pt;
+    int             wake;
+
+    while ((pt = popIdle(ps)) != 0) {
+        mprSpinLock(pt->spin);
+        wake = (pt->state == MPR_POOL_THREAD_SLEEPING);
+        if (wake) {
+            pt->state = MPR_POOL_THREAD_BUSY;
+        }
+        mprSpinUnlock(pt->spin);
+        if (wake) {
+            mprSignalCond(pt->idleCond);
+            return 1;
+        }
+    }
     return 0;
 }
 
@@ -13318,7 +14285,7 @@ int mprStartPoolThread(MprCtx ctx, MprPoolProc proc, void *data, int priority)
 static void pruneThreads(MprPoolService *ps, MprEvent *timer)
 {
     MprPoolThread   *pt;
-    int             index, toTrim;
+    int             toTrim, prune;
 
     if (mprIsExiting(ps)) {
         return;
@@ -13328,16 +14295,32 @@ static void pruneThreads(MprPoolService *ps, MprEvent *timer)
 
     /*
      *  Prune half of what we could prune. This gives exponentional decay. We use the high water mark seen in 
-     *  the last period.
+     *  the last period. Take the threads that have been idle longest from the bottom of the idle stack.
      */
     toTrim = (ps->pruneHighWater - ps->minThreads) / 2;
 
-    for (index = 0; toTrim-- > 0 && index < ps->idleThreads->length; index++) {
-        pt = (MprPoolThread*) mprGetItem(ps->idleThreads, index);
-        /*
-         *  Leave floating -- in no queue. The thread will kill itself.
-         */
-        changeState(pt, MPR_POOL_THREAD_PRUNED);
+    while (toTrim > 0) {
+        mprSpinLock(ps->spin);
+        if (ps->idleCount == 0) {
+            mprSpinUnlock(ps->spin);
+            break;
+        }
+        pt = ps->idle[0];
+        pt->inIdle = 0;
+        ps->idleCount--;
+        memmove(&ps->idle[0], &ps->idle[1], ps->idleCount * sizeof(MprPoolThread*));
+        mprSpinUnlock(ps->spin);
+
+        mprSpinLock(pt->spin);
+        prune = (pt->state == MPR_POOL_THREAD_SLEEPING);
+        if (prune) {
+            pt->state = MPR_POOL_THREAD_PRUNED;
+        }
+        mprSpinUnlock(pt->spin);
+        if (prune) {
+            mprSignalCond(pt->idleCond);
+            toTrim--;
+        }
     }
     ps->pruneHighWater = ps->minThreads;
 
@@ -13351,7 +14334,7 @@ int mprAvailablePoolThreads(MprCtx ctx)
     MprPoolService  *ps;
 
     ps = mprGetMpr(ctx)->poolService;
-    return ps->idleThreads->length + (ps->maxThreads - ps->numThreads); 
+    return ps->idleCount + (ps->maxThreads - ps->numThreads); 
 }
 
 
@@ -13392,35 +14375,110 @@ void mprGetPoolServiceStats(MprPoolService *ps, MprPoolStats *stats)
     stats->numThreads = ps->numThreads;
     stats->maxUse = ps->maxUseThreads;
     stats->pruneHighWater = ps->pruneHighWater;
-    stats->idleThreads = ps->idleThreads->length;
-    stats->busyThreads = ps->busyThreads->length;
+    stats->idleThreads = ps->idleCount;
+    stats->busyThreads = ps->numThreads - ps->idleCount;
 }
 #endif /* BLD_DEBUG */
 
 
 
 /*
- *  Create a new thread for the task
+ *  Grow the worker and idle tables. Readers only access the tables under ps->spin, so the old tables can be freed
+ *  once swapped. Must be called with ps->mutex locked.
+ */
+static int growWorkers(MprPoolService *ps)
+{
+    MprPoolThread   **workers, **idle, **oldWorkers, **oldIdle;
+    int             size;
+
+    if (ps->workerCount < ps->workerMax) {
+        return 0;
+    }
+    size = (ps->workerMax) ? (ps->workerMax * 2) : max(ps->maxThreads, 8);
+    workers = (MprPoolThread**) mprAllocZeroed(ps, size * sizeof(MprPoolThread*));
+    idle = (MprPoolThread**) mprAllocZeroed(ps, size * sizeof(MprPoolThread*));
+    if (workers == 0 || idle == 0) {
+        mprFree(workers);
+        mprFree(idle);
+        return MPR_ERR_NO_MEMORY;
+    }
+
+    mprSpinLock(ps->spin);
+    if (ps->workerCount > 0) {
+        memcpy(workers, ps->workers, ps->workerCount * sizeof(MprPoolThread*));
+    }
+    if (ps->idleCount > 0) {
+        memcpy(idle, ps->idle, ps->idleCount * sizeof(MprPoolThread*));
+    }
+    oldWorkers = ps->workers;
+    oldIdle = ps->idle;
+    ps->workers = workers;
+    ps->idle = idle;
+    ps->workerMax = size;
+    mprSpinUnlock(ps->spin);
+
+    mprFree(oldWorkers);
+    mprFree(oldIdle);
+    return 0;
+}
+
+
+
+/*
+ *  Create a new thread for the task. Reuse the deque of an exited thread if there is one so the worker table 
+ *  does not grow as threads are pruned and recreated. Must be called with ps->mutex locked.
  */
 static MprPoolThread *createPoolThread(MprPoolService *ps, int stackSize)
 {
     MprPoolThread   *pt;
+    int             i, count, reuse;
 
     char    name[16];
 
-    pt = mprAllocObjWithDestructor(ps, MprPoolThread, poolThreadDestructor);
-    if (pt == 0) {
-        return 0;
-    }
+    pt = 0;
+    mprSpinLock(ps->spin);
+    count = ps->workerCount;
+    mprSpinUnlock(ps->spin);
 
-    pt->proc = 0;
-    pt->data = 0;
-    pt->priority = 0;
-    pt->state = 0;
-    pt->pool = ps;
-    pt->idleCond = mprCreateCond(pt);
+    for (i = 0; i < count; i++) {
+        mprSpinLock(ps->spin);
+        pt = ps->workers[i];
+        mprSpinUnlock(ps->spin);
+
+        mprSpinLock(pt->spin);
+        reuse = (pt->state == MPR_POOL_THREAD_EXITED);
+        if (reuse) {
+            pt->state = MPR_POOL_THREAD_BUSY;
+        }
+        mprSpinUnlock(pt->spin);
+        if (reuse) {
+            break;
+        }
+        pt = 0;
+    }
 
-    changeState(pt, MPR_POOL_THREAD_IDLE);
+    if (pt == 0) {
+        if (growWorkers(ps) < 0) {
+            return 0;
+        }
+        pt = mprAllocObjWithDestructorZeroed(ps, MprPoolThread, poolThreadDestructor);
+        if (pt == 0) {
+            return 0;
+        }
+        pt->pool = ps;
+        pt->state = MPR_POOL_THREAD_BUSY;
+        pt->idleCond = mprCreateCond(pt);
+        pt->spin = mprCreateSpinLock(pt);
+        pt->taskMax = MPR_POOL_DEQUE_SIZE;
+        pt->tasks = (MprPoolTask*) mprAlloc(pt, pt->taskMax * sizeof(MprPoolTask));
+        if (pt->idleCond == 0 || pt->spin == 0 || pt->tasks == 0) {
+            mprFree(pt);
+            return 0;
+        }
+        mprSpinLock(ps->spin);
+        ps->workers[ps->workerCount++] = pt;
+        mprSpinUnlock(ps->spin);
+    }
 
     mprSprintf(name, sizeof(name), "pool.%u", getNextThreadNum(ps));
 
@@ -13442,110 +14500,96 @@ static int poolThreadDestructor(MprPoolThread *pt)
 
 
 
-/*
- *  Pool thread main service routine
- */
-static void poolMain(MprPoolThread *pt, MprThread *tp)
+static void runTask(MprPoolThread *pt, MprPoolTask *task)
 {
-    MprPoolService  *ps;
-
-    ps = mprGetMpr(pt)->poolService;
-
-    mprLock(pt->pool->mutex);
-
-    while (!mprIsExiting(pt) && !(pt->state & MPR_POOL_THREAD_PRUNED)) {
-
-        if (pt->proc) {
+    MprPoolProc     proc;
+    void            *data;
+    int             priority;
 
-            mprUnlock(ps->mutex);
-            mprSetThreadPriority(pt->thread, pt->priority);
-            (*pt->proc)(pt->data, pt);
-            pt->proc = 0;
-            mprSetThreadPriority(pt->thread, MPR_POOL_PRIORITY);
-            mprLock(ps->mutex);
-        }
+    /*
+     *  Save the outer task. A parallel for caller may run tasks from its deque while it waits.
+     */
+    proc = pt->proc;
+    data = pt->data;
+    priority = pt->proc ? pt->priority : MPR_POOL_PRIORITY;
 
-        changeState(pt, MPR_POOL_THREAD_SLEEPING);
-        
-        mprUnlock(ps->mutex);
-        mprWaitForCond(pt->idleCond, -1);
-        mprLock(ps->mutex);
-    }
+    pt->proc = task->proc;
+    pt->data = task->data;
+    pt->priority = task->priority;
 
-    changeState(pt, 0);
+    mprSetThreadPriority(pt->thread, task->priority);
+    (task->proc)(task->data, pt);
+    mprSetThreadPriority(pt->thread, priority);
 
-    ps->numThreads--;
-    mprUnlock(ps->mutex);
+    pt->proc = proc;
+    pt->data = data;
+    pt->priority = priority;
 }
 
 
 
-static int changeState(MprPoolThread *pt, int state)
+/*
+ *  Pool thread main service routine. Run tasks from our own deque newest first, then steal from other threads. 
+ *  When there is nothing left, sleep on the idle stack until a task is pushed or we are pruned.
+ */
+static void poolMain(MprPoolThread *pt, MprThread *tp)
 {
     MprPoolService  *ps;
-    MprList         *lp;
+    MprPoolTask     task;
+    int             empty;
 
     ps = pt->pool;
-    lp = 0;
+    mprSetThreadData(ps->current, pt);
 
-    mprLock(ps->mutex);
-    switch (pt->state) {
-    case MPR_POOL_THREAD_BUSY:
-        lp = ps->busyThreads;
-        break;
+    while (!mprIsExiting(pt)) {
+        if (popTask(pt, &task) || stealTask(ps, pt, &task)) {
+            runTask(pt, &task);
+            continue;
+        }
 
-    case MPR_POOL_THREAD_IDLE:
-        lp = ps->idleThreads;
-        break;
+        /*
+         *  Test the deque and change state under the lock. A concurrent pushTask either sees us sleeping and 
+         *  signals, or we see its task here.
+         */
+        mprSpinLock(pt->spin);
+        empty = (pt->tail == pt->head);
+        if (empty) {
+            if (pt->state & MPR_POOL_THREAD_PRUNED) {
+                mprSpinUnlock(pt->spin);
+                break;
+            }
+            pt->state = MPR_POOL_THREAD_SLEEPING;
+        }
+        mprSpinUnlock(pt->spin);
+        if (!empty) {
+            continue;
+        }
 
-    case MPR_POOL_THREAD_SLEEPING:
-        lp = ps->idleThreads;
-        mprSignalCond(pt->idleCond); 
-        break;
-        
-    case MPR_POOL_THREAD_PRUNED:
-    default:
-        break;
-    }
+        pushIdle(ps, pt);
+        mprWaitForCond(pt->idleCond, -1);
 
-    if (lp) {
-        mprRemoveItem(lp, pt);
+        mprSpinLock(pt->spin);
+        if (pt->state == MPR_POOL_THREAD_SLEEPING) {
+            pt->state = MPR_POOL_THREAD_BUSY;
+        }
+        mprSpinUnlock(pt->spin);
     }
 
-    lp = 0;
-
-    switch (state) {
-    case MPR_POOL_THREAD_BUSY:
-        lp = ps->busyThreads;
-        break;
-
-    case MPR_POOL_THREAD_IDLE:
-    case MPR_POOL_THREAD_SLEEPING:
-        lp = ps->idleThreads;
-        break;
+    mprSetThreadData(ps->current, 0);
 
-    case MPR_POOL_THREAD_PRUNED:
-        /* Don't put on a queue and the thread will exit */
-        
-    default:
-        break;
-    }
-    
-    pt->state = state;
-
-    if (lp) {
-        if (mprAddItem(lp, pt) < 0) {
-            mprUnlock(ps->mutex);
-            return MPR_ERR_NO_MEMORY;
-        }
-    }
-    mprUnlock(ps->mutex);
+    /*
+     *  After this, the thread structure may be reused by createPoolThread. Don't touch pt again.
+     */
+    mprSpinLock(pt->spin);
+    pt->state = MPR_POOL_THREAD_EXITED;
+    mprSpinUnlock(pt->spin);
 
-    return 0;
+    mprSpinLock(ps->spin);
+    ps->numThreads--;
+    mprSpinUnlock(ps->spin);
 }
 
 
-
 #else
 void __dummyMprPool() {}
 #endif /* BLD_FEATURE_MULTITHREAD */
@@ -14894,10 +15938,19 @@ int mprWaitForSingleIO(MprWaitHandler *wp, int fd, int mask, int timeout)
 }
 
 
+#if !BLD_FEATURE_EPOLL
+int mprWaitForIO(MprWaitService *ws, int timeout)
+{
+    return mprWaitForSelectIO(ws, timeout);
+}
+#endif
+
+
 /*
  *  Wait for I/O on all registered file descriptors. Timeout is in milliseconds. Return the number of events detected.
+ *  Linux builds use this if epoll can't be initialized.
  */
-int mprWaitForIO(MprWaitService *ws, int timeout)
+int mprWaitForSelectIO(MprWaitService *ws, int timeout)
 {
     MprWaitHandler  *wp;
     int             count, index, lastChange;
@@ -15126,65 +16179,396 @@ static void growFds(MprWaitService *ws)
             /*  Global memory allocation handler will handle this */
             return;
         }
-        memset(&ws->fds[ws->fdsSize], 0, (len - ws->fdsSize) * sizeof(struct pollfd));
-        ws->fdsSize = len;
+        memset(&ws->fds[ws->fdsSize], 0, (len - ws->fdsSize) * sizeof(struct pollfd));
+        ws->fdsSize = len;
+    }
+}
+
+
+/*
+ *  Set a handler to be recalled without further I/O
+ */
+void mprRecallWaitHandler(MprWaitHandler *wp)
+{
+    MprWaitService  *ws;
+
+    ws = wp->waitService;
+
+    /*
+     *  No locking needed, order important
+     */
+    wp->flags |= MPR_WAIT_RECALL_HANDLER;
+    ws->flags |= MPR_NEED_RECALL;
+
+    mprAwakenWaitService(wp->waitService);
+}
+
+
+/*
+ *  Modify a handler's interested events
+ */
+void mprSetWaitInterest(MprWaitHandler *wp, int mask)
+{
+    MprWaitService  *ws;
+
+    ws = wp->waitService;
+    mprLock(ws->mutex);
+	wp->desiredMask = mask;
+	mprModifyWaitHandler(ws, wp, 1);
+    mprUnlock(ws->mutex);
+}
+
+
+void mprDisableWaitEvents(MprWaitHandler *wp, bool wakeUp)
+{
+    /*  TODO -- better if we locked just our io handler  */
+    mprLock(wp->waitService->mutex);
+    wp->disableMask = 0;
+    mprModifyWaitHandler(wp->waitService, wp, wakeUp);
+    mprUnlock(wp->waitService->mutex);
+}
+
+
+void mprEnableWaitEvents(MprWaitHandler *wp, bool wakeUp)
+{
+    mprLock(wp->waitService->mutex);
+    wp->disableMask = -1;
+    mprModifyWaitHandler(wp->waitService, wp, wakeUp);
+    mprUnlock(wp->waitService->mutex);
+}
+
+#endif /* BLD_UNIX_LIKE */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
+/************************************************************************/
+/*
+ *  End of file "../mprSelectWait.c"
+ */
+/************************************************************************/
+
+
+
+/************************************************************************/
+/*
+ *  Start of file "../mprEpollWait.c"
+ */
+/************************************************************************/
+
+/**
+ *  mprEpollWait.c - Wait for I/O by using epoll on Linux.
+ *
+ *  Descriptors are registered with the kernel individually as handler masks change, so a wait costs nothing per idle
+ *  descriptor and only ready handlers are dispatched. Registration is level triggered to preserve the semantics
+ *  of the poll backend in mprSelectWait.c which still provides the single descriptor wait, wakeup pipe and
+ *  interest routines. The poll backend is also used if epoll can't be initialized. This module is thread-safe.
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+
+
+#if BLD_FEATURE_EPOLL
+
+static int  getFdMask(MprWaitService *ws, int fd);
+static void serviceEpollIO(MprWaitService *ws, int count, int lastChange);
+
+
+/*
+ *  Create the epoll descriptor. The wakeup pipe must already exist. If this fails, the wait service uses the poll
+ *  backend in mprSelectWait.c instead.
+ */
+int mprInitEpollWait(MprWaitService *ws)
+{
+    struct epoll_event  ev;
+
+    if ((ws->epfd = epoll_create(MPR_EPOLL_EVENTS)) < 0) {
+        return MPR_ERR_CANT_INITIALIZE;
+    }
+    fcntl(ws->epfd, F_SETFD, FD_CLOEXEC);
+
+    /*
+     *  The wakeup pipe is the only descriptor registered without a handler
+     */
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = ws->breakPipe[MPR_READ_PIPE];
+
+    ws->events = (struct epoll_event*) mprAlloc(ws, MPR_EPOLL_EVENTS * sizeof(struct epoll_event));
+    if (ws->events == 0 || epoll_ctl(ws->epfd, EPOLL_CTL_ADD, ws->breakPipe[MPR_READ_PIPE], &ev) < 0) {
+        close(ws->epfd);
+        ws->epfd = -1;
+        return MPR_ERR_CANT_INITIALIZE;
+    }
+    return 0;
+}
+
+
+/*
+ *  Add a handler to the descriptor table. Handlers that share a descriptor are chained. Must be called with the wait
+ *  service locked.
+ */
+int mprAddEpollHandler(MprWaitService *ws, MprWaitHandler *wp)
+{
+    MprWaitHandler  **fdHandlers;
+    int             size;
+
+    if (ws->epfd < 0 || wp->fd < 0) {
+        return 0;
+    }
+    if (wp->fd >= ws->fdHandlersSize) {
+        size = max(wp->fd + 1, ws->fdHandlersSize * 2);
+        size = max(size, MPR_EPOLL_EVENTS);
+        fdHandlers = (MprWaitHandler**) mprRealloc(ws, ws->fdHandlers, size * sizeof(MprWaitHandler*));
+        if (fdHandlers == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        memset(&fdHandlers[ws->fdHandlersSize], 0, (size - ws->fdHandlersSize) * sizeof(MprWaitHandler*));
+        ws->fdHandlers = fdHandlers;
+        ws->fdHandlersSize = size;
+    }
+    wp->epollMask = 0;
+    wp->nextFd = ws->fdHandlers[wp->fd];
+    ws->fdHandlers[wp->fd] = wp;
+    return 0;
+}
+
+
+/*
+ *  Remove a handler from the descriptor table and drop its events. Must be called with the wait service locked.
+ */
+void mprRemoveEpollHandler(MprWaitService *ws, MprWaitHandler *wp)
+{
+    MprWaitHandler  **link;
+
+    if (ws->epfd < 0 || wp->fd < 0 || wp->fd >= ws->fdHandlersSize) {
+        return;
+    }
+    mprSetWaitEvents(ws, wp, 0);
+    for (link = &ws->fdHandlers[wp->fd]; *link; link = &(*link)->nextFd) {
+        if (*link == wp) {
+            *link = wp->nextFd;
+            break;
+        }
+    }
+    wp->nextFd = 0;
+}
+
+
+/*
+ *  Update the events a handler waits for. Mask is the set of MPR_READABLE and MPR_WRITEABLE events. Epoll has one
+ *  registration per descriptor, so the registration is the union of the masks of all handlers on the descriptor. An
+ *  empty union removes the descriptor entirely as epoll always reports hangup and error conditions.
+ *  Must be called with the wait service locked.
+ */
+void mprSetWaitEvents(MprWaitService *ws, MprWaitHandler *wp, int mask)
+{
+    struct epoll_event  ev;
+    int                 fd, oldMask, newMask, op;
+
+    mask &= (MPR_READABLE | MPR_WRITEABLE);
+    fd = wp->fd;
+    if (ws->epfd < 0 || fd < 0 || mask == wp->epollMask) {
+        return;
+    }
+    oldMask = getFdMask(ws, fd);
+    wp->epollMask = mask;
+    if ((newMask = getFdMask(ws, fd)) == oldMask) {
+        return;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    if (newMask & MPR_READABLE) {
+        ev.events |= EPOLLIN;
+    }
+    if (newMask & MPR_WRITEABLE) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.fd = fd;
+
+    if (newMask == 0) {
+        op = EPOLL_CTL_DEL;
+    } else if (oldMask == 0) {
+        op = EPOLL_CTL_ADD;
+    } else {
+        op = EPOLL_CTL_MOD;
+    }
+    if (epoll_ctl(ws->epfd, op, fd, &ev) < 0) {
+        if (op == EPOLL_CTL_ADD && errno == EEXIST) {
+            epoll_ctl(ws->epfd, EPOLL_CTL_MOD, fd, &ev);
+        } else if (op == EPOLL_CTL_MOD && errno == ENOENT) {
+            /*
+             *  The descriptor was closed, which drops it from the epoll set, and the number has been reused
+             */
+            epoll_ctl(ws->epfd, EPOLL_CTL_ADD, fd, &ev);
+        } else if (op != EPOLL_CTL_DEL) {
+            /*
+             *  A failed delete means the descriptor is already closed and the kernel has dropped it
+             */
+            mprLog(ws, 5, "io: Can't update epoll registration for fd %d, errno %d", fd, errno);
+        }
+    }
+}
+
+
+/*
+ *  Return the events registered for a descriptor by all its handlers
+ */
+static int getFdMask(MprWaitService *ws, int fd)
+{
+    MprWaitHandler  *wp;
+    int             mask;
+
+    mask = 0;
+    if (fd < ws->fdHandlersSize) {
+        for (wp = ws->fdHandlers[fd]; wp; wp = wp->nextFd) {
+            mask |= wp->epollMask;
+        }
     }
+    return mask;
 }
 
 
 /*
- *  Set a handler to be recalled without further I/O
+ *  Wait for I/O on all registered file descriptors. Timeout is in milliseconds. Return the number of events detected.
  */
-void mprRecallWaitHandler(MprWaitHandler *wp)
+int mprWaitForIO(MprWaitService *ws, int timeout)
 {
-    MprWaitService  *ws;
+    MprWaitHandler  *wp;
+    int             count, index, lastChange;
 
-    ws = wp->waitService;
+    if (ws->epfd < 0) {
+        return mprWaitForSelectIO(ws, timeout);
+    }
+    if (ws->flags & MPR_NEED_RECALL) {
 
-    /*
-     *  No locking needed, order important
-     */
-    wp->flags |= MPR_WAIT_RECALL_HANDLER;
-    ws->flags |= MPR_NEED_RECALL;
+        mprLock(ws->mutex);
+        ws->flags &= ~MPR_NEED_RECALL;
+        lastChange = ws->listGeneration;
 
-    mprAwakenWaitService(wp->waitService);
+        for (count = index = 0; (wp = (MprWaitHandler*) mprGetNextItem(ws->list, &index)) != 0; ) {
+            if (wp->flags & MPR_WAIT_RECALL_HANDLER) {
+                count++;
+
+                mprUnlock(ws->mutex);
+                mprInvokeWaitCallback(wp, 0);
+                mprLock(ws->mutex);
+
+                if (lastChange != ws->listGeneration) {
+                    index = 0;
+                }
+            }
+        }
+        mprUnlock(ws->mutex);
+
+    } else {
+        lastChange = ws->listGeneration;
+        if ((count = epoll_wait(ws->epfd, ws->events, MPR_EPOLL_EVENTS, timeout)) > 0) {
+            serviceEpollIO(ws, count, lastChange);
+        }
+    }
+    return count;
 }
 
 
 /*
- *  Modify a handler's interested events
+ *  Service the ready events. Each event carries its descriptor and the descriptor table gives its handlers, so no
+ *  search of the handler list is required. If the handler list changes, a ready descriptor may have been closed and
+ *  its number reused, so the rest of the events are left for the next wait. They are level triggered and will be
+ *  reported again.
  */
-void mprSetWaitInterest(MprWaitHandler *wp, int mask)
+static void serviceEpollIO(MprWaitService *ws, int count, int lastChange)
 {
-    MprWaitService  *ws;
+    MprWaitHandler      *wp, *next;
+    struct epoll_event  *ev;
+    int                 i, fd, mask;
 
-    ws = wp->waitService;
     mprLock(ws->mutex);
-	wp->desiredMask = mask;
-	mprModifyWaitHandler(ws, wp, 1);
-    mprUnlock(ws->mutex);
-}
 
+    for (i = 0; i < count && lastChange == ws->listGeneration; i++) {
+        ev = &ws->events[i];
+        fd = ev->data.fd;
 
-void mprDisableWaitEvents(MprWaitHandler *wp, bool wakeUp)
-{
-    /*  TODO -- better if we locked just our io handler  */
-    mprLock(wp->waitService->mutex);
-    wp->disableMask = 0;
-    mprModifyWaitHandler(wp->waitService, wp, wakeUp);
-    mprUnlock(wp->waitService->mutex);
-}
+        if (fd == ws->breakPipe[MPR_READ_PIPE]) {
+            char    buf[128];
+            read(ws->breakPipe[MPR_READ_PIPE], buf, sizeof(buf));
+            ws->flags &= ~MPR_BREAK_REQUESTED;
+            continue;
+        }
+        if (fd >= ws->fdHandlersSize) {
+            continue;
+        }
+        for (wp = ws->fdHandlers[fd]; wp && lastChange == ws->listGeneration; wp = next) {
+            next = wp->nextFd;
+
+            mask = 0;
+            if (ev->events & (EPOLLHUP | EPOLLERR)) {
+                mask = wp->epollMask;
+            }
+            if ((wp->desiredMask & MPR_READABLE) && ev->events & EPOLLIN) {
+                mask |= MPR_READABLE;
+            }
+            if ((wp->desiredMask & MPR_WRITEABLE) && ev->events & EPOLLOUT) {
+                mask |= MPR_WRITEABLE;
+            }
+            /*
+             *  Ignore events for handlers disabled since the wait returned
+             */
+            mask &= wp->epollMask;
+            if (mask == 0) {
+                continue;
+            }
+
+#if BLD_FEATURE_MULTITHREAD
+            /*
+             *  Disable events to prevent recursive I/O events. Callback must call mprEnableWaitEvents
+             */
+            wp->disableMask = 0;
+            mprSetWaitEvents(ws, wp, 0);
+#endif
+            /*
+             *  Present mask is only cleared after the io handler callback has completed
+             */
+            wp->presentMask = mask;
 
+            mprUnlock(ws->mutex);
+            mprInvokeWaitCallback(wp, 0);
+            mprLock(ws->mutex);
+        }
+    }
 
-void mprEnableWaitEvents(MprWaitHandler *wp, bool wakeUp)
-{
-    mprLock(wp->waitService->mutex);
-    wp->disableMask = -1;
-    mprModifyWaitHandler(wp->waitService, wp, wakeUp);
-    mprUnlock(wp->waitService->mutex);
+    mprUnlock(ws->mutex);
 }
 
-#endif /* BLD_UNIX_LIKE */
+#endif /* BLD_FEATURE_EPOLL */
+
 
 /*
  *  @copy   default
@@ -15216,8 +16600,9 @@ void mprEnableWaitEvents(MprWaitHandler *wp, bool wakeUp)
  *  @end
  */
 /************************************************************************/
+/************************************************************************/
 /*
- *  End of file "../mprSelectWait.c"
+ *  End of file "../mprEpollWait.c"
  */
 /************************************************************************/
 
@@ -15250,6 +16635,15 @@ void mprEnableWaitEvents(MprWaitHandler *wp, bool wakeUp)
 #define BLD_HAS_GETADDRINFO 1
 //#endif
 
+/*
+ *  Where supported, corked writes pass MSG_MORE so the kernel holds partial frames without extra system calls
+ */
+#if defined(MSG_MORE)
+    #define MPR_MSG_MORE MSG_MORE
+#else
+    #define MPR_MSG_MORE 0
+#endif
+
 
 static void acceptHandler(void *sp, int mask, bool isPoolThread);
 static MprSocket *acceptSocket(MprSocket *sp, bool invokeCallback);
@@ -15445,10 +16839,20 @@ MprSocket *mprCreateSocket(MprCtx ctx, struct MprSsl *ssl)
         mprAssert(ss->standardProvider->createSocket);
         sp = ss->standardProvider->createSocket(ctx, NULL);
     }
+    if (sp) {
+        sp->waitService = mprGetMpr(ctx)->waitService;
+    }
     return sp;
 }
 
 
+void mprSetSocketWaitService(MprSocket *sp, MprWaitService *ws)
+{
+    mprAssert(sp->handler == 0);
+    sp->waitService = ws;
+}
+
+
 static int socketDestructor(MprSocket *sp)
 {
     mprLock(sp->mutex);
@@ -15525,7 +16929,7 @@ static int listenSocket(MprSocket *sp, cchar *host, int port, MprSocketAcceptPro
 
     sp->flags = (initialFlags &
         (MPR_SOCKET_BROADCAST | MPR_SOCKET_DATAGRAM | MPR_SOCKET_BLOCK |
-         MPR_SOCKET_LISTENER | MPR_SOCKET_NOREUSE | MPR_SOCKET_NODELAY | MPR_SOCKET_THREAD));
+         MPR_SOCKET_LISTENER | MPR_SOCKET_NOREUSE | MPR_SOCKET_NODELAY | MPR_SOCKET_THREAD | MPR_SOCKET_REUSEPORT));
 
     datagram = sp->flags & MPR_SOCKET_DATAGRAM;
 
@@ -15554,6 +16958,15 @@ static int listenSocket(MprSocket *sp, cchar *host, int port, MprSocketAcceptPro
         rc = 1;
         setsockopt(sp->fd, SOL_SOCKET, SO_REUSEADDR, (char*) &rc, sizeof(rc));
     }
+#if defined(SO_REUSEPORT)
+    if (sp->flags & MPR_SOCKET_REUSEPORT) {
+        /*
+         *  Allow several listeners (one per reactor) on the same port. The kernel balances connections across them.
+         */
+        rc = 1;
+        setsockopt(sp->fd, SOL_SOCKET, SO_REUSEPORT, (char*) &rc, sizeof(rc));
+    }
+#endif
 #endif
 
     rc = bind(sp->fd, addr, addrlen);
@@ -15576,7 +16989,8 @@ static int listenSocket(MprSocket *sp, cchar *host, int port, MprSocketAcceptPro
             mprUnlock(sp->mutex);
             return MPR_ERR_CANT_OPEN;
         }
-        sp->handler = mprCreateWaitHandler(sp, sp->fd, MPR_SOCKET_READABLE, (MprWaitProc) acceptHandler,
+        sp->handler = mprCreateServiceWaitHandler(sp->waitService, sp, sp->fd, MPR_SOCKET_READABLE, 
+            (MprWaitProc) acceptHandler,
             (void*) sp, sp->handlerPriority, (sp->flags & MPR_SOCKET_THREAD) ? MPR_WAIT_THREAD : 0);
     }
     sp->handlerMask |= MPR_SOCKET_READABLE;
@@ -15733,7 +17147,7 @@ static void closeSocket(MprSocket *sp, bool gracefully)
 
     mprAssert(sp->fd >= 0);
 
-    waitService = mprGetMpr(sp)->waitService;
+    waitService = sp->waitService;
 
     mprLock(sp->mutex);
 
@@ -15876,6 +17290,7 @@ static MprSocket *acceptSocket(MprSocket *listen, bool invokeCallback)
     nsp->flags = listen->flags;
     nsp->flags &= ~MPR_SOCKET_LISTENER;
     nsp->listenSock = listen;
+    nsp->waitService = listen->waitService;
 
     mprSetSocketBlockingMode(nsp, (nsp->flags & MPR_SOCKET_BLOCK) ? 1: 0);
 
@@ -16011,7 +17426,7 @@ static int writeSocket(MprSocket *sp, void *buf, int bufsize)
 {
     struct sockaddr     *addr;
     socklen_t           addrlen;
-    int                 family, sofar, errCode, len, written;
+    int                 family, sofar, errCode, len, written, flags;
 
     mprAssert(buf);
     mprAssert(bufsize >= 0);
@@ -16032,12 +17447,13 @@ static int writeSocket(MprSocket *sp, void *buf, int bufsize)
         errCode = 0;
         len = bufsize;
         sofar = 0;
+        flags = (sp->flags & MPR_SOCKET_CORK) ? (MSG_NOSIGNAL | MPR_MSG_MORE) : MSG_NOSIGNAL;
         while (len > 0) {
             if ((sp->flags & MPR_SOCKET_BROADCAST) || (sp->flags & MPR_SOCKET_DATAGRAM)) {
                 written = sendto(sp->fd, &((char*) buf)[sofar], len, MSG_NOSIGNAL, addr, addrlen);
 
             } else {
-                written = send(sp->fd, &((char*) buf)[sofar], len, MSG_NOSIGNAL);
+                written = send(sp->fd, &((char*) buf)[sofar], len, flags);
             }
 
             if (written < 0) {
@@ -16060,6 +17476,22 @@ static int writeSocket(MprSocket *sp, void *buf, int bufsize)
 }
 
 
+#if BLD_UNIX_LIKE && defined(MSG_MORE)
+/*
+ *  Vectored write that tells the kernel more data will follow so it can hold back a partial frame
+ */
+static int sendVectorMore(MprSocket *sp, MprIOVec *iovec, int count)
+{
+    struct msghdr   msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = (struct iovec*) iovec;
+    msg.msg_iovlen = count;
+    return (int) sendmsg(sp->fd, &msg, MSG_NOSIGNAL | MSG_MORE);
+}
+#endif
+
+
 /*
  *  Write a string to the socket
  */
@@ -16076,6 +17508,11 @@ int mprWriteSocketVector(MprSocket *sp, MprIOVec *iovec, int count)
 
 #if BLD_UNIX_LIKE
     if (sp->ssl == 0) {
+#if defined(MSG_MORE)
+        if (sp->flags & MPR_SOCKET_CORK) {
+            return sendVectorMore(sp, iovec, count);
+        }
+#endif
         return writev(sp->fd, (const struct iovec*) iovec, count);
     } else
 #endif
@@ -16176,6 +17613,14 @@ MprOffset mprSendFileToSocket(MprFile *file, MprSocket *sock, MprOffset offset,
          *  I/O requests may return short (write fewer than requested bytes).
          */
         if (beforeCount > 0) {
+#if BLD_UNIX_LIKE && defined(MSG_MORE)
+            /*
+             *  Let the headers share a frame with the start of the file data
+             */
+            if (toWriteFile > 0 && sock->ssl == 0) {
+                rc = sendVectorMore(sock, beforeVec, beforeCount);
+            } else
+#endif
             rc = mprWriteSocketVector(sock, beforeVec, beforeCount);
             if (rc > 0) {
                 written += rc;
@@ -16265,8 +17710,8 @@ void mprSetSocketCallback(MprSocket *sp, MprSocketProc fn, void *data, void *dat
     sp->handlerPriority = pri;
     sp->handlerMask = mask;
 
-    sp->handler = mprCreateWaitHandler(sp, sp->fd, sp->handlerMask, (MprWaitProc) ioProc, (void*) sp, sp->handlerPriority, 
-        (sp->flags & MPR_SOCKET_THREAD) ? MPR_WAIT_THREAD : 0);
+    sp->handler = mprCreateServiceWaitHandler(sp->waitService, sp, sp->fd, sp->handlerMask, (MprWaitProc) ioProc, 
+        (void*) sp, sp->handlerPriority, (sp->flags & MPR_SOCKET_THREAD) ? MPR_WAIT_THREAD : 0);
 
 #if UNUSED
     mprSetSocketEventMask(sp, sp->handlerMask);
@@ -16375,6 +17820,44 @@ int mprSetSocketNoDelay(MprSocket *sp, bool on)
 }
 
 
+/*
+ *  Set the socket cork mode. While corked, partial frames are held back so consecutive writes coalesce into full
+ *  segments. Where MSG_MORE is supported, corking is applied per write and held data is released by the next 
+ *  uncorked write. Otherwise TCP_CORK or TCP_NOPUSH is used and uncorking releases held data immediately.
+ */
+int mprSetSocketCork(MprSocket *sp, bool on)
+{
+    int     oldCork;
+
+    mprLock(sp->mutex);
+
+    oldCork = (sp->flags & MPR_SOCKET_CORK) ? 1 : 0;
+    if (oldCork == (on ? 1 : 0)) {
+        mprUnlock(sp->mutex);
+        return oldCork;
+    }
+    if (on) {
+        sp->flags |= MPR_SOCKET_CORK;
+    } else {
+        sp->flags &= ~(MPR_SOCKET_CORK);
+    }
+#if !defined(MSG_MORE) && (defined(TCP_CORK) || defined(TCP_NOPUSH))
+    {
+        int     cork;
+        cork = on ? 1 : 0;
+#if defined(TCP_CORK)
+        setsockopt(sp->fd, IPPROTO_TCP, TCP_CORK, (char*) &cork, sizeof(int));
+#else
+        setsockopt(sp->fd, IPPROTO_TCP, TCP_NOPUSH, (char*) &cork, sizeof(int));
+#endif
+    }
+#endif
+    mprUnlock(sp->mutex);
+
+    return oldCork;
+}
+
+
 /*
  *  Get the port number
  */
@@ -16420,8 +17903,8 @@ void mprSetSocketEventMask(MprSocket *sp, int handlerMask)
             mprSetWaitInterest(sp->handler, handlerMask);
 
         } else {
-            sp->handler = mprCreateWaitHandler(sp, sp->fd, handlerMask, (MprWaitProc) ioProc, (void*) sp, 
-                sp->handlerPriority, (sp->flags & MPR_SOCKET_THREAD) ? MPR_WAIT_THREAD : 0);
+            sp->handler = mprCreateServiceWaitHandler(sp->waitService, sp, sp->fd, handlerMask, (MprWaitProc) ioProc, 
+                (void*) sp, sp->handlerPriority, (sp->flags & MPR_SOCKET_THREAD) ? MPR_WAIT_THREAD : 0);
         }
 
     } else if (sp->handler) {
@@ -21601,7 +23084,7 @@ char *mprValidateUrl(char *url)
  *
  *  This module provides wait management for sockets and other file descriptors and allows users to create wait
  *  handlers which will be called when wait events are detected. Multiple backends (one at a time) are supported.
- *  The only current backend is mprSelectWait.c
+ *  Linux uses mprEpollWait.c, other Unix systems use mprSelectWait.c
  *
  *  This module is thread-safe.
  *
@@ -21642,7 +23125,23 @@ MprWaitService *mprCreateWaitService(Mpr *mpr)
     ws->mutex = mprCreateLock(ws);
 #endif
 
+#if BLD_FEATURE_EPOLL
+    ws->epfd = -1;
+#endif
+#if BLD_UNIX_LIKE
+    if (mprInitSelectWait(ws) < 0) {
+        mprError(ws, "io: Can't initialize wait service");
+        mprFree(ws);
+        return 0;
+    }
+#else
     mprInitSelectWait(ws);
+#endif
+#if BLD_FEATURE_EPOLL
+    if (mprInitEpollWait(ws) < 0) {
+        mprError(ws, "io: Can't initialize epoll, using poll to wait for I/O");
+    }
+#endif
     return ws;
 }
 
@@ -21652,6 +23151,12 @@ MprWaitService *mprCreateWaitService(Mpr *mpr)
  */
 static int serviceDestructor(MprWaitService *ws)
 {
+#if BLD_FEATURE_EPOLL
+    if (ws->epfd >= 0) {
+        close(ws->epfd);
+        ws->epfd = -1;
+    }
+#endif
     return 0;
 }
 
@@ -21705,6 +23210,14 @@ int mprInsertWaitHandler(MprWaitService *ws, MprWaitHandler *wp)
         mprUnlock(ws->mutex);
         return MPR_ERR_NO_MEMORY;
     }
+#if BLD_FEATURE_EPOLL
+    if (mprAddEpollHandler(ws, wp) < 0) {
+        mprRemoveItem(ws->list, wp);
+        mprUnlock(ws->mutex);
+        return MPR_ERR_NO_MEMORY;
+    }
+    mprSetWaitEvents(ws, wp, (wp->proc) ? (wp->desiredMask & wp->disableMask) : 0);
+#endif
     ws->listGeneration++;
     ws->maskGeneration++;
     mprUnlock(ws->mutex);
@@ -21723,6 +23236,9 @@ void mprRemoveWaitHandler(MprWaitService *ws, MprWaitHandler *wp)
     mprLock(ws->mutex);
 
     mprRemoveItem(ws->list, wp);
+#if BLD_FEATURE_EPOLL
+    mprRemoveEpollHandler(ws, wp);
+#endif
 
     ws->listGeneration++;
     ws->maskGeneration++;
@@ -21741,6 +23257,16 @@ int mprModifyWaitHandler(MprWaitService *ws, MprWaitHandler *wp, bool wakeUp)
 {
     mprLock(ws->mutex);
     ws->maskGeneration++;
+#if BLD_FEATURE_EPOLL
+    if (ws->epfd >= 0) {
+        /*
+         *  Epoll registrations are updated in place and take effect in a pending wait, so no wakeup is required
+         */
+        mprSetWaitEvents(ws, wp, (wp->proc) ? (wp->desiredMask & wp->disableMask) : 0);
+        mprUnlock(ws->mutex);
+        return 0;
+    }
+#endif
     mprUnlock(ws->mutex);
 
     if (wakeUp) {
@@ -21755,13 +23281,21 @@ int mprModifyWaitHandler(MprWaitService *ws, MprWaitHandler *wp, bool wakeUp)
  */
 MprWaitHandler *mprCreateWaitHandler(MprCtx ctx, int fd, int mask, MprWaitProc proc, void *data, int pri, int flags)
 {
-    MprWaitService  *ws;
+    return mprCreateServiceWaitHandler(mprGetMpr(ctx)->waitService, ctx, fd, mask, proc, data, pri, flags);
+}
+
+
+/*
+ *  Create a handler on a specific wait service (reactor)
+ */
+MprWaitHandler *mprCreateServiceWaitHandler(MprWaitService *ws, MprCtx ctx, int fd, int mask, MprWaitProc proc, 
+        void *data, int pri, int flags)
+{
     MprWaitHandler  *wp;
 
+    mprAssert(ws);
     mprAssert(fd >= 0);
 
-    ws = mprGetMpr(ctx)->waitService;
-
     wp = mprAllocObjWithDestructorZeroed(ws, MprWaitHandler, handlerDestructor);
     if (wp == 0) {
         return 0;
@@ -21849,6 +23383,133 @@ void mprSetWaitServiceThread(MprWaitService *ws, MprThread *thread)
 {
     ws->serviceThread = thread;
 }
+
+
+/*
+ *  Bind the current thread to a CPU. Best effort only.
+ */
+static void pinReactor(MprWaitService *ws, int index)
+{
+#if LINUX && defined(SYS_sched_setaffinity)
+    ulong   mask[16];
+    int     cpu, bits;
+
+    cpu = index % max(mprGetAllocStats(ws)->numCpu, 1);
+    bits = (int) (sizeof(ulong) * 8);
+    if (cpu >= (int) (sizeof(mask) * 8)) {
+        return;
+    }
+    memset(mask, 0, sizeof(mask));
+    mask[cpu / bits] = 1UL << (cpu % bits);
+    if (syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask) < 0) {
+        mprLog(ws, 3, "io: Can't bind reactor %d to cpu %d", index, cpu);
+    }
+#endif
+}
+
+
+/*
+ *  Thread main for a reactor. I/O callbacks are dispatched as usual (via the pool when threads are available).
+ *  Timers and events continue to be serviced by mprServiceEvents.
+ */
+static void reactorMain(MprWaitService *ws, MprThread *tp)
+{
+    Mpr     *mpr;
+    int     index;
+
+    mpr = mprGetMpr(ws);
+    mprSetWaitServiceThread(ws, tp);
+
+    for (index = 1; index < mpr->reactorCount; index++) {
+        if (mpr->reactors[index] == ws) {
+            pinReactor(ws, index);
+            break;
+        }
+    }
+    while (!mprIsExiting(ws)) {
+        mprWaitForIO(ws, MPR_TIMEOUT_REACTOR);
+    }
+}
+
+
+int mprStartReactors(MprCtx ctx, int count)
+{
+    Mpr             *mpr;
+    MprWaitService  *ws;
+    MprThread       *tp;
+    char            name[16];
+    int             i;
+
+    mpr = mprGetMpr(ctx);
+    if (mpr->reactorCount > 0) {
+        return MPR_ERR_BAD_STATE;
+    }
+    if (count <= 1) {
+        return 0;
+    }
+    mpr->reactors = (MprWaitService**) mprAllocZeroed(mpr, count * sizeof(MprWaitService*));
+    if (mpr->reactors == 0) {
+        return MPR_ERR_NO_MEMORY;
+    }
+    mpr->reactors[0] = mpr->waitService;
+
+    for (i = 1; i < count; i++) {
+        if ((ws = mprCreateWaitService(mpr)) == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        mprSprintf(name, sizeof(name), "reactor.%d", i);
+        tp = mprCreateThread(mpr, name, (MprThreadProc) reactorMain, ws, MPR_EVENT_PRIORITY, 0);
+        if (tp == 0) {
+            return MPR_ERR_CANT_CREATE;
+        }
+        mpr->reactors[i] = ws;
+        mpr->reactorCount = i + 1;
+        if (mprStartThread(tp) < 0) {
+            return MPR_ERR_CANT_CREATE;
+        }
+    }
+    mprLog(mpr, MPR_CONFIG, "Started %d reactors", count);
+    return 0;
+}
+
+
+MprWaitService *mprGetReactor(MprCtx ctx, int index)
+{
+    Mpr     *mpr;
+
+    mpr = mprGetMpr(ctx);
+    if (mpr->reactorCount <= 1) {
+        return mpr->waitService;
+    }
+    if (index < 0) {
+        index = -index;
+    }
+    return mpr->reactors[index % mpr->reactorCount];
+}
+
+
+int mprGetReactorCount(MprCtx ctx)
+{
+    return max(mprGetMpr(ctx)->reactorCount, 1);
+}
+
+#else
+int mprStartReactors(MprCtx ctx, int count)
+{
+    return (count <= 1) ? 0 : MPR_ERR_NOT_READY;
+}
+
+
+MprWaitService *mprGetReactor(MprCtx ctx, int index)
+{
+    return mprGetMpr(ctx)->waitService;
+}
+
+
+int mprGetReactorCount(MprCtx ctx)
+{
+    return 1;
+}
 #endif
 
 
@@ -22096,6 +23757,7 @@ static int parseNext(MprXml *xp, int state)
                 /*
                  *  Must be an attribute name
                  */
+                mprFree(aname);
                 aname = mprStrdup(xp, mprGetBufStart(tokBuf));
                 token = getToken(xp, state);
                 if (token != MPR_XMLTOK_EQ) {
@@ -22212,7 +23874,8 @@ static int parseNext(MprXml *xp, int state)
                 xmlError(xp, "Syntax error");
                 goto err;
             }
-            return 1;
+            rc = 1;
+            goto exit;
 
         case MPR_XML_EOF:       /* ---------------------------------------------- */
             goto exit;
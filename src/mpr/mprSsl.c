@@ -4974,6 +4974,7 @@ typedef struct MprSocket {
 
     struct MprSslSocket *sslSocket;     /**< Extended ssl socket state. If set, then using ssl */
     struct MprSsl   *ssl;               /**< SSL configuration */
+    struct MprWaitService *waitService; /**< Wait service (reactor) detecting I/O for this socket */
 } MprSocket;
 
 
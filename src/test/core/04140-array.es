@@ -127,6 +127,13 @@ b = a.map(function (e) { return e + 10; })
 a = [ 1, 2, 3 ]
 assert(a.push(7, 8, 9) == 6)
 
+a = []
+for (i = 0; i < 2000; i++) {
+    a.push(i)
+}
+assert(a.length == 2000)
+assert(a[1999] == 1999)
+
 
 /*
  *	pop
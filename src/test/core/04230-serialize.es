@@ -0,0 +1,149 @@
+/*
+ *	Test serialize / deserialize of object literals
+ */
+
+/*
+ *	Strict JSON input with quoted keys
+ */
+o = deserialize('{"name": "Peter", "age": 27, "tags": ["a", "b"], "address": {"city": "Seattle"}}')
+assert(o.name == "Peter")
+assert(o.age == 27)
+assert(o.tags.length == 2)
+assert(o.tags[1] == "b")
+assert(o.address.city == "Seattle")
+
+
+/*
+ *	Relaxed literals: bare keys, single quotes and trailing commas
+ */
+o = deserialize("{ name: 'Peter', list: [1, 2, 3,], flag: true, nothing: null, }")
+assert(o.name == "Peter")
+assert(o.list.length == 3)
+assert(o.list[2] == 3)
+assert(o.flag == true)
+assert(o.nothing == null)
+
+
+/*
+ *	Escapes round trip
+ */
+src = { text: 'quote " backslash \\ newline \n tab \t end' }
+copy = deserialize(serialize(src))
+assert(copy.text == src.text)
+
+o = deserialize('{ "u": "\\u0041\\u00e9" }')
+assert(o.u.length == 3)
+assert(o.u[0] == "A")
+
+
+/*
+ *	Strings longer than the old token limit
+ */
+big = ""
+for (i = 0; i < 12; i++) {
+	big += "0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz"
+	big += big
+}
+assert(big.length > 65536)
+copy = deserialize(serialize({ data: big }))
+assert(copy.data.length == big.length)
+
+
+/*
+ *	Nested round trip
+ */
+src = { a: [ 1, { b: [ 2, { c: "deep" } ] } ] }
+copy = deserialize(serialize(src))
+assert(copy.a[1].b[1].c == "deep")
+
+
+/*
+ *	Input is not modified
+ */
+s = '{ name: "Peter" }'
+deserialize(s)
+assert(s == '{ name: "Peter" }')
+
+
+/*
+ *	Excessive nesting is rejected
+ */
+deep = ""
+for (i = 0; i < 2000; i++) {
+	deep += "["
+}
+caught = false
+try {
+	deserialize(deep)
+} catch (e) {
+	caught = true
+}
+assert(caught)
+
+
+/*
+ *	Keys that are not identifiers are quoted and round trip
+ */
+src = {}
+src["a:b"] = 1
+src['say "hi"'] = 2
+src["with space"] = 3
+src["9lives"] = 4
+src.plain = 5
+copy = deserialize(serialize(src))
+assert(copy["a:b"] == 1)
+assert(copy['say "hi"'] == 2)
+assert(copy["with space"] == 3)
+assert(copy["9lives"] == 4)
+assert(copy.plain == 5)
+assert(serialize(src).indexOf("plain:") >= 0)
+
+
+/*
+ *	Empty arrays stay arrays
+ */
+copy = deserialize(serialize({ list: [] }))
+assert(copy.list is Array)
+assert(copy.list.length == 0)
+
+
+/*
+ *	Trailing input after the value is rejected
+ */
+for each (bad in [ '{ a: 1 } x', '[1, 2] ]', '"str" "more"', '{ a: 1 }}' ]) {
+	caught = false
+	try {
+		deserialize(bad)
+	} catch (e) {
+		caught = true
+	}
+	assert(caught)
+}
+o = deserialize('  { a: 1 }  \n')
+assert(o.a == 1)
+
+
+/*
+ *	Many parsed objects with distinct keys
+ */
+for (i = 0; i < 2000; i++) {
+	o = deserialize('{ "key' + i + '": ' + i + ' }')
+	assert(o["key" + i] == i)
+}
+
+
+/*
+ *	Malformed literals are rejected: missing separators, missing values and truncated input
+ */
+for each (bad in [ '{a:1 b:2}', '{"a":}', '{"a": 1', '[1, 2', '[1 2]', '{"a": 1 "b": 2}', '{:1}', '{a 1}', '[1,,2]', 
+		'{"a": [1, 2}', '{a: {b: 1}' ]) {
+	caught = false
+	try {
+		deserialize(bad)
+	} catch (e) {
+		caught = true
+	}
+	assert(caught)
+}
+o = deserialize('{ a : 1 , b : [ 2 , 3 ] }')
+assert(o.a == 1 && o.b[1] == 3)
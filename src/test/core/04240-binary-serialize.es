@@ -0,0 +1,107 @@
+/*
+ *	Test binary serialize / deserialize
+ */
+
+/*
+ *	Round trip of core types
+ */
+src = { name: "Peter", age: 27, ratio: 0.25, big: 1e300, negative: -123456789, flag: true, off: false, 
+	nothing: null, list: [1, "two", [3]], when: new Date(1234567890000) }
+data = serialize(src, { binary: true })
+assert(data is ByteArray)
+copy = deserialize(data)
+assert(copy.name == "Peter")
+assert(copy.age == 27)
+assert(copy.ratio == 0.25)
+assert(copy.big == 1e300)
+assert(copy.negative == -123456789)
+assert(copy.flag == true)
+assert(copy.off == false)
+assert(copy.nothing == null)
+assert(copy.list.length == 3)
+assert(copy.list[1] == "two")
+assert(copy.list[2][0] == 3)
+assert(copy.when is Date)
+assert(String(copy.when) == String(src.when))
+
+
+/*
+ *	Scalars
+ */
+assert(deserialize(serialize("hello", { binary: true })) == "hello")
+assert(deserialize(serialize(42, { binary: true })) == 42)
+assert(deserialize(serialize(null, { binary: true })) == null)
+
+
+/*
+ *	Shared and cyclic references are preserved
+ */
+shared = { value: 7 }
+src = { a: shared, b: shared }
+src.self = src
+copy = deserialize(serialize(src, { binary: true }))
+assert(copy.a.value == 7)
+assert(copy.a === copy.b)
+assert(copy.self === copy)
+
+
+/*
+ *	Repeated strings are written once
+ */
+list = []
+for (i = 0; i < 100; i++) {
+	list.push({ color: "a rather long repeated string value" })
+}
+data = serialize(list, { binary: true })
+assert(data.available < 1000)
+copy = deserialize(data)
+assert(copy.length == 100)
+assert(copy[99].color == "a rather long repeated string value")
+
+
+/*
+ *	ByteArrays
+ */
+ba = new ByteArray(16)
+ba.writeByte(1)
+ba.writeByte(2)
+copy = deserialize(serialize({ bytes: ba }, { binary: true }))
+assert(copy.bytes is ByteArray)
+assert(copy.bytes.available == 2)
+assert(copy.bytes.readByte() == 1)
+
+
+/*
+ *	Depth option
+ */
+copy = deserialize(serialize({ a: { b: { c: 1 } } }, { binary: true, depth: 1 }))
+assert(copy.a != undefined)
+assert(copy.a.b == undefined)
+
+
+/*
+ *	Corrupt and truncated data is rejected
+ */
+data = serialize({ name: "Peter", list: [1, 2, 3] }, { binary: true })
+bad = new ByteArray(data.available)
+for (i = 0; i < data.available - 3; i++) {
+	bad.writeByte(data.readByte())
+}
+caught = false
+try {
+	deserialize(bad)
+} catch (e) {
+	caught = true
+}
+assert(caught)
+
+bad = new ByteArray(4)
+bad.writeByte(1)
+bad.writeByte(2)
+caught = false
+try {
+	deserialize(bad)
+} catch (e) {
+	caught = true
+}
+assert(caught)
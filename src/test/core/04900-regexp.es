@@ -60,6 +60,52 @@ if (Config.RegularExpressions) {
     assert(re.lastIndex == 0)
     assert(re.matched == "def")
 
+    /*
+     *  Repeated literals and string patterns share compiled programs but not match state
+     */
+    for (i = 0; i < 3; i++) {
+        re = /(x+)y/g
+        assert(re.lastIndex == 0)
+        assert(re.exec("axxy xy") == "xxy,xx")
+        assert(re.lastIndex == 4)
+        assert("a.b.c".split(/\./g).length == 3)
+        assert("aXbXc".match("X") == "X")
+    }
+    assert(new RegExp("def", "i").test("DEF"))
+    assert(!new RegExp("def").test("DEF"))
+
+    /*
+     *  Hot patterns are studied after repeated use. Results must not change.
+     */
+    for (i = 0; i < 20; i++) {
+        assert("one two three".replace(/t(\w+)/g, "<$1>") == "one <wo> <hree>")
+        assert("abc".search(/c/) == 2)
+    }
+
+    /*
+     *  Global empty matches must advance
+     */
+    assert("abc".replace(/x*/g, "-") == "-a-b-c-")
+    assert("abc".match(/x*/g).length == 4)
+    assert("abc".split(/x*/g) == "a,b,c")
+
+    /*
+     *  More patterns than the regex cache holds. Evicted programs must stay valid while still in use.
+     */
+    var held = []
+    for (i = 0; i < 1200; i++) {
+        re = new RegExp("p" + i + "q")
+        if ((i % 100) == 0) {
+            held.push(re)
+        }
+        assert(re.test("ap" + i + "qb"))
+    }
+    for (i = 0; i < held.length; i++) {
+        assert(held[i].test("p" + (i * 100) + "q"))
+        assert(!held[i].test("p" + (i * 100) + "x"))
+    }
+    assert(new RegExp("p0q").test("p0q"))
+
     /*
         re.matched
 
@@ -0,0 +1,68 @@
+/*
+ *	Many concurrent timers fire in due order and stopped timers never fire
+ */
+
+var order = []
+
+function callback(e: TimerEvent): Void {
+	order.push(e.data.period)
+	e.data.stop()
+}
+
+var timers = []
+for each (period in [ 450, 50, 350, 150, 250 ]) {
+	timers.push(new Timer(period, callback))
+}
+
+/*
+ *	Distant and cancelled timers must not fire
+ */
+var distant: Timer = new Timer(3600 * 1000, callback)
+var cancelled: Timer = new Timer(200, callback)
+cancelled.stop()
+
+for (let i in 100) {
+	if (order.length >= 5) {
+		break
+	}
+	App.sleep(50)
+}
+App.sleep(300)
+
+assert(order.length == 5)
+assert(order == "50,150,250,350,450")
+distant.stop()
+
+/*
+ *	A timer on a higher wheel level must be cascaded at its slot boundary even when a nearer timer is next due just
+ *	after that boundary. Timer ticks are milliseconds and the first level of the wheel spans 64 ticks.
+ */
+var fired = {}
+
+function stamp(e: TimerEvent): Void {
+	fired[e.data.period] = Date.now()
+	e.data.stop()
+}
+
+App.sleep(1)
+var start: Number = Date.now()
+var late: Timer = new Timer(300, stamp)
+var boundary: Number = (start + 300) - ((start + 300) % 64)
+if ((boundary - 20) > Date.now()) {
+	App.sleep(boundary - 20 - Date.now())
+}
+/*
+ *	The wheel advances when events are serviced. Bring it up to date so the near timer is hashed on the first level.
+ */
+App.sleep(0)
+var near: Timer = new Timer(40, stamp)
+
+for (let i in 40) {
+	if (fired[300]) {
+		break
+	}
+	App.sleep(50)
+}
+assert(fired[40])
+assert(fired[300])
+assert((fired[300] - start) < 800)
@@ -0,0 +1,80 @@
+/*
+ *  Async file I/O
+ */
+const TestLength = 500
+const TestFile: String = "io/file.dat"
+
+//
+//  Async read. Data is read ahead in the background and delivered via the callback.
+//
+var f: File = new File(TestFile)
+var total = 0
+var done = false
+f.open(File.Read)
+f.setCallback(function (e: Event): Void {
+    assert(e.data == f)
+    bytes = e.data.readBytes(-1)
+    if (bytes == null) {
+        done = true
+    } else {
+        total += bytes.available
+    }
+})
+for (let i in 100) {
+    if (done) {
+        break
+    }
+    App.serviceEvents(1, 100)
+}
+f.close()
+assert(done)
+assert(total == TestLength)
+
+
+//
+//  Async write. The callback fires once all written data has drained to the file.
+//
+var drained = false
+f = new File("temp.dat")
+f.open(File.Create | File.Write | File.Truncate)
+f.setCallback(function (e: Event): Void {
+    drained = true
+})
+for (i in 100) {
+    f.write("0123456789")
+}
+for (let i in 100) {
+    if (drained) {
+        break
+    }
+    App.serviceEvents(1, 100)
+}
+assert(drained)
+f.close()
+assert(f.length == 1000)
+
+
+//
+//  Close waits for pending async writes
+//
+f = new File("temp.dat")
+f.open(File.Create | File.Write | File.Truncate)
+f.setCallback(function (e: Event): Void {})
+f.write("Hello World")
+f.close()
+assert(f.length == 11)
+f.remove()
+
+
+//
+//  Close with a write pass outstanding and more output still buffered
+//
+f = new File("temp.dat")
+f.open(File.Create | File.Write | File.Truncate)
+f.setCallback(function (e: Event): Void {})
+for (i in 2000) {
+    f.write("0123456789")
+}
+f.close()
+assert(f.length == 20000)
+f.remove()
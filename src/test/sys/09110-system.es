@@ -0,0 +1,20 @@
+/*
+ *	Tests for the System class
+ */
+
+use namespace "ejs.sys"
+
+/*
+ *	run -- Collect the standard output of a command. The command's stdout and stderr are both waited on until they
+ *	are closed.
+ */
+assert(System.run("/bin/echo hello") == "hello\n")
+assert(System.run('/bin/sh -c "echo out; echo err 1>&2"') == "out\n")
+
+/*
+ *	Output larger than a single pipe read
+ */
+var out: String = System.run('/bin/sh -c "i=0; while [ $i -lt 5000 ]; do echo line $i; i=$((i + 1)); done"')
+assert(out.length > 40000)
+assert(out.startsWith("line 0\n"))
+assert(out.endsWith("line 4999\n"))
@@ -0,0 +1,46 @@
+/*
+ *	Memory limits above 2GB are kept and don't refuse allocations
+ */
+
+const LIMIT: Number = 3 * 1024 * 1024 * 1024
+
+var saved: Number = GC.maxMemory
+GC.maxMemory = LIMIT
+assert(GC.maxMemory == LIMIT)
+
+var items = []
+for (i in 1000) {
+	items.push("item " + i)
+}
+assert(items.length == 1000)
+assert(items[999] == "item 999")
+
+GC.maxMemory = saved
+assert(GC.maxMemory == saved)
+
+/*
+ *	Allocations that would take the total over a limit above 2GB are refused. A refused allocation throws a memory
+ *	error, so this runs in another process. It reports when the total passes 2GB and if it ever passes the limit. The
+ *	child exits with an error status when the memory error is not caught.
+ */
+const CHILD: String = "sys/tmp-limit.es"
+
+File.put(CHILD, 0644,
+	"const LIMIT: Number = 2304 * 1024 * 1024\n" +
+	"GC.maxMemory = LIMIT\n" +
+	"var blocks: Array = []\n" +
+	"for (i = 0; i < 200; i++) {\n" +
+	"	blocks.push(new ByteArray(16 * 1024 * 1024))\n" +
+	"	if (GC.allocatedMemory > 2 * 1024 * 1024 * 1024) print('over 2GB')\n" +
+	"	if (GC.allocatedMemory > LIMIT) print('over limit')\n" +
+	"}\n" +
+	"print('not refused')\n")
+try {
+	var out: String = System.run('/bin/sh -c "' + App.dir + '/ejs ' + CHILD + ' 2>&1; true"')
+} finally {
+	rm(CHILD)
+}
+assert(out.contains("over 2GB"))
+assert(!out.contains("over limit"))
+assert(!out.contains("not refused"))
+assert(out.contains("MemoryError"))
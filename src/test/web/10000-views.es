@@ -0,0 +1,57 @@
+/*
+ *	Tests for compiling web pages with ejsweb. White space in literal HTML is kept unless --collapse-space is given.
+ */
+
+use namespace "ejs.sys"
+
+const DIR: String = "web/tmp"
+const PAGE: String = DIR + "/views"
+
+const Source: String =
+	"<html>\n" +
+	"    <body>\n" +
+	"\n" +
+	"        <preview>\n" +
+	"            text\n" +
+	"        </preview>\n" +
+	"        <pre>\n" +
+	"  a\n" +
+	"    <%= 1 + 2 %>\n" +
+	"      b\n" +
+	"</pre>\n" +
+	"    </body>\n" +
+	"</html>\n"
+
+/*
+ *	Compile the page and return the generated Ejscript
+ */
+function compile(options: String): String {
+	System.run(App.dir + "/ejsweb --quiet --keep " + options + " compile " + PAGE + ".ejs")
+	let result: String = File.getString(PAGE + ".es")
+	rm(PAGE + ".es")
+	rm(PAGE + ".mod")
+	return result
+}
+
+mkdir(DIR)
+File.put(PAGE + ".ejs", 0644, Source)
+try {
+	/*
+	 *	Default preserves all white space
+	 */
+	let code: String = compile("")
+	assert(code.contains("<html>\n    <body>\n\n        <preview>\n            text\n        </preview>\n        <pre>\n  a\n    "))
+	assert(code.contains("\n      b\n</pre>\n    </body>\n</html>\n"))
+
+	/*
+	 *	Collapse white space that spans lines. The pre element is preserved across the embedded code but
+	 *	preview is not a pre element.
+	 */
+	code = compile("--collapse-space")
+	assert(code.contains("<html>\n<body>\n<preview>\ntext\n</preview>\n<pre>\n  a\n    "))
+	assert(code.contains("\n      b\n</pre>\n</body>\n</html>\n"))
+
+} finally {
+	rm(PAGE + ".ejs")
+	rmdir(DIR)
+}
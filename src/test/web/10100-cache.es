@@ -0,0 +1,64 @@
+/*
+ *	Tests for the controller action cache. Responses report how many actions have run, so a response served from
+ *	the cache repeats the count of the response it replays.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4110
+const URL: String = "127.0.0.1:" + PORT + "/cache/cache/"
+
+function fetch(action: String, language: String = null): String {
+	let http: Http = new Http
+	if (language) {
+		http.addRequestHeader("Accept-Language", language)
+	}
+	http.get(URL + action)
+	assert(http.code == 200)
+	let response: String = http.response
+	http.close()
+	return response
+}
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " cache " + PORT)
+try {
+	/*
+	 *	Miss then hit
+	 */
+	assert(fetch("index") == "index 1")
+	assert(fetch("index") == "index 1")
+
+	/*
+	 *	Vary headers select distinct responses
+	 */
+	assert(fetch("lang", "en") == "lang 2")
+	assert(fetch("lang", "fr") == "lang 3")
+	assert(fetch("lang", "en") == "lang 2")
+	assert(fetch("lang", "fr") == "lang 3")
+
+	/*
+	 *	A zero lifespan disables caching
+	 */
+	assert(fetch("none") == "none 4")
+	assert(fetch("none") == "none 5")
+
+	/*
+	 *	Responses expire after their lifespan
+	 */
+	assert(fetch("brief") == "brief 6")
+	assert(fetch("brief") == "brief 6")
+	App.sleep(2100)
+	assert(fetch("brief") == "brief 7")
+
+	/*
+	 *	Expire by tag
+	 */
+	assert(fetch("tagged") == "tagged 8")
+	assert(fetch("tagged") == "tagged 8")
+	assert(fetch("expire") == "expired")
+	assert(fetch("tagged") == "tagged 9")
+	assert(fetch("index") == "index 1")
+
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop cache")
+}
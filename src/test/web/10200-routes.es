@@ -0,0 +1,46 @@
+/*
+ *	Tests for routing requests with the application route table in config/routes.ecf
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4120
+const URL: String = "127.0.0.1:" + PORT + "/routes"
+
+function fetch(path: String): String {
+	let http: Http = new Http
+	http.get(URL + path)
+	assert(http.code == 200)
+	let response: String = http.response
+	http.close()
+	return response
+}
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " routes " + PORT)
+try {
+	/*
+	 *	Literal segments are preferred over parameters
+	 */
+	assert(fetch("/posts/latest") == "latest")
+
+	/*
+	 *	Typed parameters only match digits. A route that fails deeper in the path falls back to the next route.
+	 */
+	assert(fetch("/posts/2009/10") == "archive 2009/10")
+	assert(fetch("/posts/first") == "show first")
+	assert(fetch("/posts/2009") == "show 2009")
+
+	/*
+	 *	Controller and action parameters
+	 */
+	assert(fetch("/p/blog/show/7") == "show 7")
+
+	/*
+	 *	Unrouted requests use the /controller/action mapping
+	 */
+	assert(fetch("/blog/index") == "index")
+	assert(fetch("/blog/latest") == "latest")
+
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop routes")
+}
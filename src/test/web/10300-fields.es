@@ -0,0 +1,21 @@
+/*
+ *	Tests for the request and host fields. Field values are created on first access and kept by the request.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4130
+const URL: String = "127.0.0.1:" + PORT + "/fields/fields/"
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " fields " + PORT)
+try {
+	let http: Http = new Http
+	http.get(URL + "collect?a=1")
+	assert(http.code == 200)
+	let response: String = http.response
+	http.close()
+	assert(response.startsWith("same /fields/fields/collect GET a=1 "))
+
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop fields")
+}
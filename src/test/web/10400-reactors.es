@@ -0,0 +1,38 @@
+/*
+ *	Tests for serving with several I/O event loops. Multithreaded builds give each reactor its own listening socket
+ *	on the port. Other builds ignore the reactor count.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4140
+const URL: String = "127.0.0.1:" + PORT
+
+function fetch(path: String): String {
+	let http: Http = new Http
+	http.get(URL + path)
+	assert(http.code == 200)
+	let response: String = http.response
+	http.close()
+	return response
+}
+
+/*
+ *	Each request uses a new connection, so connections are spread over the listening sockets
+ */
+function test(): Void {
+	for (i in 40) {
+		assert(fetch("/web/hello.txt") == "hello\n")
+		assert(fetch("/reactors/echo/index?n=" + i) == "echo " + i)
+	}
+	if (Config.Multithread) {
+		assert(File.getString("web/tmp/reactors.log").contains("Started 4 reactors"))
+	}
+}
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " reactors " + PORT + " 4 4")
+try {
+	test()
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop reactors")
+}
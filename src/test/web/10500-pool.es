@@ -0,0 +1,56 @@
+/*
+ *	Tests for serving a load with more concurrent requests than pool threads. Multithreaded builds queue the
+ *	excess requests behind busy threads and idle threads steal them. Other builds serve one request at a time.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4150
+const URL: String = "127.0.0.1:" + PORT
+const LOG: String = "web/tmp/pool.log"
+
+function fetch(path: String): String {
+	let http: Http = new Http
+	http.get(URL + path)
+	assert(http.code == 200)
+	let response: String = http.response
+	http.close()
+	return response
+}
+
+/*
+ *	Run the http client with several load threads. It exits with an error if any request fails. Each request
+ *	closes its connection so requests are spread over the pool rather than bound to a connection.
+ */
+function load(threads: Number, iterations: Number): Void {
+	System.run(App.dir + "/http --noout --header \"Connection: close\" --threads " + threads +
+		" --iterations " + iterations + " " + URL + "/web/pool.txt")
+}
+
+function served(): Number {
+	return File.getString(LOG).split("GET /web/pool.txt").length - 1
+}
+
+/*
+ *	Only static requests are run concurrently. Concurrent Ejscript requests are not yet safe in multithreaded builds.
+ */
+function test(): Void {
+	load(8, 400)
+	load(16, 200)
+	assert(served() >= 600)
+
+	/*
+	 *	The server is still responsive and returns the right content
+	 */
+	for (i in 10) {
+		assert(fetch("/web/pool.txt") == "pool\n")
+		assert(fetch("/pool/work/index?n=" + i) == "work " + i)
+	}
+}
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " pool " + PORT + " 2")
+try {
+	test()
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop pool")
+}
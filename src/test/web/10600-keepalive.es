@@ -0,0 +1,71 @@
+/*
+ *	Tests for running several different requests on one keep-alive connection. The server reuses the connection's
+ *	memory between requests, so each response must be intact whatever the requests before it were.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4160
+const URL: String = "127.0.0.1:" + PORT
+const APP: String = "web/tmp/keepalive"
+
+var http: Http = new Http
+var remaining: Number = 100
+var big: String
+
+/*
+ *	Issue a request on the shared connection. The server counts down the requests left on a connection in the
+ *	Keep-Alive header, so this also checks the connection was reused.
+ */
+function fetch(path: String, code: Number = 200): String {
+	http.get(URL + path)
+	assert(http.code == code)
+	assert(http.header("connection") == "keep-alive")
+	assert(http.header("keep-alive").endsWith("max=" + --remaining))
+	return http.response
+}
+
+function makeBig(): String {
+	let line: String = "0123456789abcdefghijklmnopqrstuvwxyz\n"
+	let result: String = ""
+	for (i in 1000) {
+		result += line
+	}
+	return result
+}
+
+function test(): Void {
+	http.timeout = 10000
+	big = makeBig()
+	File.put(APP + "/web/big.txt", 0644, big)
+
+	assert(fetch("/web/small.txt") == "small\n")
+	assert(fetch("/web/big.txt") == big)
+	assert(fetch("/web/small.txt") == "small\n")
+	assert(fetch("/web/missing.txt", 404).contains("Not Found"))
+	assert(fetch("/web/big.txt") == big)
+
+	http.head(URL + "/web/big.txt")
+	assert(http.code == 200)
+	assert(http.header("content-length") == "" + big.length)
+	assert(http.header("keep-alive").endsWith("max=" + --remaining))
+
+	for (i in 20) {
+		assert(fetch("/web/small.txt") == "small\n")
+	}
+
+	/*
+	 *	Controller responses are complete before they are sent, so they have a content length and are kept alive
+	 */
+	assert(fetch("/keepalive/echo/index?n=7") == "echo 7")
+	assert(fetch("/web/small.txt") == "small\n")
+	assert(fetch("/web/big.txt") == big)
+}
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " keepalive " + PORT)
+try {
+	test()
+} finally {
+	http.close()
+	System.run("/bin/bash web/webApp.ksh stop keepalive")
+}
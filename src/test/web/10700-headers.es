@@ -0,0 +1,82 @@
+/*
+ *	Tests for HTTP headers, form variables and mime types. These are kept in hash tables on the server and client,
+ *	so the tests use enough entries to grow the tables and check lookups, duplicates and case insensitive keys.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4170
+const URL: String = "127.0.0.1:" + PORT
+
+function test(): Void {
+	let http: Http
+
+	/*
+	 *	Request headers, including a duplicated header. Servers built for size accept only 20 header lines.
+	 */
+	http = new Http
+	for (i in 12) {
+		http.addRequestHeader("X-Field-" + i, "" + i)
+	}
+	http.addRequestHeader("X-Twice", "a")
+	http.addRequestHeader("X-Twice", "b", false)
+	http.get(URL + "/headers/headers/incoming")
+	assert(http.code == 200)
+	assert(http.response == "fields 12 twice 2")
+	http.close()
+
+	/*
+	 *	Response headers. The client looks headers up without regard to case.
+	 */
+	http = new Http
+	http.get(URL + "/headers/headers/outgoing")
+	assert(http.code == 200)
+	assert(http.response == "outgoing")
+	for (i in 100) {
+		assert(http.header("x-out-" + i) == "" + i)
+	}
+	assert(http.header("X-OUT-42") == "42")
+	assert(http.header("x-dup") == "second")
+	assert(http.header("Content-Type") == http.header("content-type"))
+	http.close()
+
+	/*
+	 *	Form variables. These are posted as servers built for size limit the URL to 512 bytes.
+	 */
+	let form: String = "a=1"
+	for (i in 200) {
+		form += "&p" + i + "=" + i
+	}
+	http = new Http
+	http.addRequestHeader("Content-Type", "application/x-www-form-urlencoded")
+	http.post(URL + "/headers/headers/fields", form)
+	assert(http.code == 200)
+	assert(http.response == "form 200")
+	http.close()
+
+	/*
+	 *	Mime types. Extensions match without regard to case.
+	 */
+	let types: Object = {
+		"page.html": "text/html",
+		"style.css": "text/css",
+		"script.js": "application/x-javascript",
+		"notes.txt": "text/plain",
+		"README.TXT": "text/plain",
+		"archive.zip": "application/zip",
+	}
+	for (file in types) {
+		http = new Http
+		http.get(URL + "/web/" + file)
+		assert(http.code == 200)
+		assert(http.contentType == types[file])
+		http.close()
+	}
+}
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " headers " + PORT)
+try {
+	test()
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop headers")
+}
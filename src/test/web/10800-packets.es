@@ -0,0 +1,148 @@
+/*
+ *	Tests for splitting and sharing packets. Large, streamed and ranged responses are split into packets that share
+ *	their data on the way to the connector. Responses are numbered lines so any lost or repeated data is detected.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4180
+const URL: String = "127.0.0.1:" + PORT
+const APP: String = "web/tmp/packets"
+
+function lines(from: Number, to: Number): String {
+	let result: String = ""
+	for (i = from; i < to; i++) {
+		result += "line " + i + "\n"
+	}
+	return result
+}
+
+function fetch(url: String, range: String = null, code: Number = 200): Http {
+	let http: Http = new Http
+	if (range) {
+		http.addRequestHeader("Range", range)
+	}
+	http.get(URL + url)
+	assert(http.code == code)
+	return http
+}
+
+/*
+ *	Check a response body and close the request
+ */
+function check(http: Http, expected: String): Void {
+	assert(http.response == expected)
+	http.close()
+}
+
+/*
+ *	Ranges of a response. The range boundaries fall inside packets so these are split. The length of a large dynamic
+ *	response is not known when its first packets are sent, so ranges from the end are ignored.
+ */
+function ranges(url: String, body: String, known: Boolean): Void {
+	let http: Http
+
+	http = fetch(url, "bytes=100-199", 206)
+	assert(http.header("Content-Range").startsWith("bytes 100-199/"))
+	check(http, body.slice(100, 200))
+	check(fetch(url, "bytes=5000-70000", 206), body.slice(5000, 70001))
+	if (known) {
+		check(fetch(url, "bytes=-10", 206), body.slice(body.length - 10))
+		check(fetch(url, "bytes=100000-", 206), body.slice(100000))
+	} else {
+		check(fetch(url, "bytes=-10", 200), body)
+		check(fetch(url, "bytes=100000-", 200), body)
+	}
+
+	http = fetch(url, "bytes=0-9,8190-8200,100000-100099", 206)
+	assert(http.contentType.startsWith("multipart/byteranges"))
+	let response: String = http.response
+	assert(response.contains("\r\n\r\n" + body.slice(0, 10) + "\r\n"))
+	assert(response.contains("\r\n\r\n" + body.slice(8190, 8201) + "\r\n"))
+	assert(response.contains("\r\n\r\n" + body.slice(100000, 100100) + "\r\n"))
+	http.close()
+}
+
+/*
+ *	A POST request followed by a pipelined request in the same write. The body is separated from the next request.
+ */
+function pipeline(): String {
+	let script: String = "web/tmp/pipeline.sh"
+	File.put(script, 0644,
+		"exec 3<>/dev/tcp/127.0.0.1/" + PORT + "\n" +
+		"printf 'POST /packets/packets/echo HTTP/1.1\\r\\nHost: 127.0.0.1\\r\\n" +
+			"Content-Type: application/x-www-form-urlencoded\\r\\nContent-Length: 10\\r\\n\\r\\ntext=hello" +
+			"GET /web/small.txt HTTP/1.1\\r\\nHost: 127.0.0.1\\r\\nConnection: close\\r\\n\\r\\n' >&3\n" +
+		"timeout 10 cat <&3\n")
+	let response: String
+	try {
+		response = System.run("/bin/bash " + script)
+	} finally {
+		rm(script)
+	}
+	return response
+}
+
+/*
+ *	A POST request written together with a body larger than the header limit. Only the headers count against the limit.
+ */
+function single(): String {
+	let script: String = "web/tmp/single.sh"
+	File.put(script, 0644,
+		"request=web/tmp/single.request\n" +
+		"{ printf 'POST /packets/packets/echo HTTP/1.1\\r\\nHost: 127.0.0.1\\r\\n" +
+			"Content-Type: application/x-www-form-urlencoded\\r\\nContent-Length: 3005\\r\\n" +
+			"Connection: close\\r\\n\\r\\ntext=' ; head -c 3000 /dev/zero | tr '\\0' x ; } > $request\n" +
+		"exec 3<>/dev/tcp/127.0.0.1/" + PORT + "\n" +
+		"cat $request >&3\n" +
+		"rm -f $request\n" +
+		"timeout 10 cat <&3\n")
+	let response: String
+	try {
+		response = System.run("/bin/bash " + script)
+	} finally {
+		rm(script)
+	}
+	return response
+}
+
+function test(): Void {
+	let body: String = lines(0, 12000)
+	File.put(APP + "/web/big.txt", 0644, body)
+
+	/*
+	 *	Dynamic responses, with and without transfer chunk encoding
+	 */
+	check(fetch("/packets/packets/big"), body)
+	check(fetch("/packets/packets/streamed"), body)
+
+	/*
+	 *	Ranges of dynamic and static responses
+	 */
+	ranges("/packets/packets/big", body, false)
+	ranges("/web/big.txt", body, true)
+
+	/*
+	 *	A form body read in many packets. Each is joined to the first before the form is parsed.
+	 */
+	let text: String = lines(0, 3000)
+	let http: Http = new Http
+	http.addRequestHeader("Content-Type", "application/x-www-form-urlencoded")
+	http.post(URL + "/packets/packets/echo", "text=" + text.replace(/ /g, "+").replace(/\n/g, "%0A"))
+	assert(http.code == 200)
+	check(http, "echo " + text)
+
+	let response: String = single()
+	assert(response.endsWith("\r\n\r\necho " + "x".times(3000)))
+
+	response = pipeline()
+	assert(response.contains("\r\n\r\necho hello"))
+	assert(response.contains("\r\n\r\nsmall\n"))
+}
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " packets " + PORT)
+try {
+	test()
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop packets")
+}
@@ -0,0 +1,140 @@
+/*
+ *	Tests for the connectors that write responses to the socket. Connectors gather packets into batched writes and
+ *	cork the socket while headers wait for body data, so the tests check that headers and bodies arrive intact and
+ *	promptly for small responses and for large responses that take many, possibly partial, writes.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4190
+const URL: String = "127.0.0.1:" + PORT
+const APP: String = "web/tmp/connectors"
+
+var http: Http = new Http
+
+/*
+ *	Issue a request on the shared keep-alive connection and check the content length matches the body
+ */
+function fetch(path: String, method: String = "GET"): String {
+	if (method == "HEAD") {
+		http.head(URL + path)
+	} else {
+		http.get(URL + path)
+	}
+	assert(http.code == 200)
+	assert(http.header("connection") == "keep-alive")
+	let response: String = http.response
+	if (method == "GET" && http.header("transfer-encoding") != "chunked") {
+		assert(http.header("content-length") == "" + response.length)
+	}
+	return response
+}
+
+/*
+ *	Numbered lines so lost, repeated or reordered data changes the body
+ */
+function makeBig(): String {
+	let parts: Array = []
+	for (i = 0; i < 200; i++) {
+		parts.push(lines(i * 1000, (i + 1) * 1000))
+	}
+	return parts.join("")
+}
+
+function lines(from: Number, to: Number): String {
+	let result: String = ""
+	for (i = from; i < to; i++) {
+		result += "line " + i + "\n"
+	}
+	return result
+}
+
+/*
+ *	Request a file over a raw socket and wait a second before reading the response. The server fills the socket
+ *	buffers and has to resume after partial writes. The server must close the connection once done. The body is
+ *	compared with count bytes of the file from start by the script as the response is too large to handle quickly
+ *	here. Returns the response headers.
+ */
+function slow(file: String, start: Number, count: Number, range: String = null): String {
+	let script: String = "web/tmp/slow.sh"
+	let output: String = "web/tmp/slow.out"
+	let request: String = "GET /web/" + file + " HTTP/1.1\\r\\nHost: 127.0.0.1\\r\\nConnection: close\\r\\n"
+	if (range) {
+		request += "Range: " + range + "\\r\\n"
+	}
+	File.put(script, 0644,
+		"exec 3<>/dev/tcp/127.0.0.1/" + PORT + "\n" +
+		"printf '" + request + "\\r\\n' >&3\n" +
+		"sleep 1\n" +
+		"timeout 20 cat <&3 >" + output + "\n" +
+		"status=$?\n" +
+		"sed -n '1,/^\\r$/p' " + output + "\n" +
+		"[ $status = 0 ] && sed '1,/^\\r$/d' " + output + " | cmp -s - <(tail -c +" + (start + 1) + " " + APP + "/web/" + file +
+			" | head -c " + count + ") && echo same\n")
+	let headers: String
+	try {
+		headers = System.run("/bin/bash " + script)
+	} finally {
+		rm(script)
+		rm(output)
+	}
+	assert(headers.endsWith("same\n"))
+	return headers
+}
+
+function test(): Void {
+	let big: String = makeBig()
+	File.put(APP + "/web/big.txt", 0644, big)
+
+	/*
+	 *	Small responses. Each should go out in a single write.
+	 */
+	for (i in 20) {
+		let obj: Object = deserialize(fetch("/connectors/connectors/json?n=" + i))
+		assert(obj.n == "" + i && obj.name == "connectors")
+		assert(fetch("/web/small.txt") == "small\n")
+	}
+
+	/*
+	 *	Responses without a body must not be left corked
+	 */
+	let start: Number = Date.now()
+	for (i in 20) {
+		fetch("/web/small.txt", "HEAD")
+	}
+	assert((Date.now() - start) < 2000)
+
+	/*
+	 *	Headers flushed before the body is written
+	 */
+	assert(fetch("/connectors/connectors/late") == "late\n")
+
+	/*
+	 *	Large responses from the send connector, the net connector for ranges and a controller
+	 */
+	assert(fetch("/web/big.txt") == big)
+	http.addRequestHeader("Range", "bytes=1000-2000000")
+	http.get(URL + "/web/big.txt")
+	assert(http.code == 206)
+	assert(http.response == big.slice(1000, 2000001))
+	http.close()
+	http = new Http
+	assert(fetch("/connectors/connectors/big") == big)
+
+	/*
+	 *	Responses to a slow client. These are larger than the socket buffers can hold.
+	 */
+	let huge: String = big + big + big + big + big
+	File.put(APP + "/web/huge.txt", 0644, huge)
+	assert(slow("huge.txt", 0, huge.length).contains("Content-Length: " + huge.length + "\r\n"))
+	assert(slow("huge.txt", 10, 9999991, "bytes=10-10000000").contains("Content-Range: bytes 10-10000000/" +
+		huge.length + "\r\n"))
+}
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " connectors " + PORT)
+try {
+	test()
+} finally {
+	http.close()
+	System.run("/bin/bash web/webApp.ksh stop connectors")
+}
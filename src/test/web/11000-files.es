@@ -0,0 +1,111 @@
+/*
+ *	Tests for the static file cache. Small files are served from memory and are revalidated against the file and its
+ *	precompressed ".gz" variant once the cached copy is more than a second old.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4200
+const URL: String = "127.0.0.1:" + PORT
+const APP: String = "web/tmp/files"
+const PAGE: String = APP + "/web/page.txt"
+
+/*
+ *	The server does not look inside the variant, so plain text stands in for compressed content
+ */
+const VARIANT: String = "gzip variant\n"
+
+function fetch(headers: Object = {}): Object {
+	let http: Http = new Http
+	for (key in headers) {
+		http.addRequestHeader(key, headers[key])
+	}
+	http.get(URL + "/web/page.txt")
+	let result: Object = {
+		code: http.code,
+		body: http.response,
+		etag: http.header("etag"),
+		encoding: http.header("content-encoding"),
+		vary: http.header("vary"),
+	}
+	http.close()
+	return result
+}
+
+function makePage(tag: String): String {
+	let result: String = ""
+	for (i = 0; i < 200; i++) {
+		result += tag + " line " + i + "\n"
+	}
+	return result
+}
+
+/*
+ *	Wait until the cached copy must be revalidated. This also ensures a file written next has a new modified time.
+ */
+function expire(): Void {
+	App.sleep(1100)
+}
+
+function test(): Void {
+	let page: String = makePage("first")
+	File.put(PAGE, 0644, page)
+
+	/*
+	 *	Miss then hit. Chunking splits the cached content into several packets.
+	 */
+	let first: Object = fetch()
+	assert(first.code == 200 && first.body == page && first.encoding == "")
+	let second: Object = fetch()
+	assert(second.body == page && second.etag == first.etag)
+	assert(fetch({ "X-Appweb-Chunk-Size": "1000" }).body == page)
+
+	/*
+	 *	Modified files are reloaded, whether or not the size changed
+	 */
+	expire()
+	page = makePage("second")
+	File.put(PAGE, 0644, page)
+	let modified: Object = fetch()
+	assert(modified.body == page && modified.etag != first.etag)
+
+	expire()
+	page = makePage("thirds")
+	File.put(PAGE, 0644, page)
+	assert(fetch().body == page)
+
+	/*
+	 *	The precompressed variant is served only to clients that accept gzip and want the whole file
+	 */
+	expire()
+	File.put(PAGE + ".gz", 0644, VARIANT)
+	let gzip: Object = fetch({ "Accept-Encoding": "gzip" })
+	assert(gzip.body == VARIANT && gzip.encoding == "gzip" && gzip.vary == "Accept-Encoding")
+	let plain: Object = fetch()
+	assert(plain.body == page && plain.encoding == "" && plain.vary == "Accept-Encoding" && plain.etag != gzip.etag)
+	let ranged: Object = fetch({ "Accept-Encoding": "gzip", "Range": "bytes=10-19" })
+	assert(ranged.code == 206 && ranged.body == page.slice(10, 20) && ranged.encoding == "")
+
+	/*
+	 *	Changes to the variant alone are noticed too
+	 */
+	expire()
+	File.put(PAGE + ".gz", 0644, "new " + VARIANT)
+	assert(fetch({ "Accept-Encoding": "gzip" }).body == "new " + VARIANT)
+
+	expire()
+	rm(PAGE + ".gz")
+	gzip = fetch({ "Accept-Encoding": "gzip" })
+	assert(gzip.body == page && gzip.encoding == "")
+
+	expire()
+	File.put(PAGE + ".gz", 0644, VARIANT)
+	assert(fetch({ "Accept-Encoding": "gzip" }).body == VARIANT)
+}
+
+System.run("/bin/bash web/webApp.ksh start " + App.dir + " files " + PORT)
+try {
+	test()
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop files")
+}
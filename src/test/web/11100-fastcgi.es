@@ -0,0 +1,115 @@
+/*
+ *	Tests for the ejscgi FastCGI responder. The responder is run with a request limit so the last connection also tests
+ *	recycling.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4210
+const MAX_REQUESTS: Number = 5
+
+/*
+ *	The responder runs in the application directory
+ */
+const PARAMS: String = "param ID DOCUMENT_ROOT .\nparam ID SCRIPT_NAME /fastcgi\n"
+
+/*
+ *	Send a request script to the responder and return the records received
+ */
+function send(script: String): String {
+	let path: String = "web/tmp/fastcgi.in"
+	let result: String
+	File.put(path, 0644, script)
+	try {
+		result = System.run("/bin/bash web/fastcgi.ksh " + PORT + " " + path)
+	} finally {
+		rm(path)
+	}
+	return result
+}
+
+/*
+ *	Script lines to run a request with the given id, uri and optional query and form body
+ */
+function request(id: Number, uri: String, query: String = null, body: String = null, keep: Boolean = false): String {
+	let script: String = "begin ID" + (keep ? " keep" : "") + "\n" + PARAMS +
+		"param ID PATH_INFO " + uri + "\nparam ID REQUEST_URI " + uri + "\n"
+	if (query) {
+		script += "param ID QUERY_STRING " + query + "\n"
+	}
+	if (body) {
+		script += "param ID CONTENT_TYPE application/x-www-form-urlencoded\n" +
+			"param ID CONTENT_LENGTH " + body.length + "\n"
+	}
+	script += "params ID\nparams ID\n"
+	if (body) {
+		script += "stdin ID " + body + "\n"
+	}
+	script += "stdin ID\n"
+	return script.replace(/ID/g, id)
+}
+
+/*
+ *	Script lines to run a request whose parameters carry a four byte length of 2^31 - 1 for the name or value
+ */
+function oversized(id: Number, value: Boolean): String {
+	let lengths: String = value ? "\\001\\377\\377\\377\\377" : "\\377\\377\\377\\377\\001"
+	return "begin " + id + " keep\n" +
+		"raw \\001\\004\\000\\00" + id + "\\000\\010\\000\\000" + lengths + "Axy\n" +
+		"params " + id + "\nstdin " + id + "\n"
+}
+
+/*
+ *	Test if the responder is still accepting connections, allowing it a couple of seconds to exit
+ */
+function listening(): Boolean {
+	let script: String = "web/tmp/listening.sh"
+	let result: String
+	File.put(script, 0644,
+		"for i in 1 2 3 4 5 6 7 8 9 10 ; do\n" +
+		"\t( exec 3<>/dev/tcp/127.0.0.1/" + PORT + " ) 2>/dev/null || exit 0\n" +
+		"\tsleep 0.2\n" +
+		"done\n" +
+		"echo listening\n")
+	try {
+		result = System.run("/bin/bash " + script)
+	} finally {
+		rm(script)
+	}
+	return result == "listening\n"
+}
+
+function test(): Void {
+	/*
+	 *	A static file on a connection the responder closes after the request
+	 */
+	let records: String = send(request(1, "/fastcgi/web/page.txt"))
+	assert(records.contains("Content-Type: text/plain\r\n"))
+	assert(records.contains("\nstatic page\n"))
+	assert(records.endsWith("== STDOUT 1 0\n== END_REQUEST 1 8\nstatus 0\n"))
+
+	/*
+	 *	On one kept connection: a POST with a body, two requests with bad parameter lengths, a GET that reaches the
+	 *	request limit and one more request which is refused as overloaded. The responder then closes the connection and exits.
+	 */
+	records = send(request(1, "/fastcgi/echo", "name=beta", "body=hello", true) +
+		oversized(2, true) + oversized(3, false) +
+		request(4, "/fastcgi/echo", "name=gamma", null, true) +
+		"begin 5 keep\n")
+	assert(records.contains("\nname=beta body=hello\n"))
+	assert(records.contains("== STDERR 2 38\nejscgi: ERROR: Bad FastCGI parameters\n"))
+	assert(records.contains("== STDERR 3 38\nejscgi: ERROR: Bad FastCGI parameters\n"))
+	assert(records.contains("\nname=gamma body=undefined\n"))
+	for (id = 1; id < MAX_REQUESTS; id++) {
+		assert(records.contains("== END_REQUEST " + id + " 8\nstatus 0\n"))
+	}
+	assert(records.endsWith("== END_REQUEST 5 8\nstatus 2\n"))
+	assert(!listening())
+}
+
+System.run("/bin/bash web/webApp.ksh fastcgi " + App.dir + " fastcgi " + PORT + " " + MAX_REQUESTS)
+try {
+	test()
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop fastcgi")
+}
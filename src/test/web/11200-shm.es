@@ -0,0 +1,129 @@
+/*
+ *	Tests for the shared memory session store. Each step runs a new FastCGI responder on the same store file, so
+ *	sessions can only carry over through the file.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4220
+const APP: String = "web/tmp/shm"
+const STORE: String = "sessions.shm"
+const OPTIONS: String = " --session-store " + STORE
+
+var responders: Number = 0
+
+/*
+ *	Start another responder for the given number of requests and return its port
+ */
+function respond(count: Number): Number {
+	let port: Number = PORT + ++responders
+	System.run("/bin/bash web/webApp.ksh respond " + App.dir + " shm " + port + " " + count + OPTIONS)
+	return port
+}
+
+/*
+ *	Run a request for an action and return the records received
+ */
+function run(port: Number, action: String, query: String = null, cookie: String = null): String {
+	let path: String = "web/tmp/shm.in"
+	let uri: String = "/shm/" + action
+	let script: String = "begin 1\nparam 1 DOCUMENT_ROOT .\nparam 1 SCRIPT_NAME /shm\n" +
+		"param 1 PATH_INFO " + uri + "\nparam 1 REQUEST_URI " + uri + "\n"
+	if (query) {
+		script += "param 1 QUERY_STRING " + query + "\n"
+	}
+	if (cookie) {
+		script += "param 1 HTTP_COOKIE " + cookie + "\n"
+	}
+	script += "params 1\nparams 1\nstdin 1\n"
+	let result: String
+	File.put(path, 0644, script)
+	try {
+		result = System.run("/bin/bash web/fastcgi.ksh " + port + " " + path)
+	} finally {
+		rm(path)
+	}
+	return result
+}
+
+/*
+ *	Create a session and return its cookie
+ */
+function create(port: Number): String {
+	let records: String = run(port, "create")
+	let start: Number = records.indexOf("Set-Cookie: ")
+	assert(start >= 0)
+	start += "Set-Cookie: ".length
+	return records.slice(start, records.indexOf(";", start))
+}
+
+function getValue(port: Number, cookie: String): String {
+	let records: String = run(port, "get", null, cookie)
+	let start: Number = records.indexOf("\nvalue=")
+	assert(start >= 0)
+	start += "\nvalue=".length
+	return records.slice(start, records.indexOf("\n", start))
+}
+
+/*
+ *	Run a shell command against the store file
+ */
+function damage(command: String): Void {
+	let script: String = "web/tmp/damage.sh"
+	File.put(script, 0644, "cd " + APP + "\n" + command + "\n")
+	try {
+		System.run("/bin/bash " + script)
+	} finally {
+		rm(script)
+	}
+}
+
+/*
+ *	Write a session with a value and return the cookie
+ */
+function store(value: String): String {
+	let port: Number = respond(2)
+	let cookie: String = create(port)
+	assert(run(port, "set", "value=" + value, cookie).contains("\nset " + value + "\n"))
+	return cookie
+}
+
+function test(): Void {
+	/*
+	 *	A session written by one request is read by the next, from the same and from another process
+	 */
+	let cookie: String = create(PORT)
+	run(PORT, "set", "value=one", cookie)
+	assert(getValue(PORT, cookie) == "one")
+	assert(getValue(respond(1), cookie) == "one")
+	let size: Number = new File(APP + "/" + STORE).length
+	assert(size > 0)
+
+	/*
+	 *	Store files that are corrupt or have another geometry are discarded. Their sessions are lost but the store is
+	 *	usable again.
+	 */
+	let damages: Array = [
+		"printf 'XXXX' | dd of=" + STORE + " bs=1 conv=notrunc 2>/dev/null",
+		"truncate -s 100 " + STORE,
+		"printf '\\007\\000\\000\\000' | dd of=" + STORE + " bs=1 seek=8 conv=notrunc 2>/dev/null",
+	]
+	for each (how in damages) {
+		cookie = store("two")
+		assert(getValue(respond(1), cookie) == "two")
+		damage(how)
+		let port: Number = respond(3)
+		assert(getValue(port, cookie) == "none")
+		assert(new File(APP + "/" + STORE).length == size)
+		cookie = create(port)
+		run(port, "set", "value=three", cookie)
+		assert(getValue(respond(1), cookie) == "three")
+	}
+}
+
+System.run("/bin/bash web/webApp.ksh fastcgi " + App.dir + " shm " + PORT + " 0" + OPTIONS)
+try {
+	test()
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop shm")
+}
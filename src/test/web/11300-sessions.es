@@ -0,0 +1,97 @@
+/*
+ *	Tests for session expiry. The responder runs the session clock a thousand times faster than real time, so a session
+ *	timeout in seconds expires after that many milliseconds. The expiry wheel has levels for sessions due within 64,
+ *	4096 and more timer periods of a second.
+ */
+
+use namespace "ejs.sys"
+
+const PORT: Number = 4230
+const SPEED: Number = 1000
+
+/*
+ *	Run a request for an action and return the records received
+ */
+function run(action: String, query: String = null, cookie: String = null): String {
+	let path: String = "web/tmp/sessions.in"
+	let uri: String = "/sessions/" + action
+	let script: String = "begin 1\nparam 1 DOCUMENT_ROOT .\nparam 1 SCRIPT_NAME /sessions\n" +
+		"param 1 PATH_INFO " + uri + "\nparam 1 REQUEST_URI " + uri + "\n"
+	if (query) {
+		script += "param 1 QUERY_STRING " + query + "\n"
+	}
+	if (cookie) {
+		script += "param 1 HTTP_COOKIE " + cookie + "\n"
+	}
+	script += "params 1\nparams 1\nstdin 1\n"
+	let result: String
+	File.put(path, 0644, script)
+	try {
+		result = System.run("/bin/bash web/fastcgi.ksh " + PORT + " " + path)
+	} finally {
+		rm(path)
+	}
+	return result
+}
+
+/*
+ *	Create a session, optionally with a value, and return its cookie
+ */
+function create(timeout: Number, value: String = null): String {
+	let records: String = run("create", "timeout=" + timeout)
+	let start: Number = records.indexOf("Set-Cookie: ")
+	assert(start >= 0)
+	start += "Set-Cookie: ".length
+	let cookie: String = records.slice(start, records.indexOf(";", start))
+	if (value) {
+		assert(run("set", "value=" + value, cookie).contains("\nset " + value + "\n"))
+	}
+	return cookie
+}
+
+/*
+ *	Get the session value. Reading the session also restarts its timeout.
+ */
+function getValue(cookie: String): String {
+	let records: String = run("get", null, cookie)
+	let start: Number = records.indexOf("\nvalue=")
+	assert(start >= 0)
+	start += "\nvalue=".length
+	return records.slice(start, records.indexOf("\n", start))
+}
+
+function test(): Void {
+	/*
+	 *	Sessions first scheduled at each level of the wheel. Those on the outer levels are cascaded inwards as their
+	 *	slots come due and are kept while their timeouts are restarted. The first session expires too soon to be
+	 *	given a value.
+	 */
+	let short: String = create(30)
+	let medium: String = create(2000, "medium")
+	let long: String = create(5000, "long")
+	App.sleep(500)
+	assert(getValue(short) == "none")
+	assert(getValue(medium) == "medium")
+	assert(getValue(long) == "long")
+	App.sleep(2500)
+	assert(getValue(medium) == "none")
+	assert(getValue(long) == "long")
+	App.sleep(5500)
+	assert(getValue(long) == "none")
+
+	/*
+	 *	A session in use by a request survives its expiry until the request completes. Then it expires as usual.
+	 */
+	let pinned: String = create(500, "pinned")
+	assert(run("hold", "delay=1500&value=held", pinned).contains("\nheld\n"))
+	assert(getValue(pinned) == "held")
+	App.sleep(1000)
+	assert(getValue(pinned) == "none")
+}
+
+System.run("/bin/bash web/webApp.ksh fastcgi " + App.dir + " sessions " + PORT + " 0 --session-speed " + SPEED)
+try {
+	test()
+} finally {
+	System.run("/bin/bash web/webApp.ksh stop sessions")
+}
@@ -0,0 +1,49 @@
+/*
+ *  Cache.es - Controller for the action cache tests. Each response carries the number of times an action has run.
+ */
+
+public class CacheController extends BaseController {
+
+    function CacheController() {
+        cacheAction("index")
+        cacheAction("lang", { vary: "Accept-Language" })
+        cacheAction("none", { lifespan: 0 })
+        cacheAction("brief", { lifespan: 1 })
+        cacheAction("tagged", { tags: "news" })
+    }
+
+    private function hit(): Void {
+        let path = home + "/db/hits"
+        let hits: String = "x"
+        if (exists(path)) {
+            hits += File.getString(path)
+        }
+        File.put(path, 0644, hits)
+        render(actionName + " " + hits.length)
+    }
+
+    action function index() {
+        hit()
+    }
+
+    action function lang() {
+        hit()
+    }
+
+    action function none() {
+        hit()
+    }
+
+    action function brief() {
+        hit()
+    }
+
+    action function tagged() {
+        hit()
+    }
+
+    action function expire() {
+        expireCache("news")
+        render("expired")
+    }
+}
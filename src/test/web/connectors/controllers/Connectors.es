@@ -0,0 +1,28 @@
+/*
+ *  Connectors.es - Controller for the connector tests
+ */
+
+public class ConnectorsController extends BaseController {
+
+    action function json() {
+        writeJSON({ n: params.n, name: "connectors" })
+        render()
+    }
+
+    /*
+     *  Send the headers before any body data is ready
+     */
+    action function late() {
+        stream(true)
+        flush()
+        App.sleep(200)
+        render("late\n")
+    }
+
+    /*
+     *  A large dynamic response
+     */
+    action function big() {
+        render(File.getString(home + "/web/big.txt"))
+    }
+}
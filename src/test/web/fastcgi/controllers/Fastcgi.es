@@ -0,0 +1,13 @@
+/*
+ *  Fastcgi.es - Controller for the FastCGI tests
+ */
+
+public class FastcgiController extends BaseController {
+
+    /*
+     *  Echo the query and form parameters
+     */
+    action function echo() {
+        render("name=" + params.name + " body=" + params.body + "\n")
+    }
+}
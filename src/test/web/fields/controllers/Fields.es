@@ -0,0 +1,32 @@
+/*
+ *  Fields.es - Controller for the request and host field tests
+ */
+
+public class FieldsController extends BaseController {
+
+    private function describe(): String {
+        return request.url + " " + request.method + " " + request.query + " " + request.userAgent + " " + 
+            host.name + " " + host.software
+    }
+
+    /*
+     *  Read the fields, collect garbage and read them again. The values kept by the request and host objects must
+     *  survive the collection. Request interpreters run with the collector disabled, so enable it for the action.
+     */
+    action function collect() {
+        GC.enabled = true
+        let before: String = describe()
+        GC.run(true)
+        let garbage: Array = []
+        for (var i: Number = 0; i < 2000; i++) {
+            garbage.append("value " + i)
+        }
+        let after: String = describe()
+        GC.enabled = false
+        if (before == after) {
+            render("same " + after)
+        } else {
+            render("before " + before + ", after " + after)
+        }
+    }
+}
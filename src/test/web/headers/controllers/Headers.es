@@ -0,0 +1,57 @@
+/*
+ *  Headers.es - Controller for the header and form variable tests
+ */
+
+public class HeadersController extends BaseController {
+
+    /*
+     *  Check the X-Field-N request headers each have the value N. Duplicate X-Twice headers are all kept.
+     */
+    action function incoming() {
+        let count: Number = 0
+        let twice: Number = 0
+        let bad: String = ""
+        for each (header in request.headers) {
+            for (key in header) {
+                if (key.startsWith("HTTP_X_FIELD_")) {
+                    count++
+                    if (header[key] != key.slice(13)) {
+                        bad += " " + key
+                    }
+                } else if (key == "HTTP_X_TWICE") {
+                    twice++
+                }
+            }
+        }
+        render("fields " + count + " twice " + twice + bad)
+    }
+
+    /*
+     *  Set many response headers. Header keys are case insensitive so X-Dup is overwritten.
+     */
+    action function outgoing() {
+        for (i in 100) {
+            setHeader("X-Out-" + i, "" + i)
+        }
+        setHeader("X-Dup", "first")
+        setHeader("x-dup", "second")
+        render("outgoing")
+    }
+
+    /*
+     *  Check the pN form variables each have the value N
+     */
+    action function fields() {
+        let count: Number = 0
+        let bad: String = ""
+        for (key in params) {
+            if (key.startsWith("p")) {
+                count++
+                if (params[key] != key.slice(1)) {
+                    bad += " " + key
+                }
+            }
+        }
+        render("form " + count + bad)
+    }
+}
@@ -0,0 +1,10 @@
+/*
+ *  Echo.es - Controller for the keep-alive tests
+ */
+
+public class EchoController extends BaseController {
+
+    action function index() {
+        render("echo " + params.n)
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ *  Packets.es - Controller for the packet tests. Responses are numbered lines so a lost, repeated or reordered
+ *  byte changes the body.
+ */
+
+public class PacketsController extends BaseController {
+
+    private function lines(from: Number, to: Number): String {
+        let result: String = ""
+        for (i = from; i < to; i++) {
+            result += "line " + i + "\n"
+        }
+        return result
+    }
+
+    /*
+     *  A response larger than the queue limits. It is split into packets on its way to the connector.
+     */
+    action function big() {
+        render(lines(0, 12000))
+    }
+
+    /*
+     *  A streamed response. Its length is not known in advance so it is sent with transfer chunk encoding.
+     */
+    action function streamed() {
+        stream(true)
+        for (i = 0; i < 12000; i += 1000) {
+            write(lines(i, i + 1000))
+        }
+    }
+
+    action function echo() {
+        render("echo " + params.text)
+    }
+}
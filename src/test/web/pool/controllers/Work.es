@@ -0,0 +1,10 @@
+/*
+ *  Work.es - Controller for the thread pool tests
+ */
+
+public class WorkController extends BaseController {
+
+    action function index() {
+        render("work " + params.n)
+    }
+}
@@ -0,0 +1,10 @@
+/*
+ *  Echo.es - Controller for the reactor tests
+ */
+
+public class EchoController extends BaseController {
+
+    action function index() {
+        render("echo " + params.n)
+    }
+}
@@ -0,0 +1,22 @@
+/*
+ *  Blog.es - Controller for the route table tests. Each action reports the route parameters it received.
+ */
+
+public class BlogController extends BaseController {
+
+    action function index() {
+        render("index")
+    }
+
+    action function latest() {
+        render("latest")
+    }
+
+    action function archive() {
+        render("archive " + params.year + "/" + params.month)
+    }
+
+    action function show() {
+        render("show " + params.id)
+    }
+}
@@ -0,0 +1,32 @@
+/*
+ *  Sessions.es - Controller for the session expiry tests
+ */
+
+public class SessionsController extends BaseController {
+
+    /*
+     *  The session is available to the next request from the client
+     */
+    action function create() {
+        createSession(params.timeout - 0)
+        render("created\n")
+    }
+
+    action function set() {
+        session["value"] = params.value
+        render("set " + params.value + "\n")
+    }
+
+    action function get() {
+        render("value=" + (session ? session["value"] : "none") + "\n")
+    }
+
+    /*
+     *  Keep using the session for the given number of milliseconds and then update it
+     */
+    action function hold() {
+        App.sleep(params.delay - 0)
+        session["value"] = params.value
+        render("held\n")
+    }
+}
@@ -0,0 +1,23 @@
+/*
+ *  Shm.es - Controller for the shared session store tests
+ */
+
+public class ShmController extends BaseController {
+
+    /*
+     *  The session is available to the next request from the client
+     */
+    action function create() {
+        createSession(60)
+        render("created\n")
+    }
+
+    action function set() {
+        session["value"] = params.value
+        render("set " + params.value + "\n")
+    }
+
+    action function get() {
+        render("value=" + (session ? session["value"] : "none") + "\n")
+    }
+}
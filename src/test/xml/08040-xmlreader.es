@@ -0,0 +1,115 @@
+/*
+ *  Streaming XML reader
+ */
+const TestFile: String = "xmlreader.xml"
+const Count: Number = 200
+
+function input(): File {
+    var file: File = new File(TestFile)
+    file.open(File.Read)
+    return file
+}
+
+var f: File = new File(TestFile)
+f.open(File.Create | File.Write | File.Truncate)
+f.write('<?xml version="1.0"?>\n<feed version="2">\n<!-- header -->\n')
+for (i = 0; i < Count; i++) {
+    f.write('<item id="' + i + '" kind="test"><title>Item ' + i + '</title><empty/></item>\n')
+}
+f.write('</feed>\n')
+f.close()
+
+var events = []
+var items = 0
+var empties = 0
+var lastTitle
+var comment
+var depth = 0
+var maxDepth = 0
+
+var reader: XMLReader = new XMLReader(input())
+reader.parse({
+    start: function (name, attributes) {
+        depth++
+        if (depth > maxDepth) {
+            maxDepth = depth
+        }
+        if (name == "feed") {
+            assert(attributes.version == "2")
+        } else if (name == "item") {
+            assert(attributes.id == items)
+            assert(attributes.kind == "test")
+            items++
+        } else if (name == "empty") {
+            empties++
+        }
+    },
+    end: function (name) {
+        depth--
+    },
+    text: function (text) {
+        lastTitle = text
+    },
+    comment: function (text) {
+        comment = text
+    }
+})
+assert(items == Count)
+assert(empties == Count)
+assert(depth == 0)
+assert(maxDepth == 3)
+assert(lastTitle == "Item " + (Count - 1))
+assert(comment.contains("header"))
+assert(reader.lineNumber > Count)
+
+//
+//  Handlers are optional
+//
+items = 0
+new XMLReader(input()).parse({
+    end: function (name) {
+        if (name == "item") {
+            items++
+        }
+    }
+})
+assert(items == Count)
+
+//
+//  Malformed input
+//
+f = new File(TestFile)
+f.open(File.Create | File.Write | File.Truncate)
+f.write('<a><b></a>')
+f.close()
+caught = false
+try {
+    new XMLReader(input()).parse({})
+} catch (e) {
+    caught = e is SyntaxError
+}
+assert(caught)
+
+//
+//  Exceptions in handlers propagate
+//
+f = new File(TestFile)
+f.open(File.Create | File.Write | File.Truncate)
+f.write('<a><b/></a>')
+f.close()
+var stopper = {
+    start: function (name) {
+        if (name == "b") {
+            throw new Error("stop")
+        }
+    }
+}
+caught = false
+try {
+    new XMLReader(input()).parse(stopper)
+} catch (e) {
+    caught = ("" + e).contains("stop")
+}
+assert(caught)
+
+new File(TestFile).remove()
@@ -900,6 +900,7 @@ static EjsVar *insertArray(Ejs *ejs, EjsArray *ap, int argc, EjsVar **argv)
     }
     for (i = 0; i < delta; i++) {
         dest[pos++] = src[i];
+        ejsSetReference(ejs, (EjsVar*) ap, src[i]);
     }
 
     return (EjsVar*) ap;
@@ -1050,6 +1051,7 @@ static EjsVar *pushArray(Ejs *ejs, EjsArray *ap, int argc, EjsVar **argv)
     src = args->data;
     for (i = 0; i < args->length; i++) {
         dest[i + oldLen] = src[i];
+        ejsSetReference(ejs, (EjsVar*) ap, src[i]);
     }
     return (EjsVar*) ejsCreateNumber(ejs, ap->length);
 }
@@ -1314,6 +1316,7 @@ static EjsVar *spliceArray(Ejs *ejs, EjsArray *ap, int argc, EjsVar **argv)
      */
     for (i = 0; i < values->length; i++) {
         data[start + i] = items[i];
+        ejsSetReference(ejs, (EjsVar*) ap, items[i]);
     }
 
     /*
@@ -1432,14 +1435,15 @@ static int growArray(Ejs *ejs, EjsArray *ap, int len)
      *  Allocate or grow the data structures
      */
     if (len > size) {
+        count = len;
         if (size > EJS_LOTSA_PROP) {
             /*
-             *  Looks like a big object so grow by a bigger chunk
+             *  Looks like a big object so grow by a bigger chunk. Only the capacity is rounded, not the length.
              */
             factor = max(size / 4, EJS_NUM_PROP);
-            len = (len + factor) / factor * factor;
+            count = (len + factor) / factor * factor;
         }
-        count = EJS_PROP_ROUNDUP(len);
+        count = EJS_PROP_ROUNDUP(count);
 
         if (ap->data == 0) {
             mprAssert(ap->length == 0);
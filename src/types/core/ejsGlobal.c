@@ -8,9 +8,86 @@
 
 #include    "ejs.h"
 
+/*
+ *  Deserialization parser state
+ */
+typedef struct JsonState {
+    Ejs         *ejs;
+    cchar       *next;                  /* Next input character */
+    cchar       *end;                   /* End of input */
+    MprBuf      *token;                 /* Current string or bare word token */
+    int         depth;                  /* Object literal nesting depth */
+} JsonState;
+
+/*
+ *  Binary serialization. The encoding is a two byte header followed by one tagged value:
+ *
+ *      EJS_BIN_MAGIC EJS_BIN_VERSION value
+ *
+ *  Integers, lengths and counts are varints and signed integers are zig-zag encoded. Strings are written once and 
+ *  thereafter referenced by their index in a string table. Objects and arrays are numbered as they are written so 
+ *  that shared and cyclic references are written as back-references.
+ */
+#define EJS_BIN_MAGIC           0xEB
+#define EJS_BIN_VERSION         1
+#define EJS_BIN_MAX_INTERN      256         /* Longer strings are not entered in the string table */
+#define EJS_BIN_HASH            61
+
+#define EJS_BIN_UNDEFINED       0
+#define EJS_BIN_NULL            1
+#define EJS_BIN_FALSE           2
+#define EJS_BIN_TRUE            3
+#define EJS_BIN_INTEGER         4           /* Zig-zag varint */
+#define EJS_BIN_DOUBLE          5           /* 8 byte little-endian IEEE double */
+#define EJS_BIN_STRING          6           /* Length, bytes. Entered in the string table */
+#define EJS_BIN_STRING_REF      7           /* String table index */
+#define EJS_BIN_ARRAY           8           /* Length, elements */
+#define EJS_BIN_OBJECT          9           /* Count, { key string, value }... */
+#define EJS_BIN_OBJECT_REF      10          /* Object table index */
+#define EJS_BIN_DATE            11          /* Zig-zag varint milliseconds */
+#define EJS_BIN_BYTES           12          /* Length, bytes, read position, write position */
+
+/*
+ *  Private serialization flag to emit strict JSON. Must not clash with EJS_FLAGS_ENUM_*.
+ */
+#define EJS_FLAGS_JSON          0x100
+
+typedef struct BinaryWriter {
+    Ejs             *ejs;
+    MprBuf          *buf;
+    MprHashTable    *strings;               /* String table index + 1 by value */
+    MprHashTable    *objects;               /* Object table index + 1 by address */
+    int             numStrings;
+    int             numObjects;
+    int             maxDepth;
+    int             depth;
+    int             flags;
+} BinaryWriter;
+
+typedef struct BinaryReader {
+    Ejs             *ejs;
+    cuchar          *next;
+    cuchar          *end;
+    MprList         *strings;               /* String table */
+    MprList         *objects;               /* Object table */
+    int             depth;
+} BinaryReader;
+
 /***************************** Forward Declarations ***************************/
 
-static EjsVar *parseLiteral(Ejs *ejs, char **next);
+static EjsVar *parseArray(JsonState *js);
+static EjsVar *parseObject(JsonState *js);
+static int parseToken(JsonState *js);
+static EjsVar *parseValue(JsonState *js);
+static void ownPropertyName(EjsVar *obj, cchar *name);
+static void putKey(MprBuf *buf, cchar *name, int flags);
+static void putString(MprBuf *buf, cchar *str, int len);
+static void putUtf8(MprBuf *buf, int c);
+static EjsVar *readBinaryVar(BinaryReader *br);
+static inline void skipSpace(JsonState *js);
+static int serializeToBuf(Ejs *ejs, MprBuf *buf, EjsVar *vp, int maxDepth, int flags);
+static int serializeVar(Ejs *ejs, MprBuf *buf, EjsVar *vp, int maxDepth, int flags);
+static int writeBinaryVar(BinaryWriter *bw, EjsVar *vp);
 
 /*********************************** Locals ***********************************/
 /**
@@ -79,26 +156,52 @@ static EjsVar *cloneBase(Ejs *ejs, EjsVar *ignored, int argc, EjsVar **argv)
 
 
 
-//  TODO - merge with parse() to handle all types
-//  TODO - this parser is not robust enough. Need lookahead - rewrite.
+/*
+ *  Deserialize a string into an object. This is a single pass parser that creates objects directly as the input 
+ *  is scanned. It accepts JSON and the more relaxed object literal syntax produced by serialize(): keys may be 
+ *  unquoted, strings may use single or double quotes and trailing commas are permitted. Byte arrays are decoded as 
+ *  binary serializations. Their read position is not changed.
+ */
 EjsVar *ejsDeserialize(Ejs *ejs, EjsVar *value)
 {
-    EjsVar      *obj;
-    char        *str, *next;
-
+    EjsByteArray    *ap;
+    EjsString       *str;
+    EjsVar          *obj;
+    JsonState       js;
+
+    if (ejsIsByteArray(value)) {
+        ap = (EjsByteArray*) value;
+        return ejsDeserializeBinary(ejs, (cchar*) &ap->value[ap->readPosition], ap->writePosition - ap->readPosition);
+    }
     if (!ejsIsString(value)) {
         return 0;
     }
-    str = ejsGetString(value);
-    if (str == 0) {
+    str = (EjsString*) value;
+    if (str->value == 0) {
         return 0;
-    } else if (*str == '\0') {
+    } else if (str->length == 0) {
         return (EjsVar*) ejs->emptyStringValue;
     }
+    js.ejs = ejs;
+    js.next = str->value;
+    js.end = &str->value[str->length];
+    js.depth = 0;
+    if ((js.token = mprCreateBuf(ejs, 0, 0)) == 0) {
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    obj = parseValue(&js);
+    mprFree(js.token);
 
-    next = str;
-    if ((obj = parseLiteral(ejs, &next)) == 0) {
-        ejsThrowSyntaxError(ejs, "Can't parse object literal");
+    if (obj == 0) {
+        if (!ejs->exception) {
+            ejsThrowSyntaxError(ejs, "Can't parse object literal");
+        }
+        return 0;
+    }
+    skipSpace(&js);
+    if (js.next < js.end) {
+        ejsThrowSyntaxError(ejs, "Unexpected characters after object literal");
         return 0;
     }
     return obj;
@@ -106,217 +209,283 @@ EjsVar *ejsDeserialize(Ejs *ejs, EjsVar *value)
 
 
 /*
- *  Convert a string into an object.
+ *  Convert a string or byte array into an object.
  *
- *  intrinsic native static function deserialize(obj: String): Object
+ *  intrinsic native static function deserialize(obj: Object): Object
  */
 EjsVar *deserialize(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 {
-    mprAssert(argc == 1 && ejsIsString(argv[0]));
+    mprAssert(argc == 1);
+
+    if (!ejsIsString(argv[0]) && !ejsIsByteArray(argv[0])) {
+        ejsThrowArgError(ejs, "Can only deserialize strings and byte arrays");
+        return 0;
+    }
     return ejsDeserialize(ejs, argv[0]);
 }
 
 
-typedef enum Token {
-    TOK_EOF,
-    TOK_LBRACE,
-    TOK_LBRACKET,
-    TOK_RBRACE,
-    TOK_RBRACKET,
-    TOK_COLON,
-    TOK_COMMA,
-    TOK_ID,
-    TOK_QID,            /* QUOTED */
-} Token;
+static inline void skipSpace(JsonState *js)
+{
+    while (js->next < js->end && isspace((int) *js->next)) {
+        js->next++;
+    }
+}
 
-//  TODO - get more unique name for all-in-one
 
-Token getToken(char *token, char **next)
+/*
+ *  Parse a value. Returns null on syntax errors.
+ */
+static EjsVar *parseValue(JsonState *js)
 {
-    char    *cp, *start, *firstQuote, *src, *dest;
-    int     quote, tid;
-
-    for (cp = *next; isspace((int) *cp); cp++) {
-        ;
+    Ejs         *ejs;
+    cchar       *token;
+    int         quoted;
+
+    ejs = js->ejs;
+    skipSpace(js);
+    if (js->next >= js->end) {
+        if (js->depth > 0) {
+            ejsThrowSyntaxError(ejs, "Missing value in object literal");
+        }
+        return 0;
+    }
+    if (*js->next == '{') {
+        return parseObject(js);
+    } else if (*js->next == '[') {
+        return parseArray(js);
+    }
+    if ((quoted = parseToken(js)) < 0) {
+        return 0;
+    }
+    token = mprGetBufStart(js->token);
+    if (quoted) {
+        return (EjsVar*) ejsCreateStringWithLength(ejs, token, mprGetBufLength(js->token));
+    } else if (strcmp(token, "null") == 0) {
+        return ejs->nullValue;
+    } else if (strcmp(token, "undefined") == 0) {
+        return ejs->undefinedValue;
     }
+    return ejsParseVar(ejs, token, -1);
+}
+
 
-    *next = cp + 1;
-    firstQuote = 0;
+/*
+ *  Make a property name allocated by the parser a child of the object's name table. Object type pools recycle 
+ *  objects without freeing their other children, but the name table is freed whenever the object is destroyed.
+ */
+static void ownPropertyName(EjsVar *obj, cchar *name)
+{
+    EjsObject   *op;
 
-    if (*cp == '\0') {
-        tid = TOK_EOF;
+    op = (EjsObject*) obj;
+    if (op->names && mprGetParent(op->names) == op) {
+        mprStealBlock(op->names, name);
+    }
+}
 
-    } else  if (*cp == '{') {
-        tid = TOK_LBRACE;
 
-    } else if (*cp == '[') {
-        tid = TOK_LBRACKET;
+/*
+ *  Parse an object literal. Members must be separated by commas and a trailing comma is permitted.
+ */
+static EjsVar *parseObject(JsonState *js)
+{
+    Ejs         *ejs;
+    EjsName     qname;
+    EjsVar      *obj, *vp;
+    char        *key;
 
-    } else if (*cp == '}' || *cp == ']') {
-        tid = *cp == '}' ? TOK_RBRACE: TOK_RBRACKET;
-        while (*++cp && isspace((int) *cp)) {
-            ;
+    ejs = js->ejs;
+    if (++js->depth > EJS_MAX_LITERAL_DEPTH) {
+        ejsThrowSyntaxError(ejs, "Object literal is nested too deeply");
+        return 0;
+    }
+    js->next++;
+    if ((obj = (EjsVar*) ejsCreateObject(ejs, ejs->objectType, 0)) == 0) {
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    while (1) {
+        skipSpace(js);
+        if (js->next >= js->end) {
+            ejsThrowSyntaxError(ejs, "Missing closing brace in object literal");
+            return 0;
+        } else if (*js->next == '}') {
+            js->next++;
+            break;
         }
-        if (*cp == ',' || *cp == ':') {
-            cp++;
+        if (parseToken(js) < 0) {
+            return 0;
         }
-        *next = cp;
-
-    } else if (*cp == ':') {
-        tid = TOK_COLON;
-
-    } else {
-        quote = 0;
-        start = cp;
-        for (start = cp; *cp; cp++) {
-            if (*cp == '\\') {
-                cp++;
-            } else if (*cp == '\'' || *cp == '\"') {
-                if (quote) {
-                    if (*cp == quote && cp > firstQuote && cp[-1] != '\\') {
-                        *cp = '\0';
-                        quote = 0;
-                    }
-                } else {
-                    firstQuote = cp;
-                    start = cp + 1;
-                    quote = *cp;
-                }
-                continue;
-            }
-            if (!quote && (*cp == ',' || *cp == ':')) {
-                break;
-            }
-            if (!quote && (*cp == ']' || *cp == '}')) {
-                break;
-            }
+        key = mprStrdup(obj, mprGetBufStart(js->token));
+        skipSpace(js);
+        if (js->next >= js->end || *js->next != ':') {
+            ejsThrowSyntaxError(ejs, "Missing colon after \"%s\" in object literal", key);
+            return 0;
         }
-        if (quote && *start == quote) {
-            /* No matching end */
-            start--;
+        js->next++;
+        if ((vp = parseValue(js)) == 0) {
+            return 0;
         }
-        strncpy(token, start, min(MPR_MAX_STRING, cp - start));
-        token[cp - start] = '\0';
-        if (*cp == ',' || *cp == ':') {
-            cp++;
+        ejsName(&qname, EJS_PUBLIC_NAMESPACE, key);
+        if (ejsSetPropertyByName(ejs, obj, &qname, vp) < 0) {
+            return 0;
         }
-        *next = cp;
-
-        for (dest = src = token; *src; ) {
-            if (*src == '\\') {
-                src++;
-            }
-            *dest++ = *src++;
+        ownPropertyName(obj, key);
+        skipSpace(js);
+        if (js->next < js->end && *js->next == ',') {
+            js->next++;
+        } else if (js->next < js->end && *js->next != '}') {
+            ejsThrowSyntaxError(ejs, "Expected a comma or closing brace after \"%s\" in object literal", key);
+            return 0;
         }
-        *dest = '\0';
-
-        tid = (firstQuote) ? TOK_QID : TOK_ID;
     }
-    return tid;
+    js->depth--;
+    return obj;
 }
 
 
 /*
- *  Parse an object literal string pointed to by *next into the given object. Update *next to point
- *  to the next input token in the object literal. Supports nested object literals.
- *  TODO - should be rewritten to handle unbounded key and value tokens
+ *  Parse an array literal. Elements must be separated by commas and a trailing comma is permitted.
  */
-static EjsVar *parseLiteral(Ejs *ejs, char **next)
+static EjsVar *parseArray(JsonState *js)
 {
-    EjsName     qname;
+    Ejs         *ejs;
     EjsVar      *obj, *vp;
-    char        *kp, *prior;
-    char        token[MPR_MAX_STRING], key[MPR_MAX_STRING], value[MPR_MAX_STRING];
-    int         tid, isArray;
 
-    isArray = 0;
-
-    tid = getToken(token, next);
-    if (tid == TOK_EOF) {
+    ejs = js->ejs;
+    if (++js->depth > EJS_MAX_LITERAL_DEPTH) {
+        ejsThrowSyntaxError(ejs, "Object literal is nested too deeply");
         return 0;
     }
-
-    if (tid == TOK_LBRACKET) {
-        isArray = 1;
-        obj = (EjsVar*) ejsCreateArray(ejs, 0);
-
-    } else if (tid == TOK_LBRACE) {
-        obj = (EjsVar*) ejsCreateObject(ejs, ejs->objectType, 0);
-
-    } else {
-        return ejsParseVar(ejs, token, -1);
-    }
-    if (obj == 0) {
+    js->next++;
+    if ((obj = (EjsVar*) ejsCreateArray(ejs, 0)) == 0) {
         ejsThrowMemoryError(ejs);
         return 0;
     }
-
     while (1) {
-        prior = *next;
-        tid = getToken(key, next);
-        if (tid == TOK_EOF) {
-            return obj;
-        } else if (tid == TOK_RBRACE || tid == TOK_RBRACKET) {
+        skipSpace(js);
+        if (js->next >= js->end) {
+            ejsThrowSyntaxError(ejs, "Missing closing bracket in array literal");
+            return 0;
+        } else if (*js->next == ']') {
+            js->next++;
             break;
         }
+        if ((vp = parseValue(js)) == 0) {
+            return 0;
+        }
+        if (ejsSetProperty(ejs, obj, -1, vp) < 0) {
+            return 0;
+        }
+        skipSpace(js);
+        if (js->next < js->end && *js->next == ',') {
+            js->next++;
+        } else if (js->next < js->end && *js->next != ']') {
+            ejsThrowSyntaxError(ejs, "Expected a comma or closing bracket in array literal");
+            return 0;
+        }
+    }
+    js->depth--;
+    return obj;
+}
 
-        if (tid == TOK_LBRACKET) {
-            *next = prior;
-            vp = parseLiteral(ejs, next);
-
-        } else if (tid == TOK_LBRACE) {
-            *next = prior;
-            vp = parseLiteral(ejs, next);
-
-        } else if (isArray) {
-            vp = ejsParseVar(ejs, key, -1);
-
-        } else {
-            //  TODO - really need a peek
-            prior = *next;
-            tid = getToken(value, next);
-            if (tid == TOK_LBRACE || tid == TOK_LBRACKET) {
-                *next = prior;
-                vp = parseLiteral(ejs, next);
-
-            } else if (tid != TOK_ID && tid != TOK_QID) {
-                return 0;
 
-            } else {
-                if (tid == TOK_QID) {
-                    /* Quoted */
-                    vp = (EjsVar*) ejsCreateString(ejs, value);
-                } else {
-                    if (strcmp(value, "null") == 0) {
-                        vp = ejs->nullValue;
-                    } else if (strcmp(value, "undefined") == 0) {
-                        vp = ejs->undefinedValue;
-                    } else {
-                        vp = ejsParseVar(ejs, value, -1);
+/*
+ *  Parse a quoted string or a bare word into js->token. Quoted strings are unescaped. Bare words extend to the next 
+ *  delimiter or white space. Returns 1 if the token was quoted, 0 for a bare word and -1 for an unterminated string
+ *  or a missing word.
+ */
+static int parseToken(JsonState *js)
+{
+    MprBuf      *buf;
+    cchar       *cp, *start;
+    int         quote, c, i;
+
+    buf = js->token;
+    mprFlushBuf(buf);
+    cp = js->next;
+
+    if (*cp == '"' || *cp == '\'') {
+        quote = *cp++;
+        for (start = cp; cp < js->end && *cp != quote; cp++) {
+            if (*cp != '\\') {
+                continue;
+            }
+            mprPutBlockToBuf(buf, start, (int) (cp - start));
+            if (++cp >= js->end) {
+                break;
+            }
+            switch (*cp) {
+            case 'b':
+                mprPutCharToBuf(buf, '\b');
+                break;
+            case 'f':
+                mprPutCharToBuf(buf, '\f');
+                break;
+            case 'n':
+                mprPutCharToBuf(buf, '\n');
+                break;
+            case 'r':
+                mprPutCharToBuf(buf, '\r');
+                break;
+            case 't':
+                mprPutCharToBuf(buf, '\t');
+                break;
+            case 'u':
+                if ((js->end - cp) > 4 && isxdigit((int) cp[1]) && isxdigit((int) cp[2]) && isxdigit((int) cp[3]) && 
+                        isxdigit((int) cp[4])) {
+                    for (c = 0, i = 1; i <= 4; i++) {
+                        c = (c << 4) | (isdigit((int) cp[i]) ? cp[i] - '0' : tolower((int) cp[i]) - 'a' + 10);
                     }
+                    putUtf8(buf, c);
+                    cp += 4;
+                    break;
                 }
+                /* Fall through */
+            default:
+                mprPutCharToBuf(buf, *cp);
             }
+            start = cp + 1;
         }
-        if (vp == 0) {
-            return 0;
+        if (cp >= js->end) {
+            ejsThrowSyntaxError(js->ejs, "Unterminated string in object literal");
+            return -1;
         }
+        mprPutBlockToBuf(buf, start, (int) (cp - start));
+        mprAddNullToBuf(buf);
+        js->next = cp + 1;
+        return 1;
+    }
 
-        if (isArray) {
-            if (ejsSetProperty(ejs, obj, -1, vp) < 0) {
-                return 0;
-            }
-
-        } else {
-            //  TODO - bug. Could leak if this object is put back on the object type pool and reused in this manner.
-            kp = mprStrdup(obj, key);
-            ejsName(&qname, EJS_PUBLIC_NAMESPACE, kp);
-            if (ejsSetPropertyByName(ejs, obj, &qname, vp) < 0) {
-                return 0;
-            }
+    for (start = cp; cp < js->end; cp++) {
+        if (*cp == ',' || *cp == ':' || *cp == ']' || *cp == '}' || isspace((int) *cp)) {
+            break;
         }
+    }
+    if (cp == start) {
+        ejsThrowSyntaxError(js->ejs, "Missing %s in object literal", (*cp == ':') ? "property name" : "value");
+        return -1;
+    }
+    js->next = cp;
+    mprPutBlockToBuf(buf, start, (int) (cp - start));
+    mprAddNullToBuf(buf);
+    return 0;
+}
+
 
+static void putUtf8(MprBuf *buf, int c)
+{
+    if (c < 0x80) {
+        mprPutCharToBuf(buf, c);
+    } else if (c < 0x800) {
+        mprPutCharToBuf(buf, 0xC0 | (c >> 6));
+        mprPutCharToBuf(buf, 0x80 | (c & 0x3F));
+    } else {
+        mprPutCharToBuf(buf, 0xE0 | (c >> 12));
+        mprPutCharToBuf(buf, 0x80 | ((c >> 6) & 0x3F));
+        mprPutCharToBuf(buf, 0x80 | (c & 0x3F));
     }
-    return obj;
 }
 
 
@@ -501,21 +670,35 @@ static EjsVar *printv(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 #endif
 
 
+/*
+ *  Serialize a variable into a string. The entire object graph is written into one buffer before creating the result.
+ */
 EjsVar *ejsSerialize(Ejs *ejs, EjsVar *vp, int maxDepth, bool showAll, bool showBase)
 {
-    EjsString       *result;
-    EjsVar          *pp;
-    EjsObject       *obj;
-    EjsString       *sv;
-    EjsBlock        *block;
-    MprBuf          *buf;
-    EjsName         qname;
-    char            key[16], *cp;
-    int             i, slotNum, numInherited, flags, isArray, count;
+    EjsVar      *result;
+    MprBuf      *buf;
 
-    if (maxDepth == 0) {
-        maxDepth = MAXINT;
+    if ((buf = mprCreateBuf(ejs, 0, 0)) == 0) {
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    if (ejsSerializeToBuf(ejs, buf, vp, maxDepth, showAll, showBase) < 0) {
+        mprFree(buf);
+        return 0;
     }
+    result = (EjsVar*) ejsCreateStringWithLength(ejs, mprGetBufStart(buf), mprGetBufLength(buf));
+    mprFree(buf);
+    return result;
+}
+
+
+/*
+ *  Serialize a variable by appending to the given buffer. Returns zero if successful.
+ */
+int ejsSerializeToBuf(Ejs *ejs, MprBuf *buf, EjsVar *vp, int maxDepth, bool showAll, bool showBase)
+{
+    int     flags;
+
     flags = 0;
     if (showAll) {
         flags |= EJS_FLAGS_ENUM_ALL;
@@ -523,150 +706,887 @@ EjsVar *ejsSerialize(Ejs *ejs, EjsVar *vp, int maxDepth, bool showAll, bool show
     if (showBase) {
         flags |= EJS_FLAGS_ENUM_INHERITED;
     }
+    return serializeToBuf(ejs, buf, vp, maxDepth, flags);
+}
 
-    buf = mprCreateBuf(vp, 0, 0);
-    if (buf == 0) {
-        ejsThrowMemoryError(ejs);
-        return 0;
-    }
 
-    /*
-     *  TODO - this whole strategy is flawed. Need a serialize helper per object
-     */
-    count = ejsGetPropertyCount(ejs, vp);
+/*
+ *  Serialize a variable as strict JSON by appending to the given buffer. Keys are quoted, functions and undefined 
+ *  properties are omitted and cyclic references throw a TypeError. Returns zero if successful.
+ */
+int ejsSerializeJSON(Ejs *ejs, MprBuf *buf, EjsVar *vp)
+{
+    return serializeToBuf(ejs, buf, vp, 0, EJS_FLAGS_JSON);
+}
 
-    if (count == 0 || ejsIsXML(vp)) {
 
-        if (ejsIsFunction(vp)) {
-            mprPutStringToBuf(buf, "[function]");
-
-        } else if (ejsIsString(vp) || ejsIsXML(vp)) {
-            mprPutCharToBuf(buf, '\"');
-            sv = (EjsString*) ejsToString(ejs, vp);
-            if (strchr(sv->value, '"')) {
-                for (cp = sv->value; cp < &sv->value[sv->length]; cp++) {
-                    if (*cp == '"') {
-                        mprPutCharToBuf(buf, '\\');
-                        mprPutCharToBuf(buf, *cp);
-                    } else {
-                        mprPutCharToBuf(buf, *cp);
-                    }
-                }
-            } else {
-                mprPutStringToBuf(buf, sv->value);
-            }
-            mprPutCharToBuf(buf, '\"');
+/*
+ *  Serialize into the caller's buffer. The buffer growth increment is raised as the output grows so that large 
+ *  serializations are not copied quadratically. The caller's increment is restored afterwards.
+ */
+static int serializeToBuf(Ejs *ejs, MprBuf *buf, EjsVar *vp, int maxDepth, int flags)
+{
+    int     growBy, rc;
 
-        } else if (ejsIsObject(vp)) {
-            mprPutStringToBuf(buf, "{}");
+    if (maxDepth == 0) {
+        maxDepth = MAXINT;
+    }
+    growBy = buf->growBy;
+    rc = serializeVar(ejs, buf, vp, maxDepth, flags);
+    buf->growBy = growBy;
+    return rc;
+}
 
-        } else {
-            sv = (EjsString*) ejsToString(ejs, vp);
-            mprPutStringToBuf(buf, sv->value);
-        }
 
-    } else {
+/*
+ *  Grow the buffer geometrically: the next growth is at least the current size, bounded by the buffer maximum.
+ */
+static void setSerializeGrowth(MprBuf *buf)
+{
+    int     size;
 
-        if (vp->visited) {
-            return (EjsVar*) ejsCreateString(ejs, "this");
+    size = mprGetBufSize(buf);
+    if (buf->growBy < size) {
+        buf->growBy = size;
+        if (buf->maxsize > 0 && (buf->buflen + buf->growBy) > buf->maxsize) {
+            buf->growBy = max(buf->maxsize - buf->buflen, 1);
         }
+    }
+}
 
-        isArray = ejsIsArray(vp);
-        mprPutStringToBuf(buf, isArray ? "[\n" : "{\n");
-
-        vp->visited = 1;
-        if (++ejs->serializeDepth <= maxDepth /* && ejsIsObject(vp) */) {
-
-            obj = (EjsObject*) vp;
-
-            for (slotNum = 0; slotNum < count; slotNum++) {
-                if (ejsIsBlock(vp)) {
-                    block = (EjsBlock*) vp;
-                    numInherited = ejsGetNumInheritedTraits((EjsBlock*) obj);
-                    if (slotNum < numInherited && !(flags & EJS_FLAGS_ENUM_INHERITED)) {
-                        continue;
-                    }
-                }
-                pp = ejsGetProperty(ejs, vp, slotNum);
-                
-                if (pp == 0 || (pp->hidden && !(flags & EJS_FLAGS_ENUM_ALL))) {
-                    if (ejs->exception) {
-                        return 0;
-                    }
-                    continue;
-                }
-                if (isArray) {
-                    mprItoa(key, sizeof(key), slotNum, 10);
-                    qname.name = key;
-                    qname.space = "";
-                } else {
-                    qname = ejsGetPropertyName(ejs, vp, slotNum);
-                }
-                for (i = 0; i < ejs->serializeDepth; i++) {
-                    mprPutStringToBuf(buf, "  ");
-                }
-                if (!isArray) {
-                    if (flags & EJS_FLAGS_ENUM_ALL) {
-                        mprPutFmtToBuf(buf, "%s_%s: ", qname.space, qname.name);
-                    } else {
-                        mprPutFmtToBuf(buf, "%s: ", qname.name);
-                    }
-                }
-
-                sv = (EjsString*) ejsSerialize(ejs, pp, maxDepth, showAll, showBase);
-                if (sv == 0 || !ejsIsString(sv)) {
-                    if (!ejs->exception) {
-                        ejsThrowTypeError(ejs, "Cant serialize property %s", qname.name);
-                    }
-                    return 0;
 
-                } else {
-                    mprPutStringToBuf(buf, sv->value);
-                }
+/*
+ *  Test if a name can be written as a bare word key and still be read back by ejsDeserialize
+ */
+static bool isBareKey(cchar *name)
+{
+    cchar   *cp;
 
-                mprPutStringToBuf(buf, ",\n");
-            }
+    if (*name == '\0' || isdigit((int) *name)) {
+        return 0;
+    }
+    for (cp = name; *cp; cp++) {
+        if (!isalnum((int) *cp) && *cp != '_' && *cp != '$') {
+            return 0;
         }
-        vp->visited = 0;
+    }
+    return 1;
+}
 
-        ejs->serializeDepth--;
-        for (i = 0; i < ejs->serializeDepth; i++) {
-            mprPutStringToBuf(buf, "  ");
-        }
-        mprPutCharToBuf(buf, isArray ? ']' : '}');
+
+/*
+ *  Write a property key. Keys are quoted in JSON and whenever they are not plain identifiers.
+ */
+static void putKey(MprBuf *buf, cchar *name, int flags)
+{
+    if ((flags & EJS_FLAGS_JSON) || !isBareKey(name)) {
+        putString(buf, name, (int) strlen(name));
+    } else {
+        mprPutStringToBuf(buf, name);
     }
+}
 
-    mprAddNullToBuf(buf);
-    result = ejsCreateString(ejs, mprGetBufStart(buf));
-    mprFree(buf);
 
-    return (EjsVar*) result;
+#if BLD_FEATURE_FLOATING_POINT
+/*
+ *  Test for a number other than NaN or an infinity. NaN is the only value not equal to itself.
+ */
+static bool isFinite(double d)
+{
+    return d == d && (d - d) == 0;
 }
+#endif
 
 
 /*
- *  Convert the object to a source code string.
- *
- *  intrinsic function serialize(obj: Object, maxDepth: Number = 0, showAll: Boolean = false, 
- *      showBase: Boolean = false): String
+ *  Write a value that has no properties. JSON only permits null, booleans, finite numbers and strings.
  */
-EjsVar *serialize(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+static int serializeLiteral(Ejs *ejs, MprBuf *buf, EjsVar *vp, int flags)
 {
-    EjsVar          *vp;
-    int             flags, maxDepth;
-    bool            showBase, showAll;
+    EjsString   *sv;
 
-    flags = 0;
-    maxDepth = MAXINT;
+    if (ejsIsFunction(vp)) {
+        mprPutStringToBuf(buf, (flags & EJS_FLAGS_JSON) ? "null" : "[function]");
+
+    } else if (ejsIsString(vp) || ejsIsXML(vp)) {
+        if ((sv = (EjsString*) ejsToString(ejs, vp)) == 0) {
+            return EJS_ERR;
+        }
+        putString(buf, sv->value, sv->length);
 
-    vp = argv[0];
+    } else if (ejsIsArray(vp)) {
+        mprPutStringToBuf(buf, "[]");
 
-    if (argc >= 2) {
-        maxDepth = ejsGetInt(argv[1]);
+    } else if (ejsIsObject(vp)) {
+        mprPutStringToBuf(buf, "{}");
+
+    } else if (!(flags & EJS_FLAGS_JSON) || ejsIsNull(vp) || ejsIsBoolean(vp)) {
+        if ((sv = (EjsString*) ejsToString(ejs, vp)) == 0) {
+            return EJS_ERR;
+        }
+        mprPutBlockToBuf(buf, sv->value, sv->length);
+
+    } else if (ejsIsUndefined(vp)) {
+        mprPutStringToBuf(buf, "null");
+
+    } else {
+        if ((sv = (EjsString*) ejsToString(ejs, vp)) == 0) {
+            return EJS_ERR;
+        }
+        if (!ejsIsNumber(vp)) {
+            putString(buf, sv->value, sv->length);
+#if BLD_FEATURE_FLOATING_POINT
+        } else if (!isFinite(ejsGetDouble(vp))) {
+            mprPutStringToBuf(buf, "null");
+#endif
+        } else {
+            mprPutBlockToBuf(buf, sv->value, sv->length);
+        }
     }
+    return 0;
+}
 
-    showAll = (argc >= 3 && argv[2] == (EjsVar*) ejs->trueValue);
-    showBase = (argc == 4 && argv[3] == (EjsVar*) ejs->trueValue);
+
+static int serializeVar(Ejs *ejs, MprBuf *buf, EjsVar *vp, int maxDepth, int flags)
+{
+    EjsVar          *pp;
+    EjsName         qname;
+    char            key[16];
+    int             i, slotNum, numInherited, isArray, count, written, rc;
+
+    /*
+     *  TODO - this whole strategy is flawed. Need a serialize helper per object
+     */
+    setSerializeGrowth(buf);
+    count = ejsGetPropertyCount(ejs, vp);
+
+    if (count == 0 || ejsIsXML(vp)) {
+        return serializeLiteral(ejs, buf, vp, flags);
+    }
+
+    if (vp->visited) {
+        if (flags & EJS_FLAGS_JSON) {
+            ejsThrowTypeError(ejs, "Can't serialize a cyclic reference as JSON");
+            return EJS_ERR;
+        }
+        mprPutStringToBuf(buf, "this");
+        return 0;
+    }
+    isArray = ejsIsArray(vp);
+    mprPutStringToBuf(buf, isArray ? "[\n" : "{\n");
+
+    rc = 0;
+    written = 0;
+    vp->visited = 1;
+    if (++ejs->serializeDepth <= maxDepth) {
+        numInherited = ejsIsBlock(vp) ? ejsGetNumInheritedTraits((EjsBlock*) vp) : 0;
+
+        for (slotNum = 0; slotNum < count; slotNum++) {
+            if (slotNum < numInherited && !(flags & EJS_FLAGS_ENUM_INHERITED)) {
+                continue;
+            }
+            pp = ejsGetProperty(ejs, vp, slotNum);
+            if (pp == 0 || (pp->hidden && !(flags & EJS_FLAGS_ENUM_ALL))) {
+                if (ejs->exception) {
+                    rc = EJS_ERR;
+                    break;
+                }
+                if (!isArray || !(flags & EJS_FLAGS_JSON)) {
+                    continue;
+                }
+                pp = ejs->nullValue;
+            }
+            if (!isArray && (flags & EJS_FLAGS_JSON) && (ejsIsFunction(pp) || ejsIsUndefined(pp))) {
+                continue;
+            }
+            if (isArray) {
+                mprItoa(key, sizeof(key), slotNum, 10);
+                qname.name = key;
+                qname.space = "";
+            } else {
+                qname = ejsGetPropertyName(ejs, vp, slotNum);
+            }
+            /*
+             *  JSON does not permit a trailing comma so the separator is written before each member
+             */
+            if ((flags & EJS_FLAGS_JSON) && written++ > 0) {
+                mprPutBlockToBuf(buf, ",\n", 2);
+            }
+            for (i = 0; i < ejs->serializeDepth; i++) {
+                mprPutStringToBuf(buf, "  ");
+            }
+            if (!isArray) {
+                if (flags & EJS_FLAGS_ENUM_ALL) {
+                    mprPutFmtToBuf(buf, "%s_%s: ", qname.space, qname.name);
+                } else {
+                    putKey(buf, qname.name, flags);
+                    mprPutBlockToBuf(buf, ": ", 2);
+                }
+            }
+            if (serializeVar(ejs, buf, pp, maxDepth, flags) < 0) {
+                if (!ejs->exception) {
+                    ejsThrowTypeError(ejs, "Cant serialize property %s", qname.name);
+                }
+                rc = EJS_ERR;
+                break;
+            }
+            if (!(flags & EJS_FLAGS_JSON)) {
+                mprPutBlockToBuf(buf, ",\n", 2);
+            }
+        }
+        if ((flags & EJS_FLAGS_JSON) && written > 0) {
+            mprPutCharToBuf(buf, '\n');
+        }
+    }
+    vp->visited = 0;
+    ejs->serializeDepth--;
+    if (rc < 0) {
+        return rc;
+    }
+    for (i = 0; i < ejs->serializeDepth; i++) {
+        mprPutStringToBuf(buf, "  ");
+    }
+    mprPutCharToBuf(buf, isArray ? ']' : '}');
+    return 0;
+}
+
+
+/*
+ *  Write a quoted string, escaping quotes, back slashes and control characters. Unescaped runs are copied as a block.
+ */
+static void putString(MprBuf *buf, cchar *str, int len)
+{
+    cchar   *cp, *start, *end;
+    int     c;
+
+    mprPutCharToBuf(buf, '"');
+    end = &str[len];
+    for (start = cp = str; cp < end; cp++) {
+        c = (uchar) *cp;
+        if (c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+        if (cp > start) {
+            mprPutBlockToBuf(buf, start, (int) (cp - start));
+        }
+        mprPutCharToBuf(buf, '\\');
+        switch (c) {
+        case '\b':
+            mprPutCharToBuf(buf, 'b');
+            break;
+        case '\f':
+            mprPutCharToBuf(buf, 'f');
+            break;
+        case '\n':
+            mprPutCharToBuf(buf, 'n');
+            break;
+        case '\r':
+            mprPutCharToBuf(buf, 'r');
+            break;
+        case '\t':
+            mprPutCharToBuf(buf, 't');
+            break;
+        case '"':
+        case '\\':
+            mprPutCharToBuf(buf, c);
+            break;
+        default:
+            mprPutFmtToBuf(buf, "u%04x", c);
+        }
+        start = cp + 1;
+    }
+    if (cp > start) {
+        mprPutBlockToBuf(buf, start, (int) (cp - start));
+    }
+    mprPutCharToBuf(buf, '"');
+}
+
+
+/*
+ *  Serialize a variable into a byte array using the compact binary encoding. The write position of the result is set 
+ *  to the length of the encoding.
+ */
+EjsVar *ejsSerializeBinary(Ejs *ejs, EjsVar *vp, int maxDepth, bool showAll, bool showBase)
+{
+    EjsByteArray    *ap;
+    MprBuf          *buf;
+    int             len;
+
+    if ((buf = mprCreateBuf(ejs, 0, 0)) == 0) {
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    if (ejsSerializeBinaryToBuf(ejs, buf, vp, maxDepth, showAll, showBase) < 0) {
+        mprFree(buf);
+        return 0;
+    }
+    len = mprGetBufLength(buf);
+    if ((ap = ejsCreateByteArray(ejs, len)) == 0) {
+        mprFree(buf);
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    memcpy(ap->value, mprGetBufStart(buf), len);
+    ejsSetByteArrayPositions(ejs, ap, 0, len);
+    mprFree(buf);
+    return (EjsVar*) ap;
+}
+
+
+/*
+ *  Serialize a variable by appending its binary encoding to the given buffer. Returns zero if successful.
+ */
+int ejsSerializeBinaryToBuf(Ejs *ejs, MprBuf *buf, EjsVar *vp, int maxDepth, bool showAll, bool showBase)
+{
+    BinaryWriter    bw;
+    int             rc;
+
+    memset(&bw, 0, sizeof(bw));
+    bw.ejs = ejs;
+    bw.buf = buf;
+    bw.maxDepth = (maxDepth == 0) ? MAXINT : maxDepth;
+    if (showAll) {
+        bw.flags |= EJS_FLAGS_ENUM_ALL;
+    }
+    if (showBase) {
+        bw.flags |= EJS_FLAGS_ENUM_INHERITED;
+    }
+    bw.strings = mprCreateHash(buf, EJS_BIN_HASH);
+    bw.objects = mprCreateHash(buf, EJS_BIN_HASH);
+    if (bw.strings == 0 || bw.objects == 0) {
+        ejsThrowMemoryError(ejs);
+        return EJS_ERR;
+    }
+    mprPutCharToBuf(buf, EJS_BIN_MAGIC);
+    mprPutCharToBuf(buf, EJS_BIN_VERSION);
+    rc = writeBinaryVar(&bw, vp);
+    mprFree(bw.strings);
+    mprFree(bw.objects);
+    return rc;
+}
+
+
+static void putVarint(MprBuf *buf, uint64 value)
+{
+    while (value >= 0x80) {
+        mprPutCharToBuf(buf, (int) ((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    mprPutCharToBuf(buf, (int) value);
+}
+
+
+static void putZigzag(MprBuf *buf, int64 value)
+{
+    putVarint(buf, ((uint64) value << 1) ^ (uint64) (value >> 63));
+}
+
+
+/*
+ *  Write a string. Strings already written are replaced by a reference to their string table index.
+ */
+static void writeBinaryString(BinaryWriter *bw, cchar *str, int len)
+{
+    int     index;
+
+    if (len <= EJS_BIN_MAX_INTERN && (int) strlen(str) == len) {
+        if ((index = PTOI(mprLookupHash(bw->strings, str))) > 0) {
+            mprPutCharToBuf(bw->buf, EJS_BIN_STRING_REF);
+            putVarint(bw->buf, index - 1);
+            return;
+        }
+        mprAddHash(bw->strings, str, ITOP(bw->numStrings + 1));
+    }
+    bw->numStrings++;
+    mprPutCharToBuf(bw->buf, EJS_BIN_STRING);
+    putVarint(bw->buf, len);
+    mprPutBlockToBuf(bw->buf, str, len);
+}
+
+
+static void writeBinaryNumber(BinaryWriter *bw, MprNumber value)
+{
+#if BLD_FEATURE_FLOATING_POINT
+    union {
+        double  d;
+        uint64  u;
+    } bits;
+    int     i;
+
+    if (!(value >= -9.0e18 && value <= 9.0e18 && value == (MprNumber) ((int64) value))) {
+        bits.d = (double) value;
+        mprPutCharToBuf(bw->buf, EJS_BIN_DOUBLE);
+        for (i = 0; i < 8; i++) {
+            mprPutCharToBuf(bw->buf, (int) ((bits.u >> (i * 8)) & 0xff));
+        }
+        return;
+    }
+#endif
+    mprPutCharToBuf(bw->buf, EJS_BIN_INTEGER);
+    putZigzag(bw->buf, (int64) value);
+}
+
+
+/*
+ *  Test if an object property should be serialized. This mirrors the text serializer.
+ */
+static EjsVar *getBinaryProperty(BinaryWriter *bw, EjsVar *vp, int slotNum, int numInherited)
+{
+    EjsVar      *pp;
+
+    if (slotNum < numInherited && !(bw->flags & EJS_FLAGS_ENUM_INHERITED)) {
+        return 0;
+    }
+    pp = ejsGetProperty(bw->ejs, vp, slotNum);
+    if (pp == 0 || (pp->hidden && !(bw->flags & EJS_FLAGS_ENUM_ALL))) {
+        return 0;
+    }
+    return pp;
+}
+
+
+static int writeBinaryVar(BinaryWriter *bw, EjsVar *vp)
+{
+    Ejs             *ejs;
+    EjsByteArray    *ap;
+    EjsString       *sv;
+    EjsVar          *pp;
+    EjsName         qname;
+    MprBuf          *buf;
+    char            key[32];
+    int             index, slotNum, count, numInherited, length, rc;
+
+    ejs = bw->ejs;
+    buf = bw->buf;
+
+    if (vp == 0 || ejsIsUndefined(vp) || ejsIsFunction(vp)) {
+        mprPutCharToBuf(buf, EJS_BIN_UNDEFINED);
+        return 0;
+
+    } else if (ejsIsNull(vp)) {
+        mprPutCharToBuf(buf, EJS_BIN_NULL);
+        return 0;
+
+    } else if (ejsIsBoolean(vp)) {
+        mprPutCharToBuf(buf, ejsGetBoolean(vp) ? EJS_BIN_TRUE : EJS_BIN_FALSE);
+        return 0;
+
+    } else if (ejsIsNumber(vp)) {
+        writeBinaryNumber(bw, ((EjsNumber*) vp)->value);
+        return 0;
+
+    } else if (ejsIsDate(vp)) {
+        mprPutCharToBuf(buf, EJS_BIN_DATE);
+        putZigzag(buf, ((EjsDate*) vp)->value);
+        return 0;
+
+    } else if (ejsIsString(vp)) {
+        sv = (EjsString*) vp;
+        writeBinaryString(bw, sv->value, sv->length);
+        return 0;
+    }
+
+    /*
+     *  Objects, arrays and byte arrays are entered in the object table so repeated references are written once
+     */
+    mprSprintf(key, sizeof(key), "%p", vp);
+    if ((index = PTOI(mprLookupHash(bw->objects, key))) > 0) {
+        mprPutCharToBuf(buf, EJS_BIN_OBJECT_REF);
+        putVarint(buf, index - 1);
+        return 0;
+    }
+
+    if (ejsIsByteArray(vp)) {
+        ap = (EjsByteArray*) vp;
+        mprAddHash(bw->objects, key, ITOP(++bw->numObjects));
+        mprPutCharToBuf(buf, EJS_BIN_BYTES);
+        putVarint(buf, ap->length);
+        mprPutBlockToBuf(buf, (char*) ap->value, ap->length);
+        putVarint(buf, ap->readPosition);
+        putVarint(buf, ap->writePosition);
+        return 0;
+    }
+
+    count = ejsGetPropertyCount(ejs, vp);
+    if (ejsIsXML(vp) || (count == 0 && !ejsIsObject(vp))) {
+        if ((sv = (EjsString*) ejsToString(ejs, vp)) == 0) {
+            return EJS_ERR;
+        }
+        writeBinaryString(bw, sv->value, sv->length);
+        return 0;
+    }
+
+    mprAddHash(bw->objects, key, ITOP(++bw->numObjects));
+    if (++bw->depth > bw->maxDepth) {
+        count = 0;
+    }
+    rc = 0;
+
+    if (ejsIsArray(vp)) {
+        length = (count > 0) ? ((EjsArray*) vp)->length : 0;
+        mprPutCharToBuf(buf, EJS_BIN_ARRAY);
+        putVarint(buf, length);
+        for (slotNum = 0; slotNum < length && rc == 0; slotNum++) {
+            rc = writeBinaryVar(bw, ejsGetProperty(ejs, vp, slotNum));
+        }
+
+    } else {
+        numInherited = ejsIsBlock(vp) ? ejsGetNumInheritedTraits((EjsBlock*) vp) : 0;
+        length = 0;
+        for (slotNum = 0; slotNum < count; slotNum++) {
+            if (getBinaryProperty(bw, vp, slotNum, numInherited)) {
+                length++;
+            }
+        }
+        if (ejs->exception) {
+            return EJS_ERR;
+        }
+        mprPutCharToBuf(buf, EJS_BIN_OBJECT);
+        putVarint(buf, length);
+        for (slotNum = 0; slotNum < count && rc == 0; slotNum++) {
+            if ((pp = getBinaryProperty(bw, vp, slotNum, numInherited)) == 0) {
+                continue;
+            }
+            qname = ejsGetPropertyName(ejs, vp, slotNum);
+            writeBinaryString(bw, qname.name, (int) strlen(qname.name));
+            if ((rc = writeBinaryVar(bw, pp)) < 0 && !ejs->exception) {
+                ejsThrowTypeError(ejs, "Cant serialize property %s", qname.name);
+            }
+        }
+    }
+    bw->depth--;
+    return rc;
+}
+
+
+/*
+ *  Deserialize a binary encoding created by ejsSerializeBinary. Throws an IOError if the data is truncated or corrupt.
+ */
+EjsVar *ejsDeserializeBinary(Ejs *ejs, cchar *data, int len)
+{
+    BinaryReader    br;
+    EjsVar          *vp;
+
+    if (len < 2 || (uchar) data[0] != EJS_BIN_MAGIC) {
+        ejsThrowIOError(ejs, "Data is not a binary serialization");
+        return 0;
+    }
+    if ((uchar) data[1] != EJS_BIN_VERSION) {
+        ejsThrowIOError(ejs, "Unsupported binary serialization version %d", (uchar) data[1]);
+        return 0;
+    }
+    br.ejs = ejs;
+    br.next = (cuchar*) &data[2];
+    br.end = (cuchar*) &data[len];
+    br.depth = 0;
+    br.strings = mprCreateList(ejs);
+    br.objects = mprCreateList(ejs);
+    if (br.strings == 0 || br.objects == 0) {
+        mprFree(br.strings);
+        mprFree(br.objects);
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    vp = readBinaryVar(&br);
+    if (vp && br.next != br.end) {
+        vp = 0;
+    }
+    mprFree(br.strings);
+    mprFree(br.objects);
+    if (vp == 0 && !ejs->exception) {
+        ejsThrowIOError(ejs, "Corrupt binary serialization");
+    }
+    return vp;
+}
+
+
+/*
+ *  Read a varint. Returns -1 if the data is truncated or the value is too large.
+ */
+static int getVarint(BinaryReader *br, uint64 *value)
+{
+    uint64      result;
+    int         c, shift;
+
+    result = 0;
+    for (shift = 0; shift < 64; shift += 7) {
+        if (br->next >= br->end) {
+            return -1;
+        }
+        c = *br->next++;
+        result |= ((uint64) (c & 0x7f)) << shift;
+        if (!(c & 0x80)) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+
+/*
+ *  Read a length or count. Each item requires at least "minSize" bytes so counts larger than the remaining 
+ *  data are rejected before anything is allocated.
+ */
+static int getCount(BinaryReader *br, int minSize)
+{
+    uint64      value;
+
+    if (getVarint(br, &value) < 0 || value > (uint64) ((br->end - br->next) / minSize)) {
+        return -1;
+    }
+    return (int) value;
+}
+
+
+static int getZigzag(BinaryReader *br, int64 *value)
+{
+    uint64      raw;
+
+    if (getVarint(br, &raw) < 0) {
+        return -1;
+    }
+    *value = (int64) (raw >> 1) ^ -((int64) (raw & 1));
+    return 0;
+}
+
+
+/*
+ *  Read a string or string reference
+ */
+static EjsString *readBinaryString(BinaryReader *br)
+{
+    EjsString   *sp;
+    uint64      index;
+    int         tag, len;
+
+    if (br->next >= br->end) {
+        return 0;
+    }
+    tag = *br->next++;
+    if (tag == EJS_BIN_STRING_REF) {
+        if (getVarint(br, &index) < 0 || index >= (uint64) mprGetListCount(br->strings)) {
+            return 0;
+        }
+        return (EjsString*) mprGetItem(br->strings, (int) index);
+
+    } else if (tag != EJS_BIN_STRING || (len = getCount(br, 1)) < 0) {
+        return 0;
+    }
+    if ((sp = ejsCreateStringWithLength(br->ejs, (cchar*) br->next, len)) == 0) {
+        return 0;
+    }
+    br->next += len;
+    mprAddItem(br->strings, sp);
+    return sp;
+}
+
+
+static EjsVar *readBinaryObject(BinaryReader *br, int tag)
+{
+    Ejs             *ejs;
+    EjsByteArray    *ap;
+    EjsString       *sp;
+    EjsName         qname;
+    EjsVar          *obj, *vp;
+    uint64          readPosition, writePosition;
+    int             i, count;
+
+    ejs = br->ejs;
+    if (tag == EJS_BIN_BYTES) {
+        if ((count = getCount(br, 1)) < 0 || (ap = ejsCreateByteArray(ejs, count)) == 0) {
+            return 0;
+        }
+        memcpy(ap->value, br->next, count);
+        ap->length = count;
+        br->next += count;
+        mprAddItem(br->objects, ap);
+        if (getVarint(br, &readPosition) < 0 || getVarint(br, &writePosition) < 0 || 
+                readPosition > writePosition || writePosition > (uint64) count) {
+            return 0;
+        }
+        ejsSetByteArrayPositions(ejs, ap, (int) readPosition, (int) writePosition);
+        return (EjsVar*) ap;
+    }
+
+    if (++br->depth > EJS_MAX_LITERAL_DEPTH) {
+        ejsThrowIOError(ejs, "Binary serialization is nested too deeply");
+        return 0;
+    }
+    if (tag == EJS_BIN_ARRAY) {
+        if ((count = getCount(br, 1)) < 0 || (obj = (EjsVar*) ejsCreateArray(ejs, count)) == 0) {
+            return 0;
+        }
+        mprAddItem(br->objects, obj);
+        for (i = 0; i < count; i++) {
+            if ((vp = readBinaryVar(br)) == 0 || ejsSetProperty(ejs, obj, i, vp) < 0) {
+                return 0;
+            }
+        }
+
+    } else {
+        if ((count = getCount(br, 2)) < 0 || (obj = (EjsVar*) ejsCreateObject(ejs, ejs->objectType, 0)) == 0) {
+            return 0;
+        }
+        mprAddItem(br->objects, obj);
+        for (i = 0; i < count; i++) {
+            if ((sp = readBinaryString(br)) == 0 || (vp = readBinaryVar(br)) == 0) {
+                return 0;
+            }
+            ejsName(&qname, EJS_PUBLIC_NAMESPACE, mprStrdup(obj, sp->value));
+            if (ejsSetPropertyByName(ejs, obj, &qname, vp) < 0) {
+                return 0;
+            }
+            ownPropertyName(obj, qname.name);
+        }
+    }
+    br->depth--;
+    return obj;
+}
+
+
+/*
+ *  Read one tagged value. Returns null if the data is corrupt.
+ */
+static EjsVar *readBinaryVar(BinaryReader *br)
+{
+    Ejs         *ejs;
+    uint64      index;
+    int64       value;
+    int         tag;
+#if BLD_FEATURE_FLOATING_POINT
+    union {
+        double  d;
+        uint64  u;
+    } bits;
+    int         i;
+#endif
+
+    ejs = br->ejs;
+    if (br->next >= br->end) {
+        return 0;
+    }
+    tag = *br->next;
+
+    switch (tag) {
+    case EJS_BIN_UNDEFINED:
+        br->next++;
+        return ejs->undefinedValue;
+
+    case EJS_BIN_NULL:
+        br->next++;
+        return ejs->nullValue;
+
+    case EJS_BIN_FALSE:
+        br->next++;
+        return (EjsVar*) ejs->falseValue;
+
+    case EJS_BIN_TRUE:
+        br->next++;
+        return (EjsVar*) ejs->trueValue;
+
+    case EJS_BIN_INTEGER:
+        br->next++;
+        if (getZigzag(br, &value) < 0) {
+            return 0;
+        }
+        return (EjsVar*) ejsCreateNumber(ejs, (MprNumber) value);
+
+#if BLD_FEATURE_FLOATING_POINT
+    case EJS_BIN_DOUBLE:
+        br->next++;
+        if ((br->end - br->next) < 8) {
+            return 0;
+        }
+        bits.u = 0;
+        for (i = 0; i < 8; i++) {
+            bits.u |= ((uint64) *br->next++) << (i * 8);
+        }
+        return (EjsVar*) ejsCreateNumber(ejs, (MprNumber) bits.d);
+#endif
+
+    case EJS_BIN_DATE:
+        br->next++;
+        if (getZigzag(br, &value) < 0) {
+            return 0;
+        }
+        return (EjsVar*) ejsCreateDate(ejs, (MprTime) value);
+
+    case EJS_BIN_STRING:
+    case EJS_BIN_STRING_REF:
+        return (EjsVar*) readBinaryString(br);
+
+    case EJS_BIN_OBJECT_REF:
+        br->next++;
+        if (getVarint(br, &index) < 0 || index >= (uint64) mprGetListCount(br->objects)) {
+            return 0;
+        }
+        return (EjsVar*) mprGetItem(br->objects, (int) index);
+
+    case EJS_BIN_ARRAY:
+    case EJS_BIN_OBJECT:
+    case EJS_BIN_BYTES:
+        br->next++;
+        return readBinaryObject(br, tag);
+    }
+    return 0;
+}
+
+
+/*
+ *  Get a serialization option. Object literal keys are in the empty namespace while deserialized objects use public.
+ */
+static EjsVar *getOption(Ejs *ejs, EjsVar *options, cchar *name)
+{
+    EjsName     qname;
+    EjsVar      *vp;
+
+    if ((vp = ejsGetPropertyByName(ejs, options, ejsName(&qname, "", name))) == 0) {
+        vp = ejsGetPropertyByName(ejs, options, ejsName(&qname, EJS_PUBLIC_NAMESPACE, name));
+    }
+    return vp;
+}
+
+
+/*
+ *  Convert the object to a source code string. If the second argument is an options object rather than a depth, it
+ *  may contain "depth", "all", "base" and "binary" properties. Binary encodings are returned as a ByteArray.
+ *
+ *  intrinsic function serialize(obj: Object, options: Object = null, showAll: Boolean = false, 
+ *      showBase: Boolean = false): Object
+ */
+EjsVar *serialize(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+{
+    EjsVar          *options, *vp;
+    int             maxDepth;
+    bool            showBase, showAll, binary;
+
+    maxDepth = MAXINT;
+    binary = 0;
+    showAll = (argc >= 3 && argv[2] == (EjsVar*) ejs->trueValue);
+    showBase = (argc == 4 && argv[3] == (EjsVar*) ejs->trueValue);
+
+    if (argc >= 2) {
+        options = argv[1];
+        if (ejsIsNumber(options)) {
+            maxDepth = ejsGetInt(options);
+
+        } else if (options && !ejsIsNull(options) && !ejsIsUndefined(options)) {
+            if ((vp = getOption(ejs, options, "depth")) != 0 && ejsIsNumber(vp)) {
+                maxDepth = ejsGetInt(vp);
+            }
+            if ((vp = getOption(ejs, options, "all")) != 0) {
+                showAll = (vp == (EjsVar*) ejs->trueValue);
+            }
+            if ((vp = getOption(ejs, options, "base")) != 0) {
+                showBase = (vp == (EjsVar*) ejs->trueValue);
+            }
+            binary = ((vp = getOption(ejs, options, "binary")) != 0 && vp == (EjsVar*) ejs->trueValue);
+        }
+    }
+    if (binary) {
+        return ejsSerializeBinary(ejs, argv[0], maxDepth, showAll, showBase);
+    }
     return ejsSerialize(ejs, argv[0], maxDepth, showAll, showBase);
 }
 
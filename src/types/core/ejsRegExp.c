@@ -12,6 +12,9 @@
 
 /***************************** Forward Declarations ***************************/
 
+static EjsRegExpCode *compileRegExp(Ejs *ejs, EjsRegExp *rp, cchar *pattern, int options);
+static void releaseRegExpCode(EjsRegExpCode *code);
+static void studyRegExp(Ejs *ejs, EjsRegExpCode *code);
 static int parseFlags(EjsRegExp *rp, cchar *flags);
 
 /******************************************************************************/
@@ -44,10 +47,18 @@ static void destroyRegExp(Ejs *ejs, EjsRegExp *rp)
 {
     mprAssert(rp);
 
-    if (rp->compiled) {
-        free(rp->compiled);
-        rp->compiled = 0;
+    if (rp->code) {
+        if (rp->code->shared) {
+            mprLock(ejs->service->mutex);
+            releaseRegExpCode(rp->code);
+            mprUnlock(ejs->service->mutex);
+        } else {
+            free(rp->code->compiled);
+            free(rp->code->extra);
+            mprFree(rp->code);
+        }
     }
+    rp->code = 0;
     ejsFreeVar(ejs, (EjsVar*) rp);
 }
 
@@ -61,9 +72,8 @@ static void destroyRegExp(Ejs *ejs, EjsRegExp *rp)
 
 static EjsVar *regexConstructor(Ejs *ejs, EjsRegExp *rp, int argc, EjsVar **argv)
 {
-    cchar       *errMsg;
     char        *pattern, *flags, *barePattern;
-    int         column, errCode, options;
+    int         options;
 
     pattern = ejsGetString(argv[0]);
     options = PCRE_JAVASCRIPT_COMPAT;
@@ -87,12 +97,8 @@ static EjsVar *regexConstructor(Ejs *ejs, EjsRegExp *rp, int argc, EjsVar **argv
         pattern = barePattern;
     }
 
-    rp->compiled = (void*) pcre_compile2(pattern, options, &errCode, &errMsg, &column, NULL);
+    compileRegExp(ejs, rp, pattern, options);
     mprFree(barePattern);
-
-    if (rp->compiled == NULL) {
-        ejsThrowArgError(ejs, "Can't compile regular expression. Error %s at column %d", errMsg, column);
-    }
     return (EjsVar*) rp;
 }
 
@@ -133,7 +139,8 @@ static EjsVar *exec(Ejs *ejs, EjsRegExp *rp, int argc, EjsVar **argv)
     options = 0;
     rp->matched = 0;
 
-    count = pcre_exec(rp->compiled, NULL, str, (int) strlen(str), start, options, matches, sizeof(matches) / sizeof(int));
+    count = ejsRunRegExp(ejs, rp, str, ((EjsString*) argv[0])->length, start, options, matches, 
+        sizeof(matches) / sizeof(int));
     if (count < 0) {
         rp->endLastMatch = 0;
         return (EjsVar*) ejs->nullValue;
@@ -210,7 +217,7 @@ static EjsVar *test(Ejs *ejs, EjsRegExp *rp, int argc, EjsVar **argv)
     int         count;
 
     str = ejsGetString(argv[0]);
-    count = pcre_exec(rp->compiled, NULL, str, (int) strlen(str), rp->endLastMatch, 0, 0, 0);
+    count = ejsRunRegExp(ejs, rp, str, ((EjsString*) argv[0])->length, rp->endLastMatch, 0, 0, 0);
     if (count < 0) {
         rp->endLastMatch = 0;
         return (EjsVar*) ejs->falseValue;
@@ -235,9 +242,8 @@ static EjsVar *regExpToString(Ejs *ejs, EjsRegExp *rp, int argc, EjsVar **argv)
 EjsRegExp *ejsCreateRegExp(Ejs *ejs, cchar *pattern)
 {
     EjsRegExp   *rp;
-    cchar       *errMsg;
     char        *flags, *barePattern;
-    int         column, errCode, options;
+    int         options;
 
     mprAssert(pattern[0] == '/');
 
@@ -255,11 +261,10 @@ EjsRegExp *ejsCreateRegExp(Ejs *ejs, cchar *pattern)
         }
 
         options = parseFlags(rp, flags);
-        rp->compiled = pcre_compile2(barePattern, options, &errCode, &errMsg, &column, NULL);
+        compileRegExp(ejs, rp, barePattern, options);
         mprFree(barePattern);
 
-        if (rp->compiled == NULL) {
-            ejsThrowArgError(ejs, "Can't compile regular expression. Error %s at column %d", errMsg, column);
+        if (rp->code == NULL) {
             return 0;
         }
     }
@@ -267,6 +272,150 @@ EjsRegExp *ejsCreateRegExp(Ejs *ejs, cchar *pattern)
 }
 
 
+/*
+ *  Run a compiled regular expression. Programs are studied once they have been run EJS_REGEX_STUDY_THRESHOLD times 
+ *  so that one-off patterns do not pay the cost of studying. As programs are shared via the regex cache, the 
+ *  execution count and study data accumulate across all RegExp objects using the same pattern.
+ */
+int ejsRunRegExp(Ejs *ejs, EjsRegExp *rp, cchar *str, int len, int start, int options, int *matches, int size)
+{
+    EjsRegExpCode   *code;
+
+    mprAssert(rp);
+    mprAssert(str);
+
+    code = rp->code;
+    if (code == 0 || start < 0 || start > len) {
+        return PCRE_ERROR_NOMATCH;
+    }
+    if (!code->studied) {
+        studyRegExp(ejs, code);
+    }
+    return pcre_exec(code->compiled, code->extra, str, len, start, options, matches, size);
+}
+
+
+/*
+ *  Count a run of a program that has not yet been studied and study it once it reaches the threshold. Study builds a 
+ *  start-of-match bitmap and other data to accelerate matching and is only attempted once. Pcre returns null study 
+ *  data if it cannot usefully optimize the pattern. The count is shared by all users of the program, so lock.
+ */
+static void studyRegExp(Ejs *ejs, EjsRegExpCode *code)
+{
+    cchar       *errMsg;
+
+    mprLock(ejs->service->mutex);
+    if (!code->studied && ++code->runs >= EJS_REGEX_STUDY_THRESHOLD) {
+        errMsg = 0;
+        code->extra = pcre_study(code->compiled, 0, &errMsg);
+        if (errMsg) {
+            mprLog(ejs, 5, "Can't study regular expression: %s", errMsg);
+        }
+        code->studied = 1;
+    }
+    mprUnlock(ejs->service->mutex);
+}
+
+
+/*
+ *  Compile a bare pattern (without slash delimiters or flags). Compiled programs are read-only and are shared by all 
+ *  interpreters via the service regex cache keyed by pattern and options. This avoids recompiling the patterns of 
+ *  regular expression literals and strings used as patterns each time they are evaluated. Once the cache is full, 
+ *  the least recently used program is evicted. Evicted programs are freed when the last RegExp using them is freed.
+ */
+static EjsRegExpCode *compileRegExp(Ejs *ejs, EjsRegExp *rp, cchar *pattern, int options)
+{
+    EjsService      *sp;
+    EjsRegExpCode   *code;
+    cchar           *errMsg;
+    void            *compiled;
+    char            key[MPR_MAX_STRING];
+    int             column, errCode, len;
+
+    sp = ejs->service;
+    len = mprSprintf(key, sizeof(key), "%x:%s", options, pattern);
+    if (sp == 0 || sp->regexCache == 0 || sp->regexLru == 0 || len >= (int) sizeof(key) - 1) {
+        key[0] = '\0';
+    }
+
+    if (key[0]) {
+        mprLock(sp->mutex);
+        if ((code = (EjsRegExpCode*) mprLookupHash(sp->regexCache, key)) != 0) {
+            code->prev->next = code->next;
+            code->next->prev = code->prev;
+            code->next = sp->regexLru->next;
+            code->prev = sp->regexLru;
+            sp->regexLru->next->prev = code;
+            sp->regexLru->next = code;
+            code->refs++;
+            rp->code = code;
+        }
+        mprUnlock(sp->mutex);
+        if (rp->code) {
+            return rp->code;
+        }
+    }
+
+    compiled = (void*) pcre_compile2(pattern, options, &errCode, &errMsg, &column, NULL);
+    if (compiled == NULL) {
+        ejsThrowArgError(ejs, "Can't compile regular expression. Error %s at column %d", errMsg, column);
+        return 0;
+    }
+
+    if (key[0]) {
+        mprLock(sp->mutex);
+        if (mprLookupHash(sp->regexCache, key) == 0) {
+            while (mprGetHashCount(sp->regexCache) >= EJS_REGEX_CACHE_MAX && sp->regexLru->prev != sp->regexLru) {
+                code = sp->regexLru->prev;
+                code->prev->next = code->next;
+                code->next->prev = code->prev;
+                mprRemoveHash(sp->regexCache, code->key);
+                releaseRegExpCode(code);
+            }
+            if ((code = mprAllocObjZeroed(sp, EjsRegExpCode)) != 0) {
+                code->compiled = compiled;
+                code->shared = 1;
+                code->key = mprStrdup(code, key);
+                if (code->key && mprAddHash(sp->regexCache, code->key, code)) {
+                    /* One reference for the cache and one for this RegExp */
+                    code->refs = 2;
+                    code->next = sp->regexLru->next;
+                    code->prev = sp->regexLru;
+                    sp->regexLru->next->prev = code;
+                    sp->regexLru->next = code;
+                    rp->code = code;
+                } else {
+                    mprFree(code);
+                }
+            }
+        }
+        mprUnlock(sp->mutex);
+    }
+    if (rp->code == 0) {
+        if ((rp->code = mprAllocObjZeroed(rp, EjsRegExpCode)) == 0) {
+            free(compiled);
+            ejsThrowMemoryError(ejs);
+            return 0;
+        }
+        rp->code->compiled = compiled;
+    }
+    return rp->code;
+}
+
+
+/*
+ *  Release a reference to a shared program. Must be called with the service locked.
+ */
+static void releaseRegExpCode(EjsRegExpCode *code)
+{
+    if (--code->refs <= 0) {
+        free(code->compiled);
+        free(code->extra);
+        mprFree(code);
+    }
+}
+
+
 static int parseFlags(EjsRegExp *rp, cchar *flags)
 {
     cchar       *cp;
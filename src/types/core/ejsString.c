@@ -417,7 +417,7 @@ static EjsVar *containsString(Ejs *ejs, EjsString *sp, int argc, EjsVar **argv)
         EjsRegExp   *rp;
         int         count;
         rp = (EjsRegExp*) argv[0];
-        count = pcre_exec(rp->compiled, NULL, sp->value, sp->length, 0, 0, 0, 0);
+        count = ejsRunRegExp(ejs, rp, sp->value, sp->length, 0, 0, 0, 0);
         return (EjsVar*) ejsCreateBoolean(ejs, count >= 0);
 #endif
     }
@@ -781,16 +781,24 @@ static EjsVar *match(Ejs *ejs, EjsString *sp, int argc, EjsVar **argv)
     EjsArray    *results;
     EjsString   *match;
     int         matches[EJS_MAX_REGEX_MATCHES * 3];
-    int         count, len, resultCount;
+    int         count, len, resultCount, options;
 
     rp = (EjsRegExp*) argv[0];
     rp->endLastMatch = 0;
     results = NULL;
     resultCount = 0;
+    options = 0;
 
     do {
-        count = pcre_exec(rp->compiled, NULL, sp->value, sp->length, rp->endLastMatch, 0, matches, sizeof(matches) / sizeof(int));
+        count = ejsRunRegExp(ejs, rp, sp->value, sp->length, rp->endLastMatch, options, matches, 
+            sizeof(matches) / sizeof(int));
         if (count <= 0) {
+            if (options && rp->endLastMatch < sp->length) {
+                /* No non-empty match at the end of an empty match. Retry one character on */
+                rp->endLastMatch++;
+                options = 0;
+                continue;
+            }
             break;
         }
         if (results == 0) {
@@ -800,6 +808,8 @@ static EjsVar *match(Ejs *ejs, EjsString *sp, int argc, EjsVar **argv)
         match = ejsCreateStringWithLength(ejs, &sp->value[matches[0]], len);
         ejsSetProperty(ejs, (EjsVar*) results, resultCount++, (EjsVar*) match);
         rp->endLastMatch = matches[1];
+        /* After an empty match, only accept a non-empty match at the same offset */
+        options = (len == 0) ? (PCRE_NOTEMPTY | PCRE_ANCHORED) : 0;
 
     } while (rp->global);
 
@@ -967,15 +977,22 @@ static EjsVar *replace(Ejs *ejs, EjsString *sp, int argc, EjsVar **argv)
         EjsRegExp   *rp;
         char        *cp, *lastReplace, *end;
         int         matches[EJS_MAX_REGEX_MATCHES * 3];
-        int         count, endLastMatch, submatch;
+        int         count, endLastMatch, start, submatch, options;
 
         rp = (EjsRegExp*) argv[0];
         result = ejsCreateString(ejs, 0);
-        endLastMatch = 0;
+        endLastMatch = start = 0;
+        options = 0;
 
         do {
-            count = pcre_exec(rp->compiled, NULL, sp->value, sp->length, endLastMatch, 0, matches, sizeof(matches) / sizeof(int));
+            count = ejsRunRegExp(ejs, rp, sp->value, sp->length, start, options, matches, 
+                sizeof(matches) / sizeof(int));
             if (count <= 0) {
+                if (options && start < sp->length) {
+                    start++;
+                    options = 0;
+                    continue;
+                }
                 break;
             }
 
@@ -1036,7 +1053,8 @@ static EjsVar *replace(Ejs *ejs, EjsString *sp, int argc, EjsVar **argv)
             if (lastReplace < cp && lastReplace < end) {
                 catString(ejs, result, lastReplace, (int) (cp - lastReplace));
             }
-            endLastMatch = matches[1];
+            endLastMatch = start = matches[1];
+            options = (matches[0] == matches[1]) ? (PCRE_NOTEMPTY | PCRE_ANCHORED) : 0;
 
         } while (rp->global);
 
@@ -1096,7 +1114,7 @@ static EjsVar *searchString(Ejs *ejs, EjsString *sp, int argc, EjsVar **argv)
         int         matches[EJS_MAX_REGEX_MATCHES * 3];
         int         count;
         rp = (EjsRegExp*) argv[0];
-        count = pcre_exec(rp->compiled, NULL, sp->value, sp->length, 0, 0, matches, sizeof(matches) / sizeof(int));
+        count = ejsRunRegExp(ejs, rp, sp->value, sp->length, 0, 0, matches, sizeof(matches) / sizeof(int));
         if (count < 0) {
             return (EjsVar*) ejs->minusOneValue;
         }
@@ -1217,21 +1235,28 @@ static EjsVar *split(Ejs *ejs, EjsString *sp, int argc, EjsVar **argv)
     } else if (ejsIsRegExp(argv[0])) {
         EjsRegExp   *rp;
         EjsString   *match;
-        int         matches[EJS_MAX_REGEX_MATCHES * 3], count, resultCount;
+        int         matches[EJS_MAX_REGEX_MATCHES * 3], count, resultCount, start, options;
         rp = (EjsRegExp*) argv[0];
-        rp->endLastMatch = 0;
+        rp->endLastMatch = start = 0;
         resultCount = 0;
+        options = 0;
         do {
-            count = pcre_exec(rp->compiled, NULL, sp->value, sp->length, rp->endLastMatch, 0, matches, 
+            count = ejsRunRegExp(ejs, rp, sp->value, sp->length, start, options, matches, 
                 sizeof(matches) / sizeof(int));
             if (count <= 0) {
+                if (options && start < sp->length) {
+                    start++;
+                    options = 0;
+                    continue;
+                }
                 break;
             }
             if (rp->endLastMatch < matches[0]) {
                 match = ejsCreateStringWithLength(ejs, &sp->value[rp->endLastMatch], matches[0] - rp->endLastMatch);
                 ejsSetProperty(ejs, (EjsVar*) results, resultCount++, (EjsVar*) match);
             }
-            rp->endLastMatch = matches[1];
+            rp->endLastMatch = start = matches[1];
+            options = (matches[0] == matches[1]) ? (PCRE_NOTEMPTY | PCRE_ANCHORED) : 0;
         } while (rp->global);
 
         if (rp->endLastMatch < sp->length) {
@@ -18,13 +18,53 @@
 
 /**************************** Forward Declarations ****************************/
 
+static void asyncIOEvent(EjsFile *fp, MprEvent *event);
+#if BLD_FEATURE_MULTITHREAD
+static void asyncIOComplete(EjsFile *fp, MprEvent *event);
+static void asyncIOThread(EjsFile *fp, MprPoolThread *tp);
+#endif
+static void completeAsyncIO(Ejs *ejs, EjsFile *fp, bool notify);
+static void doAsyncIO(EjsFile *fp);
+static void finishAsyncIO(Ejs *ejs, EjsFile *fp);
+static void lockFile(EjsFile *fp);
+static int  readAsyncData(Ejs *ejs, EjsFile *fp, EjsByteArray *ap, int offset, int count);
 static int  readData(Ejs *ejs, EjsFile *fp, EjsByteArray *ap, int offset, int count);
+static void scheduleAsyncIO(Ejs *ejs, EjsFile *fp);
+static void unlockFile(EjsFile *fp);
 
 #if BLD_FEATURE_MMU && FUTURE
 static void *mapFile(EjsFile *fp, uint size, int mode);
 static void unmapFile(EjsFile *fp);
 #endif
 
+/************************************ Helpers *********************************/
+
+static void destroyFile(Ejs *ejs, EjsFile *fp)
+{
+    mprAssert(fp);
+    mprAssert(!fp->ioBusy);
+
+    if (fp->file) {
+        mprFree(fp->file);
+        fp->file = 0;
+    }
+    mprFree(fp->asyncBuf);
+    fp->asyncBuf = 0;
+    mprFree(fp->ioBuf);
+    fp->ioBuf = 0;
+    (ejs->objectHelpers->destroyVar)(ejs, (EjsVar*) fp);
+}
+
+
+static void markFileVar(Ejs *ejs, EjsVar *parent, EjsFile *fp)
+{
+    ejsMarkObject(ejs, parent, (EjsObject*) fp);
+    if (fp->callback) {
+        ejsMarkVar(ejs, (EjsVar*) fp, (EjsVar*) fp->callback);
+    }
+}
+
+
 /************************************ Methods *********************************/
 /*
  *  Index into a file and extract a byte. This is random access reading.
@@ -166,6 +206,13 @@ static EjsVar *basenameProc(Ejs *ejs, EjsFile *fp, int argc, EjsVar **argv)
  */
 static EjsVar *closeFile(Ejs *ejs, EjsFile *fp, int argc, EjsVar **argv)
 {
+    int     writeError;
+
+    if (fp->callback) {
+        finishAsyncIO(ejs, fp);
+    }
+    writeError = fp->ioError && (fp->mode & EJS_FILE_WRITE);
+
     if (fp->mode & EJS_FILE_OPEN && fp->mode & EJS_FILE_WRITE) {
         if (mprFlush(fp->file) < 0) {
             ejsThrowIOError(ejs, "Can't flush file data");
@@ -177,12 +224,16 @@ static EjsVar *closeFile(Ejs *ejs, EjsFile *fp, int argc, EjsVar **argv)
         mprFree(fp->file);
         fp->file = 0;
     }
+    fp->mode = 0;
 #if BLD_FEATURE_MMU && FUTURE
     if (fp->mapped) {
         unmapFile(fp);
         fp->mapped = 0;
     }
 #endif
+    if (writeError) {
+        ejsThrowIOError(ejs, "Can't write to %s", fp->path);
+    }
     return 0;
 }
 
@@ -918,6 +969,11 @@ static EjsVar *openProc(Ejs *ejs, EjsFile *fp, int argc, EjsVar **argv)
         ejsThrowIOError(ejs, "Can't open %s, error %d", fp->path, errno);
     } else {
         fp->mode = mode | EJS_FILE_OPEN;
+        fp->ioEof = 0;
+        fp->ioError = 0;
+        if (fp->callback) {
+            scheduleAsyncIO(ejs, fp);
+        }
     }
     //  TODO - should push this into File and it should maintain position and length
     mprGetFileInfo(ejs, fp->path, &fp->info);
@@ -1132,6 +1188,30 @@ static EjsVar *readBytes(Ejs *ejs, EjsFile *fp, int argc, EjsVar **argv)
         return 0;
     }
 
+    if (fp->callback) {
+        /*
+         *  Async mode. Only return data already read ahead. Return null once the end of file has been consumed.
+         */
+        arraySize = mprGetBufLength(fp->asyncBuf);
+        if (count >= 0) {
+            arraySize = min(count, arraySize);
+        }
+        if (arraySize == 0 && fp->ioEof) {
+            return (EjsVar*) ejs->nullValue;
+        }
+        result = ejsCreateByteArray(ejs, max(arraySize, 1));
+        if (result == 0) {
+            ejsThrowMemoryError(ejs);
+            return 0;
+        }
+        totalRead = readAsyncData(ejs, fp, result, 0, arraySize);
+        if (totalRead < 0) {
+            return 0;
+        }
+        ejsSetByteArrayPositions(ejs, result, 0, totalRead);
+        return (EjsVar*) result;
+    }
+
     arraySize = mprGetFileInfo(fp, fp->path, &info) == 0 ? (int) info.size : MPR_BUFSIZE;
     result = ejsCreateByteArray(ejs, arraySize);
     if (result == 0) {
@@ -1181,7 +1261,11 @@ static EjsVar *readProc(Ejs *ejs, EjsFile *fp, int argc, EjsVar **argv)
     /*
      *  TODO - what if the file is opened with a stream. Should still work
      */
-    totalRead = readData(ejs, fp, buffer, offset, count);
+    if (fp->callback) {
+        totalRead = readAsyncData(ejs, fp, buffer, offset, count);
+    } else {
+        totalRead = readData(ejs, fp, buffer, offset, count);
+    }
     if (totalRead < 0) {
         return 0;
     }
@@ -1254,7 +1338,33 @@ static int renameProc(Ejs *ejs, EjsFile *fp, int argc, EjsVar **argv)
  */
 static EjsVar *setFileCallback(Ejs *ejs, EjsFile *fp, int argc, EjsVar **argv)
 {
-    mprAssert(0);
+    mprAssert(argc == 1);
+
+    if (!ejsIsFunction(argv[0])) {
+        ejsThrowArgError(ejs, "Callback is not a function");
+        return 0;
+    }
+    if (fp->asyncBuf == 0) {
+        fp->asyncBuf = mprCreateBuf(fp, EJS_FILE_ASYNC_CHUNK, -1);
+        fp->ioBuf = mprAlloc(fp, EJS_FILE_ASYNC_CHUNK);
+#if BLD_FEATURE_MULTITHREAD
+        fp->mutex = mprCreateLock(fp);
+        fp->ioCond = mprCreateCond(fp);
+        if (fp->mutex == 0 || fp->ioCond == 0) {
+            ejsThrowMemoryError(ejs);
+            return 0;
+        }
+#endif
+        if (fp->asyncBuf == 0 || fp->ioBuf == 0) {
+            ejsThrowMemoryError(ejs);
+            return 0;
+        }
+    }
+    fp->ejs = ejs;
+    fp->callback = (EjsFunction*) argv[0];
+    if (fp->file) {
+        scheduleAsyncIO(ejs, fp);
+    }
     return 0;
 }
 
@@ -1324,12 +1434,24 @@ EjsVar *fileWrite(Ejs *ejs, EjsFile *fp, int argc, EjsVar **argv)
             len = str->length;
             break;
         }
-        if (mprWrite(fp->file, buf, len) != len) {
+        if (fp->callback) {
+            if (fp->ioError) {
+                ejsThrowIOError(ejs, "Can't write to %s", fp->path);
+                return 0;
+            }
+            if (mprPutBlockToBuf(fp->asyncBuf, buf, len) != len) {
+                ejsThrowMemoryError(ejs);
+                return 0;
+            }
+        } else if (mprWrite(fp->file, buf, len) != len) {
             ejsThrowIOError(ejs, "Can't write to %s", fp->path);
             return 0;
         }
         written += len;
     }
+    if (fp->callback) {
+        scheduleAsyncIO(ejs, fp);
+    }
 
     return (EjsVar*) ejsCreateNumber(ejs, written);
 }
@@ -1361,6 +1483,258 @@ static int readData(Ejs *ejs, EjsFile *fp, EjsByteArray *ap, int offset, int cou
 }
 
 
+/*
+ *  Copy read-ahead data from the async buffer. Never blocks. Returns zero if no data is yet available.
+ */
+static int readAsyncData(Ejs *ejs, EjsFile *fp, EjsByteArray *ap, int offset, int count)
+{
+    int     bytes;
+
+    if (fp->ioError && mprGetBufLength(fp->asyncBuf) == 0) {
+        ejsThrowIOError(ejs, "Error reading from %s", fp->path);
+        return -1;
+    }
+    if (count < 0) {
+        count = ap->length - offset;
+    }
+    count = min(count, ap->length - offset);
+    bytes = mprGetBlockFromBuf(fp->asyncBuf, &ap->value[offset], count);
+    mprResetBufIfEmpty(fp->asyncBuf);
+
+    /*
+     *  Consuming data may have made room for more read-ahead
+     */
+    scheduleAsyncIO(ejs, fp);
+    return bytes;
+}
+
+
+/*
+ *  Start the next async I/O pass if one is not already outstanding. Writes drain the pending output buffer. Reads fill 
+ *  the read-ahead buffer up to EJS_FILE_ASYNC_MAX. Each pass transfers at most EJS_FILE_ASYNC_CHUNK bytes. On 
+ *  multithreaded builds the pass runs on a pool thread so a slow disk never blocks the event loop. Otherwise, or if no 
+ *  pool thread is available, it runs from the event queue so timers and sockets are serviced between passes.
+ */
+static void scheduleAsyncIO(Ejs *ejs, EjsFile *fp)
+{
+    int     len;
+
+    if (fp->ioBusy || fp->callback == 0 || fp->file == 0 || fp->ioError) {
+        return;
+    }
+    if (fp->mode & EJS_FILE_WRITE) {
+        len = mprGetBufLength(fp->asyncBuf);
+        if (len == 0) {
+            return;
+        }
+        fp->ioLength = min(len, EJS_FILE_ASYNC_CHUNK);
+        memcpy(fp->ioBuf, mprGetBufStart(fp->asyncBuf), fp->ioLength);
+        mprAdjustBufStart(fp->asyncBuf, fp->ioLength);
+        mprResetBufIfEmpty(fp->asyncBuf);
+
+    } else {
+        if (fp->ioEof || mprGetBufLength(fp->asyncBuf) >= EJS_FILE_ASYNC_MAX) {
+            return;
+        }
+        fp->ioLength = EJS_FILE_ASYNC_CHUNK;
+    }
+    fp->ioBusy = 1;
+    fp->ioWrite = (fp->mode & EJS_FILE_WRITE) ? 1 : 0;
+
+    /*
+     *  Keep the file alive while the I/O is outstanding. Don't disturb files the caller has made permanent.
+     */
+    if (!fp->obj.var.permanent) {
+        fp->ioPinned = 1;
+        ejsMakePermanent(ejs, (EjsVar*) fp);
+    }
+
+#if BLD_FEATURE_MULTITHREAD
+    fp->ioDone = 0;
+    fp->ioThread = 1;
+    if (mprStartPoolThread(ejs, (MprPoolProc) asyncIOThread, fp, MPR_NORMAL_PRIORITY) == 0) {
+        return;
+    }
+    fp->ioThread = 0;
+#endif
+    lockFile(fp);
+    fp->ioEvent = mprCreateEvent(fp, (MprEventProc) asyncIOEvent, 0, MPR_NORMAL_PRIORITY, fp, 0);
+    unlockFile(fp);
+    if (fp->ioEvent == 0) {
+        fp->ioCount = -1;
+        completeAsyncIO(ejs, fp, 0);
+    }
+}
+
+
+/*
+ *  Perform one async I/O pass. This may run on a pool thread and so must not touch the interpreter or fp->mode.
+ */
+static void doAsyncIO(EjsFile *fp)
+{
+    if (fp->ioWrite) {
+        fp->ioCount = mprWrite(fp->file, fp->ioBuf, fp->ioLength);
+        if (fp->ioCount != fp->ioLength) {
+            fp->ioCount = -1;
+        }
+    } else {
+        fp->ioCount = mprRead(fp->file, fp->ioBuf, fp->ioLength);
+    }
+}
+
+
+/*
+ *  Run an async I/O pass from the event queue
+ */
+static void asyncIOEvent(EjsFile *fp, MprEvent *event)
+{
+    lockFile(fp);
+    fp->ioEvent = 0;
+    mprFree(event);
+    unlockFile(fp);
+
+    doAsyncIO(fp);
+    completeAsyncIO(fp->ejs, fp, 1);
+}
+
+
+#if BLD_FEATURE_MULTITHREAD
+/*
+ *  Run an async I/O pass on a pool thread and hand the result back to the event loop which owns the interpreter
+ */
+static void asyncIOThread(EjsFile *fp, MprPoolThread *tp)
+{
+    doAsyncIO(fp);
+
+    lockFile(fp);
+    fp->ioEvent = mprCreateEvent(fp, (MprEventProc) asyncIOComplete, 0, MPR_NORMAL_PRIORITY, fp, 0);
+    fp->ioDone = 1;
+    unlockFile(fp);
+    mprSignalCond(fp->ioCond);
+}
+
+
+/*
+ *  Completion event for pool thread I/O passes
+ */
+static void asyncIOComplete(EjsFile *fp, MprEvent *event)
+{
+    lockFile(fp);
+    fp->ioEvent = 0;
+    mprFree(event);
+    unlockFile(fp);
+
+    completeAsyncIO(fp->ejs, fp, 1);
+}
+#endif
+
+
+/*
+ *  Process the result of an async I/O pass and, if notify is set, invoke the callback and start the next pass. 
+ *  Invoked as: callback(e: Event) where e.data == file.
+ */
+static void completeAsyncIO(Ejs *ejs, EjsFile *fp, bool notify)
+{
+    EjsVar      *arg;
+
+    fp->ioBusy = 0;
+    fp->ioThread = 0;
+    if (fp->ioPinned) {
+        fp->ioPinned = 0;
+        ejsMakeTransient(ejs, (EjsVar*) fp);
+    }
+
+    if (fp->ioCount < 0) {
+        fp->ioError = 1;
+    } else if (!fp->ioWrite) {
+        if (fp->ioCount == 0) {
+            fp->ioEof = 1;
+        } else if (mprPutBlockToBuf(fp->asyncBuf, fp->ioBuf, fp->ioCount) != fp->ioCount) {
+            fp->ioError = 1;
+        }
+    } else if (notify && mprGetBufLength(fp->asyncBuf) > 0) {
+        /*
+         *  Only notify writers once all pending output has drained
+         */
+        scheduleAsyncIO(ejs, fp);
+        if (fp->ioBusy) {
+            return;
+        }
+    }
+    if (!notify) {
+        return;
+    }
+    if (fp->callback && fp->file) {
+        arg = (EjsVar*) fp;
+        arg = ejsCreateInstance(ejs, ejsGetType(ejs, ES_ejs_events_Event), 1, &arg);
+        if (arg) {
+            ejsRunFunction(ejs, fp->callback, 0, 1, &arg);
+        }
+    }
+    scheduleAsyncIO(ejs, fp);
+}
+
+
+/*
+ *  Complete any outstanding async I/O pass without invoking the callback and then synchronously write any remaining 
+ *  output. Used when closing the file. A pass still queued on the event loop is run here. A pass running on a pool 
+ *  thread is waited for and its completion event is cancelled.
+ */
+static void finishAsyncIO(Ejs *ejs, EjsFile *fp)
+{
+    MprEvent    *event;
+    int         len;
+
+    if (fp->ioBusy) {
+#if BLD_FEATURE_MULTITHREAD
+        if (fp->ioThread) {
+            lockFile(fp);
+            while (!fp->ioDone) {
+                unlockFile(fp);
+                mprWaitForCond(fp->ioCond, -1);
+                lockFile(fp);
+            }
+            unlockFile(fp);
+        }
+#endif
+        lockFile(fp);
+        event = fp->ioEvent;
+        fp->ioEvent = 0;
+        mprFree(event);
+        unlockFile(fp);
+
+        if (!fp->ioThread) {
+            doAsyncIO(fp);
+        }
+        completeAsyncIO(ejs, fp, 0);
+    }
+
+    len = mprGetBufLength(fp->asyncBuf);
+    if (len > 0 && fp->file && !fp->ioError) {
+        if (mprWrite(fp->file, mprGetBufStart(fp->asyncBuf), len) != len) {
+            fp->ioError = 1;
+        }
+    }
+    mprFlushBuf(fp->asyncBuf);
+}
+
+
+static void lockFile(EjsFile *fp)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(fp->mutex);
+#endif
+}
+
+
+static void unlockFile(EjsFile *fp)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(fp->mutex);
+#endif
+}
+
+
 #if BLD_FEATURE_MMU && FUTURE
 static void *mapFile(EjsFile *fp, uint size, int mode)
 {
@@ -1432,7 +1806,9 @@ int ejsCreateFileType(Ejs *ejs)
     /*
      *  Define the helper functions.
      */
+    type->helpers->destroyVar = (EjsDestroyVarHelper) destroyFile;
     type->helpers->getProperty = (EjsGetPropertyHelper) getFileProperty;
+    type->helpers->markVar = (EjsMarkVarHelper) markFileVar;
     type->helpers->setProperty = (EjsSetPropertyHelper) setFileProperty;
 
     //  TODO - Need attribute for this */
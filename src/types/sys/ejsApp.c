@@ -114,7 +114,7 @@ static EjsVar *serviceEvents(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 static EjsVar *sleepProc(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 {
     MprTime     start;
-    int         delay;
+    int         delay, remaining;
 
     delay = (argc > 0) ? ejsGetInt(argv[0]): MAXINT;
     if (delay < 0) {
@@ -122,10 +122,11 @@ static EjsVar *sleepProc(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
     }
 
     start = mprGetTime(ejs);
+    remaining = delay;
     do {
-        mprServiceEvents(ejs, delay, 0);
-        delay -= (int) (mprGetTime(ejs) - start);
-    } while (delay > 0);
+        mprServiceEvents(ejs, remaining, 0);
+        remaining = delay - (int) (mprGetTime(ejs) - start);
+    } while (remaining > 0);
 
     return 0;
 }
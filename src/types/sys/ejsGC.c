@@ -58,11 +58,21 @@ static EjsVar *getMaxMemory(Ejs *ejs, EjsVar *thisObj, int argc, EjsVar **argv)
  */
 static EjsVar *setMaxMemory(Ejs *ejs, EjsVar *thisObj, int argc, EjsVar **argv)
 {
-    int     maxMemory, redLine;
+    MprNumber   limit;
+    uint        maxMemory, redLine;
 
     mprAssert(argc == 1 && ejsIsNumber(argv[0]));
 
-    maxMemory = ejsGetInt(argv[0]);
+    /*
+     *  The allocator keeps limits as unsigned. Clamp rather than wrap limits above 2GB.
+     */
+    limit = ejsGetNumber(argv[0]);
+    if (limit < 0) {
+        limit = 0;
+    } else if (limit > (MprNumber) ((uint) -1)) {
+        limit = (MprNumber) ((uint) -1);
+    }
+    maxMemory = (uint) limit;
 
     /*
      *  Set the redline at 95% of the maximum
@@ -103,7 +113,7 @@ static EjsVar *runGC(Ejs *ejs, EjsVar *thisObj, int argc, EjsVar **argv)
 {
     int     deep;
 
-    deep = ((argc == 1) && ejsIsBoolean(argv[1]));
+    deep = ((argc == 1) && argv[0] == (EjsVar*) ejs->trueValue);
 
     if (deep) {
         ejsCollectGarbage(ejs, EJS_GC_ALL);
@@ -0,0 +1,345 @@
+/**
+ *  ejsXMLReader.c - Streaming, event based XML reader.
+ *
+ *  The reader drives the MPR XML parser with data read incrementally from a stream and invokes handler methods as 
+ *  elements, text and comments are parsed. No XML nodes are created so the memory required is bounded by the largest 
+ *  token rather than by the size of the document.
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "ejs.h"
+
+#if BLD_FEATURE_EJS_E4X && ES_XMLReader
+
+/****************************** Forward Declarations **************************/
+
+static EjsFunction *getMethod(Ejs *ejs, EjsVar *obj, cchar *name);
+static int  invokeHandler(EjsXMLReader *rp, EjsFunction *fn, int argc, EjsVar **argv);
+static int  readerHandler(MprXml *xp, int state, cchar *tagName, cchar *attName, cchar *value);
+static int  readStream(MprXml *xp, void *data, char *buf, int size);
+
+/*********************************** Helpers **********************************/
+
+static void markXMLReader(Ejs *ejs, EjsVar *parent, EjsXMLReader *rp)
+{
+    ejsMarkObject(ejs, parent, (EjsObject*) rp);
+    if (rp->input) {
+        ejsMarkVar(ejs, (EjsVar*) rp, rp->input);
+    }
+    if (rp->buffer) {
+        ejsMarkVar(ejs, (EjsVar*) rp, (EjsVar*) rp->buffer);
+    }
+    if (rp->handler) {
+        ejsMarkVar(ejs, (EjsVar*) rp, rp->handler);
+    }
+    if (rp->attributes) {
+        ejsMarkVar(ejs, (EjsVar*) rp, rp->attributes);
+    }
+}
+
+/*********************************** Methods **********************************/
+/*
+ *  function XMLReader(input: Stream, maxToken: Number = -1)
+ */
+static EjsVar *readerConstructor(Ejs *ejs, EjsXMLReader *rp, int argc, EjsVar **argv)
+{
+    mprAssert(argc == 1 || argc == 2);
+
+    rp->ejs = ejs;
+    rp->input = argv[0];
+    rp->maxToken = (argc == 2) ? ejsGetInt(argv[1]) : -1;
+    if (rp->maxToken <= 0) {
+        rp->maxToken = EJS_E4X_BUF_MAX;
+    }
+    rp->readFn = getMethod(ejs, rp->input, "read");
+    if (rp->readFn == 0) {
+        ejsThrowArgError(ejs, "Input is not a readable stream");
+        return 0;
+    }
+    return (EjsVar*) rp;
+}
+
+
+/*
+ *  function get lineNumber(): Number
+ */
+static EjsVar *getLineNumber(Ejs *ejs, EjsXMLReader *rp, int argc, EjsVar **argv)
+{
+    return (EjsVar*) ejsCreateNumber(ejs, rp->xp ? mprXmlGetLineNumber(rp->xp) : rp->lineNumber);
+}
+
+
+/*
+ *  Parse the input stream till EOF, invoking the handler methods as items are parsed.
+ *
+ *  function parse(handler: Object): Void
+ */
+static EjsVar *parse(Ejs *ejs, EjsXMLReader *rp, int argc, EjsVar **argv)
+{
+    MprXml      *xp;
+    int         rc;
+
+    mprAssert(argc == 1);
+
+    if (rp->xp) {
+        ejsThrowStateError(ejs, "XMLReader is already parsing");
+        return 0;
+    }
+    rp->handler = argv[0];
+    rp->startFn = getMethod(ejs, rp->handler, "start");
+    rp->endFn = getMethod(ejs, rp->handler, "end");
+    rp->textFn = getMethod(ejs, rp->handler, "text");
+    rp->commentFn = getMethod(ejs, rp->handler, "comment");
+    rp->attributes = 0;
+    rp->depth = 0;
+
+    if ((xp = mprXmlOpen(ejs, MPR_BUFSIZE, rp->maxToken)) == 0) {
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    rp->xp = xp;
+    mprXmlSetParseArg(xp, rp);
+    mprXmlSetParserHandler(xp, readerHandler);
+    mprXmlSetInputStream(xp, readStream, rp);
+
+    rc = mprXmlParse(xp);
+    if (rc < 0 && !ejsHasException(ejs)) {
+        ejsThrowSyntaxError(ejs, "Can't parse XML stream at line %d: %s", mprXmlGetLineNumber(xp), 
+            mprXmlGetErrorMsg(xp));
+    }
+    rp->lineNumber = mprXmlGetLineNumber(xp);
+    rp->xp = 0;
+    rp->handler = 0;
+    rp->startFn = rp->endFn = rp->textFn = rp->commentFn = 0;
+    rp->attributes = 0;
+    mprFree(xp);
+    return 0;
+}
+
+/*********************************** Support **********************************/
+/*
+ *  Parser callback. Translate parser states into handler method invocations. Attributes are collected as they are 
+ *  parsed and passed to the start method once the opening element is complete.
+ */
+static int readerHandler(MprXml *xp, int state, cchar *tagName, cchar *attName, cchar *value)
+{
+    Ejs             *ejs;
+    EjsXMLReader    *rp;
+    EjsName         qname;
+    EjsVar          *argv[2];
+
+    rp = (EjsXMLReader*) xp->parseArg;
+    ejs = rp->ejs;
+    rp->lineNumber = mprXmlGetLineNumber(xp);
+
+    switch (state) {
+    case MPR_XML_NEW_ELT:
+        if (++rp->depth > E4X_MAX_NODE_DEPTH) {
+            ejsThrowSyntaxError(ejs, "XML nodes nested too deeply at line %d", rp->lineNumber);
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        rp->attributes = 0;
+        break;
+
+    case MPR_XML_NEW_ATT:
+        if (rp->startFn == 0) {
+            break;
+        }
+        if (rp->attributes == 0) {
+            rp->attributes = (EjsVar*) ejsCreateSimpleObject(ejs);
+        }
+        ejsName(&qname, EJS_PUBLIC_NAMESPACE, mprStrdup(rp->attributes, attName));
+        ejsSetPropertyByName(ejs, rp->attributes, &qname, (EjsVar*) ejsCreateString(ejs, value));
+        break;
+
+    case MPR_XML_ELT_DEFINED:
+    case MPR_XML_SOLO_ELT_DEFINED:
+        if (rp->startFn) {
+            argv[0] = (EjsVar*) ejsCreateString(ejs, tagName);
+            argv[1] = rp->attributes ? rp->attributes : (EjsVar*) ejsCreateSimpleObject(ejs);
+            rp->attributes = 0;
+            if (invokeHandler(rp, rp->startFn, 2, argv) < 0) {
+                return MPR_ERR_BAD_STATE;
+            }
+        }
+        if (state == MPR_XML_ELT_DEFINED) {
+            break;
+        }
+        /* Fall through for solo elements */
+
+    case MPR_XML_END_ELT:
+        rp->depth--;
+        if (rp->endFn) {
+            argv[0] = (EjsVar*) ejsCreateString(ejs, tagName);
+            if (invokeHandler(rp, rp->endFn, 1, argv) < 0) {
+                return MPR_ERR_BAD_STATE;
+            }
+        }
+        break;
+
+    case MPR_XML_ELT_DATA:
+    case MPR_XML_CDATA:
+        if (rp->textFn) {
+            argv[0] = (EjsVar*) ejsCreateString(ejs, value);
+            if (invokeHandler(rp, rp->textFn, 1, argv) < 0) {
+                return MPR_ERR_BAD_STATE;
+            }
+        }
+        break;
+
+    case MPR_XML_COMMENT:
+        if (rp->commentFn) {
+            argv[0] = (EjsVar*) ejsCreateString(ejs, value);
+            if (invokeHandler(rp, rp->commentFn, 1, argv) < 0) {
+                return MPR_ERR_BAD_STATE;
+            }
+        }
+        break;
+
+    case MPR_XML_PI:
+        break;
+
+    default:
+        ejsThrowSyntaxError(ejs, "XML error at line %d: %s", rp->lineNumber, mprXmlGetErrorMsg(xp));
+        return MPR_ERR_BAD_SYNTAX;
+    }
+    return 0;
+}
+
+
+/*
+ *  Parser input callback. Read the next block of data from the input stream by invoking its read method.
+ *  Returns the number of bytes read, zero on EOF or -1 on errors.
+ */
+static int readStream(MprXml *xp, void *data, char *buf, int size)
+{
+    Ejs             *ejs;
+    EjsXMLReader    *rp;
+    EjsVar          *argv[3], *result;
+    int             count;
+
+    rp = (EjsXMLReader*) data;
+    ejs = rp->ejs;
+
+    if (rp->buffer == 0) {
+        if ((rp->buffer = ejsCreateByteArray(ejs, size)) == 0) {
+            return -1;
+        }
+    }
+    count = min(size, rp->buffer->length);
+    argv[0] = (EjsVar*) rp->buffer;
+    argv[1] = (EjsVar*) ejs->zeroValue;
+    argv[2] = (EjsVar*) ejsCreateNumber(ejs, count);
+
+    result = ejsRunFunction(ejs, rp->readFn, rp->input, 3, argv);
+    if (result == 0 || ejsHasException(ejs)) {
+        return -1;
+    }
+    count = ejsIsNumber(result) ? ejsGetInt(result) : 0;
+    if (count <= 0) {
+        return 0;
+    }
+    mprAssert(count <= size);
+    memcpy(buf, rp->buffer->value, count);
+    return count;
+}
+
+
+static int invokeHandler(EjsXMLReader *rp, EjsFunction *fn, int argc, EjsVar **argv)
+{
+    Ejs     *ejs;
+
+    ejs = rp->ejs;
+    ejsRunFunction(ejs, fn, rp->handler, argc, argv);
+    return ejsHasException(ejs) ? -1 : 0;
+}
+
+
+/*
+ *  Find a method by name in any namespace. Returns null if the object does not define a function of that name.
+ */
+static EjsFunction *getMethod(Ejs *ejs, EjsVar *obj, cchar *name)
+{
+    EjsLookup   lookup;
+    EjsName     qname;
+    EjsVar      *vp;
+
+    if (obj == 0 || ejsIsNull(obj) || ejsIsUndefined(obj)) {
+        return 0;
+    }
+    vp = ejsGetVarByName(ejs, obj, ejsName(&qname, "", name), 1, &lookup);
+    if (vp == 0 || !ejsIsFunction(vp)) {
+        return 0;
+    }
+    return (EjsFunction*) vp;
+}
+
+/*********************************** Factory **********************************/
+
+int ejsCreateXMLReaderType(Ejs *ejs)
+{
+    EjsType     *type;
+    EjsName     qname;
+
+    type = ejsCreateCoreType(ejs, ejsName(&qname, EJS_INTRINSIC_NAMESPACE, "XMLReader"), ejs->objectType, 
+        sizeof(EjsXMLReader), ES_XMLReader, ES_XMLReader_NUM_CLASS_PROP, ES_XMLReader_NUM_INSTANCE_PROP, 
+        EJS_ATTR_NATIVE | EJS_ATTR_OBJECT | EJS_ATTR_HAS_CONSTRUCTOR | EJS_ATTR_OBJECT_HELPERS);
+    if (type == 0) {
+        return EJS_ERR;
+    }
+    type->helpers->markVar = (EjsMarkVarHelper) markXMLReader;
+    return 0;
+}
+
+
+int ejsConfigureXMLReaderType(Ejs *ejs)
+{
+    EjsType     *type;
+
+    type = ejsGetType(ejs, ES_XMLReader);
+
+    ejsBindMethod(ejs, type, ES_XMLReader_XMLReader, (EjsNativeFunction) readerConstructor);
+    ejsBindMethod(ejs, type, ES_XMLReader_parse, (EjsNativeFunction) parse);
+    ejsBindMethod(ejs, type, ES_XMLReader_lineNumber, (EjsNativeFunction) getLineNumber);
+    return 0;
+}
+
+
+/******************************************************************************/
+#else
+void __ejsXMLReaderDummy() {}
+#endif /* BLD_FEATURE_EJS_E4X */
+
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
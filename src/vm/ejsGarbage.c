@@ -393,6 +393,7 @@ static void checkMarks(Ejs *ejs)
 static void markFrame(Ejs *ejs, EjsFrame *frame)
 {
     EjsBlock    *block;
+    EjsVar      *vp;
     int         next;
 
     if (frame->returnValue) {
@@ -415,7 +416,24 @@ static void markFrame(Ejs *ejs, EjsFrame *frame)
         }
     }
 
-    ejsMarkVar(ejs, NULL, (EjsVar*) &frame->function);
+    /*
+     *  The frame function is a stack copy of its template block and inherits the template's (often older) generation.
+     *  Frames are roots, so always traverse them, otherwise objects referenced only by the frame (such as block
+     *  namespaces) are collected while the frame is still active.
+     */
+    vp = (EjsVar*) &frame->function;
+    if (!vp->marked) {
+        vp->marked = 1;
+        (vp->type->helpers->markVar)(ejs, NULL, vp);
+    }
+
+    /*
+     *  The frame runs the byte code of its template function. The template may be a temporary, such as a method bound
+     *  to its object by a property read, that is no longer referenced from the stack.
+     */
+    if (frame->templateBlock) {
+        ejsMarkVar(ejs, NULL, (EjsVar*) frame->templateBlock);
+    }
 }
 
 
@@ -477,7 +495,7 @@ void ejsMarkVar(Ejs *ejs, EjsVar *container, EjsVar *vp)
 static inline bool memoryUsageOk(Ejs *ejs)
 {
     MprAlloc    *alloc;
-    uint        memory;
+    int64       memory;
 
     memory = mprGetUsedMemory(ejs);
     alloc = mprGetAllocStats(ejs);
@@ -491,7 +509,7 @@ static inline void pruneTypePools(Ejs *ejs)
     MprAlloc    *alloc;
     EjsGC       *gc;
     EjsVar      *vp, *nextVp;
-    uint        memory;
+    int64       memory;
     int         i;
 
     gc = &ejs->gc;
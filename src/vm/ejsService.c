@@ -14,7 +14,7 @@
 
 /*********************************** Forward **********************************/
 
-static void allocNotifier(Ejs *ejs, uint size, uint total, bool granted);
+static void allocNotifier(MprCtx ctx, uint size, uint total, bool granted);
 static int  cloneMaster(Ejs *ejs, Ejs *master);
 static int  configureEjsModule(Ejs *ejs, EjsModule *mp, cchar *path);
 static int  defineTypes(Ejs *ejs);
@@ -53,6 +53,13 @@ EjsService *ejsCreateService(MprCtx ctx)
     _globalEjsService = sp;
 
     setEjsPath(sp);
+    sp->regexCache = mprCreateHash(sp, EJS_REGEX_CACHE_MAX);
+    if ((sp->regexLru = mprAllocObjZeroed(sp, EjsRegExpCode)) != 0) {
+        sp->regexLru->next = sp->regexLru->prev = sp->regexLru;
+    }
+#if BLD_FEATURE_MULTITHREAD
+    sp->mutex = mprCreateLock(sp);
+#endif
     return sp;
 }
 
@@ -68,7 +75,7 @@ Ejs *ejsCreate(MprCtx ctx, Ejs *master, int flags)
     if (ejs == 0) {
         return 0;
     }
-    mprSetAllocNotifier(ejs, (MprAllocNotifier) allocNotifier);
+    mprSetAllocNotifier(ejs, allocNotifier);
 
     ejs->service = _globalEjsService;
     ejs->flags |= (flags & (EJS_FLAG_EMPTY | EJS_FLAG_COMPILER | EJS_FLAG_NO_EXE | EJS_FLAG_DOC));
@@ -172,6 +179,9 @@ static int createTypes(Ejs *ejs)
 #if ES_XMLList && BLD_FEATURE_EJS_E4X
     ejsCreateXMLListType(ejs);
 #endif
+#if ES_XMLReader && BLD_FEATURE_EJS_E4X
+    ejsCreateXMLReaderType(ejs);
+#endif
 #if ES_RegExp && BLD_FEATURE_REGEXP
     ejsCreateRegExpType(ejs);
 #endif
@@ -262,6 +272,9 @@ static int configureEjsModule(Ejs *ejs, EjsModule *mp, cchar *path)
 #if ES_XMLList && BLD_FEATURE_EJS_E4X
     ejsConfigureXMLListType(ejs);
 #endif
+#if ES_XMLReader && BLD_FEATURE_EJS_E4X
+    ejsConfigureXMLReaderType(ejs);
+#endif
 #if ES_RegExp && BLD_FEATURE_REGEXP
     ejsConfigureRegExpType(ejs);
 #endif
@@ -561,11 +574,12 @@ static int cloneMaster(Ejs *ejs, Ejs *master)
 
 
 /*
- *  Notifier callback function. Invoked by mprAlloc on allocation errors
+ *  Notifier callback function. Invoked by mprAlloc on allocation errors. The notifier is set on the heap containing
+ *  the interpreter, so the context is the parent of the failed block and not necessarily an interpreter. Don't touch
+ *  it. The error is flagged on the block and its parents, and failed requests throw a MemoryError.
  */
-static void allocNotifier(Ejs *ejs, uint size, uint total, bool granted)
+static void allocNotifier(MprCtx ctx, uint size, uint total, bool granted)
 {
-    ejs->attention = 1;
 }
 
 
@@ -0,0 +1,437 @@
+/**
+ *  ejsWebCache.c - Response cache for the web framework
+ *
+ *  Responses of actions declared cacheable by Controller.cacheAction are captured as they are written and stored in a 
+ *  shared LRU cache. Items have a lifespan and may be tagged for invalidation. Connectors look up the cache before 
+ *  creating a request interpreter and replay hits directly.
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "ejs.h"
+
+#if BLD_FEATURE_EJS_WEB
+
+/*********************************** Locals ***********************************/
+/*
+ *  Key specification for a URI. Requests are keyed by URI, the values of the vary request headers and optionally the
+ *  session ID. Specs are reference counted by the items that use them.
+ */
+typedef struct CacheSpec {
+    char            *vary;                  /* Space separated CGI style request header keys */
+    int             session;                /* Key includes the session ID */
+    int             refs;                   /* Count of items using this spec */
+} CacheSpec;
+
+
+typedef struct CacheItem {
+    struct CacheItem *prev;                 /* LRU list links. Most recently used first */
+    struct CacheItem *next;
+    char            *key;                   /* Cache key */
+    char            *uri;                   /* Request URI */
+    char            *tags;                  /* Space delimited tags with leading and trailing spaces */
+    CacheSpec       *spec;                  /* Key specification */
+    MprTime         expires;                /* When the item expires */
+    int             size;                   /* Approximate memory used by the item */
+    EjsWebCached    *response;              /* Cached response */
+} CacheItem;
+
+
+typedef struct EjsWebCache {
+    MprHashTable    *index;                 /* Items by key */
+    MprHashTable    *specs;                 /* Key specifications by URI */
+    CacheItem       lru;                    /* LRU list head */
+    int             size;                   /* Total size of cached items */
+    int             maxSize;                /* Maximum total size */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;
+#endif
+} EjsWebCache;
+
+/***************************** Forward Declarations ***************************/
+
+static EjsWebCached *copyResponse(MprCtx ctx, EjsWebCached *rp);
+static char *makeKey(MprCtx ctx, EjsWebControl *control, void *handle, CacheSpec *spec, cchar *uri);
+static char *mapVary(MprCtx ctx, cchar *vary);
+static void lockCache(EjsWebCache *cache);
+static void unlockCache(EjsWebCache *cache);
+static void removeItem(EjsWebCache *cache, CacheItem *item);
+
+/************************************* Code ***********************************/
+/*
+ *  Return a copy of the cached response for a request or null if there is no current response. The copy is owned by
+ *  ctx so it remains valid if the item is evicted while the response is being sent.
+ */
+EjsWebCached *ejsLookupWebCache(MprCtx ctx, EjsWebControl *control, void *handle, cchar *uri)
+{
+    EjsWebCache     *cache;
+    EjsWebCached    *cached;
+    CacheSpec       *spec;
+    CacheItem       *item;
+    char            *key;
+
+    if ((cache = control->cache) == 0 || uri == 0) {
+        return 0;
+    }
+    cached = 0;
+    lockCache(cache);
+
+    if ((spec = (CacheSpec*) mprLookupHash(cache->specs, uri)) == 0) {
+        unlockCache(cache);
+        return 0;
+    }
+    key = makeKey(ctx, control, handle, spec, uri);
+    item = (CacheItem*) mprLookupHash(cache->index, key);
+
+    if (item && item->expires <= mprGetTime(cache)) {
+        removeItem(cache, item);
+        item = 0;
+    }
+    if (item) {
+        item->prev->next = item->next;
+        item->next->prev = item->prev;
+        item->next = cache->lru.next;
+        item->prev = &cache->lru;
+        cache->lru.next->prev = item;
+        cache->lru.next = item;
+
+        cached = copyResponse(ctx, item->response);
+    }
+    unlockCache(cache);
+    mprFree(key);
+    return cached;
+}
+
+
+/*
+ *  Start capturing the response for the cache. This is a no-op if the connector does not serve cached responses.
+ */
+void ejsBeginWebCache(Ejs *ejs)
+{
+    EjsWeb          *web;
+    EjsWebCached    *capture;
+
+    web = ejsGetHandle(ejs);
+    if (web->cacheUri == 0 || web->control->cache == 0 || web->capture) {
+        return;
+    }
+    if ((capture = mprAllocObjZeroed(web, EjsWebCached)) == 0) {
+        return;
+    }
+    capture->code = MPR_HTTP_CODE_OK;
+    capture->headers = mprCreateHash(capture, 7);
+    capture->body = mprCreateBuf(capture, MPR_BUFSIZE, -1);
+    if (capture->headers == 0 || capture->body == 0) {
+        mprFree(capture);
+        return;
+    }
+    web->capture = capture;
+}
+
+
+/*
+ *  Store the captured response. Vary is a space separated list of request header names and tags is a space separated
+ *  list of tags for ejsExpireWebCache. If session is true, the response is cached per session. Only successful
+ *  responses that don't set cookies or redirect are cached. Returns true if the response was cached.
+ */
+int ejsSaveWebCache(Ejs *ejs, int lifespan, cchar *vary, cchar *tags, bool session)
+{
+    EjsWeb          *web;
+    EjsWebCache     *cache;
+    EjsWebCached    *capture;
+    CacheSpec       *spec;
+    CacheItem       *item, *old;
+    char            *key, *keys;
+    int             size;
+
+    web = ejsGetHandle(ejs);
+    if ((capture = web->capture) == 0) {
+        return 0;
+    }
+    web->capture = 0;
+    cache = web->control->cache;
+
+    size = (int) (sizeof(CacheItem) + sizeof(EjsWebCached) + mprGetBufLength(capture->body) + strlen(web->cacheUri));
+    if (capture->uncacheable || capture->code != MPR_HTTP_CODE_OK || lifespan <= 0 || size > cache->maxSize) {
+        mprFree(capture);
+        return 0;
+    }
+    keys = mapVary(web, vary);
+
+    lockCache(cache);
+    if ((spec = (CacheSpec*) mprLookupHash(cache->specs, web->cacheUri)) == 0) {
+        if ((spec = mprAllocObjZeroed(cache, CacheSpec)) == 0) {
+            unlockCache(cache);
+            mprFree(capture);
+            return 0;
+        }
+        spec->vary = mprStrdup(spec, keys);
+        mprAddHash(cache->specs, web->cacheUri, spec);
+
+    } else if (strcmp(spec->vary, keys) != 0 || spec->session != session) {
+        /*
+         *  Items cached under the prior specification become unreachable and age out of the cache
+         */
+        mprFree(spec->vary);
+        spec->vary = mprStrdup(spec, keys);
+    }
+    spec->session = session;
+    spec->refs++;
+
+    key = makeKey(web, web->control, web->handle, spec, web->cacheUri);
+    if ((old = (CacheItem*) mprLookupHash(cache->index, key)) != 0) {
+        removeItem(cache, old);
+    }
+    while (cache->size + size > cache->maxSize && cache->lru.prev != &cache->lru) {
+        removeItem(cache, cache->lru.prev);
+    }
+    /*
+     *  The capture is allocated from request memory which is released when the request completes, so keep a copy
+     */
+    if ((item = mprAllocObjZeroed(cache, CacheItem)) == 0 || (item->response = copyResponse(item, capture)) == 0) {
+        mprFree(item);
+        if (--spec->refs <= 0) {
+            mprRemoveHash(cache->specs, web->cacheUri);
+            mprFree(spec);
+        }
+        unlockCache(cache);
+        mprFree(capture);
+        return 0;
+    }
+    item->key = mprStrdup(item, key);
+    item->uri = mprStrdup(item, web->cacheUri);
+    mprAllocSprintf(item, &item->tags, -1, " %s ", tags ? tags : "");
+    item->spec = spec;
+    item->expires = mprGetTime(cache) + (MprTime) lifespan * MPR_TICKS_PER_SEC;
+    item->size = size;
+    mprFree(capture);
+
+    item->next = cache->lru.next;
+    item->prev = &cache->lru;
+    cache->lru.next->prev = item;
+    cache->lru.next = item;
+    mprAddHash(cache->index, item->key, item);
+    cache->size += size;
+
+    unlockCache(cache);
+    mprFree(key);
+    mprFree(keys);
+    return 1;
+}
+
+
+/*
+ *  Expire cached responses with the given tag. If tag is null, all responses are expired.
+ */
+void ejsExpireWebCache(EjsWebControl *control, cchar *tag)
+{
+    EjsWebCache     *cache;
+    CacheItem       *item, *next;
+    char            *pattern;
+
+    if ((cache = control->cache) == 0) {
+        return;
+    }
+    pattern = 0;
+    if (tag && *tag) {
+        mprAllocSprintf(cache, &pattern, -1, " %s ", tag);
+    }
+    lockCache(cache);
+    for (item = cache->lru.next; item != &cache->lru; item = next) {
+        next = item->next;
+        if (pattern == 0 || strstr(item->tags, pattern) != 0) {
+            removeItem(cache, item);
+        }
+    }
+    unlockCache(cache);
+    mprFree(pattern);
+}
+
+
+/*
+ *  Unlink and free an item. Must be called locked.
+ */
+static void removeItem(EjsWebCache *cache, CacheItem *item)
+{
+    CacheSpec   *spec;
+
+    item->prev->next = item->next;
+    item->next->prev = item->prev;
+    mprRemoveHash(cache->index, item->key);
+    cache->size -= item->size;
+
+    spec = item->spec;
+    if (--spec->refs <= 0) {
+        mprRemoveHash(cache->specs, item->uri);
+        mprFree(spec);
+    }
+    mprFree(item);
+}
+
+
+/*
+ *  Make a deep copy of a response owned by ctx
+ */
+static EjsWebCached *copyResponse(MprCtx ctx, EjsWebCached *rp)
+{
+    EjsWebCached    *cached;
+    MprHash         *hp;
+    int             len;
+
+    if ((cached = mprAllocObjZeroed(ctx, EjsWebCached)) == 0) {
+        return 0;
+    }
+    cached->code = rp->code;
+    cached->mimeType = rp->mimeType ? mprStrdup(cached, rp->mimeType) : 0;
+    cached->headers = mprCreateHash(cached, 7);
+    len = mprGetBufLength(rp->body);
+    cached->body = mprCreateBuf(cached, len + 1, -1);
+    if (cached->headers == 0 || cached->body == 0) {
+        mprFree(cached);
+        return 0;
+    }
+    for (hp = mprGetFirstHash(rp->headers); hp; hp = mprGetNextHash(rp->headers, hp)) {
+        mprAddHash(cached->headers, hp->key, mprStrdup(cached->headers, hp->data));
+    }
+    mprPutBlockToBuf(cached->body, mprGetBufStart(rp->body), len);
+    return cached;
+}
+
+
+/*
+ *  Make a cache key from the URI, the vary request headers and the session ID
+ */
+static char *makeKey(MprCtx ctx, EjsWebControl *control, void *handle, CacheSpec *spec, cchar *uri)
+{
+    MprBuf      *buf;
+    cchar       *value;
+    char        *keys, *name, *tok, *id, *key;
+
+    buf = mprCreateBuf(ctx, MPR_BUFSIZE, -1);
+    mprPutStringToBuf(buf, uri);
+
+    if (*spec->vary) {
+        keys = mprStrdup(buf, spec->vary);
+        for (name = mprStrTok(keys, " ", &tok); name; name = mprStrTok(0, " ", &tok)) {
+            value = control->getHeader(handle, name);
+            mprPutCharToBuf(buf, '\n');
+            mprPutStringToBuf(buf, value ? value : "");
+        }
+    }
+    if (spec->session) {
+        id = ejsGetWebSessionId(buf, control->getHeader(handle, "HTTP_COOKIE"));
+        mprPutCharToBuf(buf, '\n');
+        mprPutStringToBuf(buf, id ? id : "");
+    }
+    mprAddNullToBuf(buf);
+    key = mprStrdup(ctx, mprGetBufStart(buf));
+    mprFree(buf);
+    return key;
+}
+
+
+/*
+ *  Map HTTP header names to the CGI style keys used by connectors. "Accept-Language" becomes "HTTP_ACCEPT_LANGUAGE".
+ */
+static char *mapVary(MprCtx ctx, cchar *vary)
+{
+    MprBuf      *buf;
+    char        *names, *name, *tok, *cp, *keys;
+
+    buf = mprCreateBuf(ctx, MPR_BUFSIZE, -1);
+    if (vary) {
+        names = mprStrdup(buf, vary);
+        for (name = mprStrTok(names, " \t,", &tok); name; name = mprStrTok(0, " \t,", &tok)) {
+            for (cp = name; *cp; cp++) {
+                *cp = (*cp == '-') ? '_' : toupper((int) *cp);
+            }
+            if (mprGetBufLength(buf) > 0) {
+                mprPutCharToBuf(buf, ' ');
+            }
+            mprPutStringToBuf(buf, "HTTP_");
+            mprPutStringToBuf(buf, name);
+        }
+    }
+    mprAddNullToBuf(buf);
+    keys = mprStrdup(ctx, mprGetBufStart(buf));
+    mprFree(buf);
+    return keys;
+}
+
+
+static void lockCache(EjsWebCache *cache)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(cache->mutex);
+#endif
+}
+
+
+static void unlockCache(EjsWebCache *cache)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(cache->mutex);
+#endif
+}
+
+/*********************************** Factory **********************************/
+
+EjsWebCache *ejsCreateWebCache(MprCtx ctx, int maxSize)
+{
+    EjsWebCache     *cache;
+
+    cache = mprAllocObjZeroed(ctx, EjsWebCache);
+    if (cache == 0) {
+        return 0;
+    }
+    cache->maxSize = maxSize;
+    cache->lru.next = cache->lru.prev = &cache->lru;
+    cache->index = mprCreateHash(cache, EJS_WEB_CACHE_HASH);
+    cache->specs = mprCreateHash(cache, EJS_WEB_CACHE_HASH);
+    if (cache->index == 0 || cache->specs == 0) {
+        mprFree(cache);
+        return 0;
+    }
+#if BLD_FEATURE_MULTITHREAD
+    cache->mutex = mprCreateLock(cache);
+    if (cache->mutex == 0) {
+        mprFree(cache);
+        return 0;
+    }
+#endif
+    return cache;
+}
+
+#endif /* BLD_FEATURE_EJS_WEB */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
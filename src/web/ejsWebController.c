@@ -23,6 +23,51 @@ static EjsVar *cache(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 }
 
 
+/*
+ *  Start capturing the response for the response cache
+ *
+ *  private native function beginCache(): Void
+ */
+static EjsVar *beginCache(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+{
+    ejsBeginWebCache(ejs);
+    return 0;
+}
+
+
+/*
+ *  Store the captured response in the response cache
+ *
+ *  private native function saveCache(lifespan: Number, vary: String, tags: String, session: Boolean): Void
+ */
+static EjsVar *saveCache(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+{
+    mprAssert(argc == 4);
+
+    ejsSaveWebCache(ejs, ejsGetInt(argv[0]), ejsGetString(argv[1]), ejsGetString(argv[2]), ejsGetBoolean(argv[3]));
+    return 0;
+}
+
+
+/*
+ *  Expire cached responses with a given tag or all cached responses if the tag is omitted
+ *
+ *  native function expireCache(tag: String = null): Void
+ */
+static EjsVar *expireCache(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+{
+    EjsWeb      *web;
+    cchar       *tag;
+
+    mprAssert(argc == 0 || argc == 1);
+
+    web = ejsGetHandle(ejs);
+    tag = (argc == 1 && ejsIsString(argv[0])) ? ejsGetString(argv[0]) : 0;
+    ejsExpireWebCache(web->control, tag);
+    return 0;
+}
+
+
 /*
  *  Enable sessions for this request.
  *
@@ -72,6 +117,20 @@ static EjsVar *discardOutput(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 }
 
 
+/*
+ *  Flush pending output to the client
+ *
+ *  function flush(): Void
+ */
+static EjsVar *flushMethod(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+{
+    if (ejsFlushWeb(ejs) < 0) {
+        ejsThrowIOError(ejs, "Can't write to browser");
+    }
+    return 0;
+}
+
+
 /*
  *  Send an error response back to the client.
  *
@@ -149,6 +208,25 @@ static EjsVar *loadView(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 }
 
 
+/*
+ *  Define the request form and query parameters. Called on first access to Controller.params.
+ *
+ *  private native function loadParams(params: Object): Void
+ */
+static EjsVar *loadParams(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+{
+    EjsWeb      *web;
+
+    mprAssert(argc == 1);
+
+    web = ejsGetHandle(ejs);
+    web->params = argv[0];
+    ejsDefineParams(ejs);
+    ejsDefineWebRouteParams(web);
+    return 0;
+}
+
+
 /*
  *  Redirect the client's browser to a new URL.
  *
@@ -179,18 +257,16 @@ static EjsVar *redirectUrl(Ejs *ejs, EjsVar *controller, int argc, EjsVar **argv
  */
 static EjsVar *setHeader(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 {
-    EjsWeb      *web;
     char        *key, *value;
     bool        allowMultiple;
 
     mprAssert(argc == 1 || argc == 2);
 
-    web = ejsGetHandle(ejs);
     key = ejsGetString(argv[0]);
     value = ejsGetString(argv[1]);
     allowMultiple = (argc == 3) ? ejsGetBoolean(argv[2]) : 1;
 
-    web->control->setHeader(web->handle, allowMultiple, key, value);
+    ejsSetWebHeader(ejs, allowMultiple, key, "%s", value);
     return 0;
 }
 
@@ -202,19 +278,17 @@ static EjsVar *setHeader(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
  */
 static EjsVar *setCookie(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 {
-    EjsWeb      *web;
     char        *name, *value, *path;
     int         lifetime, secure;
     
     mprAssert(4 <= argc && argc <= 5);
-    web = ejsGetHandle(ejs);
 
     name = ejsGetString(argv[0]);
     value = ejsGetString(argv[1]);
     lifetime = ejsGetInt(argv[2]);
     path = ejsGetString(argv[3]);
     secure = (argc == 5) ? ejsGetBoolean(argv[4]): 0;
-    web->control->setCookie(web->handle, name, value, lifetime, path, secure);
+    ejsSetCookie(ejs, name, value, lifetime, path, secure);
     return 0;
 }
 
@@ -226,15 +300,13 @@ static EjsVar *setCookie(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
  */
 static EjsVar *setHttpCode(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 {
-    EjsWeb      *web;
     int         code;
     
     mprAssert(argc == 1);
-    web = ejsGetHandle(ejs);
 
     code = ejsGetInt(argv[0]);
 
-    web->control->setHttpCode(web->handle, code);
+    ejsSetHttpCode(ejs, code);
     return 0;
 }
 
@@ -246,16 +318,28 @@ static EjsVar *setHttpCode(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
  */
 static EjsVar *setMimeType(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 {
-    EjsWeb      *web;
     char        *mimeType;
     
     mprAssert(argc == 1);
     mprAssert(ejsIsString(argv[0]));
 
-    web = ejsGetHandle(ejs);
     mimeType = ejsGetString(argv[0]);
 
-    web->control->setMimeType(web->handle, mimeType);
+    ejsSetMimeType(ejs, mimeType);
+    return 0;
+}
+
+
+/*
+ *  Control whether output is streamed to the client as it is written
+ *
+ *  function stream(on: Boolean): Void
+ */
+static EjsVar *stream(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+{
+    mprAssert(argc == 1 && ejsIsBoolean(argv[0]));
+
+    ejsSetWebStreaming(ejs, ejsGetBoolean(argv[0]));
     return 0;
 }
 
@@ -323,6 +407,37 @@ static EjsVar *writeMethod(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
 }
 
 
+/*
+ *  Serialize an object as JSON and write it to the client. The serialized text is written directly from the buffer.
+ *
+ *  function writeJSON(obj: Object): Void
+ */
+static EjsVar *writeJSON(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+{
+    MprBuf      *buf;
+    int         len;
+
+    mprAssert(argc == 1);
+
+    buf = mprCreateBuf(ejs, MPR_BUFSIZE, -1);
+    if (buf == 0) {
+        ejsThrowMemoryError(ejs);
+        return 0;
+    }
+    if (ejsSerializeJSON(ejs, buf, argv[0]) < 0) {
+        mprFree(buf);
+        return 0;
+    }
+    ejsSetMimeType(ejs, "application/json");
+    len = mprGetBufLength(buf);
+    if (ejsWriteBlock(ejs, mprGetBufStart(buf), len) != len) {
+        ejsThrowIOError(ejs, "Can't write to browser");
+    }
+    mprFree(buf);
+    return 0;
+}
+
+
 /*********************************** Factory **********************************/
 /*
  *  The controller type is a scripted class augmented by native methods.
@@ -342,18 +457,25 @@ void ejsConfigureWebControllerType(Ejs *ejs)
     }
 
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_cache, (EjsNativeFunction) cache);
+    ejsBindMethod(ejs, type, ES_ejs_web_Controller_beginCache, (EjsNativeFunction) beginCache);
+    ejsBindMethod(ejs, type, ES_ejs_web_Controller_saveCache, (EjsNativeFunction) saveCache);
+    ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_expireCache, (EjsNativeFunction) expireCache);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_createSession, (EjsNativeFunction) createSession);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_destroySession, (EjsNativeFunction) destroySession);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_discardOutput, (EjsNativeFunction) discardOutput);
+    ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_flush, (EjsNativeFunction) flushMethod);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_sendError, (EjsNativeFunction) sendError);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_keepAlive, (EjsNativeFunction) keepAlive);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_loadView, (EjsNativeFunction) loadView);
+    ejsBindMethod(ejs, type, ES_ejs_web_Controller_loadParams, (EjsNativeFunction) loadParams);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_redirectUrl, (EjsNativeFunction) redirectUrl);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_setCookie, (EjsNativeFunction) setCookie);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_setHeader, (EjsNativeFunction) setHeader);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_setHttpCode, (EjsNativeFunction) setHttpCode);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_setMimeType, (EjsNativeFunction) setMimeType);
+    ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_stream, (EjsNativeFunction) stream);
     ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_write, (EjsNativeFunction) writeMethod);
+    ejsBindMethod(ejs, type, ES_ejs_web_Controller_ejs_web_writeJSON, (EjsNativeFunction) writeJSON);
 }
 
 #endif /* BLD_FEATURE_EJS_WEB */
@@ -21,6 +21,7 @@ static EjsWebControl *webControl;
 /***************************** Forward Declarations ***************************/
 
 static int  compile(EjsWeb *web, cchar *kind, cchar *name);
+static int  destroyWebRequest(EjsWeb *web);
 static void createCookie(Ejs *ejs, EjsVar *cookies, cchar *name, cchar *value, cchar *domain, cchar *path);
 static int  initInterp(Ejs *ejs, EjsWebControl *control);
 static int  loadApplication(EjsWeb *web);
@@ -40,6 +41,7 @@ void ejsConfigureWebTypes(Ejs *ejs)
     ejsConfigureWebHostType(ejs);
     ejsConfigureWebControllerType(ejs);
     ejsConfigureWebSessionType(ejs);
+    ejsConfigureWebViewType(ejs);
 }
 
 
@@ -77,6 +79,15 @@ int ejsOpenWebFramework(EjsWebControl *control, bool useMaster)
     if (control->service == 0) {
         return MPR_ERR_NO_MEMORY;
     }
+#if BLD_FEATURE_MULTITHREAD
+    /*
+     *  Builds use their own lock so that compiling a stale component does not stall session access under ejsLockWeb
+     */
+    control->buildLock = mprCreateLock(control);
+    if (control->buildLock == 0) {
+        return MPR_ERR_NO_MEMORY;
+    }
+#endif
 
     if (useMaster) {
         /*
@@ -92,6 +103,21 @@ int ejsOpenWebFramework(EjsWebControl *control, bool useMaster)
         if (initInterp(control->master, control) < 0) {
             return MPR_ERR_CANT_INITIALIZE;
         }
+        /*
+         *  The master is shared by all requests and may be used by multiple threads. It is treated as read-only after
+         *  this point. Only sessions are stored in it. They are indexed by the session store and their values are
+         *  accessed under ejsLockWeb.
+         */
+        control->master->gc.enabled = 0;
+
+        control->sessions = ejsCreateWebSessionStore(control);
+        if (control->sessions == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        control->cache = ejsCreateWebCache(control, EJS_WEB_CACHE_SIZE);
+        if (control->cache == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
     }
     webControl = control;
     return 0;
@@ -100,8 +126,6 @@ int ejsOpenWebFramework(EjsWebControl *control, bool useMaster)
 
 static int initInterp(Ejs *ejs, EjsWebControl *control)
 {
-    EjsVar      *sessions;
-
 #if !BLD_FEATURE_STATIC
     if (ejsLoadModule(ejs, "ejs.web", NULL, NULL, 0) == 0) {
         mprError(control, "Can't load ejs.web.mod: %s", ejsGetErrorMsg(ejs, 1));
@@ -115,17 +139,6 @@ static int initInterp(Ejs *ejs, EjsWebControl *control)
 
     //  TODO - should session timeouts per different per app?
     control->sessionTimeout = EJS_SESSION_TIMEOUT;
-#if ES_ejs_web_sessions
-    sessions = ejsGetProperty(ejs, ejs->global, ES_ejs_web_sessions);
-#else
-{
-    EjsName qname;
-    sessions = ejsGetPropertyByName(ejs, ejs->global, ejsName(&qname, "ejs.web", "sessions"));
-}
-#endif
-    ejsMakePermanent(ejs, sessions);
-    control->sessions = (EjsObject*) sessions;
-
     return 0;
 }
 
@@ -154,7 +167,7 @@ EjsWeb *ejsCreateWebRequest(MprCtx ctx, EjsWebControl *control, void *handle, cc
     EjsWeb          *web;
     cchar           *appUrl;
 
-    web = (EjsWeb*) mprAllocObjZeroed(ctx, EjsWeb);
+    web = (EjsWeb*) mprAllocObjWithDestructorZeroed(ctx, EjsWeb, destroyWebRequest);
     if (web == 0) {
         return 0;
     }
@@ -196,9 +209,6 @@ EjsWeb *ejsCreateWebRequest(MprCtx ctx, EjsWebControl *control, void *handle, cc
     ejsSetHandle(ejs, web);
 
     //  TODO - temp
-    if (control->master) {
-        control->master->gc.enabled = 0;
-    }
     ejs->gc.enabled = 0;
 
     mprLog(ctx, 3, "EJS: new request: AppDir %s, AppUrl %s, URL %s", web->appDir, web->appUrl, web->url);
@@ -207,6 +217,16 @@ EjsWeb *ejsCreateWebRequest(MprCtx ctx, EjsWebControl *control, void *handle, cc
 }
 
 
+/*
+ *  Release the request's session so the session timer can expire it
+ */
+static int destroyWebRequest(EjsWeb *web)
+{
+    ejsDetachWebSession(web);
+    return 0;
+}
+
+
 /*
  *  Parse the request URI and create the controller and action names. URI is in the form: "controller/action"
  */
@@ -239,8 +259,12 @@ static int parseControllerAction(EjsWeb *web)
     }
 
     /*
-     *  Request as part of an Ejscript application (not stand-alone)
+     *  Request as part of an Ejscript application (not stand-alone). Use the application route table if it has one.
      */
+    ejsName(&web->doActionName, "ejs.web", "doAction");
+    if (ejsMatchWebRoute(web)) {
+        return 0;
+    }
     for (url = web->url; *url == '/'; url++) {
         ;
     }
@@ -266,9 +290,6 @@ static int parseControllerAction(EjsWeb *web)
     mprAllocSprintf(web, &cp, -1, "%sController", controllerName);
     ejsName(&web->controllerName, EJS_PUBLIC_NAMESPACE, cp);
     web->controllerFile = controllerName;
-
-    ejsName(&web->doActionName, "ejs.web", "doAction");
-
     return 0;
 }
 
@@ -336,7 +357,7 @@ static int createController(EjsWeb *web)
     argv[0] = (web->flags & EJS_WEB_FLAG_SOLO) ? (EjsVar*) ejs->falseValue : (EjsVar*) ejs->trueValue;
     argv[1] = (EjsVar*) ejsCreateString(ejs, web->appDir);
     argv[2] = (EjsVar*) ejsCreateString(ejs, web->appUrl);
-    argv[3] = (EjsVar*) web->session;
+    argv[3] = web->session ? (EjsVar*) web->session : ejs->nullValue;
     argv[4] = host;
     argv[5] = request;
     argv[6] = response;
@@ -356,9 +377,6 @@ static int createController(EjsWeb *web)
         ejsRunFunctionBySlot(ejs, web->controller, slotNum, 0, NULL);
     }
 
-    web->params = ejsGetProperty(ejs, web->controller, ES_ejs_web_Controller_params);
-    //  TODO - rc
-    ejsDefineParams(ejs);
     ejsSetGeneration(ejs, oldGen);
     
     return 0;
@@ -406,6 +424,9 @@ int ejsRunWebRequest(EjsWeb *web)
 
     argv[0] = (EjsVar*) ejsCreateString(ejs, web->viewName);
     result = ejsRunFunction(ejs, (EjsFunction*) web->doAction, web->controller, 1, argv);
+    if (web->session) {
+        ejsSaveWebSession(web);
+    }
     if (result == 0 && ejs->exception) {
         web->error = ejsGetErrorMsg(ejs, 1);
         return MPR_ERR_CANT_COMPLETE;
@@ -546,32 +567,37 @@ static int compile(EjsWeb *web, cchar *kind, cchar *name)
 
 
 /*
- *  Buidl a resource
+ *  Build a resource. Builds are serialized so that concurrent requests for a stale component compile it once. Later
+ *  requests wait and then find the module up to date.
  */
 static int build(EjsWeb *web, cchar *kind, cchar *name, cchar *base, cchar *ext)
 {
     MprFileInfo     moduleInfo, sourceInfo;
     char            module[MPR_MAX_FNAME], source[MPR_MAX_FNAME];
+    int             rc;
 
     mprSprintf(module, sizeof(module), "%s.mod", base);
     mprSprintf(source, sizeof(source), "%s%s", base, ext);
+
+    rc = 0;
+    ejsLockBuild(web->control);
     mprGetFileInfo(web, module, &moduleInfo);
     mprGetFileInfo(web, source, &sourceInfo);
 
     if (!sourceInfo.valid) {
         mprLog(web, 3, "Can't find resource %s", source);
         mprAllocSprintf(web, &web->error, -1, "Can't find resource: \"%s\"", source);
-        return MPR_ERR_NOT_FOUND;
-    }
-    if (moduleInfo.valid && sourceInfo.valid && sourceInfo.mtime < moduleInfo.mtime) {
+        rc = MPR_ERR_NOT_FOUND;
+
+    } else if (moduleInfo.valid && sourceInfo.mtime < moduleInfo.mtime) {
         /* Up to date already */
         mprLog(web, 5, "Resource %s is up to date", source);
-        return 0;
-    }
-    if (compile(web, kind, name) != 0) {
-        return MPR_ERR_BAD_STATE;
+
+    } else if (compile(web, kind, name) != 0) {
+        rc = MPR_ERR_BAD_STATE;
     }
-    return 0;
+    ejsUnlockBuild(web->control);
+    return rc;
 }
 
 
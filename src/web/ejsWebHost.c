@@ -23,11 +23,19 @@
 
 /************************************* Code ***********************************/
 /*
- *  Lookup a property. These properties are virtualized.
+ *  Lookup a property. These properties are virtualized and materialized from the web server on first access.
  */
 static EjsVar *getHostProperty(Ejs *ejs, EjsWebHost *rq, int slotNum)
 {
-    return ejsGetWebVar(ejs, EJS_WEB_HOST_VAR, slotNum);
+    if (slotNum < 0 || slotNum >= ES_ejs_web_Host_NUM_INSTANCE_PROP) {
+        ejsThrowOutOfBoundsError(ejs, "Bad property slot reference");
+        return 0;
+    }
+    if (rq->values[slotNum] == 0) {
+        rq->values[slotNum] = ejsGetWebVar(ejs, EJS_WEB_HOST_VAR, slotNum);
+        ejsSetReference(ejs, (EjsVar*) rq, rq->values[slotNum]);
+    }
+    return rq->values[slotNum];
 }
 
 
@@ -57,10 +65,25 @@ static int lookupHostProperty(struct Ejs *ejs, EjsWebHost *rq, EjsName *qname)
  */
 static int setHostProperty(struct Ejs *ejs, EjsWebHost *ap, int slotNum,  EjsVar *value)
 {
+    if (0 <= slotNum && slotNum < ES_ejs_web_Host_NUM_INSTANCE_PROP) {
+        ap->values[slotNum] = 0;
+    }
     return ejsSetWebVar(ejs, EJS_WEB_HOST_VAR, slotNum, value);
 }
 
 
+static void markHostVar(Ejs *ejs, EjsVar *parent, EjsWebHost *hp)
+{
+    int         i;
+
+    for (i = 0; i < ES_ejs_web_Host_NUM_INSTANCE_PROP; i++) {
+        if (hp->values[i]) {
+            ejsMarkVar(ejs, (EjsVar*) hp, hp->values[i]);
+        }
+    }
+}
+
+
 /*********************************** Factory **********************************/
 
 EjsWebHost *ejsCreateWebHostObject(Ejs *ejs, void *handle)
@@ -102,6 +125,7 @@ void ejsConfigureWebHostType(Ejs *ejs)
     type->helpers->getPropertyCount = (EjsGetPropertyCountHelper) getHostPropertyCount;
     type->helpers->getPropertyName = (EjsGetPropertyNameHelper) getHostPropertyName;
     type->helpers->lookupProperty = (EjsLookupPropertyHelper) lookupHostProperty;
+    type->helpers->markVar = (EjsMarkVarHelper) markHostVar;
     type->helpers->setProperty = (EjsSetPropertyHelper) setHostProperty;
 }
 
@@ -10,6 +10,54 @@
 #include    "ejs.h"
 
 /************************************ Code ************************************/
+/*
+ *  Lock the master interpreter and shared web state. Request interpreters are private to one request (and thread)
+ *  and do not need locking. The master is read-only after initialization except for the sessions it stores.
+ */
+void ejsLockWeb(EjsWebControl *control)
+{
+#if BLD_FEATURE_MULTITHREAD
+    if (control->lock) {
+        control->lock(control->lockData);
+    }
+#endif
+}
+
+
+void ejsUnlockWeb(EjsWebControl *control)
+{
+#if BLD_FEATURE_MULTITHREAD
+    if (control->unlock) {
+        control->unlock(control->lockData);
+    }
+#endif
+}
+
+
+/*
+ *  Lock component builds and route table loading. This is separate from ejsLockWeb so that a slow compile does not 
+ *  block requests that only need session access.
+ */
+void ejsLockBuild(EjsWebControl *control)
+{
+#if BLD_FEATURE_MULTITHREAD
+    if (control->buildLock) {
+        mprLock(control->buildLock);
+    }
+#endif
+}
+
+
+void ejsUnlockBuild(EjsWebControl *control)
+{
+#if BLD_FEATURE_MULTITHREAD
+    if (control->buildLock) {
+        mprUnlock(control->buildLock);
+    }
+#endif
+}
+
+
 
 void ejsDefineParams(Ejs *ejs)
 {
@@ -24,6 +72,23 @@ void ejsDefineParams(Ejs *ejs)
 }
 
 
+/*
+ *  Flush output written so far to the client. Headers can not be modified after output has been flushed.
+ */
+int ejsFlushWeb(Ejs *ejs)
+{
+    EjsWeb         *web;
+
+    mprAssert(ejs);
+    web = ejsGetHandle(ejs);
+
+    if (web->control->flush) {
+        return web->control->flush(web->handle);
+    }
+    return 0;
+}
+
+
 /*
  *  Discard all generated output
  */
@@ -37,6 +102,9 @@ void ejsDiscardOutput(Ejs *ejs)
     if (web->control->discardOutput) {
         web->control->discardOutput(web->handle);
     }
+    if (web->capture) {
+        mprFlushBuf(web->capture->body);
+    }
 }
 
 
@@ -55,6 +123,9 @@ void ejsWebError(Ejs *ejs, int code, cchar *fmt, ...)
     va_start(args, fmt);
     mprAllocVsprintf(ejs, &buf, -1, fmt, args);
     web = ejsGetHandle(ejs);
+    if (web->capture) {
+        web->capture->uncacheable = 1;
+    }
 
     if (web->control->error) {
         web->control->error(web->handle, code, buf);
@@ -129,6 +200,9 @@ void ejsRedirect(Ejs *ejs, int code, cchar *url)
     mprAssert(url);
 
     web = ejsGetHandle(ejs);
+    if (web->capture) {
+        web->capture->uncacheable = 1;
+    }
     mprAssert(web->control->redirect);
     web->control->redirect(web->handle, code, url);
 }
@@ -141,6 +215,9 @@ void ejsSetCookie(Ejs *ejs, cchar *name, cchar *value, int lifetime, cchar *path
     mprAssert(ejs);
 
     web = ejsGetHandle(ejs);
+    if (web->capture) {
+        web->capture->uncacheable = 1;
+    }
     mprAssert(web->control->setCookie);
     web->control->setCookie(web->handle, name, value, lifetime, path, secure);
 }
@@ -159,8 +236,13 @@ void ejsSetWebHeader(Ejs *ejs, bool allowMultiple, cchar *key, cchar *fmt, ...)
 
     va_start(vargs, fmt);
     mprAllocVsprintf(web, &value, -1, fmt, vargs);
+    va_end(vargs);
 
-    web->control->setHeader(web->handle, allowMultiple, key, value);
+    if (web->capture) {
+        mprAddHash(web->capture->headers, key, mprStrdup(web->capture->headers, value));
+    }
+    web->control->setHeader(web->handle, allowMultiple, key, "%s", value);
+    mprFree(value);
 }
 
 
@@ -172,10 +254,49 @@ void ejsSetHttpCode(Ejs *ejs, int code)
 
     web = ejsGetHandle(ejs);
     mprAssert(web->control->setHttpCode);
+    if (web->capture) {
+        web->capture->code = code;
+    }
     web->control->setHttpCode(web->handle, code);
 }
 
 
+void ejsSetMimeType(Ejs *ejs, cchar *mimeType)
+{
+    EjsWeb     *web;
+
+    mprAssert(ejs);
+    mprAssert(mimeType);
+
+    web = ejsGetHandle(ejs);
+    mprAssert(web->control->setMimeType);
+    if (web->capture) {
+        mprFree((char*) web->capture->mimeType);
+        web->capture->mimeType = mprStrdup(web->capture, mimeType);
+    }
+    web->control->setMimeType(web->handle, mimeType);
+}
+
+
+/*
+ *  Stream output to the client as it is written rather than when the request completes. Connectors without a flush
+ *  callback buffer all output regardless.
+ */
+void ejsSetWebStreaming(Ejs *ejs, bool on)
+{
+    EjsWeb     *web;
+
+    mprAssert(ejs);
+
+    web = ejsGetHandle(ejs);
+    if (on) {
+        web->flags |= EJS_WEB_FLAG_STREAM;
+    } else {
+        web->flags &= ~EJS_WEB_FLAG_STREAM;
+    }
+}
+
+
 /*
  *  Set a variable in the web server. This is used to implement virtual properties
  */
@@ -205,20 +326,19 @@ int ejsWriteBlock(Ejs *ejs, cchar *buf, int size)
 
     web = ejsGetHandle(ejs);
     mprAssert(web->control->write);
+    if (web->capture) {
+        mprPutBlockToBuf(web->capture->body, buf, size);
+    }
     return web->control->write(web->handle, buf, size);
 }
 
 
 int ejsWriteString(Ejs *ejs, cchar *buf)
 {
-    EjsWeb     *web;
-
     mprAssert(ejs);
     mprAssert(buf);
 
-    web = ejsGetHandle(ejs);
-    mprAssert(web->control->write);
-    return web->control->write(web->handle, buf, (int) strlen(buf));
+    return ejsWriteBlock(ejs, buf, (int) strlen(buf));
 }
 
 
@@ -237,7 +357,7 @@ int ejsWrite(Ejs *ejs, cchar *fmt, ...)
 
     va_start(args, fmt);
     len = mprAllocVsprintf(web, &buf, -1, fmt, args);
-    rc = web->control->write(web->handle, buf, len);
+    rc = ejsWriteBlock(ejs, buf, len);
     mprFree(buf);
     va_end(args);
 
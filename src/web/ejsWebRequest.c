@@ -15,11 +15,26 @@
 
 /************************************* Code ***********************************/
 /*
- *  Lookup a property. These properties are virtualized.
+ *  Lookup a property. These properties are virtualized. Values are created from the web server request on first access
+ *  and retained, so only the properties a request actually uses are allocated. The session ID may change during the
+ *  request and is always fetched.
  */
 static EjsVar *getRequestProperty(Ejs *ejs, EjsWebRequest *rq, int slotNum)
 {
-    return ejsGetWebVar(ejs, EJS_WEB_REQUEST_VAR, slotNum);
+    EjsVar      *value;
+
+    if (slotNum < 0 || slotNum >= ES_ejs_web_Request_NUM_INSTANCE_PROP) {
+        ejsThrowOutOfBoundsError(ejs, "Bad property slot reference");
+        return 0;
+    }
+    if ((value = rq->values[slotNum]) == 0) {
+        value = ejsGetWebVar(ejs, EJS_WEB_REQUEST_VAR, slotNum);
+        if (slotNum != ES_ejs_web_Request_sessionID) {
+            rq->values[slotNum] = value;
+            ejsSetReference(ejs, (EjsVar*) rq, value);
+        }
+    }
+    return value;
 }
 
 
@@ -48,6 +63,18 @@ static int setRequestProperty(Ejs *ejs, EjsWebRequest *rq, int slotNum,  EjsVar
 }
 
 
+static void markRequestVar(Ejs *ejs, EjsVar *parent, EjsWebRequest *rq)
+{
+    int         i;
+
+    for (i = 0; i < ES_ejs_web_Request_NUM_INSTANCE_PROP; i++) {
+        if (rq->values[i]) {
+            ejsMarkVar(ejs, (EjsVar*) rq, rq->values[i]);
+        }
+    }
+}
+
+
 /*********************************** Factory **********************************/
 
 EjsWebRequest *ejsCreateWebRequestObject(Ejs *ejs, void *handle)
@@ -88,6 +115,7 @@ void ejsConfigureWebRequestType(Ejs *ejs)
     type->helpers->getPropertyCount = (EjsGetPropertyCountHelper) getRequestPropertyCount;
     type->helpers->getPropertyName = (EjsGetPropertyNameHelper) getRequestPropertyName;
     type->helpers->lookupProperty = (EjsLookupPropertyHelper) lookupRequestProperty;
+    type->helpers->markVar = (EjsMarkVarHelper) markRequestVar;
     type->helpers->setProperty = (EjsSetPropertyHelper) setRequestProperty;
 }
 
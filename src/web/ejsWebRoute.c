@@ -0,0 +1,412 @@
+/**
+ *  ejsWebRoute.c - Route table for controller dispatch
+ *
+ *  Routes are read from config/routes.ecf when an application first receives a request and are compiled into a trie
+ *  of URL path segments. A request is resolved by walking the trie once over the path segments, so large route sets
+ *  match in time proportional to the path length. Requests that match no route use the default /controller/action 
+ *  mapping. The routes file has the form:
+ *
+ *      routes: [
+ *          { url: "/articles/${year:int}/${month:int}", controller: "Articles", action: "archive" },
+ *          { url: "/${controller}/${action}/${id}" },
+ *      ]
+ *
+ *  Parameters match one path segment and are defined in the controller params. Typed "int" parameters only match
+ *  decimal digits. The special "controller" and "action" parameters select the controller and action.
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "ejs.h"
+
+#if BLD_FEATURE_EJS_WEB
+
+/*********************************** Locals ***********************************/
+
+#define ROUTE_MAX_SEGMENTS  64              /* Max URL path segments considered for routing */
+#define ROUTE_PARAM_INT     1               /* Parameter matches decimal digits only */
+#define ROUTE_PARAM_STRING  2               /* Parameter matches any segment */
+
+typedef struct Route {
+    cchar           *controllerFile;        /* Controller name without the "Controller" suffix */
+    cchar           *controllerName;        /* Controller class name */
+    cchar           *action;                /* Action name */
+} Route;
+
+
+typedef struct RouteNode {
+    MprHashTable    *literals;              /* Child nodes by literal segment */
+    struct RouteNode *params;               /* Child nodes for parameter segments. Int parameters first */
+    struct RouteNode *nextParam;            /* Next sibling parameter node */
+    cchar           *paramName;             /* Name of the parameter captured by this node */
+    int             paramType;              /* ROUTE_PARAM_INT or ROUTE_PARAM_STRING */
+    Route           *route;                 /* Route ending at this node */
+} RouteNode;
+
+
+typedef struct EjsWebRoutes {
+    RouteNode       *root;                  /* Trie root */
+    int             count;                  /* Number of routes */
+} EjsWebRoutes;
+
+/***************************** Forward Declarations ***************************/
+
+static int addRoute(EjsWebRoutes *routes, cchar *url, cchar *controller, cchar *action);
+static EjsWebRoutes *getRoutes(EjsWeb *web);
+static cchar *getRouteOption(Ejs *ejs, EjsVar *obj, cchar *name);
+static EjsWebRoutes *loadRoutes(EjsWeb *web);
+static Route *matchNode(RouteNode *node, char **segments, int count, int index, RouteNode **trail);
+
+/************************************* Code ***********************************/
+/*
+ *  Resolve the request URL via the application route table. Sets the controller, action and route parameters and
+ *  returns true if a route matched.
+ */
+bool ejsMatchWebRoute(EjsWeb *web)
+{
+    EjsWebRoutes    *routes;
+    RouteNode       *trail[ROUTE_MAX_SEGMENTS];
+    Route           *route;
+    cchar           *controller, *action, **params;
+    char            *segments[ROUTE_MAX_SEGMENTS], *path, *seg, *tok;
+    int             count, i, nparams;
+
+    routes = getRoutes(web);
+    if (routes == 0 || routes->count == 0) {
+        return 0;
+    }
+    path = mprStrdup(web, web->url);
+    count = 0;
+    for (seg = mprStrTok(path, "/", &tok); seg; seg = mprStrTok(0, "/", &tok)) {
+        if (count >= ROUTE_MAX_SEGMENTS) {
+            mprFree(path);
+            return 0;
+        }
+        segments[count++] = seg;
+    }
+    if ((route = matchNode(routes->root, segments, count, 0, trail)) == 0) {
+        mprFree(path);
+        return 0;
+    }
+
+    /*
+     *  Collect the parameters captured along the matched path
+     */
+    controller = route->controllerFile;
+    action = route->action;
+    params = (cchar**) mprAlloc(web, (count * 2 + 1) * sizeof(cchar*));
+    if (params == 0) {
+        mprFree(path);
+        return 0;
+    }
+    for (nparams = i = 0; i < count; i++) {
+        if (trail[i]->paramName == 0) {
+            continue;
+        }
+        if (strcmp(trail[i]->paramName, "controller") == 0) {
+            segments[i][0] = toupper((int) segments[i][0]);
+            controller = segments[i];
+        } else if (strcmp(trail[i]->paramName, "action") == 0) {
+            action = segments[i];
+        } else {
+            params[nparams++] = trail[i]->paramName;
+            params[nparams++] = segments[i];
+        }
+    }
+    params[nparams] = 0;
+
+    if (controller == 0) {
+        controller = "Base";
+    }
+    if (controller == route->controllerFile) {
+        ejsName(&web->controllerName, EJS_PUBLIC_NAMESPACE, route->controllerName);
+    } else {
+        mprAllocSprintf(web, &seg, -1, "%sController", controller);
+        ejsName(&web->controllerName, EJS_PUBLIC_NAMESPACE, seg);
+    }
+    web->controllerFile = (char*) controller;
+    web->viewName = (char*) ((action && *action) ? action : "index");
+    web->routeParams = params;
+    return 1;
+}
+
+
+/*
+ *  Define the parameters captured by the matched route in the controller params
+ */
+void ejsDefineWebRouteParams(EjsWeb *web)
+{
+    cchar       **pp;
+
+    if ((pp = web->routeParams) == 0) {
+        return;
+    }
+    for (; *pp; pp += 2) {
+        ejsDefineWebParam(web->ejs, pp[0], pp[1]);
+    }
+}
+
+
+/*
+ *  Depth first match preferring literal segments over parameters and int parameters over string parameters. Trail
+ *  records the node matched for each segment.
+ */
+static Route *matchNode(RouteNode *node, char **segments, int count, int index, RouteNode **trail)
+{
+    RouteNode   *child;
+    Route       *route;
+    char        *cp;
+
+    if (index == count) {
+        return node->route;
+    }
+    if (node->literals && (child = (RouteNode*) mprLookupHash(node->literals, segments[index])) != 0) {
+        trail[index] = child;
+        if ((route = matchNode(child, segments, count, index + 1, trail)) != 0) {
+            return route;
+        }
+    }
+    for (child = node->params; child; child = child->nextParam) {
+        if (child->paramType == ROUTE_PARAM_INT) {
+            for (cp = segments[index]; isdigit((int) *cp); cp++) {
+                ;
+            }
+            if (*cp) {
+                continue;
+            }
+        }
+        trail[index] = child;
+        if ((route = matchNode(child, segments, count, index + 1, trail)) != 0) {
+            return route;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ *  Return the route table for the request application. Tables are compiled on the first request for an application
+ *  and then shared by all requests.
+ */
+static EjsWebRoutes *getRoutes(EjsWeb *web)
+{
+    EjsWebControl   *control;
+    EjsWebRoutes    *routes;
+
+    if (!(web->flags & EJS_WEB_FLAG_APP) || web->appDir == 0) {
+        return 0;
+    }
+    control = web->control;
+
+    ejsLockBuild(control);
+    if (control->routes == 0) {
+        control->routes = mprCreateHash(control, 0);
+    }
+    if ((routes = (EjsWebRoutes*) mprLookupHash(control->routes, web->appDir)) == 0) {
+        if ((routes = loadRoutes(web)) != 0) {
+            mprAddHash(control->routes, web->appDir, routes);
+        }
+    }
+    ejsUnlockBuild(control);
+    return routes;
+}
+
+
+/*
+ *  Read and compile config/routes.ecf. Returns an empty table if the application has no routes file.
+ */
+static EjsWebRoutes *loadRoutes(EjsWeb *web)
+{
+    Ejs             *ejs;
+    EjsWebRoutes    *routes;
+    EjsArray        *list;
+    EjsVar          *config, *item;
+    EjsName         qname;
+    MprFile         *file;
+    MprBuf          *buf;
+    char            path[MPR_MAX_FNAME], data[MPR_BUFSIZE];
+    int             bytes, i;
+
+    ejs = web->ejs;
+    routes = mprAllocObjZeroed(web->control, EjsWebRoutes);
+    if (routes == 0) {
+        return 0;
+    }
+    routes->root = mprAllocObjZeroed(routes, RouteNode);
+    if (routes->root == 0) {
+        mprFree(routes);
+        return 0;
+    }
+    mprSprintf(path, sizeof(path), "%s/config/routes.ecf", web->appDir);
+    if ((file = mprOpen(web, path, O_RDONLY | O_BINARY, 0)) == 0) {
+        return routes;
+    }
+    buf = mprCreateBuf(web, MPR_BUFSIZE, -1);
+    mprPutStringToBuf(buf, "{ ");
+    while ((bytes = mprRead(file, data, sizeof(data))) > 0) {
+        mprPutBlockToBuf(buf, data, bytes);
+    }
+    mprPutStringToBuf(buf, " }");
+    mprAddNullToBuf(buf);
+    mprFree(file);
+
+    config = ejsDeserialize(ejs, (EjsVar*) ejsCreateStringWithLength(ejs, mprGetBufStart(buf), mprGetBufLength(buf)));
+    mprFree(buf);
+    if (config == 0) {
+        mprError(web, "Can't parse %s: %s", path, ejs->exception ? ejsGetErrorMsg(ejs, 0) : "");
+        ejs->exception = 0;
+        return routes;
+    }
+    list = (EjsArray*) ejsGetPropertyByName(ejs, config, ejsName(&qname, "", "routes"));
+    if (list == 0) {
+        list = (EjsArray*) ejsGetPropertyByName(ejs, config, ejsName(&qname, EJS_PUBLIC_NAMESPACE, "routes"));
+    }
+    if (list == 0 || !ejsIsArray(list)) {
+        mprError(web, "Missing routes array in %s", path);
+        return routes;
+    }
+    for (i = 0; i < list->length; i++) {
+        item = list->data[i];
+        if (item == 0 || !ejsIsObject(item)) {
+            continue;
+        }
+        if (addRoute(routes, getRouteOption(ejs, item, "url"), getRouteOption(ejs, item, "controller"), 
+                getRouteOption(ejs, item, "action")) < 0) {
+            mprError(web, "Bad route %d in %s", i, path);
+        }
+    }
+    mprLog(web, 3, "Loaded %d routes from %s", routes->count, path);
+    return routes;
+}
+
+
+static cchar *getRouteOption(Ejs *ejs, EjsVar *obj, cchar *name)
+{
+    EjsName     qname;
+    EjsVar      *vp;
+
+    if ((vp = ejsGetPropertyByName(ejs, obj, ejsName(&qname, "", name))) == 0) {
+        vp = ejsGetPropertyByName(ejs, obj, ejsName(&qname, EJS_PUBLIC_NAMESPACE, name));
+    }
+    return (vp && ejsIsString(vp)) ? ejsGetString(vp) : 0;
+}
+
+
+/*
+ *  Add a route URL pattern to the trie. Pattern segments are literals or parameters of the form ${name} or 
+ *  ${name:type} where type is "int" or "string".
+ */
+static int addRoute(EjsWebRoutes *routes, cchar *url, cchar *controller, cchar *action)
+{
+    RouteNode   *node, *child, **pp;
+    Route       *route;
+    char        *pattern, *seg, *tok, *name, *type, *cp;
+    int         paramType;
+
+    if (url == 0) {
+        return MPR_ERR_BAD_ARGS;
+    }
+    pattern = mprStrdup(routes, url);
+    node = routes->root;
+
+    for (seg = mprStrTok(pattern, "/", &tok); seg; seg = mprStrTok(0, "/", &tok)) {
+        if (strncmp(seg, "${", 2) != 0) {
+            if (node->literals == 0) {
+                node->literals = mprCreateHash(node, 0);
+            }
+            if ((child = (RouteNode*) mprLookupHash(node->literals, seg)) == 0) {
+                child = mprAllocObjZeroed(node, RouteNode);
+                mprAddHash(node->literals, seg, child);
+            }
+            node = child;
+            continue;
+        }
+        name = &seg[2];
+        if ((cp = strchr(name, '}')) == 0 || cp[1] != '\0') {
+            mprFree(pattern);
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        *cp = '\0';
+        paramType = ROUTE_PARAM_STRING;
+        if ((type = strchr(name, ':')) != 0) {
+            *type++ = '\0';
+            if (strcmp(type, "int") == 0) {
+                paramType = ROUTE_PARAM_INT;
+            } else if (strcmp(type, "string") != 0) {
+                mprFree(pattern);
+                return MPR_ERR_BAD_SYNTAX;
+            }
+        }
+        for (child = node->params; child; child = child->nextParam) {
+            if (child->paramType == paramType && strcmp(child->paramName, name) == 0) {
+                break;
+            }
+        }
+        if (child == 0) {
+            child = mprAllocObjZeroed(node, RouteNode);
+            child->paramName = mprStrdup(child, name);
+            child->paramType = paramType;
+            for (pp = &node->params; *pp && (*pp)->paramType <= paramType; pp = &(*pp)->nextParam) {
+                ;
+            }
+            child->nextParam = *pp;
+            *pp = child;
+        }
+        node = child;
+    }
+    mprFree(pattern);
+
+    if (node->route) {
+        /* First definition wins */
+        return 0;
+    }
+    route = node->route = mprAllocObjZeroed(node, Route);
+    if (controller && *controller) {
+        name = mprStrdup(route, controller);
+        if ((cp = strstr(name, "Controller")) != 0 && cp[10] == '\0') {
+            *cp = '\0';
+        }
+        route->controllerFile = name;
+        mprAllocSprintf(route, &cp, -1, "%sController", name);
+        route->controllerName = cp;
+    }
+    if (action && *action) {
+        route->action = mprStrdup(route, action);
+    }
+    routes->count++;
+    return 0;
+}
+
+#endif /* BLD_FEATURE_EJS_WEB */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
@@ -11,9 +11,42 @@
 #include    "ejs.h"
 
 #if BLD_FEATURE_EJS_WEB
+/*********************************** Locals ***********************************/
+/*
+ *  Expiry wheel geometry. Three levels of 64 slots cover 2^18 timer periods (about 72 hours at one second).
+ */
+#define EJS_WHEEL_BITS      6
+#define EJS_WHEEL_SLOTS     (1 << EJS_WHEEL_BITS)
+#define EJS_WHEEL_MASK      (EJS_WHEEL_SLOTS - 1)
+#define EJS_WHEEL_LEVELS    3
+
+#define EJS_SESSION_RECORD          'S'     /* Session backend record signature */
+#define EJS_SESSION_RECORD_VERSION  2
+
+typedef struct EjsWebSessionShard {
+    MprHashTable    *table;                                     /* Sessions indexed by ID */
+    EjsWebSession   *wheel[EJS_WHEEL_LEVELS][EJS_WHEEL_SLOTS];  /* Expiry wheel slots */
+    int64           tick;                                       /* Last timer period processed by the wheel */
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;                                     /* Guards the table and wheel */
+#endif
+} EjsWebSessionShard;
+
+typedef struct EjsWebSessionStore {
+    EjsWebControl       *control;
+    MprEvent            *timer;                                 /* Expiry timer */
+    MprTime             start;                                  /* Time of wheel tick zero */
+    int                 speed;                                  /* Session clock speed relative to real time */
+    EjsWebSessionShard  shards[EJS_SESSION_SHARDS];
+} EjsWebSessionStore;
+
 /*********************************** Forwards *********************************/
 
-static void sessionActivity(Ejs *ejs, EjsWebSession *sp);
+static void addSession(EjsWebSessionStore *store, EjsWebSession *sp);
+static EjsWebSession *allocSession(Ejs *ejs, EjsWebControl *control, cchar *id, int timeout);
+static void attachSession(EjsWeb *web, EjsWebSession *sp);
+static bool removeSession(EjsWebSessionStore *store, EjsWebSession *sp);
+static void sessionActivity(EjsWebControl *control, EjsWebSession *sp);
 static void sessionTimer(EjsWebControl *control, MprEvent *event);
 
 /************************************* Code ***********************************/
@@ -52,6 +85,11 @@ static EjsVar *getSessionProperty(Ejs *ejs, EjsWebSession *sp, int slotNum)
         return (EjsVar*) ejs->emptyStringValue;
     }
 
+    /*
+     *  Session values live in the master interpreter. Deserialize while locked so the value can't be replaced and 
+     *  collected by another request underneath us.
+     */
+    ejsLockWeb(web->control);
     vp = ejs->objectHelpers->getProperty(ejs, (EjsVar*) sp, slotNum);
     if (vp) {
         vp = ejsDeserialize(ejs, vp);
@@ -62,7 +100,8 @@ static EjsVar *getSessionProperty(Ejs *ejs, EjsWebSession *sp, int slotNum)
     if (vp == ejs->undefinedValue) {
         vp = (EjsVar*) ejs->emptyStringValue;
     }
-    sessionActivity(ejs, sp);
+    sessionActivity(web->control, sp);
+    ejsUnlockWeb(web->control);
     return vp;
 }
 
@@ -79,6 +118,7 @@ static EjsVar *getSessionPropertyByName(Ejs *ejs, EjsWebSession *sp, EjsName *qn
     }
 
     qname->space = EJS_PUBLIC_NAMESPACE;
+    ejsLockWeb(web->control);
     slotNum = ejs->objectHelpers->lookupProperty(ejs, (EjsVar*) sp, qname);
     if (slotNum < 0) {
         /*
@@ -94,7 +134,8 @@ static EjsVar *getSessionPropertyByName(Ejs *ejs, EjsWebSession *sp, EjsName *qn
 #endif
         }
     }
-    sessionActivity(ejs, sp);
+    sessionActivity(web->control, sp);
+    ejsUnlockWeb(web->control);
     return vp;
 }
 
@@ -133,6 +174,7 @@ static char *escape(MprCtx ctx, char *str)
 static int setSessionProperty(Ejs *ejs, EjsWebSession *sp, int slotNum, EjsVar *value)
 {
     EjsWeb  *web;
+    EjsVar  *prior;
     
     web = ejs->handle;
     if (web->session != sp) {
@@ -143,6 +185,7 @@ static int setSessionProperty(Ejs *ejs, EjsWebSession *sp, int slotNum, EjsVar *
     /*
      *  Allocate the serialized object using the master interpreter
      */
+    ejsLockWeb(web->control);
     if (ejs->master) {
         ejs = ejs->master;
     }
@@ -155,77 +198,521 @@ static int setSessionProperty(Ejs *ejs, EjsWebSession *sp, int slotNum, EjsVar *
         mprFree(estr);
     }
 #else
-    value = (EjsVar*) ejsSerialize(ejs, value, 0, 0, 0);
+    value = (EjsVar*) ejsSerializeBinary(ejs, value, 0, 0, 0);
 #endif
+    if (value == 0) {
+        ejsUnlockWeb(web->control);
+        return EJS_ERR;
+    }
+
+    /*
+     *  Values are only referenced from the permanent session object which the collector does not traverse
+     */
+    if (slotNum >= 0 && slotNum < sp->obj.numProp) {
+        prior = ejs->objectHelpers->getProperty(ejs, (EjsVar*) sp, slotNum);
+        if (prior) {
+            ejsMakeTransient(ejs, prior);
+        }
+    }
+    ejsMakePermanent(ejs, value);
     slotNum = ejs->objectHelpers->setProperty(ejs, (EjsVar*) sp, slotNum, value);
+    sp->dirty = 1;
     
-    sessionActivity(ejs, sp);
+    sessionActivity(web->control, sp);
+    ejsUnlockWeb(web->control);
     return slotNum;
 }
 
 
 /******************************************************************************/
 /*
- *  Update the session expiration time due to activity
+ *  Read the session clock. This runs at real time unless the control has sped it up for testing.
  */
-static void sessionActivity(Ejs *ejs, EjsWebSession *sp)
+static MprTime getSessionTime(EjsWebSessionStore *store)
 {
-    sp->expire = mprGetTime(ejs) + sp->timeout * MPR_TICKS_PER_SEC;
+    return store->start + (mprGetTime(store) - store->start) * store->speed;
 }
 
 
 /*
- *  Check for expired sessions
+ *  Update the session expiration time due to activity. This does not move the session in the expiry wheel. The wheel
+ *  re-checks the expiry time when the session's slot comes due and reschedules it if there has been activity.
  */
-static void sessionTimer(EjsWebControl *control, MprEvent *event)
+static void sessionActivity(EjsWebControl *control, EjsWebSession *sp)
+{
+    sp->expire = getSessionTime(control->sessions) + sp->timeout * MPR_TICKS_PER_SEC;
+}
+
+
+/*
+ *  Lock a shard's index and expiry wheel. Session values and the session use counts are guarded by ejsLockWeb. When 
+ *  both are needed, the web lock is taken first.
+ */
+static void lockShard(EjsWebSessionShard *shard)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(shard->mutex);
+#endif
+}
+
+
+static void unlockShard(EjsWebSessionShard *shard)
+{
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(shard->mutex);
+#endif
+}
+
+
+/*
+ *  Make a session the current session for a request. A session in use by a request is not released by the expiry 
+ *  timer. Must be called with the web lock held.
+ */
+static void attachSession(EjsWeb *web, EjsWebSession *sp)
+{
+    if (web->session == sp) {
+        return;
+    }
+    if (web->session) {
+        web->session->users--;
+    }
+    if (sp) {
+        sp->users++;
+    }
+    web->session = sp;
+}
+
+
+/*
+ *  Release the request's hold on its session. Called when the request completes.
+ */
+void ejsDetachWebSession(EjsWeb *web)
+{
+    if (web->session) {
+        ejsLockWeb(web->control);
+        attachSession(web, 0);
+        ejsUnlockWeb(web->control);
+    }
+}
+
+
+/*
+ *  Select the shard for a session ID
+ */
+static EjsWebSessionShard *getShard(EjsWebSessionStore *store, cchar *id)
+{
+    uint    hash;
+
+    for (hash = 0; *id; id++) {
+        hash = (hash * 33) + *id;
+    }
+    return &store->shards[hash % EJS_SESSION_SHARDS];
+}
+
+
+/*
+ *  Insert a session into the expiry wheel. The wheel has three levels of slots. Level 0 holds sessions due within
+ *  EJS_WHEEL_SLOTS ticks, level 1 and level 2 hold progressively coarser ranges which are cascaded down as the wheel
+ *  turns. Sessions due beyond the wheel range are parked in the furthest slot and rescheduled when it comes due.
+ *  First is the earliest tick the session may be placed at.
+ */
+static void scheduleSession(EjsWebSessionStore *store, EjsWebSessionShard *shard, EjsWebSession *sp, int64 first)
+{
+    EjsWebSession   **slot;
+    int64           when, delta;
+
+    when = (sp->expire - store->start + EJS_TIMER_PERIOD - 1) / EJS_TIMER_PERIOD;
+    if (when < first) {
+        when = first;
+    }
+    delta = when - shard->tick;
+    if (delta >= (1 << (EJS_WHEEL_BITS * EJS_WHEEL_LEVELS))) {
+        when = shard->tick + (1 << (EJS_WHEEL_BITS * EJS_WHEEL_LEVELS)) - 1;
+        delta = when - shard->tick;
+    }
+    if (delta < (1 << EJS_WHEEL_BITS)) {
+        slot = &shard->wheel[0][when & EJS_WHEEL_MASK];
+    } else if (delta < (1 << (EJS_WHEEL_BITS * 2))) {
+        slot = &shard->wheel[1][(when >> EJS_WHEEL_BITS) & EJS_WHEEL_MASK];
+    } else {
+        slot = &shard->wheel[2][(when >> (EJS_WHEEL_BITS * 2)) & EJS_WHEEL_MASK];
+    }
+    sp->nextExpire = *slot;
+    *slot = sp;
+}
+
+
+/*
+ *  Redistribute the sessions of a coarse wheel slot into finer slots
+ */
+static void cascadeWheel(EjsWebSessionStore *store, EjsWebSessionShard *shard, int level, int index)
+{
+    EjsWebSession   *sp, *next;
+
+    sp = shard->wheel[level][index];
+    shard->wheel[level][index] = 0;
+    for (; sp; sp = next) {
+        next = sp->nextExpire;
+        scheduleSession(store, shard, sp, shard->tick);
+    }
+}
+
+
+/*
+ *  Release an expired or destroyed session. The session and its values were made permanent when stored in the master
+ *  interpreter. Make them transient so the next collection will reclaim them. Must be called with the web lock held,
+ *  the same lock that guards reading and writing session values.
+ */
+static void releaseSession(Ejs *master, EjsWebSession *sp)
+{
+    EjsVar      *vp;
+    int         i;
+
+    for (i = 0; i < sp->obj.numProp; i++) {
+        vp = master->objectHelpers->getProperty(master, (EjsVar*) sp, i);
+        if (vp) {
+            ejsMakeTransient(master, vp);
+        }
+    }
+    ejsMakeTransient(master, (EjsVar*) sp);
+}
+
+
+/*
+ *  Advance a shard's expiry wheel up to the given tick. Return the count of sessions expired. Sessions still attached
+ *  to a request are rescheduled rather than released. Must be called with the web lock and the shard locked.
+ */
+static int advanceWheel(EjsWebSessionStore *store, EjsWebSessionShard *shard, int64 tick, MprTime now)
 {
     Ejs             *master;
-    EjsObject       *sessions;
-    EjsWebSession   *session;
-    MprTime         now;
-    int             i, count, deleted;
+    EjsWebSession   *sp, *next;
+    int             index, expired;
 
-    sessions = control->sessions;
+    master = store->control->master;
+    expired = 0;
+
+    while (shard->tick < tick) {
+        shard->tick++;
+        index = (int) (shard->tick & EJS_WHEEL_MASK);
+        if (index == 0) {
+            if (((shard->tick >> EJS_WHEEL_BITS) & EJS_WHEEL_MASK) == 0) {
+                cascadeWheel(store, shard, 2, (int) ((shard->tick >> (EJS_WHEEL_BITS * 2)) & EJS_WHEEL_MASK));
+            }
+            cascadeWheel(store, shard, 1, (int) ((shard->tick >> EJS_WHEEL_BITS) & EJS_WHEEL_MASK));
+        }
+        sp = shard->wheel[0][index];
+        shard->wheel[0][index] = 0;
+        for (; sp; sp = next) {
+            next = sp->nextExpire;
+            if (sp->expire <= now && sp->users == 0) {
+                /*
+                 *  Destroyed sessions have already been removed from the hash
+                 */
+                if (mprLookupHash(shard->table, sp->id) == sp) {
+                    mprRemoveHash(shard->table, sp->id);
+                }
+                releaseSession(master, sp);
+                expired++;
+            } else {
+                scheduleSession(store, shard, sp, shard->tick + 1);
+            }
+        }
+    }
+    return expired;
+}
+
+
+/*
+ *  Check for expired sessions. Each shard's wheel is advanced under its own lock and only visits sessions whose slot
+ *  has come due. The web lock is held throughout so sessions are released and collected under the same lock that 
+ *  guards their values and use counts.
+ */
+static void sessionTimer(EjsWebControl *control, MprEvent *event)
+{
+    Ejs                 *master;
+    EjsWebSessionStore  *store;
+    EjsWebSessionShard  *shard;
+    MprTime             now;
+    int64               tick;
+    int                 i, expired;
+
+    store = control->sessions;
     master = control->master;
-    if (master == 0) {
+    if (master == 0 || store == 0) {
         mprAssert(master);
         return;
     }
 
-    now = mprGetTime(control);
+    now = getSessionTime(store);
+    tick = (now - store->start) / EJS_TIMER_PERIOD;
 
-    //  TODO - locking MULTITHREAD
- 
-    count = ejsGetPropertyCount(master, (EjsVar*) sessions);
-    deleted = 0;
-    for (i = 0; i < count; i++) {
-        session = (EjsWebSession*) ejsGetProperty(master, (EjsVar*) sessions, i);
-        if (session && session->expire <= now) {
-            ejsDeleteProperty(master, (EjsVar*) sessions, i);
-            deleted++;
-            i--;
-            count--;
+    expired = 0;
+    ejsLockWeb(control);
+    for (i = 0; i < EJS_SESSION_SHARDS; i++) {
+        shard = &store->shards[i];
+        lockShard(shard);
+        expired += advanceWheel(store, shard, tick, now);
+        unlockShard(shard);
+    }
+    if (expired) {
+        /*
+         *  The master collector is otherwise disabled as requests share the master. Session values are only created
+         *  and released under the web lock and requests hold only deserialized copies of them. Sessions attached to
+         *  a request are permanent until detached, so a generational collection is safe here.
+         */
+        master->gc.enabled = 1;
+        ejsCollectGarbage(master, EJS_GC_SMART);
+        master->gc.enabled = 0;
+    }
+    ejsUnlockWeb(control);
+}
+
+
+/*
+ *  Session records exchanged with a session backend have the form:
+ *
+ *      'S' version timeout count { nameLength name valueLength value }...
+ *
+ *  Numbers and lengths are unsigned varints. Values are held in their binary serialized form.
+ */
+static void putRecordNum(MprBuf *buf, int num)
+{
+    mprAssert(num >= 0);
+
+    while (num >= 0x80) {
+        mprPutCharToBuf(buf, (num & 0x7f) | 0x80);
+        num >>= 7;
+    }
+    mprPutCharToBuf(buf, num);
+}
+
+
+static int getRecordNum(cchar **pp, cchar *end)
+{
+    cchar   *cp;
+    int     c, num, shift;
+
+    for (num = 0, shift = 0, cp = *pp; cp < end && shift < 32; shift += 7) {
+        c = (uchar) *cp++;
+        num |= (c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            *pp = cp;
+            return num;
+        }
+    }
+    return -1;
+}
+
+
+/*
+ *  Encode a session record. Must be called with the web lock held.
+ */
+static void encodeSession(Ejs *master, EjsWebSession *sp, MprBuf *buf)
+{
+    EjsName         qname;
+    EjsByteArray    *vp;
+    int             i, count, len;
+
+    for (count = i = 0; i < sp->obj.numProp; i++) {
+        vp = (EjsByteArray*) master->objectHelpers->getProperty(master, (EjsVar*) sp, i);
+        qname = master->objectHelpers->getPropertyName(master, (EjsVar*) sp, i);
+        if (vp && ejsIsByteArray(vp) && qname.name) {
+            count++;
         }
     }
-    if (deleted) {
-        ejsCollectGarbage(master, EJS_GC_ALL);
+    mprPutCharToBuf(buf, EJS_SESSION_RECORD);
+    mprPutCharToBuf(buf, EJS_SESSION_RECORD_VERSION);
+    putRecordNum(buf, sp->timeout);
+    putRecordNum(buf, count);
+
+    for (i = 0; i < sp->obj.numProp; i++) {
+        vp = (EjsByteArray*) master->objectHelpers->getProperty(master, (EjsVar*) sp, i);
+        qname = master->objectHelpers->getPropertyName(master, (EjsVar*) sp, i);
+        if (vp && ejsIsByteArray(vp) && qname.name) {
+            len = (int) strlen(qname.name);
+            putRecordNum(buf, len);
+            mprPutBlockToBuf(buf, qname.name, len);
+            putRecordNum(buf, vp->writePosition);
+            mprPutBlockToBuf(buf, (char*) vp->value, vp->writePosition);
+        }
     }
 }
 
 
-void ejsParseWebSessionCookie(EjsWeb *web)
+/*
+ *  Replace the session properties with those from a record. Must be called with the web lock held.
+ */
+static int decodeSession(Ejs *master, EjsWebSession *sp, cchar *data, int size)
 {
     EjsName         qname;
-    EjsWebControl   *control;
-    char            *id, *cp, *value;
-    int             quoted, len;
+    EjsByteArray    *ap;
+    EjsVar          *vp;
+    cchar           *cp, *end;
+    char            *name, *str;
+    int             i, count, timeout, nameLen, valueLen, slotNum;
 
-    if ((value = strstr(web->cookie, EJS_SESSION)) == 0) {
+    cp = data;
+    end = &data[size];
+    if (size < 2 || cp[0] != EJS_SESSION_RECORD || cp[1] != EJS_SESSION_RECORD_VERSION) {
+        return MPR_ERR_BAD_FORMAT;
+    }
+    cp += 2;
+    if ((timeout = getRecordNum(&cp, end)) < 0 || (count = getRecordNum(&cp, end)) < 0) {
+        return MPR_ERR_BAD_FORMAT;
+    }
+    if (timeout > 0) {
+        sp->timeout = timeout;
+    }
+
+    /*
+     *  Properties removed by another process read as empty, like properties that were never set
+     */
+    for (i = 0; i < sp->obj.numProp; i++) {
+        vp = master->objectHelpers->getProperty(master, (EjsVar*) sp, i);
+        if (vp && vp != master->undefinedValue) {
+            ejsMakeTransient(master, vp);
+            master->objectHelpers->setProperty(master, (EjsVar*) sp, i, master->undefinedValue);
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if ((nameLen = getRecordNum(&cp, end)) < 0 || nameLen > (end - cp)) {
+            return MPR_ERR_BAD_FORMAT;
+        }
+        name = (char*) cp;
+        cp += nameLen;
+        if ((valueLen = getRecordNum(&cp, end)) < 0 || valueLen > (end - cp)) {
+            return MPR_ERR_BAD_FORMAT;
+        }
+        if ((ap = ejsCreateByteArray(master, valueLen)) == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        memcpy(ap->value, cp, valueLen);
+        ejsSetByteArrayPositions(master, ap, 0, valueLen);
+        cp += valueLen;
+        vp = (EjsVar*) ap;
+        ejsMakePermanent(master, vp);
+
+        /*
+         *  The name is not terminated in the record. Copy exactly nameLen bytes and terminate the copy.
+         */
+        if ((str = mprAlloc(sp, nameLen + 1)) == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        memcpy(str, name, nameLen);
+        str[nameLen] = '\0';
+        ejsName(&qname, EJS_PUBLIC_NAMESPACE, str);
+        slotNum = master->objectHelpers->lookupProperty(master, (EjsVar*) sp, &qname);
+        if (slotNum < 0) {
+            slotNum = master->objectHelpers->setProperty(master, (EjsVar*) sp, -1, vp);
+            if (slotNum >= 0) {
+                master->objectHelpers->setPropertyName(master, (EjsVar*) sp, slotNum, &qname);
+            }
+        } else {
+            mprFree((char*) qname.name);
+            master->objectHelpers->setProperty(master, (EjsVar*) sp, slotNum, vp);
+        }
+    }
+    return 0;
+}
+
+
+/*
+ *  Bring a session up to date with the session backend which holds the authoritative copy when worker processes share
+ *  sessions. Returns the local session or null if the session no longer exists.
+ */
+static EjsWebSession *syncSession(EjsWeb *web, cchar *id, EjsWebSession *sp)
+{
+    EjsWebControl           *control;
+    EjsWebSessionBackend    *backend;
+    MprBuf                  *buf;
+    int                     version;
+
+    control = web->control;
+    backend = control->sessionBackend;
+
+    buf = mprCreateBuf(web, MPR_BUFSIZE, -1);
+    if (buf == 0) {
+        return sp;
+    }
+    version = backend->get(backend, id, sp ? sp->version : 0, buf);
+    if (version <= 0) {
+        if (sp) {
+            removeSession(control->sessions, sp);
+            ejsDetachWebSession(web);
+        }
+        mprFree(buf);
+        return 0;
+    }
+    if (sp == 0 || sp->version != version) {
+        ejsLockWeb(control);
+        if (sp == 0 && (sp = allocSession(web->ejs, control, id, control->sessionTimeout)) != 0) {
+            addSession(control->sessions, sp);
+        }
+        if (sp) {
+            if (decodeSession(control->master, sp, mprGetBufStart(buf), mprGetBufLength(buf)) < 0) {
+                mprError(web, "Corrupt session record for %s", id);
+            }
+            sp->version = version;
+            sessionActivity(control, sp);
+        }
+        attachSession(web, sp);
+        ejsUnlockWeb(control);
+    }
+    mprFree(buf);
+    return sp;
+}
+
+
+/*
+ *  Publish the current session to the session backend if it was modified by this request
+ */
+void ejsSaveWebSession(EjsWeb *web)
+{
+    EjsWebControl           *control;
+    EjsWebSessionBackend    *backend;
+    EjsWebSession           *sp;
+    MprBuf                  *buf;
+    int                     version;
+
+    control = web->control;
+    backend = control->sessionBackend;
+    sp = web->session;
+    if (backend == 0 || sp == 0 || !sp->dirty) {
         return;
     }
+    buf = mprCreateBuf(web, MPR_BUFSIZE, -1);
+    if (buf == 0) {
+        return;
+    }
+    ejsLockWeb(control);
+    encodeSession(control->master, sp, buf);
+    sp->dirty = 0;
+    ejsUnlockWeb(control);
+
+    version = backend->put(backend, sp->id, mprGetBufStart(buf), mprGetBufLength(buf), sp->timeout);
+    if (version > 0) {
+        sp->version = version;
+    }
+    mprFree(buf);
+}
+
+
+/*
+ *  Extract the session ID from a cookie header. Returns an allocated string or null if there is no session cookie.
+ */
+char *ejsGetWebSessionId(MprCtx ctx, cchar *cookie)
+{
+    cchar       *cp, *value;
+    char        *id;
+    int         quoted, len;
+
+    if (cookie == 0 || (value = strstr(cookie, EJS_SESSION)) == 0) {
+        return 0;
+    }
     value += strlen(EJS_SESSION);
 
-    while (isspace(*value) || *value == '=') {
+    while (isspace((int) *value) || *value == '=') {
         value++;
     }
     quoted = 0;
@@ -244,15 +731,42 @@ void ejsParseWebSessionCookie(EjsWeb *web)
             }
         }
     }
-    control = web->control;
-
-    len = cp - value;
-    id = mprMemdup(web, value, len + 1);
+    len = (int) (cp - value);
+    id = mprMemdup(ctx, value, len + 1);
     id[len] = '\0';
+    return id;
+}
 
-    if (control->master) {
-        ejsName(&qname, "", id);
-        web->session = (EjsWebSession*) ejsGetPropertyByName(control->master, (EjsVar*) control->sessions, &qname);
+
+void ejsParseWebSessionCookie(EjsWeb *web)
+{
+    EjsWebControl       *control;
+    EjsWebSessionShard  *shard;
+    EjsWebSession       *sp;
+    char                *id;
+
+    if ((id = ejsGetWebSessionId(web, web->cookie)) == 0) {
+        return;
+    }
+    control = web->control;
+
+    if (control->sessions) {
+        shard = getShard(control->sessions, id);
+        ejsLockWeb(control);
+        lockShard(shard);
+        sp = (EjsWebSession*) mprLookupHash(shard->table, id);
+        if (sp) {
+            /*
+             *  Attach and refresh so the session timer won't expire the session while this request is using it
+             */
+            sessionActivity(control, sp);
+        }
+        attachSession(web, sp);
+        unlockShard(shard);
+        ejsUnlockWeb(control);
+        if (control->sessionBackend) {
+            syncSession(web, id, web->session);
+        }
     }
     mprFree(id);
 }
@@ -260,29 +774,55 @@ void ejsParseWebSessionCookie(EjsWeb *web)
 
 /*********************************** Factory **********************************/
 /*
- *  Create a new session object. This is created in the master interpreter and will persist past the life of the current
- *  request. This will allocate a new session ID. Timeout is in seconds.
+ *  Create the session store. Sessions are held in a hash sharded by session ID. Each shard has its own lock and expiry
+ *  wheel so lookups and expiry in one shard don't contend with requests using other shards.
  */
-EjsWebSession *ejsCreateSession(Ejs *ejs, int timeout, bool secure)
+EjsWebSessionStore *ejsCreateWebSessionStore(EjsWebControl *control)
 {
-    Ejs             *master;
-    EjsWeb          *web;
-    EjsWebControl   *control;
-    EjsWebSession   *session;
-    EjsType         *sessionType;
-    EjsName         qname;
-    char            idBuf[64], *id;
+    EjsWebSessionStore  *store;
+    EjsWebSessionShard  *shard;
+    int                 i;
 
-    master = ejs->master;
-    if (master == 0) {
+    store = mprAllocObjZeroed(control, EjsWebSessionStore);
+    if (store == 0) {
         return 0;
     }
-    web = ejsGetHandle(ejs);
-    control = web->control;
+    store->control = control;
+    store->start = mprGetTime(control);
+    store->speed = max(control->sessionSpeed, 1);
 
-    if (timeout <= 0) {
-        timeout = control->sessionTimeout;
+    for (i = 0; i < EJS_SESSION_SHARDS; i++) {
+        shard = &store->shards[i];
+        shard->table = mprCreateHash(store, EJS_SESSION_HASH);
+        if (shard->table == 0) {
+            mprFree(store);
+            return 0;
+        }
+#if BLD_FEATURE_MULTITHREAD
+        shard->mutex = mprCreateLock(store);
+        if (shard->mutex == 0) {
+            mprFree(store);
+            return 0;
+        }
+#endif
     }
+    return store;
+}
+
+
+/*
+ *  Allocate a session object in the master interpreter for the given ID. Must be called with the web lock held.
+ */
+static EjsWebSession *allocSession(Ejs *ejs, EjsWebControl *control, cchar *id, int timeout)
+{
+    Ejs                 *master;
+    EjsWebSession       *session;
+    EjsWebSessionStore  *store;
+    EjsType             *sessionType;
+    EjsName             qname;
+
+    master = control->master;
+    store = control->sessions;
 
 #if ES_ejs_web_Session
     sessionType = ejsGetType(ejs, ES_ejs_web_Session);
@@ -293,42 +833,116 @@ EjsWebSession *ejsCreateSession(Ejs *ejs, int timeout, bool secure)
         mprAssert(0);
         return 0;
     }
-
     session = (EjsWebSession*) ejsCreateObject(master, sessionType, 0);
     if (session == 0) {
         return 0;
     }
-
     session->timeout = timeout;
-    session->expire = mprGetTime(ejs) + timeout * MPR_TICKS_PER_SEC;
+    session->expire = getSessionTime(store) + timeout * MPR_TICKS_PER_SEC;
+    session->id = mprStrdup(session, id);
 
-    mprSprintf(idBuf, sizeof(idBuf), "%08x%08x%08x", PTOI(ejs) + PTOI(web) + PTOI(session->expire), 
-        (int) time(0), (int) control->nextSession++);
-    id = mprGetMD5Hash(session, (uchar*) idBuf, sizeof(idBuf), "x");
-    if (id == 0) {
-        mprFree(session);
+    /*
+     *  The session is only referenced from the store, so keep it from being collected until it expires
+     */
+    ejsMakePermanent(master, (EjsVar*) session);
+
+    if (store->timer == 0 /* TODO && !mprGetDebugMode(master) */) {
+        store->timer = mprCreateTimerEvent(master, (MprEventProc) sessionTimer, max(EJS_TIMER_PERIOD / store->speed, 1),
+            MPR_NORMAL_PRIORITY, control, MPR_EVENT_CONTINUOUS);
+    }
+    return session;
+}
+
+
+/*
+ *  Index a session and schedule its expiry
+ */
+static void addSession(EjsWebSessionStore *store, EjsWebSession *sp)
+{
+    EjsWebSessionShard  *shard;
+
+    shard = getShard(store, sp->id);
+    lockShard(shard);
+    mprAddHash(shard->table, sp->id, sp);
+    scheduleSession(store, shard, sp, shard->tick + 1);
+    unlockShard(shard);
+}
+
+
+/*
+ *  Remove a session from the index. The session stays in the expiry wheel and is released when its slot comes due, so
+ *  requests still using it can continue safely. Returns true if the session was indexed.
+ */
+static bool removeSession(EjsWebSessionStore *store, EjsWebSession *sp)
+{
+    EjsWebSessionShard  *shard;
+    bool                removed;
+
+    shard = getShard(store, sp->id);
+    lockShard(shard);
+    removed = 0;
+    if (mprLookupHash(shard->table, sp->id) == sp) {
+        mprRemoveHash(shard->table, sp->id);
+        removed = 1;
+    }
+    sp->expire = 0;
+    unlockShard(shard);
+    return removed;
+}
+
+
+/*
+ *  Create a new session object. This is created in the master interpreter and will persist past the life of the current
+ *  request. This will allocate a new session ID. Timeout is in seconds.
+ */
+EjsWebSession *ejsCreateSession(Ejs *ejs, int timeout, bool secure)
+{
+    EjsWeb              *web;
+    EjsWebControl       *control;
+    EjsWebSession       *session;
+    char                idBuf[64], *id;
+
+    if (ejs->master == 0) {
         return 0;
     }
-    session->id = mprStrdup(session, id);
+    web = ejsGetHandle(ejs);
+    control = web->control;
+    if (control->sessions == 0) {
+        return 0;
+    }
+
+    if (timeout <= 0) {
+        timeout = control->sessionTimeout;
+    }
 
     /*
-     *  Create a cookie that will only live while the browser is not exited. (Set timeout to zero).
+     *  We use an MD5 prefix of "x" so we can avoid the hash being interpreted as a numeric index.
      */
-    ejsSetCookie(ejs, EJS_SESSION, id, 0, "/", secure);
+    ejsLockWeb(control);
+    mprSprintf(idBuf, sizeof(idBuf), "%08x%08x%08x", PTOI(ejs) + PTOI(web) + PTOI(mprGetTime(ejs)), 
+        (int) time(0), (int) control->nextSession++);
+    id = mprGetMD5Hash(web, (uchar*) idBuf, sizeof(idBuf), "x");
+    session = (id) ? allocSession(ejs, control, id, timeout) : 0;
+    if (session == 0) {
+        ejsUnlockWeb(control);
+        mprFree(id);
+        return 0;
+    }
+    mprFree(id);
 
     /*
-     *  We use an MD5 prefix of "x" above so we can avoid the hash being interpreted as a numeric index.
+     *  New sessions are published to the session backend when the request completes
      */
-    ejsName(&qname, "", session->id);
-    ejsSetPropertyByName(control->master, (EjsVar*) control->sessions, &qname, (EjsVar*) session);
-    web->session = session;
+    session->dirty = 1;
+    addSession(control->sessions, session);
+    attachSession(web, session);
+    ejsUnlockWeb(control);
 
-    mprLog(ejs, 3, "Created new session %s", id);
-
-    if (control->sessions->numProp == 1 /* TODO && !mprGetDebugMode(master) */) {
-        mprCreateTimerEvent(master, (MprEventProc) sessionTimer, EJS_TIMER_PERIOD, MPR_NORMAL_PRIORITY, control, 
-            MPR_EVENT_CONTINUOUS);
-    }
+    /*
+     *  Create a cookie that will only live while the browser is not exited. (Set timeout to zero).
+     */
+    ejsSetCookie(ejs, EJS_SESSION, session->id, 0, "/", secure);
+    mprLog(ejs, 3, "Created new session %s", session->id);
 
     return session;
 }
@@ -336,22 +950,28 @@ EjsWebSession *ejsCreateSession(Ejs *ejs, int timeout, bool secure)
 
 bool ejsDestroySession(Ejs *ejs)
 {
-    EjsWeb          *web;
-    EjsWebControl   *control;
-    EjsName         qname;
-    int             rc;
+    EjsWeb              *web;
+    EjsWebControl       *control;
+    EjsWebSession       *session;
+    int                 rc;
 
     web = ejs->handle;
     control = web->control;
+    session = web->session;
 
-    if (web->session == 0) {
+    if (session == 0) {
         //  TODO - remove
         mprAssert(0);
         return 0;
     }
-
-    rc = ejsDeletePropertyByName(control->master, (EjsVar*) control->sessions, ejsName(&qname, "", web->session->id));
-    web->session = 0;
+    if (control->sessions == 0) {
+        return 0;
+    }
+    rc = removeSession(control->sessions, session);
+    if (control->sessionBackend) {
+        control->sessionBackend->remove(control->sessionBackend, session->id);
+    }
+    ejsDetachWebSession(web);
     return rc;
 }
 
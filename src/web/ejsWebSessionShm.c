@@ -0,0 +1,637 @@
+/**
+ *  ejsWebSessionShm.c - Shared memory session backend.
+ *
+ *  Session records are stored in a memory mapped file so that all worker processes on a host share sessions. The
+ *  file holds a fixed number of fixed size slots indexed by a chained hash. Slots are kept on an LRU list and the
+ *  least recently used slot is evicted when the store is full. Expired slots are reclaimed as they are found.
+ *
+ *  Access is serialized across processes with a fcntl lock on the file and across threads with a mutex.
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "ejs.h"
+
+#if BLD_FEATURE_EJS_WEB && BLD_UNIX_LIKE
+/*********************************** Locals ***********************************/
+
+#define SHM_MAGIC       0x53534a45          /* "EJSS" */
+#define SHM_VERSION     1
+#define SHM_NONE        -1
+#define SHM_ID_MAX      48                  /* Max session ID length including the null */
+
+/*
+ *  File header. This is followed by the hash buckets and then the slots. All links are slot indexes so the file can
+ *  be mapped at any address.
+ */
+typedef struct ShmHeader {
+    int         magic;
+    int         version;
+    int         slotCount;
+    int         slotSize;                   /* Max record size */
+    int         freeList;                   /* Free slots chained via hashNext */
+    int         lruHead;                    /* Most recently used */
+    int         lruTail;                    /* Least recently used */
+    int         generation;                 /* Record version counter */
+} ShmHeader;
+
+typedef struct ShmSlot {
+    char        id[SHM_ID_MAX];
+    MprTime     expire;                     /* Absolute expiry time */
+    int         timeout;                    /* Inactivity timeout in seconds */
+    int         version;                    /* Record version. Changes on every put */
+    int         hashNext;
+    int         lruPrev;
+    int         lruNext;
+    int         len;                        /* Record length. Data follows the slot */
+} ShmSlot;
+
+typedef struct EjsShmSessions {
+    EjsWebSessionBackend    backend;        /* Must be first */
+    char                    *path;
+    char                    *base;          /* Mapped file */
+    int                     mapSize;
+    int                     fd;
+    int                     slotCount;      /* Geometry when mapped. The header copy is not trusted */
+    int                     slotSize;
+    int                     slotBase;       /* Offset of the first slot */
+    int                     stride;         /* Bytes per slot including data */
+    int                     *buckets;
+    ShmHeader               *header;
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex                *mutex;
+#endif
+} EjsShmSessions;
+
+/*
+ *  Test if a slot index read from the file is in range
+ */
+#define validSlot(shm, index) ((index) >= 0 && (index) < (shm)->slotCount)
+
+/***************************** Forward Declarations ***************************/
+
+static int  destroyShm(EjsShmSessions *shm);
+static int  getRecord(EjsWebSessionBackend *backend, cchar *id, int known, MprBuf *buf);
+static void initSlots(EjsShmSessions *shm);
+static int  putRecord(EjsWebSessionBackend *backend, cchar *id, cchar *data, int len, int timeout);
+static int  removeRecord(EjsWebSessionBackend *backend, cchar *id);
+
+/************************************* Code ***********************************/
+
+static void lockShm(EjsShmSessions *shm)
+{
+    struct flock    lock;
+
+#if BLD_FEATURE_MULTITHREAD
+    mprLock(shm->mutex);
+#endif
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    while (fcntl(shm->fd, F_SETLKW, &lock) < 0 && errno == EINTR) {
+        ;
+    }
+}
+
+
+static void unlockShm(EjsShmSessions *shm)
+{
+    struct flock    lock;
+
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_UNLCK;
+    lock.l_whence = SEEK_SET;
+    fcntl(shm->fd, F_SETLK, &lock);
+#if BLD_FEATURE_MULTITHREAD
+    mprUnlock(shm->mutex);
+#endif
+}
+
+
+/*
+ *  The file is writable by every worker so links read from it are not trusted. If a link is out of range or a chain
+ *  does not terminate, discard all sessions and reinitialize the store. Must be called with the store locked.
+ */
+static int resetStore(EjsShmSessions *shm)
+{
+    mprError(shm, "Session store %s is corrupt, discarding all sessions", shm->path);
+    initSlots(shm);
+    return MPR_ERR_BAD_STATE;
+}
+
+
+static ShmSlot *getSlot(EjsShmSessions *shm, int index)
+{
+    mprAssert(validSlot(shm, index));
+    return (ShmSlot*) &shm->base[shm->slotBase + index * shm->stride];
+}
+
+
+static char *getSlotData(ShmSlot *sp)
+{
+    return (char*) &sp[1];
+}
+
+
+static int hashId(EjsShmSessions *shm, cchar *id)
+{
+    uint    hash;
+    int     i;
+
+    for (hash = 0, i = 0; id[i] && i < SHM_ID_MAX; i++) {
+        hash = (hash * 33) + id[i];
+    }
+    return hash % shm->slotCount;
+}
+
+
+static int unlinkLru(EjsShmSessions *shm, int index, ShmSlot *sp)
+{
+    ShmHeader   *hp;
+
+    hp = shm->header;
+    if ((sp->lruPrev != SHM_NONE && !validSlot(shm, sp->lruPrev)) ||
+            (sp->lruNext != SHM_NONE && !validSlot(shm, sp->lruNext))) {
+        return resetStore(shm);
+    }
+    if (sp->lruPrev >= 0) {
+        getSlot(shm, sp->lruPrev)->lruNext = sp->lruNext;
+    } else {
+        hp->lruHead = sp->lruNext;
+    }
+    if (sp->lruNext >= 0) {
+        getSlot(shm, sp->lruNext)->lruPrev = sp->lruPrev;
+    } else {
+        hp->lruTail = sp->lruPrev;
+    }
+    sp->lruPrev = sp->lruNext = SHM_NONE;
+    return 0;
+}
+
+
+static int pushLru(EjsShmSessions *shm, int index, ShmSlot *sp)
+{
+    ShmHeader   *hp;
+
+    hp = shm->header;
+    if (hp->lruHead != SHM_NONE && !validSlot(shm, hp->lruHead)) {
+        return resetStore(shm);
+    }
+    sp->lruPrev = SHM_NONE;
+    sp->lruNext = hp->lruHead;
+    if (hp->lruHead >= 0) {
+        getSlot(shm, hp->lruHead)->lruPrev = index;
+    } else {
+        hp->lruTail = index;
+    }
+    hp->lruHead = index;
+    return 0;
+}
+
+
+/*
+ *  Move a slot to the head of the LRU list
+ */
+static int touchLru(EjsShmSessions *shm, int index, ShmSlot *sp)
+{
+    if (unlinkLru(shm, index, sp) < 0) {
+        return MPR_ERR_BAD_STATE;
+    }
+    return pushLru(shm, index, sp);
+}
+
+
+/*
+ *  Find a slot by ID. Returns the slot index or SHM_NONE. A chain can hold at most slotCount entries.
+ */
+static int findSlot(EjsShmSessions *shm, cchar *id)
+{
+    ShmSlot     *sp;
+    int         index, count;
+
+    if ((int) strlen(id) >= SHM_ID_MAX) {
+        return SHM_NONE;
+    }
+    for (count = 0, index = shm->buckets[hashId(shm, id)]; index != SHM_NONE; index = sp->hashNext) {
+        if (!validSlot(shm, index) || ++count > shm->slotCount) {
+            resetStore(shm);
+            return SHM_NONE;
+        }
+        sp = getSlot(shm, index);
+        if (strncmp(sp->id, id, SHM_ID_MAX) == 0) {
+            return index;
+        }
+    }
+    return SHM_NONE;
+}
+
+
+/*
+ *  Unlink a slot from its hash chain and the LRU list and return it to the free list
+ */
+static int freeSlot(EjsShmSessions *shm, int index)
+{
+    ShmSlot     *sp, *prev;
+    int         *link, i, count;
+
+    sp = getSlot(shm, index);
+    link = &shm->buckets[hashId(shm, sp->id)];
+    for (count = 0, prev = 0, i = *link; i != SHM_NONE && i != index; i = prev->hashNext) {
+        if (!validSlot(shm, i) || ++count > shm->slotCount) {
+            return resetStore(shm);
+        }
+        prev = getSlot(shm, i);
+    }
+    if (i == index) {
+        if (prev) {
+            prev->hashNext = sp->hashNext;
+        } else {
+            *link = sp->hashNext;
+        }
+    }
+    if (unlinkLru(shm, index, sp) < 0) {
+        return MPR_ERR_BAD_STATE;
+    }
+    sp->id[0] = '\0';
+    sp->len = 0;
+    sp->hashNext = shm->header->freeList;
+    shm->header->freeList = index;
+    return 0;
+}
+
+
+/*
+ *  Allocate a slot for a new ID. If the store is full, evict the least recently used slot.
+ */
+static int allocSlot(EjsShmSessions *shm, cchar *id)
+{
+    ShmHeader   *hp;
+    ShmSlot     *sp;
+    int         index, bucket;
+
+    hp = shm->header;
+    if (hp->freeList == SHM_NONE) {
+        if (!validSlot(shm, hp->lruTail)) {
+            /* With no free slots, every slot must be on the LRU list */
+            resetStore(shm);
+        } else {
+            sp = getSlot(shm, hp->lruTail);
+            if (sp->expire > mprGetTime(shm)) {
+                mprLog(shm, 1, "Session store %s is full, evicting live session %.*s", shm->path, SHM_ID_MAX, sp->id);
+            } else {
+                mprLog(shm, 5, "Session store full, evicting %.*s", SHM_ID_MAX, sp->id);
+            }
+            freeSlot(shm, hp->lruTail);
+        }
+    }
+    if (!validSlot(shm, hp->freeList)) {
+        resetStore(shm);
+    }
+    index = hp->freeList;
+    sp = getSlot(shm, index);
+    hp->freeList = sp->hashNext;
+
+    mprStrcpy(sp->id, sizeof(sp->id), id);
+    bucket = hashId(shm, id);
+    sp->hashNext = shm->buckets[bucket];
+    shm->buckets[bucket] = index;
+    if (pushLru(shm, index, sp) < 0) {
+        return SHM_NONE;
+    }
+    return index;
+}
+
+
+/*
+ *  Get a session record. Returns the record version or zero if the session does not exist or has expired. The record
+ *  is only copied into buf if its version differs from "known". Getting a record counts as activity.
+ */
+static int getRecord(EjsWebSessionBackend *backend, cchar *id, int known, MprBuf *buf)
+{
+    EjsShmSessions  *shm;
+    ShmSlot         *sp;
+    MprTime         now;
+    int             index, version;
+
+    shm = (EjsShmSessions*) backend;
+    now = mprGetTime(shm);
+    version = 0;
+
+    lockShm(shm);
+    if ((index = findSlot(shm, id)) >= 0) {
+        sp = getSlot(shm, index);
+        if (sp->len < 0 || sp->len > shm->slotSize) {
+            resetStore(shm);
+        } else if (sp->expire <= now) {
+            freeSlot(shm, index);
+        } else if (touchLru(shm, index, sp) == 0) {
+            sp->expire = now + sp->timeout * MPR_TICKS_PER_SEC;
+            version = sp->version;
+            if (version != known && buf) {
+                mprFlushBuf(buf);
+                if (mprPutBlockToBuf(buf, getSlotData(sp), sp->len) != sp->len) {
+                    version = MPR_ERR_NO_MEMORY;
+                }
+            }
+        }
+    }
+    unlockShm(shm);
+    return version;
+}
+
+
+/*
+ *  Store a session record. Returns the new record version.
+ */
+static int putRecord(EjsWebSessionBackend *backend, cchar *id, cchar *data, int len, int timeout)
+{
+    EjsShmSessions  *shm;
+    ShmHeader       *hp;
+    ShmSlot         *sp;
+    int             index, version;
+
+    shm = (EjsShmSessions*) backend;
+    hp = shm->header;
+
+    if (len > shm->slotSize) {
+        mprError(shm, "Session %s is too big for the session store (%d bytes)", id, len);
+        return MPR_ERR_WONT_FIT;
+    }
+    if ((int) strlen(id) >= SHM_ID_MAX) {
+        return MPR_ERR_BAD_ARGS;
+    }
+
+    lockShm(shm);
+    if ((index = findSlot(shm, id)) >= 0) {
+        if (touchLru(shm, index, getSlot(shm, index)) < 0) {
+            index = SHM_NONE;
+        }
+    }
+    if (index < 0 && (index = allocSlot(shm, id)) < 0) {
+        unlockShm(shm);
+        return MPR_ERR_NO_MEMORY;
+    }
+    sp = getSlot(shm, index);
+    memcpy(getSlotData(sp), data, len);
+    sp->len = len;
+    sp->timeout = timeout;
+    sp->expire = mprGetTime(shm) + timeout * MPR_TICKS_PER_SEC;
+    if (++hp->generation <= 0) {
+        hp->generation = 1;
+    }
+    version = sp->version = hp->generation;
+    unlockShm(shm);
+    return version;
+}
+
+
+static int removeRecord(EjsWebSessionBackend *backend, cchar *id)
+{
+    EjsShmSessions  *shm;
+    int             index;
+
+    shm = (EjsShmSessions*) backend;
+
+    lockShm(shm);
+    if ((index = findSlot(shm, id)) >= 0) {
+        freeSlot(shm, index);
+    }
+    unlockShm(shm);
+    return (index >= 0) ? 0 : MPR_ERR_NOT_FOUND;
+}
+
+
+/*
+ *  Compute the file layout for the given geometry. The layout is computed in 64 bits and rejected if it does not fit
+ *  the mapping size.
+ */
+static int setGeometry(EjsShmSessions *shm, int slots, int slotSize)
+{
+    int64   slotBase, stride, mapSize;
+
+    if (slots <= 0 || slotSize <= 0) {
+        return MPR_ERR_BAD_ARGS;
+    }
+    slotBase = MPR_ALLOC_ALIGN((int64) sizeof(ShmHeader) + (int64) slots * sizeof(int));
+    stride = MPR_ALLOC_ALIGN((int64) sizeof(ShmSlot) + slotSize);
+    mapSize = slotBase + (int64) slots * stride;
+    if (stride > MAXINT || mapSize > MAXINT) {
+        return MPR_ERR_WONT_FIT;
+    }
+    shm->slotCount = slots;
+    shm->slotSize = slotSize;
+    shm->slotBase = (int) slotBase;
+    shm->stride = (int) stride;
+    shm->mapSize = (int) mapSize;
+    return 0;
+}
+
+
+/*
+ *  Empty the hash buckets and put every slot on the free list. Must be called with the store locked.
+ */
+static void initSlots(EjsShmSessions *shm)
+{
+    ShmHeader   *hp;
+    ShmSlot     *sp;
+    int         i;
+
+    hp = shm->header;
+    hp->slotCount = shm->slotCount;
+    hp->slotSize = shm->slotSize;
+    hp->lruHead = hp->lruTail = SHM_NONE;
+    hp->generation = 0;
+    for (i = 0; i < shm->slotCount; i++) {
+        shm->buckets[i] = SHM_NONE;
+        sp = getSlot(shm, i);
+        sp->id[0] = '\0';
+        sp->len = 0;
+        sp->lruPrev = sp->lruNext = SHM_NONE;
+        sp->hashNext = (i + 1 < shm->slotCount) ? i + 1 : SHM_NONE;
+    }
+    hp->freeList = 0;
+    hp->version = SHM_VERSION;
+    hp->magic = SHM_MAGIC;
+}
+
+
+/*
+ *  Initialize a new store file. Must be called with the store locked.
+ */
+static int initStore(EjsShmSessions *shm)
+{
+    if (ftruncate(shm->fd, shm->mapSize) < 0) {
+        return MPR_ERR_CANT_WRITE;
+    }
+    shm->base = mmap(0, shm->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    if (shm->base == MAP_FAILED) {
+        shm->base = 0;
+        return MPR_ERR_CANT_INITIALIZE;
+    }
+    shm->header = (ShmHeader*) shm->base;
+    shm->buckets = (int*) &shm->header[1];
+    initSlots(shm);
+    return 0;
+}
+
+
+/*
+ *  Map an existing store file. A file that is not a store of the configured geometry was left by another
+ *  configuration or is damaged, so it is reinitialized. Must be called with the store locked.
+ */
+static int mapStore(EjsShmSessions *shm, int64 fileSize)
+{
+    ShmHeader   header;
+    int         i;
+
+    if (read(shm->fd, &header, sizeof(header)) != sizeof(header) || header.magic != SHM_MAGIC ||
+            header.version != SHM_VERSION || header.slotCount != shm->slotCount || header.slotSize != shm->slotSize ||
+            fileSize != shm->mapSize) {
+        mprError(shm, "Session store %s has a different format or geometry, discarding all sessions", shm->path);
+        return initStore(shm);
+    }
+    shm->base = mmap(0, shm->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    if (shm->base == MAP_FAILED) {
+        shm->base = 0;
+        return MPR_ERR_CANT_INITIALIZE;
+    }
+    shm->header = (ShmHeader*) shm->base;
+    shm->buckets = (int*) &shm->header[1];
+
+    /*
+     *  Check the list heads. Links within the lists are checked as they are followed.
+     */
+    if ((header.freeList != SHM_NONE && !validSlot(shm, header.freeList)) ||
+            (header.lruHead != SHM_NONE && !validSlot(shm, header.lruHead)) ||
+            (header.lruTail != SHM_NONE && !validSlot(shm, header.lruTail))) {
+        resetStore(shm);
+        return 0;
+    }
+    for (i = 0; i < shm->slotCount; i++) {
+        if (shm->buckets[i] != SHM_NONE && !validSlot(shm, shm->buckets[i])) {
+            resetStore(shm);
+            break;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ *  Open (or create) a shared memory session store. Processes sharing a store must use the same geometry.
+ */
+EjsWebSessionBackend *ejsCreateSharedSessionBackend(MprCtx ctx, cchar *path, int slots, int slotSize)
+{
+    EjsShmSessions  *shm;
+    struct stat     info;
+    int             rc;
+
+    if (slots <= 0) {
+        slots = EJS_SESSION_SHM_SLOTS;
+    }
+    if (slotSize <= 0) {
+        slotSize = EJS_SESSION_SHM_SIZE;
+    }
+    shm = mprAllocObjWithDestructorZeroed(ctx, EjsShmSessions, destroyShm);
+    if (shm == 0) {
+        return 0;
+    }
+    shm->fd = -1;
+    shm->path = mprStrdup(shm, path);
+    shm->backend.get = getRecord;
+    shm->backend.put = putRecord;
+    shm->backend.remove = removeRecord;
+
+#if BLD_FEATURE_MULTITHREAD
+    if ((shm->mutex = mprCreateLock(shm)) == 0) {
+        mprFree(shm);
+        return 0;
+    }
+#endif
+    if ((shm->fd = open(path, O_RDWR | O_CREAT, 0600)) < 0) {
+        mprError(ctx, "Can't open session store %s", path);
+        mprFree(shm);
+        return 0;
+    }
+    fcntl(shm->fd, F_SETFD, FD_CLOEXEC);
+
+    lockShm(shm);
+    if (fstat(shm->fd, &info) < 0) {
+        rc = MPR_ERR_CANT_ACCESS;
+    } else if ((rc = setGeometry(shm, slots, slotSize)) == 0) {
+        if (info.st_size == 0) {
+            rc = initStore(shm);
+        } else {
+            rc = mapStore(shm, (int64) info.st_size);
+        }
+    }
+    unlockShm(shm);
+
+    if (rc < 0) {
+        mprError(ctx, "Can't initialize session store %s, error %d", path, rc);
+        mprFree(shm);
+        return 0;
+    }
+    mprLog(ctx, 3, "Session store %s: %d slots of %d bytes", path, shm->slotCount, shm->slotSize);
+    return (EjsWebSessionBackend*) shm;
+}
+
+
+static int destroyShm(EjsShmSessions *shm)
+{
+    if (shm->base) {
+        munmap(shm->base, shm->mapSize);
+        shm->base = 0;
+    }
+    if (shm->fd >= 0) {
+        close(shm->fd);
+        shm->fd = -1;
+    }
+    return 0;
+}
+
+
+#else /* BLD_FEATURE_EJS_WEB && BLD_UNIX_LIKE */
+
+#if BLD_FEATURE_EJS_WEB
+EjsWebSessionBackend *ejsCreateSharedSessionBackend(MprCtx ctx, cchar *path, int slots, int slotSize)
+{
+    mprError(ctx, "Shared session store is not supported on this platform");
+    return 0;
+}
+#endif
+
+void __ejsWebSessionShmDummy() {}
+#endif /* BLD_FEATURE_EJS_WEB && BLD_UNIX_LIKE */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
@@ -0,0 +1,87 @@
+/**
+ *  ejsWebView.c - Native code for the View class
+ *
+ *  Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "ejs.h"
+
+#if BLD_FEATURE_EJS_WEB
+
+/*********************************** Methods **********************************/
+/*
+ *  Write a template segment to the client. Compiled views call this for each literal HTML segment and expression 
+ *  result, so the string is written straight to the response.
+ *
+ *  function writeSegment(text: String): Void
+ */
+static EjsVar *writeSegment(Ejs *ejs, EjsVar *unused, int argc, EjsVar **argv)
+{
+    EjsString   *s;
+
+    mprAssert(argc == 1);
+
+    if ((s = (EjsString*) argv[0]) == 0 || !ejsIsString(s)) {
+        if ((s = (EjsString*) ejsToString(ejs, argv[0])) == 0) {
+            return 0;
+        }
+    }
+    if (s->length > 0 && ejsWriteBlock(ejs, s->value, s->length) != s->length) {
+        ejsThrowIOError(ejs, "Can't write to browser");
+    }
+    return 0;
+}
+
+/*********************************** Factory **********************************/
+/*
+ *  The view type is a scripted class augmented by native methods.
+ */
+void ejsConfigureWebViewType(Ejs *ejs)
+{
+    EjsType     *type;
+    EjsName     qname;
+
+    type = (EjsType*) ejsGetPropertyByName(ejs, ejs->global, ejsName(&qname, "ejs.web", "View"));
+    if (type == 0) {
+        if (!(ejs->flags & EJS_FLAG_EMPTY)) {
+            mprError(ejs, "Can't find ejs.web View class");
+            ejs->hasError = 1;
+        }
+        return;
+    }
+    ejsBindMethod(ejs, type, ES_ejs_web_View_ejs_web_writeSegment, (EjsNativeFunction) writeSegment);
+}
+
+#endif /* BLD_FEATURE_EJS_WEB */
+
+/*
+ *  @copy   default
+ *
+ *  Copyright (c) Embedthis Software LLC, 2003-2009. All Rights Reserved.
+ *  Copyright (c) Michael O'Brien, 1993-2009. All Rights Reserved.
+ *
+ *  This software is distributed under commercial and open source licenses.
+ *  You may use the GPL open source license described below or you may acquire
+ *  a commercial license from Embedthis Software. You agree to be fully bound
+ *  by the terms of either license. Consult the LICENSE.TXT distributed with
+ *  this software for full details.
+ *
+ *  This software is open source; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2 of the License, or (at your
+ *  option) any later version. See the GNU General Public License for more
+ *  details at: http://www.embedthis.com/downloads/gplLicense.html
+ *
+ *  This program is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  This GPL license does NOT permit incorporating this software into
+ *  proprietary programs. If you are unable to comply with the GPL, you must
+ *  acquire a commercial license to use this software. Commercial licenses
+ *  for this software and support services are available from Embedthis
+ *  Software at http://www.embedthis.com
+ *
+ *  @end
+ */
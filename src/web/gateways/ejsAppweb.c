@@ -21,6 +21,8 @@ static void ejsWebUnlock(void *lockData);
 /***************************** Forward Declarations *****************************/
 
 static void error(void *handle, int code, cchar *fmt, ...);
+static char *getCacheUri(MaConn *conn);
+static int  flushOutput(void *handle);
 static int  parseUrl(MaConn *conn);
 static void redirect(void *handle, int code, cchar *url);
 static void setCookie(void *handle, cchar *name, cchar *value, int lifetime, cchar *path, bool secure);
@@ -33,11 +35,13 @@ static int  writeBlock(void *handle, cchar *buf, int size);
  */
 static bool matchEjs(MaConn *conn, MaStage *handler, cchar *url)
 {
-    MaRequest   *req;
-    MaLocation  *loc;
-    EjsWeb      *web;
-    cchar       *ext;
-    char        urlbuf[MPR_MAX_FNAME];
+    MaRequest       *req;
+    MaLocation      *loc;
+    EjsWeb          *web;
+    EjsWebControl   *control;
+    EjsWebCached    *cached;
+    cchar           *ext;
+    char            *uri, urlbuf[MPR_MAX_FNAME];
 
     loc = conn->request->location;
 
@@ -59,6 +63,27 @@ static bool matchEjs(MaConn *conn, MaStage *handler, cchar *url)
         return 1;
     }
 
+    /*
+     *  Serve cached action responses without creating an interpreter
+     */
+    if ((req->method & (MA_REQ_GET | MA_REQ_HEAD)) && (uri = getCacheUri(conn)) != 0) {
+        control = handler->stageData;
+        if ((cached = ejsLookupWebCache(req, control, conn, uri)) != 0) {
+            if ((web = mprAllocObjZeroed(req, EjsWeb)) == 0) {
+                maFailRequest(conn, MPR_HTTP_CODE_INTERNAL_SERVER_ERROR, "Can't create Ejs web object for %s",
+                    req->url);
+                return 1;
+            }
+            web->control = control;
+            web->handle = conn;
+            web->url = req->url;
+            web->cached = cached;
+            conn->response->handlerData = web;
+            return 1;
+        }
+        mprFree(uri);
+    }
+
     if (parseUrl(conn) < 0) {
         return 1;
     }
@@ -159,19 +184,42 @@ static int parseUrl(MaConn *conn)
     }
     resp->handlerData = web;
 
+    if (req->method & MA_REQ_GET) {
+        web->cacheUri = getCacheUri(conn);
+    }
     return 0;
 }
 
 
+/*
+ *  Return the response cache key URI. This is the request URL including any query.
+ */
+static char *getCacheUri(MaConn *conn)
+{
+    MaRequest   *req;
+    char        *uri;
+
+    req = conn->request;
+    if (req->parsedUri && req->parsedUri->query && *req->parsedUri->query) {
+        mprAllocSprintf(req, &uri, -1, "%s?%s", req->url, req->parsedUri->query);
+    } else {
+        uri = mprStrdup(req, req->url);
+    }
+    return uri;
+}
+
+
 /*
  *  Run the Ejscript request. The routine runs when all input data has been received.
  */
 static void runEjs(MaQueue *q)
 {
-    MaConn      *conn;
-    MaRequest   *req;
-    EjsWeb      *web;
-    char        msg[MPR_MAX_STRING];
+    MaConn          *conn;
+    MaRequest       *req;
+    EjsWeb          *web;
+    EjsWebCached    *cached;
+    MprHash         *hp;
+    char            msg[MPR_MAX_STRING];
 
     conn = q->conn;
     req = conn->request;
@@ -182,6 +230,19 @@ static void runEjs(MaQueue *q)
 
     maPutForService(q, maCreateHeaderPacket(conn), 0);
 
+    if ((cached = web->cached) != 0) {
+        maSetResponseCode(conn, cached->code);
+        if (cached->mimeType) {
+            maSetResponseMimeType(conn, cached->mimeType);
+        }
+        for (hp = mprGetFirstHash(cached->headers); hp; hp = mprGetNextHash(cached->headers, hp)) {
+            maSetHeader(conn, 0, hp->key, "%s", hp->data);
+        }
+        maWriteBlock(q, mprGetBufStart(cached->body), mprGetBufLength(cached->body), 1);
+        maPutForService(q, maCreateEndPacket(conn), 1);
+        return;
+    }
+
     if (ejsRunWebRequest(web) < 0) {
         //  TODO - refactor. Want request failed to have an option which says send this output to the client also.
         if (web->flags & EJS_WEB_FLAG_BROWSER_ERRORS) {
@@ -521,20 +582,65 @@ static void setMimeType(void *handle, cchar *mimeType)
 }
 
 
+/*
+ *  Flush output to the client. The pending packet is closed and the service queue is scheduled so the packets go
+ *  downstream under the normal queue flow control. Packets the network can't take yet stay queued and are sent as the
+ *  socket drains. The socket is not put into blocking mode.
+ */
+static int flushOutput(void *handle)
+{
+    MaConn      *conn;
+    MaQueue     *q;
+
+    conn = (MaConn*) handle;
+    q = conn->response->queue[MA_QUEUE_SEND].nextQ;
+
+    q->pending = 0;
+    if (q->first && !(q->flags & MA_QUEUE_DISABLED)) {
+        maScheduleQueue(q);
+        maServiceQueues(conn);
+    }
+    return conn->abandonConnection ? MPR_ERR_CANT_WRITE : 0;
+}
+
+
 static int writeBlock(void *handle, cchar *buf, int size)
 {
     MaConn      *conn;
+    MaResponse  *resp;
     MaQueue     *q;
+    EjsWeb      *web;
+    int         written;
 
     conn = (MaConn*) handle;
+    resp = conn->response;
+    web = (EjsWeb*) resp->handlerData;
 
     /*
      *  We write to the service queue of the handler
      */
-    q = conn->response->queue[MA_QUEUE_SEND].nextQ;
+    q = resp->queue[MA_QUEUE_SEND].nextQ;
     mprAssert(q->stage->flags & MA_STAGE_HANDLER);
 
-    return maWriteBlock(q, buf, size, 1);
+    if (!(web->flags & EJS_WEB_FLAG_STREAM)) {
+        return maWriteBlock(q, buf, size, 1);
+    }
+
+    /*
+     *  Streamed output is written in fixed size packets which are flushed to the client as each one fills. The
+     *  chunk filter applies transfer chunk encoding as the total length is not known. maWriteBlock still drains the
+     *  queue if it reaches its limit.
+     */
+    if (resp->chunkSize < 0) {
+        resp->chunkSize = min(EJS_WEB_STREAM_SIZE, conn->http->limits.maxChunkSize);
+    }
+    if ((written = maWriteBlock(q, buf, size, 1)) < 0) {
+        return written;
+    }
+    if (q->pending && mprGetBufSpace(q->pending->content) == 0 && flushOutput(conn) < 0) {
+        return MPR_ERR_CANT_WRITE;
+    }
+    return written;
 }
 
 
@@ -544,6 +650,7 @@ static int parseEjs(MaHttp *http, cchar *key, char *value, MaConfigState *state)
     MaLocation      *location;
     MaServer        *server;
     MaHost          *host;
+    EjsWebControl   *control;
     char            *prefix, *path;
     int             flags;
     
@@ -625,6 +732,18 @@ static int parseEjs(MaHttp *http, cchar *key, char *value, MaConfigState *state)
         }
         return 1;
 
+    } else if (mprStrcmpAnyCase(key, "EjsSessionStore") == 0) {
+        if (value == 0 || http->ejsHandler == 0) {
+            return MPR_ERR_BAD_SYNTAX;
+        }
+        control = (EjsWebControl*) http->ejsHandler->stageData;
+        path = mprStrTrim(value, "\"");
+        control->sessionBackend = ejsCreateSharedSessionBackend(control, path, 0, 0);
+        if (control->sessionBackend == 0) {
+            return MPR_ERR_CANT_OPEN;
+        }
+        return 1;
+
     } else if (mprStrcmpAnyCase(key, "EjsSession") == 0) {
         if (mprStrcmpAnyCase(value, "on") == 0) {
             location->flags |= MA_LOC_AUTO_SESSION;
@@ -639,13 +758,16 @@ static int parseEjs(MaHttp *http, cchar *key, char *value, MaConfigState *state)
 #endif
 
 
-#if BLD_FEATURE_MULTITHREAD && TODO
+#if BLD_FEATURE_MULTITHREAD
+/*
+ *  Lock the master interpreter. Request interpreters are private to a request and run unlocked.
+ */
 static void ejsWebLock(void *lockData)
 {
     MprMutex    *mutex = (MprMutex*) lockData;
 
     mprAssert(mutex);
-    mutex->lock();
+    mprLock(mutex);
 }
 
 
@@ -654,8 +776,7 @@ static void ejsWebUnlock(void *lockData)
     MprMutex    *mutex = (MprMutex*) lockData;
 
     mprAssert(mutex);
-
-    mutex->unlock();
+    mprUnlock(mutex);
 }
 #endif /* BLD_FEATURE_MULTITHREAD */
 
@@ -668,6 +789,9 @@ MprModule *maEjsHandlerInit(MaHttp *http, cchar *path)
     MprModule       *module;
     MaStage         *handler;
     EjsWebControl   *control;
+#if BLD_FEATURE_MULTITHREAD
+    MprMutex        *mutex;
+#endif
 
     module = mprCreateModule(http, "ejsHandler", BLD_VERSION, 0, 0, 0);
     if (module == 0) {
@@ -693,6 +817,7 @@ MprModule *maEjsHandlerInit(MaHttp *http, cchar *path)
     control->defineParams = defineParams;
     control->discardOutput = discardOutput;
     control->error = error;
+    control->flush = flushOutput;
     control->getHeader = getHeader;
     control->getVar = getVar;
     control->redirect = redirect;
@@ -703,11 +828,14 @@ MprModule *maEjsHandlerInit(MaHttp *http, cchar *path)
     control->write = writeBlock;
     control->modulePath = mprStrdup(control, path);
 
-#if BLD_FEATURE_MULTITHREAD && FUTURE
+#if BLD_FEATURE_MULTITHREAD
     /*
      *  This mutex is used very sparingly and must be an application global lock.
      */
     mutex = mprCreateLock(control);
+    if (mutex == 0) {
+        return 0;
+    }
     control->lock = ejsWebLock;
     control->unlock = ejsWebUnlock;
     control->lockData = mutex;
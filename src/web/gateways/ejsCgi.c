@@ -3,6 +3,10 @@
  *
  *  The ejs handler supports the Ejscript web framework for applications using server-side Javascript. 
  *
+ *  By default, ejscgi serves one request per process. When invoked with --fastcgi (or as "ejsfast", or when the web
+ *  server passes a listening socket on standard input), it runs as a persistent FastCGI responder. The master 
+ *  interpreter with the core and web modules is then loaded once and each request runs in a cloned interpreter.
+ *
  *  Copyright (c) All Rights Reserved. See details at the end of the file.
  *
  *  TODO
@@ -15,6 +19,63 @@
 
 #include    "ejs.h"
 
+#if BLD_UNIX_LIKE
+ #include    <sys/un.h>
+#endif
+
+/*********************************** Defines **********************************/
+#if BLD_UNIX_LIKE
+/*
+ *  FastCGI protocol. See http://www.fastcgi.com/devkit/doc/fcgi-spec.html
+ */
+#define FCGI_LISTENSOCK_FILENO  0
+#define FCGI_VERSION            1
+#define FCGI_HEADER_LEN         8
+#define FCGI_MAX_CONTENT        65528           /* Max content per record, multiple of 8 */
+
+#define FCGI_BEGIN_REQUEST      1               /* Record types */
+#define FCGI_ABORT_REQUEST      2
+#define FCGI_END_REQUEST        3
+#define FCGI_PARAMS             4
+#define FCGI_STDIN              5
+#define FCGI_STDOUT             6
+#define FCGI_STDERR             7
+#define FCGI_DATA               8
+#define FCGI_GET_VALUES         9
+#define FCGI_GET_VALUES_RESULT  10
+#define FCGI_UNKNOWN_TYPE       11
+
+#define FCGI_RESPONDER          1               /* Roles */
+#define FCGI_KEEP_CONN          1               /* Begin request flags */
+
+#define FCGI_REQUEST_COMPLETE   0               /* End request protocol status */
+#define FCGI_OVERLOADED         2
+#define FCGI_UNKNOWN_ROLE       3
+
+/*
+ *  FastCGI connection from the web server. Multiple requests may be multiplexed over one connection.
+ */
+typedef struct FcgiConn {
+    int             fd;                     /* Socket connected to the web server */
+    MprWaitHandler  *handler;               /* I/O wait handler */
+    MprBuf          *input;                 /* Unparsed record data */
+    MprList         *requests;              /* Requests in progress on this connection */
+    int             closing;                /* Close once all requests complete */
+} FcgiConn;
+
+/*
+ *  FastCGI request. This is also the memory context for all per-request allocations.
+ */
+typedef struct FcgiRequest {
+    FcgiConn        *conn;                  /* Owning connection */
+    int             id;                     /* Request ID */
+    int             keepConn;               /* Keep the connection open after this request */
+    MprBuf          *params;                /* Encoded FCGI_PARAMS stream */
+    MprBuf          *input;                 /* FCGI_STDIN post data */
+    int             tooLarge;               /* Post data exceeded EJS_CGI_MAX_POST and was discarded */
+} FcgiRequest;
+#endif
+
 /***************************** Forward Declarations *****************************/
 
 static void copyFile(cchar *url);
@@ -26,7 +87,23 @@ static char *getDateString(MprFileInfo *sbuf);
 static int  getPostData();
 static int  getRequest();
 static int  initControlBlock();
+static void initRequest();
+static int  parseRequest();
 static void processRequest();
+static int  writeToClient(cchar *buf, int len);
+
+#if BLD_UNIX_LIKE
+static void acceptConn(void *data, int mask, int isPoolThread);
+static void closeConn(FcgiConn *conn);
+static void endRequest(FcgiRequest *rq, int protocolStatus);
+static bool isFastCgiListener();
+static int  openListener(cchar *address);
+static int  parseRecords(FcgiConn *conn);
+static void readConn(FcgiConn *conn, int mask, int isPoolThread);
+static void runFastCgiRequest(FcgiRequest *rq);
+static int  serveFastCgi();
+static int  writeRecord(FcgiConn *conn, int type, int id, cchar *buf, int len);
+#endif
 
 /*
  *  Control callbacks
@@ -68,6 +145,7 @@ static EjsWebControl    *control;
 static MprHashTable     *requestHeaders;
 static MprHashTable     *formVars;
 static FILE             *debugFile;
+static MprCtx           requestCtx;                 /* Memory context for the current request */
 
 /*
  *  Parsed request details
@@ -96,11 +174,27 @@ static char             *responseMimeType;
 static MprBuf           *output;
 static MprBuf           *headerOutput;
 
+#if BLD_UNIX_LIKE
+/*
+ *  FastCGI state
+ */
+static int              fastCgi;                    /* Serve requests persistently via FastCGI */
+static cchar            *fastCgiAddress;            /* Address to listen on. Null to use the inherited socket */
+static FcgiRequest      *currentRequest;            /* FastCGI request being run */
+static int              listenFd = -1;              /* FastCGI listening socket */
+static MprWaitHandler   *listenHandler;             /* Wait handler for new connections */
+static MprList          *connections;               /* Open FastCGI connections */
+static int              maxRequests = EJS_FCGI_MAX_REQUESTS;
+static int              requestCount;               /* Requests served by this process */
+static cchar            *sessionStore;              /* Shared session store file */
+#endif
+
 #if VXWORKS
 static char             **ppGlobalEnviron;
 #endif
 #if BLD_DEBUG
 static int              dummy;                      /* Mock up a dummy request */
+static int              sessionSpeed;               /* Run the session clock faster for testing */
 #endif
 
 /************************************* Code ***********************************/
@@ -120,6 +214,11 @@ int main(int argc, char **argv)
     if (strcmp(program, "ejscgi-debug") == 0) {
         debug++;
     }
+#if BLD_UNIX_LIKE
+    if (strcmp(program, "ejsfast") == 0) {
+        fastCgi++;
+    }
+#endif
 
     if (mprStart(mpr, 0) < 0) {
         mprError(mpr, "Can't start mpr services");
@@ -138,6 +237,34 @@ int main(int argc, char **argv)
 #if BLD_DEBUG
         } else if (strcmp(argp, "--dummy") == 0) {
             dummy++;
+
+        } else if (strcmp(argp, "--session-speed") == 0) {
+            if ((nextArg + 1) >= argc) {
+                err++;
+            } else {
+                sessionSpeed = atoi(argv[++nextArg]);
+            }
+#endif
+#if BLD_UNIX_LIKE
+        } else if (strcmp(argp, "--fastcgi") == 0) {
+            fastCgi++;
+            if ((nextArg + 1) < argc && argv[nextArg + 1][0] != '-') {
+                fastCgiAddress = argv[++nextArg];
+            }
+
+        } else if (strcmp(argp, "--max-requests") == 0) {
+            if ((nextArg + 1) >= argc) {
+                err++;
+            } else {
+                maxRequests = atoi(argv[++nextArg]);
+            }
+
+        } else if (strcmp(argp, "--session-store") == 0) {
+            if ((nextArg + 1) >= argc) {
+                err++;
+            } else {
+                sessionStore = argv[++nextArg];
+            }
 #endif
         } else if (strcmp(argp, "--log") == 0 || strcmp(argp, "-l") == 0) {
             if (nextArg >= argc) {
@@ -170,6 +297,11 @@ int main(int argc, char **argv)
         mprErrorPrintf(mpr,
             "Usage: %s [options]\n"
             "  Options:\n"
+#if BLD_UNIX_LIKE
+            "  --fastcgi [address]      # Serve FastCGI requests on a socket path or [host:]port\n"
+            "  --max-requests count     # Exit after serving count FastCGI requests (0 for no limit)\n"
+            "  --session-store file     # Share sessions with other FastCGI processes via a mapped file\n"
+#endif
             "  --log logSpec            # Diagnostic trace\n"
             "  --searchpath ejsPath     # Module search path\n"
             "  --version                # Emit the program version information\n\n",
@@ -177,13 +309,23 @@ int main(int argc, char **argv)
         return -1;
     }
 
+#if BLD_UNIX_LIKE
+    if (!fastCgi && isFastCgiListener()) {
+        fastCgi++;
+    }
+#endif
+    requestCtx = mpr;
+
     if (initControlBlock() < 0) {
         error(NULL, 0, "Can't initialize control block");
         exit(1);
     }
 
-    //  FAST CGI must update this
-    currentDate = getDateString(0);
+#if BLD_UNIX_LIKE
+    if (fastCgi) {
+        return serveFastCgi();
+    }
+#endif
 
     if (getRequest() < 0) {
         error(NULL, 0, "Can't get request");
@@ -225,10 +367,28 @@ static int initControlBlock()
     control->setMimeType = setMimeType;
     control->setVar = setVar;
     control->write = writeBlock;
+#if BLD_DEBUG
+    control->sessionSpeed = sessionSpeed;
+#endif
 
+    /*
+     *  Persistent FastCGI processes keep a master interpreter so the core modules are loaded only once.
+     */
+#if BLD_UNIX_LIKE
+    if (ejsOpenWebFramework(control, fastCgi) < 0) {
+#else
     if (ejsOpenWebFramework(control, 0) < 0) {
+#endif
         return EJS_ERR;
     }
+#if BLD_UNIX_LIKE
+    if (sessionStore && fastCgi) {
+        control->sessionBackend = ejsCreateSharedSessionBackend(control, sessionStore, 0, 0);
+        if (control->sessionBackend == 0) {
+            return EJS_ERR;
+        }
+    }
+#endif
 
     output = mprCreateBuf(mpr, EJS_CGI_MIN_BUF, EJS_CGI_MAX_BUF);
     headerOutput = mprCreateBuf(mpr, MPR_BUFSIZE, -1);
@@ -273,12 +433,10 @@ static int initControlBlock()
  */
 static int getRequest() 
 {
-    char    key[MPR_MAX_STRING], *ep, *cp, *value;
+    char    key[MPR_MAX_STRING], *ep, *cp;
     int     len, i;
 
-    formVars = mprCreateHash(mpr, EJS_CGI_HDR_HASH);
-    requestHeaders = mprCreateHash(mpr, EJS_CGI_HDR_HASH);
-    responseHeaders = mprCreateHash(mpr, EJS_CGI_HDR_HASH);
+    initRequest();
 
     if (debug) {
         debugFile = fopen("/tmp/ejscgi.log", "w+");
@@ -321,6 +479,41 @@ static int getRequest()
 
     }
 #endif
+    return parseRequest();
+}
+
+
+/*
+ *  Reset the request and response state before each request
+ */
+static void initRequest()
+{
+    formVars = mprCreateHash(requestCtx, EJS_CGI_HDR_HASH);
+    requestHeaders = mprCreateHash(requestCtx, EJS_CGI_HDR_HASH);
+    responseHeaders = mprCreateHash(requestCtx, EJS_CGI_HDR_HASH);
+    currentDate = getDateString(0);
+
+    contentLength = -1;
+    contentType = cookie = documentRoot = ext = pathInfo = pathTranslated = query = scriptName = uri = 0;
+    headersEmitted = 0;
+    input = 0;
+    responseCode = 0;
+    responseMsg = 0;
+    responseMimeType = 0;
+    web = 0;
+    ejs = 0;
+
+    mprFlushBuf(output);
+    mprFlushBuf(headerOutput);
+}
+
+
+/*
+ *  Extract the request details from the request headers
+ */
+static int parseRequest()
+{
+    char    *value;
 
     documentRoot = (char*) mprLookupHash(requestHeaders, "DOCUMENT_ROOT");
     cookie = (char*) mprLookupHash(requestHeaders, "HTTP_COOKIE");
@@ -357,14 +550,14 @@ static void processRequest()
     char        *appName, *url;
     int         flags;
 
-    appName = mprStrdup(mpr, pathInfo);
+    appName = mprStrdup(requestCtx, pathInfo);
     if (*appName == '/') {
         appName++;
     }
     if ((url = strchr(appName, '/')) != 0) {
         *url++ = '\0';
     }
-    if (strncmp(url, "web/", 4) == 0) {
+    if (url && strncmp(url, "web/", 4) == 0) {
         copyFile(url);
         flushOutput(output);
         return;
@@ -381,7 +574,7 @@ static void processRequest()
     if (ext == 0) {
         flags |= EJS_WEB_FLAG_APP;
     }
-    if ((web = ejsCreateWebRequest(mpr, control, NULL, scriptName, pathInfo, documentRoot, flags)) == 0) {
+    if ((web = ejsCreateWebRequest(requestCtx, control, NULL, scriptName, pathInfo, documentRoot, flags)) == 0) {
         error(NULL, 0, "Can't create web request");
         return;
     }
@@ -427,7 +620,7 @@ static void copyFile(cchar *url)
         }
     }
     mprSprintf(path, sizeof(path), "%s/%s", documentRoot, url);
-    file = mprOpen(mpr, path, O_RDONLY, 0);
+    file = mprOpen(requestCtx, path, O_RDONLY, 0);
     if (file == 0) {
         error(NULL, 0, "Can't open %s", path);
         return;
@@ -440,6 +633,568 @@ static void copyFile(cchar *url)
     }
 }
 
+#if BLD_UNIX_LIKE
+/*********************************** FastCGI **********************************/
+/*
+ *  Test if the web server has passed a listening socket on standard input. This is how FastCGI applications are 
+ *  normally spawned by the web server.
+ */
+static bool isFastCgiListener()
+{
+    struct sockaddr_storage     addr;
+    socklen_t                   len;
+
+    len = sizeof(addr);
+    errno = 0;
+    return getpeername(FCGI_LISTENSOCK_FILENO, (struct sockaddr*) &addr, &len) < 0 && errno == ENOTCONN;
+}
+
+
+/*
+ *  Open the FastCGI listening socket. The address is either a Unix domain socket path (containing "/") or a
+ *  TCP [host:]port. If the address is null, use the socket inherited from the web server.
+ */
+static int openListener(cchar *address)
+{
+    struct sockaddr_un  sun;
+    struct addrinfo     hints, *res;
+    char                host[MPR_MAX_STRING], *port;
+    int                 fd, one;
+
+    if (address == 0) {
+        return FCGI_LISTENSOCK_FILENO;
+    }
+    if (strchr(address, '/')) {
+        if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+            return MPR_ERR_CANT_OPEN;
+        }
+        memset(&sun, 0, sizeof(sun));
+        sun.sun_family = AF_UNIX;
+        if (mprStrcpy(sun.sun_path, sizeof(sun.sun_path), address) < 0) {
+            close(fd);
+            return MPR_ERR_BAD_ARGS;
+        }
+        unlink(address);
+        if (bind(fd, (struct sockaddr*) &sun, sizeof(sun)) < 0) {
+            close(fd);
+            return MPR_ERR_CANT_OPEN;
+        }
+
+    } else {
+        mprStrcpy(host, sizeof(host), address);
+        if ((port = strrchr(host, ':')) != 0) {
+            *port++ = '\0';
+        } else {
+            port = host;
+        }
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        if (getaddrinfo((port == host || *host == '\0') ? "127.0.0.1" : host, port, &hints, &res) != 0) {
+            return MPR_ERR_BAD_ARGS;
+        }
+        if ((fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol)) < 0) {
+            freeaddrinfo(res);
+            return MPR_ERR_CANT_OPEN;
+        }
+        one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char*) &one, sizeof(one));
+        if (bind(fd, res->ai_addr, res->ai_addrlen) < 0) {
+            freeaddrinfo(res);
+            close(fd);
+            return MPR_ERR_CANT_OPEN;
+        }
+        freeaddrinfo(res);
+    }
+    if (listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        return MPR_ERR_CANT_OPEN;
+    }
+    return fd;
+}
+
+
+/*
+ *  Serve FastCGI requests until recycled or terminated
+ */
+static int serveFastCgi()
+{
+    if ((listenFd = openListener(fastCgiAddress)) < 0) {
+        mprError(mpr, "Can't open FastCGI listening socket %s", fastCgiAddress ? fastCgiAddress : "");
+        return EJS_ERR;
+    }
+#if BLD_FEATURE_MULTITHREAD
+    /*
+     *  Requests share the gateway state so they must all be run on this thread
+     */
+    mprSetMaxPoolThreads(mpr, 0);
+#endif
+    connections = mprCreateList(mpr);
+    listenHandler = mprCreateWaitHandler(mpr, listenFd, MPR_READABLE, acceptConn, NULL, MPR_NORMAL_PRIORITY, 0);
+    if (listenHandler == 0) {
+        return EJS_ERR;
+    }
+    mprLog(mpr, 2, "ejscgi: serving FastCGI requests");
+
+    mprServiceEvents(mpr, -1, 0);
+
+    if (listenHandler) {
+        mprFree(listenHandler);
+        close(listenFd);
+    }
+    return 0;
+}
+
+
+/*
+ *  Stop accepting connections once the request limit is reached. The process exits when in-flight requests 
+ *  complete and the web server will spawn a fresh process.
+ */
+static bool recycling()
+{
+    return maxRequests > 0 && requestCount >= maxRequests;
+}
+
+
+static void checkRecycle()
+{
+    FcgiConn    *conn;
+    int         next;
+
+    if (!recycling()) {
+        return;
+    }
+    if (listenHandler) {
+        mprLog(mpr, 2, "ejscgi: recycling after %d requests", requestCount);
+        mprFree(listenHandler);
+        listenHandler = 0;
+        close(listenFd);
+    }
+    for (next = 0; (conn = mprGetNextItem(connections, &next)) != 0; ) {
+        if (mprGetListCount(conn->requests) == 0) {
+            closeConn(conn);
+            next--;
+        }
+    }
+    if (mprGetListCount(connections) == 0) {
+        mprTerminate(mpr, 1);
+    }
+}
+
+
+static void acceptConn(void *data, int mask, int isPoolThread)
+{
+    FcgiConn    *conn;
+    int         fd;
+
+    if ((fd = accept(listenFd, NULL, NULL)) < 0) {
+#if BLD_FEATURE_MULTITHREAD
+        mprEnableWaitEvents(listenHandler, 0);
+#endif
+        return;
+    }
+    if ((conn = mprAllocObjZeroed(mpr, FcgiConn)) == 0) {
+        close(fd);
+        return;
+    }
+    conn->fd = fd;
+    mprAddItem(connections, conn);
+    conn->input = mprCreateBuf(conn, MPR_BUFSIZE, -1);
+    conn->requests = mprCreateList(conn);
+    conn->handler = mprCreateWaitHandler(conn, fd, MPR_READABLE, (MprWaitProc) readConn, conn, MPR_NORMAL_PRIORITY, 0);
+    if (conn->input == 0 || conn->requests == 0 || conn->handler == 0) {
+        closeConn(conn);
+        return;
+    }
+    if (mprGetListCount(connections) >= EJS_FCGI_MAX_CONNS) {
+        mprDisableWaitEvents(listenHandler, 0);
+#if BLD_FEATURE_MULTITHREAD
+    } else {
+        mprEnableWaitEvents(listenHandler, 0);
+#endif
+    }
+}
+
+
+static void closeConn(FcgiConn *conn)
+{
+    if (conn->handler) {
+        mprFree(conn->handler);
+    }
+    close(conn->fd);
+    if (mprGetListCount(connections) >= EJS_FCGI_MAX_CONNS && listenHandler) {
+        mprEnableWaitEvents(listenHandler, 0);
+    }
+    mprRemoveItem(connections, conn);
+    mprFree(conn);
+}
+
+
+static void readConn(FcgiConn *conn, int mask, int isPoolThread)
+{
+    MprBuf      *buf;
+    int         nbytes;
+
+    buf = conn->input;
+    mprResetBufIfEmpty(buf);
+    if (mprGetBufSpace(buf) < MPR_BUFSIZE) {
+        mprCompactBuf(buf);
+        if (mprGetBufSpace(buf) < MPR_BUFSIZE && mprGrowBuf(buf, MPR_BUFSIZE) < 0) {
+            closeConn(conn);
+            return;
+        }
+    }
+    nbytes = read(conn->fd, mprGetBufEnd(buf), mprGetBufSpace(buf));
+    if (nbytes < 0 && (errno == EINTR || errno == EAGAIN)) {
+        nbytes = 0;
+    } else if (nbytes <= 0) {
+        closeConn(conn);
+        checkRecycle();
+        return;
+    }
+    mprAdjustBufEnd(buf, nbytes);
+
+    if (parseRecords(conn) < 0 || (conn->closing && mprGetListCount(conn->requests) == 0)) {
+        closeConn(conn);
+    } else {
+#if BLD_FEATURE_MULTITHREAD
+        mprEnableWaitEvents(conn->handler, 0);
+#endif
+    }
+    checkRecycle();
+}
+
+
+static FcgiRequest *findRequest(FcgiConn *conn, int id)
+{
+    FcgiRequest     *rq;
+    int             next;
+
+    for (next = 0; (rq = mprGetNextItem(conn->requests, &next)) != 0; ) {
+        if (rq->id == id) {
+            return rq;
+        }
+    }
+    return 0;
+}
+
+
+static void beginRequest(FcgiConn *conn, int id, uchar *body, int len)
+{
+    FcgiRequest     *rq;
+    uchar           end[8];
+    int             role;
+
+    if (len < 8 || findRequest(conn, id)) {
+        return;
+    }
+    role = (body[0] << 8) | body[1];
+    if (role != FCGI_RESPONDER || recycling()) {
+        memset(end, 0, sizeof(end));
+        end[4] = (role != FCGI_RESPONDER) ? FCGI_UNKNOWN_ROLE : FCGI_OVERLOADED;
+        writeRecord(conn, FCGI_END_REQUEST, id, (char*) end, sizeof(end));
+        if (!(body[2] & FCGI_KEEP_CONN)) {
+            conn->closing = 1;
+        }
+        return;
+    }
+    if ((rq = mprAllocObjZeroed(conn, FcgiRequest)) == 0) {
+        return;
+    }
+    rq->conn = conn;
+    rq->id = id;
+    rq->keepConn = body[2] & FCGI_KEEP_CONN;
+    rq->params = mprCreateBuf(rq, MPR_BUFSIZE, -1);
+    rq->input = mprCreateBuf(rq, MPR_BUFSIZE, -1);
+    mprAddItem(conn->requests, rq);
+}
+
+
+/*
+ *  Reply to a management request for the application's limits
+ */
+static void getValues(FcgiConn *conn)
+{
+    MprBuf      *buf;
+    char        value[16];
+    cchar       *names[] = { "FCGI_MAX_CONNS", "FCGI_MAX_REQS", "FCGI_MPXS_CONNS" };
+    int         i, len;
+
+    buf = mprCreateBuf(conn, MPR_BUFSIZE, -1);
+    for (i = 0; i < (int) (sizeof(names) / sizeof(*names)); i++) {
+        if (i < 2) {
+            mprItoa(value, sizeof(value), EJS_FCGI_MAX_CONNS, 10);
+        } else {
+            mprStrcpy(value, sizeof(value), "1");
+        }
+        len = (int) strlen(names[i]);
+        mprPutCharToBuf(buf, len);
+        mprPutCharToBuf(buf, (int) strlen(value));
+        mprPutBlockToBuf(buf, names[i], len);
+        mprPutStringToBuf(buf, value);
+    }
+    writeRecord(conn, FCGI_GET_VALUES_RESULT, 0, mprGetBufStart(buf), mprGetBufLength(buf));
+    mprFree(buf);
+}
+
+
+/*
+ *  Parse and dispatch all complete records in the connection input buffer. Records for different requests may be
+ *  interleaved. A request is run once its parameters and post data have been fully received.
+ */
+static int parseRecords(FcgiConn *conn)
+{
+    FcgiRequest     *rq;
+    MprBuf          *buf;
+    uchar           *hp, *content, unknown[8];
+    int             type, id, contentLen, paddingLen, len;
+
+    buf = conn->input;
+    while ((len = mprGetBufLength(buf)) >= FCGI_HEADER_LEN) {
+        hp = (uchar*) mprGetBufStart(buf);
+        if (hp[0] != FCGI_VERSION) {
+            return MPR_ERR_BAD_FORMAT;
+        }
+        type = hp[1];
+        id = (hp[2] << 8) | hp[3];
+        contentLen = (hp[4] << 8) | hp[5];
+        paddingLen = hp[6];
+        if (len < (FCGI_HEADER_LEN + contentLen + paddingLen)) {
+            break;
+        }
+        content = &hp[FCGI_HEADER_LEN];
+        rq = (id) ? findRequest(conn, id) : 0;
+
+        switch (type) {
+        case FCGI_BEGIN_REQUEST:
+            beginRequest(conn, id, content, contentLen);
+            break;
+
+        case FCGI_ABORT_REQUEST:
+            if (rq) {
+                endRequest(rq, FCGI_REQUEST_COMPLETE);
+            }
+            break;
+
+        case FCGI_PARAMS:
+            if (rq) {
+                mprPutBlockToBuf(rq->params, (char*) content, contentLen);
+            }
+            break;
+
+        case FCGI_STDIN:
+            if (rq) {
+                if (contentLen > 0) {
+                    if (rq->tooLarge || (mprGetBufLength(rq->input) + contentLen) > EJS_CGI_MAX_POST) {
+                        rq->tooLarge = 1;
+                        mprFlushBuf(rq->input);
+                    } else {
+                        mprPutBlockToBuf(rq->input, (char*) content, contentLen);
+                    }
+                } else {
+                    runFastCgiRequest(rq);
+                }
+            }
+            break;
+
+        case FCGI_DATA:
+            break;
+
+        case FCGI_GET_VALUES:
+            getValues(conn);
+            break;
+
+        default:
+            memset(unknown, 0, sizeof(unknown));
+            unknown[0] = type;
+            writeRecord(conn, FCGI_UNKNOWN_TYPE, 0, (char*) unknown, sizeof(unknown));
+            break;
+        }
+        mprAdjustBufStart(buf, FCGI_HEADER_LEN + contentLen + paddingLen);
+    }
+    return 0;
+}
+
+
+/*
+ *  Get a name or value length from a name-value pair. Lengths over 127 bytes are encoded in 4 bytes.
+ */
+static int getParamLength(uchar **cp, uchar *end)
+{
+    uchar   *p;
+    int     len;
+
+    p = *cp;
+    if (p >= end) {
+        return -1;
+    }
+    if (*p < 0x80) {
+        *cp = p + 1;
+        return *p;
+    }
+    if ((end - p) < 4) {
+        return -1;
+    }
+    len = ((p[0] & 0x7f) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    *cp = p + 4;
+    return len;
+}
+
+
+/*
+ *  Decode the FCGI_PARAMS name-value pairs into the request headers
+ */
+static int decodeParams(FcgiRequest *rq)
+{
+    uchar   *cp, *end;
+    char    *key, *value;
+    int     keyLen, valueLen;
+
+    cp = (uchar*) mprGetBufStart(rq->params);
+    end = cp + mprGetBufLength(rq->params);
+
+    while (cp < end) {
+        keyLen = getParamLength(&cp, end);
+        valueLen = getParamLength(&cp, end);
+        /*
+         *  Lengths are up to 2^31 - 1 each, so check them separately. Their sum could overflow an int.
+         */
+        if (keyLen < 0 || valueLen < 0 || keyLen > (end - cp) || valueLen > ((end - cp) - keyLen)) {
+            return MPR_ERR_BAD_FORMAT;
+        }
+        key = (char*) mprAlloc(rq, keyLen + valueLen + 2);
+        if (key == 0) {
+            return MPR_ERR_NO_MEMORY;
+        }
+        memcpy(key, cp, keyLen);
+        key[keyLen] = '\0';
+        value = &key[keyLen + 1];
+        memcpy(value, &cp[keyLen], valueLen);
+        value[valueLen] = '\0';
+        cp += keyLen + valueLen;
+        mprAddHash(requestHeaders, key, value);
+    }
+    return 0;
+}
+
+
+/*
+ *  Run a fully received request. All request memory is allocated from the request object and freed when it ends.
+ */
+static void runFastCgiRequest(FcgiRequest *rq)
+{
+    char    *msg;
+    int     len;
+
+    currentRequest = rq;
+    requestCtx = rq;
+    initRequest();
+
+    if (decodeParams(rq) < 0) {
+        error(NULL, 0, "Bad FastCGI parameters");
+    } else if (rq->tooLarge) {
+        error(NULL, MPR_HTTP_CODE_REQUEST_TOO_LARGE, "Request body is too large");
+    } else if (parseRequest() == 0) {
+        processRequest();
+    }
+    if (responseCode && responseMsg) {
+        len = mprAllocSprintf(rq, &msg, -1, "ejscgi: ERROR: %s\n", responseMsg);
+        writeRecord(rq->conn, FCGI_STDERR, rq->id, msg, len);
+    }
+    requestCount++;
+    endRequest(rq, FCGI_REQUEST_COMPLETE);
+}
+
+
+/*
+ *  Complete a request. This terminates the output stream and frees the request.
+ */
+static void endRequest(FcgiRequest *rq, int protocolStatus)
+{
+    FcgiConn    *conn;
+    uchar       end[8];
+
+    conn = rq->conn;
+    writeRecord(conn, FCGI_STDOUT, rq->id, NULL, 0);
+
+    memset(end, 0, sizeof(end));
+    end[4] = protocolStatus;
+    writeRecord(conn, FCGI_END_REQUEST, rq->id, (char*) end, sizeof(end));
+
+    if (!rq->keepConn) {
+        conn->closing = 1;
+    }
+    if (currentRequest == rq) {
+        currentRequest = 0;
+        requestCtx = mpr;
+        web = 0;
+        ejs = 0;
+    }
+    mprRemoveItem(conn->requests, rq);
+    mprFree(rq);
+}
+
+
+/*
+ *  Write a block of data to the web server as one or more records. A zero length write emits an empty record which 
+ *  marks the end of a stream.
+ */
+static int writeRecord(FcgiConn *conn, int type, int id, cchar *buf, int len)
+{
+    struct iovec    iov[3];
+    uchar           header[FCGI_HEADER_LEN];
+    char            padding[8];
+    int             written, count, rc, i;
+
+    memset(padding, 0, sizeof(padding));
+    written = 0;
+    do {
+        count = min(len - written, FCGI_MAX_CONTENT);
+        header[0] = FCGI_VERSION;
+        header[1] = type;
+        header[2] = (id >> 8) & 0xff;
+        header[3] = id & 0xff;
+        header[4] = (count >> 8) & 0xff;
+        header[5] = count & 0xff;
+        header[6] = (8 - (count & 7)) & 7;
+        header[7] = 0;
+
+        iov[0].iov_base = (char*) header;
+        iov[0].iov_len = FCGI_HEADER_LEN;
+        iov[1].iov_base = (char*) &buf[written];
+        iov[1].iov_len = count;
+        iov[2].iov_base = padding;
+        iov[2].iov_len = header[6];
+
+        for (i = 0; i < 3; ) {
+            if (iov[i].iov_len == 0) {
+                i++;
+                continue;
+            }
+            rc = writev(conn->fd, &iov[i], 3 - i);
+            if (rc < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                conn->closing = 1;
+                return MPR_ERR_CANT_WRITE;
+            }
+            while (i < 3 && rc >= (int) iov[i].iov_len) {
+                rc -= iov[i].iov_len;
+                iov[i++].iov_len = 0;
+            }
+            if (i < 3) {
+                iov[i].iov_base = (char*) iov[i].iov_base + rc;
+                iov[i].iov_len -= rc;
+            }
+        }
+        written += count;
+    } while (written < len);
+    return len;
+}
+#endif /* BLD_UNIX_LIKE */
+
 
 /****************************** Control Callbacks ****************************/
 /*
@@ -474,7 +1229,7 @@ void error(void *handle, int code, cchar *fmt, ...)
         }
         responseCode = code;
         va_start(args, fmt);
-        mprAllocVsprintf(mpr, &responseMsg, -1, fmt, args);
+        mprAllocVsprintf(requestCtx, &responseMsg, -1, fmt, args);
         va_end(args);
     }
 }
@@ -552,7 +1307,7 @@ static void setHeader(void *handle, bool allowMultiple, cchar *key, cchar *fmt,
     va_list         vargs;
 
     va_start(vargs, fmt);
-    mprAllocVsprintf(mpr, &value, EJS_MAX_HEADERS, fmt, vargs);
+    mprAllocVsprintf(requestCtx, &value, EJS_MAX_HEADERS, fmt, vargs);
 
     if (allowMultiple) {
         mprAddDuplicateHash(responseHeaders, key, value);
@@ -602,7 +1357,7 @@ static int writeBlock(void *handle, cchar *buf, int size)
         if (size < EJS_CGI_MAX_BUF) {
             rc = mprPutBlockToBuf(output, buf, size);
         } else {
-            rc = write(1, (char*) buf, size);
+            rc = writeToClient(buf, size);
         }
     }
     return rc;
@@ -877,7 +1632,7 @@ static void flushOutput(MprBuf *buf)
     }
 
     while ((len = mprGetBufLength(buf)) > 0) {
-        rc = write(1, mprGetBufStart(buf), len);
+        rc = writeToClient(mprGetBufStart(buf), len);
         if (rc < 0) {
             //  TODO diag
             return;
@@ -888,6 +1643,20 @@ static void flushOutput(MprBuf *buf)
 }
 
 
+/*
+ *  Write data to the web server. For FastCGI, data is wrapped in FCGI_STDOUT records.
+ */
+static int writeToClient(cchar *buf, int len)
+{
+#if BLD_UNIX_LIKE
+    if (currentRequest) {
+        return writeRecord(currentRequest->conn, FCGI_STDOUT, currentRequest->id, buf, len);
+    }
+#endif
+    return write(1, (char*) buf, len);
+}
+
+
 /*
  *  Decode the query and post form data into formVars
  */
@@ -896,7 +1665,7 @@ static void decodeFormData(cchar *data)
     char    *value, *key, *buf;
     int     buflen;
 
-    buf = mprStrdup(mpr, data);
+    buf = mprStrdup(requestCtx, data);
     buflen = strlen(buf);
 
     /*
@@ -923,8 +1692,28 @@ static int getPostData()
     if (contentLength == 0) {
         return 0;
     }
+    if (contentLength > EJS_CGI_MAX_POST) {
+        error(NULL, MPR_HTTP_CODE_REQUEST_TOO_LARGE, "Request body is too large");
+        return MPR_ERR_WONT_FIT;
+    }
+
+#if BLD_UNIX_LIKE
+    if (currentRequest) {
+        /*
+         *  FastCGI post data has already been received via FCGI_STDIN records
+         */
+        len = mprGetBufLength(currentRequest->input);
+        if (contentLength < 0 || len < contentLength) {
+            contentLength = len;
+        }
+        mprAddNullToBuf(currentRequest->input);
+        input = mprGetBufStart(currentRequest->input);
+        input[contentLength] = '\0';
+        return 0;
+    }
+#endif
 
-    input = (char*) malloc(contentLength + 1);
+    input = (char*) mprAlloc(requestCtx, contentLength + 1);
     if (input == 0) {
         error(NULL, 0, "Content length is too large");
         return MPR_ERR_NO_MEMORY;
@@ -999,7 +1788,7 @@ static char *getDateString(MprFileInfo *sbuf)
         when = (MprTime) sbuf->mtime * MPR_TICKS_PER_SEC;
     }
 
-    dateStr = (char*) mprAlloc(mpr, 64);
+    dateStr = (char*) mprAlloc(requestCtx, 64);
     mprGmtime(mpr, &tm, when);
     mprStrftime(mpr, dateStr, 64, "%a, %d %b %Y %T %Z", &tm);
 